@@ -268,7 +268,7 @@ void function_processes(const char *transaction, char *function,
 
     int rows= 0;
     for(p = root_of_pids(); p ; p = p->next) {
-        if(!p->updated)
+        if(!p->updated || p->short_lived)
             continue;
 
         if(category && p->target != category)
@@ -102,7 +102,7 @@ static inline int incrementally_read_pid_io(struct pid_stat *p, void *ptr) {
 // --------------------------------------------------------------------------------------------------------------------
 
 int incrementally_collect_data_for_pid_stat(struct pid_stat *p, void *ptr) {
-    if(unlikely(p->read)) return 0;
+    if(unlikely(p->read || p->short_lived)) return 0;
 
     pid_collection_started(p);
 
@@ -170,6 +170,12 @@ int incrementally_collect_data_for_pid(pid_t pid, void *ptr) {
     struct pid_stat *p = get_or_allocate_pid_entry(pid);
     if(unlikely(!p)) return 0;
 
+    if(unlikely(p->short_lived)) {
+        // the pid of a short-lived process has been reused by a new process
+        del_pid_entry(pid);
+        p = get_or_allocate_pid_entry(pid);
+    }
+
     return incrementally_collect_data_for_pid_stat(p, ptr);
 }
 #endif
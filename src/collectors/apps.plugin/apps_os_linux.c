@@ -13,7 +13,7 @@ int max_fds_cache_seconds = 60;
 kernel_uint_t system_uptime_secs;
 
 void apps_os_init_linux(void) {
-    ;
+    apps_proc_events_init();
 }
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -288,7 +288,145 @@ static void apps_handle_smaps_updates(void) {
 
 #endif // PROCESSES_HAVE_SMAPS_ROLLUP
 
-bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
+// --------------------------------------------------------------------------------------------------------------------
+// /proc/pid/fd
+//
+// Reading the fds of a process is a readdir() of /proc/PID/fd and a readlink() for every fd
+// not cached, so on busy servers this is most of the work apps.plugin does.
+// The processes are queued while they are collected, and their fds are scanned after all
+// processes have been collected, by a pool of threads.
+//
+// The fds of a process are touched only by the thread scanning the process. The list of all
+// the files of the system (all_files) however is shared, so each thread records the changes
+// it needs to make to it in its own table, and the main thread applies them when all threads
+// have finished. The names of the new files are deduplicated per thread, so that the global
+// index is searched once per unique name of each thread.
+
+int fds_scan_threads = 0;           // 0 = auto
+int fds_sample_seconds = 0;         // 0 = scan the fds of all processes on every iteration
+
+#define FDS_SCAN_MAX_THREADS 8
+#define FDS_SCAN_PIDS_PER_THREAD 64 // the minimum number of processes to wake up a thread
+
+typedef enum __attribute__((packed)) {
+    FDS_OP_NOT_USED,                // the process does not use a file anymore
+    FDS_OP_ADD,                     // the process uses a file we did not know it uses
+    FDS_OP_DONE,                    // the fds of the process have been scanned
+} FDS_OP_TYPE;
+
+struct fds_op {
+    FDS_OP_TYPE type;
+    int fdid;                       // FDS_OP_ADD: the fd of the process
+    uint32_t id;                    // NOT_USED: the file id, ADD: the name in the table, DONE: errno or 0
+    struct pid_stat *p;
+};
+
+struct fds_name {
+    uint32_t hash;
+    uint32_t offset;                // the offset of the name in the strings
+    uint32_t file;                  // the file id in all_files, 0 = not looked up yet
+};
+
+typedef struct fds_scan_table {
+    struct fds_op *ops;             // the changes to all_files, in the order they have to be applied
+    size_t ops_used, ops_size;
+
+    struct fds_name *names;         // the unique names of the files added
+    uint32_t names_used, names_size;
+
+    uint32_t *slots;                // open addressing index of the names (name + 1, 0 = empty)
+    uint32_t slots_size;
+
+    char *strings;
+    uint32_t strings_used, strings_size;
+
+    size_t files, filenames_allocated, inodes_changed, links_changed;
+} FDS_SCAN_TABLE;
+
+static struct {
+    struct pid_stat **pids;         // the processes to be scanned in this iteration
+    size_t used, size;
+    size_t next;                    // the next process to be scanned, atomically incremented
+
+    size_t threads;                 // the threads scanning, including the caller
+    FDS_SCAN_TABLE *tables;         // one per thread
+    ND_EXECUTOR_GROUP *group;
+} fds_scan = { 0 };
+
+static inline void fds_table_op(FDS_SCAN_TABLE *t, FDS_OP_TYPE type, struct pid_stat *p, int fdid, uint32_t id) {
+    if(unlikely(t->ops_used == t->ops_size)) {
+        t->ops_size = t->ops_size ? t->ops_size * 2 : 1024;
+        t->ops = reallocz(t->ops, t->ops_size * sizeof(*t->ops));
+    }
+
+    struct fds_op *op = &t->ops[t->ops_used++];
+    op->type = type;
+    op->fdid = fdid;
+    op->id = id;
+    op->p = p;
+}
+
+static void fds_table_slots_grow(FDS_SCAN_TABLE *t) {
+    t->slots_size = t->slots_size ? t->slots_size * 2 : 1024;
+    freez(t->slots);
+    t->slots = callocz(t->slots_size, sizeof(uint32_t));
+
+    for(uint32_t n = 0; n < t->names_used ;n++) {
+        uint32_t s = t->names[n].hash & (t->slots_size - 1);
+        while(t->slots[s])
+            s = (s + 1) & (t->slots_size - 1);
+
+        t->slots[s] = n + 1;
+    }
+}
+
+static uint32_t fds_table_name(FDS_SCAN_TABLE *t, const char *name, size_t len, uint32_t hash) {
+    if(unlikely((t->names_used + 1) * 2 > t->slots_size))
+        fds_table_slots_grow(t);
+
+    uint32_t s = hash & (t->slots_size - 1);
+    while(t->slots[s]) {
+        struct fds_name *n = &t->names[t->slots[s] - 1];
+        if(n->hash == hash && strcmp(&t->strings[n->offset], name) == 0)
+            return t->slots[s] - 1;
+
+        s = (s + 1) & (t->slots_size - 1);
+    }
+
+    if(unlikely(t->names_used == t->names_size)) {
+        t->names_size = t->names_size ? t->names_size * 2 : 512;
+        t->names = reallocz(t->names, t->names_size * sizeof(*t->names));
+    }
+
+    if(unlikely(t->strings_used + len + 1 > t->strings_size)) {
+        t->strings_size = MAX(t->strings_size * 2, MAX(t->strings_used + len + 1, 65536));
+        t->strings = reallocz(t->strings, t->strings_size);
+    }
+
+    struct fds_name *n = &t->names[t->names_used];
+    n->hash = hash;
+    n->offset = t->strings_used;
+    n->file = 0;
+    memcpy(&t->strings[t->strings_used], name, len + 1);
+    t->strings_used += len + 1;
+
+    t->slots[s] = t->names_used + 1;
+    return t->names_used++;
+}
+
+static void fds_table_reset(FDS_SCAN_TABLE *t) {
+    if(t->names_used)
+        memset(t->slots, 0, t->slots_size * sizeof(uint32_t));
+
+    t->ops_used = 0;
+    t->names_used = 0;
+    t->strings_used = 0;
+    t->files = t->filenames_allocated = t->inodes_changed = t->links_changed = 0;
+}
+
+// scan the fds of a process - this runs in parallel for different processes,
+// so it should touch only the process and the table of the thread
+static bool fds_scan_pid(struct pid_stat *p, FDS_SCAN_TABLE *t) {
     if(unlikely(!p->fds_dirname)) {
         char dirname[FILENAME_MAX+1];
         snprintfz(dirname, FILENAME_MAX, "%s/proc/%d/fd", netdata_configured_host_prefix, p->pid);
@@ -334,8 +472,8 @@ bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
 
         if(unlikely(p->fds[fdid].fd < 0 && de->d_ino != p->fds[fdid].inode)) {
             // inodes do not match, clear the previous entry
-            inodes_changed_counter++;
-            file_descriptor_not_used(-p->fds[fdid].fd);
+            t->inodes_changed++;
+            fds_table_op(t, FDS_OP_NOT_USED, p, fdid, -p->fds[fdid].fd);
             clear_pid_fd(&p->fds[fdid]);
         }
 
@@ -346,13 +484,13 @@ bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
         }
 
         if(unlikely(!p->fds[fdid].filename)) {
-            filenames_allocated_counter++;
+            t->filenames_allocated++;
             char fdname[FILENAME_MAX + 1];
             snprintfz(fdname, FILENAME_MAX, "%s/proc/%d/fd/%s", netdata_configured_host_prefix, p->pid, de->d_name);
             p->fds[fdid].filename = strdupz(fdname);
         }
 
-        file_counter++;
+        t->files++;
         ssize_t l = readlink(p->fds[fdid].filename, linkname, FILENAME_MAX);
         if(unlikely(l == -1)) {
             // cannot read the link
@@ -361,7 +499,7 @@ bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
                 netdata_log_error("Cannot read link %s", p->fds[fdid].filename);
 
             if(unlikely(p->fds[fdid].fd < 0)) {
-                file_descriptor_not_used(-p->fds[fdid].fd);
+                fds_table_op(t, FDS_OP_NOT_USED, p, fdid, -p->fds[fdid].fd);
                 clear_pid_fd(&p->fds[fdid]);
             }
 
@@ -374,17 +512,15 @@ bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
 
         if(unlikely(p->fds[fdid].fd < 0 && p->fds[fdid].link_hash != link_hash)) {
             // the link changed
-            links_changed_counter++;
-            file_descriptor_not_used(-p->fds[fdid].fd);
+            t->links_changed++;
+            fds_table_op(t, FDS_OP_NOT_USED, p, fdid, -p->fds[fdid].fd);
             clear_pid_fd(&p->fds[fdid]);
         }
 
         if(unlikely(p->fds[fdid].fd == 0)) {
-            // we don't know this fd, get it
-
-            // if another process already has this, we will get
-            // the same id
-            p->fds[fdid].fd = (int)file_descriptor_find_or_add(linkname, link_hash);
+            // we don't know this fd - the fd stays zero until the main thread
+            // finds or adds the file in all_files
+            fds_table_op(t, FDS_OP_ADD, p, fdid, fds_table_name(t, linkname, l, link_hash));
             p->fds[fdid].inode = de->d_ino;
             p->fds[fdid].link_hash = link_hash;
         }
@@ -420,6 +556,119 @@ bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
     return true;
 }
 
+static void fds_scan_run(size_t slot, void *ptr __maybe_unused) {
+    FDS_SCAN_TABLE *t = &fds_scan.tables[slot];
+
+    size_t i;
+    while((i = __atomic_fetch_add(&fds_scan.next, 1, __ATOMIC_RELAXED)) < fds_scan.used) {
+        struct pid_stat *p = fds_scan.pids[i];
+        errno_clear();
+        bool ok = fds_scan_pid(p, t);
+        fds_table_op(t, FDS_OP_DONE, p, 0, ok ? 0 : (uint32_t)errno);
+    }
+}
+
+// apply the changes of a table to all_files - this runs on the main thread
+static void fds_table_merge(FDS_SCAN_TABLE *t) {
+    for(size_t i = 0; i < t->ops_used ;i++) {
+        struct fds_op *op = &t->ops[i];
+
+        switch(op->type) {
+            case FDS_OP_NOT_USED:
+                file_descriptor_not_used((int)op->id);
+                break;
+
+            case FDS_OP_ADD: {
+                // the files found by this table are used by the fds added,
+                // so their ids remain valid until the end of the merge
+                struct fds_name *n = &t->names[op->id];
+                if(!n->file)
+                    n->file = file_descriptor_find_or_add(&t->strings[n->offset], n->hash);
+                else
+                    file_descriptor_used(n->file);
+
+                op->p->fds[op->fdid].fd = (int)n->file;
+                break;
+            }
+
+            case FDS_OP_DONE:
+                // release the fds the process does not have anymore
+                cleanup_negative_pid_fds(op->p);
+
+                if(unlikely(op->id)) {
+                    errno = (int)op->id;
+                    managed_log(op->p, PID_LOG_FDS, false);
+                }
+                break;
+        }
+    }
+
+    file_counter += t->files;
+    filenames_allocated_counter += t->filenames_allocated;
+    inodes_changed_counter += t->inodes_changed;
+    links_changed_counter += t->links_changed;
+
+    fds_table_reset(t);
+}
+
+static void fds_scan_init(void) {
+    if(fds_scan_threads <= 0) {
+        // one thread for every 4 CPUs, the scanning is mostly waiting for the kernel -
+        // the cpus are the ones the agent uses for its threads, or the ones we can use
+        const char *conf_cpus = getenv("NETDATA_CONF_CPUS");
+        size_t cpus = conf_cpus ? str2ul(conf_cpus) : 0;
+        if(!cpus)
+            cpus = os_get_effective_cpus().effective;
+        fds_scan.threads = MIN(MAX(cpus / 4, 1), FDS_SCAN_MAX_THREADS);
+    }
+    else
+        fds_scan.threads = (size_t)fds_scan_threads;
+
+    fds_scan.tables = callocz(fds_scan.threads, sizeof(FDS_SCAN_TABLE));
+
+    // the scanning threads are the threads of the executor of the plugin, plus the caller
+    nd_executor_init(fds_scan.threads - 1);
+    fds_scan.group = nd_executor_group_get("fds", fds_scan.threads);
+
+    nd_log(NDLS_COLLECTORS, NDLP_INFO, "apps.plugin: scanning the fds of processes with %zu threads", fds_scan.threads);
+}
+
+bool apps_os_read_pid_fds_linux(struct pid_stat *p, void *ptr __maybe_unused) {
+    // when sampling, the fds of each process are scanned once every a few iterations,
+    // spread across iterations by pid - new processes are always scanned
+    size_t every = (fds_sample_seconds > update_every) ? (size_t)(fds_sample_seconds / update_every) : 1;
+    if(every > 1 && p->fds_dirname && (global_iterations_counter + (size_t)p->pid) % every)
+        return true;
+
+    if(unlikely(fds_scan.used == fds_scan.size)) {
+        fds_scan.size = fds_scan.size ? fds_scan.size * 2 : 1024;
+        fds_scan.pids = reallocz(fds_scan.pids, fds_scan.size * sizeof(struct pid_stat *));
+    }
+
+    // the fds are scanned by apps_os_scan_queued_pids_fds(),
+    // after all the processes have been collected
+    fds_scan.pids[fds_scan.used++] = p;
+    return true;
+}
+
+static void apps_os_scan_queued_pids_fds(void) {
+    if(!fds_scan.used)
+        return;
+
+    if(unlikely(!fds_scan.tables))
+        fds_scan_init();
+
+    size_t active = MIN(fds_scan.threads, MAX(fds_scan.used / FDS_SCAN_PIDS_PER_THREAD, 1));
+    fds_scan.next = 0;
+
+    size_t ran = nd_executor_parallel(fds_scan.group, ND_EXECUTOR_PRIORITY_HIGH, active, fds_scan_run, NULL);
+
+    for(size_t t = 0; t < ran ;t++)
+        fds_table_merge(&fds_scan.tables[t]);
+
+    fds_scan.used = 0;
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // /proc/meminfo
 
@@ -1008,21 +1257,7 @@ cleanup:
 // to avoid filling up all disk space
 // if debug is enabled, all errors are printed
 
-bool apps_os_collect_all_pids_linux(void) {
-#if (PROCESSES_HAVE_STATE == 1)
-    // clear process state counter
-    memset(proc_state_count, 0, sizeof proc_state_count);
-#endif
-
-    // preload the parents and then their children
-    collect_parents_before_children();
-
-    static char uptime_filename[FILENAME_MAX + 1] = "";
-    if(*uptime_filename == '\0')
-        snprintfz(uptime_filename, FILENAME_MAX, "%s/proc/uptime", netdata_configured_host_prefix);
-
-    system_uptime_secs = (kernel_uint_t)(uptime_msec(uptime_filename) / MSEC_PER_SEC);
-
+static bool scan_proc_for_new_pids(void) {
     char dirname[FILENAME_MAX + 1];
 
     snprintfz(dirname, FILENAME_MAX, "%s/proc", netdata_configured_host_prefix);
@@ -1047,6 +1282,41 @@ bool apps_os_collect_all_pids_linux(void) {
     }
     closedir(dir);
 
+    return true;
+}
+
+bool apps_os_collect_all_pids_linux(void) {
+#if (PROCESSES_HAVE_STATE == 1)
+    // clear process state counter
+    memset(proc_state_count, 0, sizeof proc_state_count);
+#endif
+
+    // preload the parents and then their children
+    collect_parents_before_children();
+
+    static char uptime_filename[FILENAME_MAX + 1] = "";
+    if(*uptime_filename == '\0')
+        snprintfz(uptime_filename, FILENAME_MAX, "%s/proc/uptime", netdata_configured_host_prefix);
+
+    system_uptime_secs = (kernel_uint_t)(uptime_msec(uptime_filename) / MSEC_PER_SEC);
+
+    // find the new processes - from the process events, or by scanning /proc
+    if(!apps_proc_events_collect_new_pids()) {
+        size_t pids_before = all_pids_count();
+
+        if(!scan_proc_for_new_pids())
+            return false;
+
+        apps_proc_events_scan_completed(all_pids_count() - pids_before);
+    }
+
+    // the fds of the processes collected
+    if(enable_file_charts)
+        apps_os_scan_queued_pids_fds();
+
+    // the processes that started and exited since the last iteration
+    apps_proc_events_account_exited_pids();
+
 #if (PROCESSES_HAVE_SMAPS_ROLLUP == 1)
     apps_handle_smaps_updates();
 #endif
@@ -748,7 +748,7 @@ static inline void process_exited_pids(void) {
 //        }
 
         for(struct pid_stat *pp = p->parent; pp ; pp = pp->parent) {
-            if(!pp->updated) continue;
+            if(!pp->updated || pp->short_lived) continue;
 
             kernel_uint_t absorbed;
 #if (PROCESSES_HAVE_CPU_CHILDREN_TIME == 1)
@@ -847,6 +847,35 @@ static inline void process_exited_pids(void) {
 }
 #endif
 
+#if (PROCESSES_HAVE_EVENTS == 1)
+static inline void process_short_lived_pids(void) {
+    // The short-lived processes (the ones that exited before we could read them)
+    // have the resources they used as their values. Their running ancestors got
+    // the same resources in their children resources when they reaped them.
+    // Remove them from there, so that they are not counted twice.
+
+    for(struct pid_stat *p = root_of_pids(); p ; p = p->next) {
+        if(!p->short_lived || !p->updated)
+            continue;
+
+        kernel_uint_t utime  = p->values[PDF_UTIME];
+        kernel_uint_t stime  = p->values[PDF_STIME];
+        kernel_uint_t minflt = p->values[PDF_MINFLT];
+        kernel_uint_t majflt = p->values[PDF_MAJFLT];
+
+        for(struct pid_stat *pp = p->parent; pp ; pp = pp->parent) {
+            if(!pp->updated || pp->short_lived) continue;
+
+            remove_exited_child_from_parent(&utime,  &pp->values[PDF_CUTIME]);
+            remove_exited_child_from_parent(&stime,  &pp->values[PDF_CSTIME]);
+            remove_exited_child_from_parent(&minflt, &pp->values[PDF_CMINFLT]);
+            remove_exited_child_from_parent(&majflt, &pp->values[PDF_CMAJFLT]);
+            break;
+        }
+    }
+}
+#endif
+
 // --------------------------------------------------------------------------------------------------------------------
 // the main loop for collecting process data
 
@@ -929,6 +958,11 @@ bool collect_data_for_all_pids(void) {
     process_exited_pids();
 #endif
 
+#if (PROCESSES_HAVE_EVENTS == 1)
+    // remove short-lived pids from their parents
+    process_short_lived_pids();
+#endif
+
     // the first iteration needs to be eliminated
     // since we are looking for rates
     if(unlikely(global_iterations_counter == 1)) {
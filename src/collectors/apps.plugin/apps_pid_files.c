@@ -353,6 +353,14 @@ static inline uint32_t file_descriptor_set_on_empty_slot(const char *name, uint3
     return c;
 }
 
+// one more user of a file we already have
+void file_descriptor_used(uint32_t id) {
+    if(likely(id > 0 && id < all_files_size && all_files[id].count))
+        all_files[id].count++;
+    else
+        netdata_log_error("Request to increase counter of fd %"PRIu32", which is not used", id);
+}
+
 uint32_t file_descriptor_find_or_add(const char *name, uint32_t hash) {
     if(unlikely(!hash))
         hash = simple_hash(name);
@@ -414,7 +422,7 @@ void make_all_pid_fds_negative(struct pid_stat *p) {
     }
 }
 
-static inline void cleanup_negative_pid_fds(struct pid_stat *p) {
+void cleanup_negative_pid_fds(struct pid_stat *p) {
     struct pid_fd *pfd = p->fds, *pfdend = &p->fds[p->fds_size];
 
     while(pfd < pfdend) {
@@ -443,7 +451,11 @@ void init_pid_fds(struct pid_stat *p, size_t first, size_t size) {
 
 int read_pid_file_descriptors(struct pid_stat *p, void *ptr) {
     bool ret = OS_FUNCTION(apps_os_read_pid_fds)(p, ptr);
+
+#if !defined(OS_LINUX)
+    // on linux the process is only queued, the cleanup is done when its fds are scanned
     cleanup_negative_pid_fds(p);
+#endif
 
     return ret ? 1 : 0;
 }
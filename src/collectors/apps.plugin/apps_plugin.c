@@ -443,6 +443,51 @@ static void parse_args(int argc, char **argv)
             continue;
         }
 
+        if(strcmp("fds-threads", argv[i]) == 0) {
+            if(argc <= i + 1) {
+                fprintf(stderr, "Parameter 'fds-threads' requires a number as argument.\n");
+                exit(1);
+            }
+            i++;
+            fds_scan_threads = str2i(argv[i]);
+            if(fds_scan_threads < 0) fds_scan_threads = 0;
+            continue;
+        }
+
+        if(strcmp("fds-sample-secs", argv[i]) == 0) {
+            if(argc <= i + 1) {
+                fprintf(stderr, "Parameter 'fds-sample-secs' requires a number as argument.\n");
+                exit(1);
+            }
+            i++;
+            fds_sample_seconds = str2i(argv[i]);
+            if(fds_sample_seconds < 0) fds_sample_seconds = 0;
+            continue;
+        }
+
+#if (PROCESSES_HAVE_EVENTS == 1)
+        if(strcmp("with-process-events", argv[i]) == 0) {
+            enable_process_events = true;
+            continue;
+        }
+
+        if(strcmp("no-process-events", argv[i]) == 0 || strcmp("without-process-events", argv[i]) == 0) {
+            enable_process_events = false;
+            continue;
+        }
+
+        if(strcmp("process-events-rescan-secs", argv[i]) == 0) {
+            if(argc <= i + 1) {
+                fprintf(stderr, "Parameter 'process-events-rescan-secs' requires a number as argument.\n");
+                exit(1);
+            }
+            i++;
+            process_events_rescan_seconds = str2i(argv[i]);
+            if(process_events_rescan_seconds < 1) process_events_rescan_seconds = 1;
+            continue;
+        }
+#endif
+
 #if (PROCESSES_HAVE_SMAPS_ROLLUP == 1)
         if(strcmp("--pss", argv[i]) == 0) {
             if(argc <= i + 1) {
@@ -585,6 +630,26 @@ static void parse_args(int argc, char **argv)
                     "                        max given)\n"
                     "                        (default is %d seconds)\n"
                     "\n"
+                    " fds-threads N          scan the files of processes with N threads\n"
+                    "                        (default is 0 = one thread per 4 CPUs, up to 8)\n"
+                    "\n"
+                    " fds-sample-secs N      scan the files of each process once every N\n"
+                    "                        seconds, instead of every iteration\n"
+                    "                        new processes are always scanned\n"
+                    "                        (default is 0 = every iteration)\n"
+                    "\n"
+#if (PROCESSES_HAVE_EVENTS == 1)
+                    " with-process-events\n"
+                    " without-process-events enable / disable finding new processes with\n"
+                    "                        the netlink proc connector and accounting\n"
+                    "                        the short-lived ones with taskstats\n"
+                    "                        (both need CAP_NET_ADMIN, default is enabled)\n"
+                    "\n"
+                    " process-events-rescan-secs N\n"
+                    "                        scan /proc every N seconds, even when the\n"
+                    "                        proc connector works (default is %d seconds)\n"
+                    "\n"
+#endif
 #if (PROCESSES_HAVE_SMAPS_ROLLUP == 1)
                     " --pss TIME            enable estimated memory using PSS sampling at the given interval\n"
                     "                        (e.g. 5m, 300s). Use 'off' or '0' to disable.\n"
@@ -597,6 +662,9 @@ static void parse_args(int argc, char **argv)
                     , NETDATA_VERSION
 #if defined(OS_LINUX)
                     , max_fds_cache_seconds
+#endif
+#if (PROCESSES_HAVE_EVENTS == 1)
+                    , process_events_rescan_seconds
 #endif
             );
             exit(0);
@@ -845,8 +913,12 @@ int main(int argc, char **argv) {
             exit(0);
         }
 
-        if(send_resource_usage)
+        if(send_resource_usage) {
             send_resource_usage_to_netdata(dt);
+#if (PROCESSES_HAVE_EVENTS == 1)
+            apps_proc_events_send_resource_usage(dt);
+#endif
+        }
 
 #if (PROCESSES_HAVE_STATE == 1)
         send_proc_states_count(dt);
@@ -37,6 +37,7 @@
 #define PROCESSES_HAVE_STATE                 0
 #define PPID_SHOULD_BE_RUNNING               1
 #define INCREMENTAL_DATA_COLLECTION          1
+#define PROCESSES_HAVE_EVENTS                0
 #define CPU_TO_NANOSECONDCORES (1)
 #define OS_FUNCTION(func) OS_FUNC_CONCAT(func, _freebsd)
 
@@ -85,6 +86,7 @@ struct pid_info {
 #define PROCESSES_HAVE_STATE                 0
 #define PPID_SHOULD_BE_RUNNING               1
 #define INCREMENTAL_DATA_COLLECTION          1
+#define PROCESSES_HAVE_EVENTS                0
 #define CPU_TO_NANOSECONDCORES (1) // already in nanoseconds
 #define OS_FUNCTION(func) OS_FUNC_CONCAT(func, _macos)
 
@@ -116,6 +118,7 @@ struct pid_info {
 #define PROCESSES_HAVE_STATE                 0
 #define PPID_SHOULD_BE_RUNNING               0
 #define INCREMENTAL_DATA_COLLECTION          0
+#define PROCESSES_HAVE_EVENTS                0
 #define CPU_TO_NANOSECONDCORES (100) // convert 100ns to ns
 #define OS_FUNCTION(func) OS_FUNC_CONCAT(func, _windows)
 
@@ -148,10 +151,13 @@ struct pid_info {
 #define PPID_SHOULD_BE_RUNNING               1
 #define USE_APPS_GROUPS_CONF                 1
 #define INCREMENTAL_DATA_COLLECTION          1
+#define PROCESSES_HAVE_EVENTS                1
 #define CPU_TO_NANOSECONDCORES (NSEC_PER_SEC / system_hz)
 #define OS_FUNCTION(func) OS_FUNC_CONCAT(func, _linux)
 
 extern int max_fds_cache_seconds;
+extern int fds_scan_threads;
+extern int fds_sample_seconds;
 
 #else
 #error "Unsupported operating system"
@@ -571,6 +577,7 @@ struct pid_stat {
     bool is_aggregator:1;           // true when this pid is a process aggregator
 
     bool matched_by_config:1;
+    bool short_lived:1;             // it exited before we could read it, its values are from its exit statistics
 
 #if (PROCESSES_HAVE_STATE == 1)
     char state;
@@ -672,6 +679,8 @@ void aggregate_pid_fds_on_targets(struct pid_stat *p);
 int read_pid_file_descriptors(struct pid_stat *p, void *ptr);
 void make_all_pid_fds_negative(struct pid_stat *p);
 uint32_t file_descriptor_find_or_add(const char *name, uint32_t hash);
+void file_descriptor_used(uint32_t id);
+void cleanup_negative_pid_fds(struct pid_stat *p);
 #endif
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -693,6 +702,22 @@ int incrementally_collect_data_for_pid(pid_t pid, void *ptr);
 int incrementally_collect_data_for_pid_stat(struct pid_stat *p, void *ptr);
 #endif
 
+#if (PROCESSES_HAVE_EVENTS == 1)
+// event driven discovery of new processes (proc connector)
+// and accounting of short-lived processes (taskstats)
+extern bool enable_process_events;
+extern int process_events_rescan_seconds;
+
+bool apps_proc_events_init(void);
+
+// returns false when /proc has to be scanned to find the new processes
+bool apps_proc_events_collect_new_pids(void);
+void apps_proc_events_scan_completed(size_t new_pids);
+
+void apps_proc_events_account_exited_pids(void);
+void apps_proc_events_send_resource_usage(usec_t dt);
+#endif
+
 // --------------------------------------------------------------------------------------------------------------------
 // pid management
 
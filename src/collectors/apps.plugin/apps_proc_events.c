@@ -0,0 +1,759 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "apps_plugin.h"
+
+#if (PROCESSES_HAVE_EVENTS == 1)
+
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include <linux/genetlink.h>
+#include <linux/taskstats.h>
+
+// Event driven process collection
+//
+// 1. The netlink proc connector tells us the processes that are forked, so that we
+//    don't need to readdir() /proc on every iteration to find the new ones.
+//    The processes we already know are read as before (their CPU and memory change
+//    without any events). When the kernel drops events (ENOBUFS), we scan /proc at
+//    the next iteration, and we also scan /proc periodically, as a safety net.
+//
+// 2. The taskstats exit notifications give us the resources of the processes that
+//    started and exited between two iterations, so we never saw them running.
+//    These resources are given to the targets of the short-lived processes and they
+//    are removed from the children resources of their running ancestors (who got them
+//    when they reaped them), so that they are not counted twice.
+//
+// Both need CAP_NET_ADMIN. Without it (or when the kernel does not support them),
+// apps.plugin scans /proc as before.
+
+bool enable_process_events = true;
+int process_events_rescan_seconds = 60;
+
+#define PROC_EVENTS_MAX_FORKED      65536       // new processes per iteration
+#define PROC_EVENTS_MAX_EXITED      65536       // exited tasks per iteration
+#define PROC_EVENTS_RCVBUF          (8 * 1024 * 1024)
+#define PROC_EVENTS_TASKSTATS_MIN_VERSION 12    // ac_tgid is available since version 12
+
+struct exited_task {
+    pid_t pid;
+    pid_t tgid;
+    pid_t ppid;
+    uid_t uid;
+    gid_t gid;
+    char comm[TS_COMM_LEN];
+    uint64_t etime;                             // microseconds
+    uint64_t utime;                             // microseconds
+    uint64_t stime;                             // microseconds
+    uint64_t minflt, majflt;
+    uint64_t read_char, write_char;
+    uint64_t read_syscalls, write_syscalls;
+    uint64_t read_bytes, write_bytes;
+    uint64_t nvcsw, nivcsw;
+};
+
+// shared between the events thread and the collector
+static struct {
+    SPINLOCK spinlock;
+
+    struct {
+        pid_t *pids;
+        size_t used;
+        bool overflow;                          // we lost events, /proc has to be scanned
+    } forked;
+
+    struct {
+        struct exited_task *tasks;
+        size_t used;
+    } exited;
+
+    size_t forks;
+    size_t execs;
+    size_t exits;
+    size_t lost_events;
+    size_t lost_exits;
+} events = {
+    .spinlock = SPINLOCK_INITIALIZER,
+};
+
+// used only by the events thread
+static struct {
+    int connector_fd;
+    int taskstats_fd;
+    uint16_t taskstats_family;
+    bool taskstats_old_version;
+} listener = {
+    .connector_fd = -1,
+    .taskstats_fd = -1,
+};
+
+// used only by the collector
+static struct {
+    bool connector;                             // the connector is working
+    bool taskstats;                             // the taskstats exit notifications are working
+
+    pid_t *pids;                                // swapped with events.forked.pids
+    struct exited_task *tasks;                  // swapped with events.exited.tasks
+
+    usec_t last_scan_ut;
+    usec_t last_accounting_ut;
+    bool periodic_scan;
+    size_t forks_before_scan;
+
+    size_t scans;
+    size_t short_lived;
+} collector = { 0 };
+
+// --------------------------------------------------------------------------------------------------------------------
+// netlink attributes (the uapi headers do not provide these)
+
+#define PE_NLA_OK(na, rem) ((rem) >= (int)sizeof(struct nlattr) && (na)->nla_len >= sizeof(struct nlattr) && (int)(na)->nla_len <= (rem))
+#define PE_NLA_NEXT(na, rem) ((rem) -= NLA_ALIGN((na)->nla_len), (struct nlattr *)((char *)(na) + NLA_ALIGN((na)->nla_len)))
+#define PE_NLA_DATA(na) ((void *)((char *)(na) + NLA_HDRLEN))
+#define PE_NLA_PAYLOAD(na) ((int)(na)->nla_len - NLA_HDRLEN)
+#define PE_NLA_TYPE(na) ((na)->nla_type & NLA_TYPE_MASK)
+
+static void proc_events_socket_buffer(int fd) {
+    int size = PROC_EVENTS_RCVBUF;
+
+    // SO_RCVBUFFORCE ignores rmem_max, but it needs CAP_NET_ADMIN - which we have
+    if(setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) != 0)
+        (void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// the proc connector
+
+static int proc_events_connector_open(void) {
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if(fd == -1) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO, "PROCESS EVENTS: cannot create a netlink connector socket: %s", strerror(errno));
+        return -1;
+    }
+
+    struct sockaddr_nl sa = {
+        .nl_family = AF_NETLINK,
+        .nl_groups = CN_IDX_PROC,
+        .nl_pid = 0,
+    };
+
+    if(bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO,
+               "PROCESS EVENTS: cannot bind to the proc connector (apps.plugin needs CAP_NET_ADMIN for this): %s",
+               strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    proc_events_socket_buffer(fd);
+
+    struct __attribute__((aligned(NLMSG_ALIGNTO))) {
+        struct nlmsghdr nlh;
+        struct __attribute__((__packed__)) {
+            struct cn_msg cn;
+            enum proc_cn_mcast_op op;
+        };
+    } msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.nlh.nlmsg_len = sizeof(msg);
+    msg.nlh.nlmsg_type = NLMSG_DONE;
+    msg.cn.id.idx = CN_IDX_PROC;
+    msg.cn.id.val = CN_VAL_PROC;
+    msg.cn.len = sizeof(enum proc_cn_mcast_op);
+    msg.op = PROC_CN_MCAST_LISTEN;
+
+    if(send(fd, &msg, sizeof(msg), 0) == -1) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO, "PROCESS EVENTS: cannot subscribe to the proc connector: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void proc_events_connector_parse(char *buf, int len) {
+    for(struct nlmsghdr *nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len) ; nlh = NLMSG_NEXT(nlh, len)) {
+        if(nlh->nlmsg_type == NLMSG_NOOP)
+            continue;
+
+        if(nlh->nlmsg_type == NLMSG_ERROR || nlh->nlmsg_type == NLMSG_OVERRUN) {
+            spinlock_lock(&events.spinlock);
+            events.forked.overflow = true;
+            events.lost_events++;
+            spinlock_unlock(&events.spinlock);
+            continue;
+        }
+
+        struct cn_msg *cn = NLMSG_DATA(nlh);
+        if(cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC)
+            continue;
+
+        struct proc_event *ev = (struct proc_event *)cn->data;
+        switch(ev->what) {
+            case PROC_EVENT_FORK:
+                // threads are not processes
+                if(ev->event_data.fork.child_pid != ev->event_data.fork.child_tgid)
+                    break;
+
+                spinlock_lock(&events.spinlock);
+                events.forks++;
+                if(likely(events.forked.used < PROC_EVENTS_MAX_FORKED))
+                    events.forked.pids[events.forked.used++] = ev->event_data.fork.child_tgid;
+                else
+                    events.forked.overflow = true;
+                spinlock_unlock(&events.spinlock);
+                break;
+
+            case PROC_EVENT_EXEC:
+                __atomic_add_fetch(&events.execs, 1, __ATOMIC_RELAXED);
+                break;
+
+            case PROC_EVENT_EXIT:
+                if(ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid)
+                    __atomic_add_fetch(&events.exits, 1, __ATOMIC_RELAXED);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// taskstats
+
+static bool proc_events_genl_send(int fd, uint16_t type, uint8_t cmd, uint8_t version, uint16_t attr_type, const void *attr, size_t attr_len, uint32_t seq) {
+    struct {
+        struct nlmsghdr nlh;
+        struct genlmsghdr gh;
+        char attrs[256];
+    } msg;
+
+    if(NLA_HDRLEN + attr_len > sizeof(msg.attrs))
+        return false;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.nlh.nlmsg_type = type;
+    msg.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    msg.nlh.nlmsg_seq = seq;
+    msg.gh.cmd = cmd;
+    msg.gh.version = version;
+
+    struct nlattr *na = (struct nlattr *)msg.attrs;
+    na->nla_type = attr_type;
+    na->nla_len = NLA_HDRLEN + attr_len;
+    memcpy(PE_NLA_DATA(na), attr, attr_len);
+
+    msg.nlh.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN + NLA_ALIGN(na->nla_len));
+
+    struct sockaddr_nl sa = { .nl_family = AF_NETLINK };
+    return sendto(fd, &msg, msg.nlh.nlmsg_len, 0, (struct sockaddr *)&sa, sizeof(sa)) >= 0;
+}
+
+// wait for the answer to a request - returns the netlink error code (0 = ok)
+// when family is given, the reply of CTRL_CMD_GETFAMILY is parsed into it
+static int proc_events_genl_wait(int fd, uint32_t seq, uint16_t *family) {
+    char buf[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    for(size_t attempts = 0; attempts < 100 ;attempts++) {
+        int len = (int)recv(fd, buf, sizeof(buf), 0);
+        if(len < 0) {
+            if(errno == EINTR || errno == ENOBUFS) continue;
+            return -errno;
+        }
+
+        for(struct nlmsghdr *nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len) ; nlh = NLMSG_NEXT(nlh, len)) {
+            if(nlh->nlmsg_seq != seq)
+                continue;
+
+            if(nlh->nlmsg_type == NLMSG_ERROR) {
+                struct nlmsgerr *err = NLMSG_DATA(nlh);
+                return err->error;
+            }
+
+            if(family && nlh->nlmsg_type == GENL_ID_CTRL) {
+                struct nlattr *na = (struct nlattr *)((char *)NLMSG_DATA(nlh) + GENL_HDRLEN);
+                int rem = (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+                for(; PE_NLA_OK(na, rem) ; na = PE_NLA_NEXT(na, rem)) {
+                    if(PE_NLA_TYPE(na) == CTRL_ATTR_FAMILY_ID && PE_NLA_PAYLOAD(na) >= (int)sizeof(uint16_t))
+                        memcpy(family, PE_NLA_DATA(na), sizeof(uint16_t));
+                }
+            }
+        }
+    }
+
+    return -ETIMEDOUT;
+}
+
+static int proc_events_taskstats_open(void) {
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if(fd == -1) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO, "PROCESS EVENTS: cannot create a generic netlink socket: %s", strerror(errno));
+        return -1;
+    }
+
+    struct sockaddr_nl sa = { .nl_family = AF_NETLINK };
+    if(bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO, "PROCESS EVENTS: cannot bind a generic netlink socket: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // the requests are answered immediately, don't wait forever if they are not
+    struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    uint16_t family = 0;
+    if(!proc_events_genl_send(fd, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 1,
+                              CTRL_ATTR_FAMILY_NAME, TASKSTATS_GENL_NAME, sizeof(TASKSTATS_GENL_NAME), 1) ||
+       proc_events_genl_wait(fd, 1, &family) != 0 || !family) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO, "PROCESS EVENTS: the kernel does not provide taskstats.");
+        close(fd);
+        return -1;
+    }
+
+    // register for the exit notifications of all the possible CPUs
+    char cpumask[1024];
+    char filename[FILENAME_MAX + 1];
+    snprintfz(filename, FILENAME_MAX, "%s/sys/devices/system/cpu/possible", netdata_configured_host_prefix);
+    if(read_txt_file(filename, cpumask, sizeof(cpumask)) != 0 || !*cpumask)
+        snprintfz(cpumask, sizeof(cpumask), "0-%zu", os_get_system_cpus_uncached() - 1);
+
+    // remove the trailing newline
+    cpumask[strcspn(cpumask, "\r\n")] = '\0';
+
+    proc_events_socket_buffer(fd);
+
+    int err;
+    if(!proc_events_genl_send(fd, family, TASKSTATS_CMD_GET, TASKSTATS_GENL_VERSION,
+                              TASKSTATS_CMD_ATTR_REGISTER_CPUMASK, cpumask, strlen(cpumask) + 1, 2) ||
+       (err = proc_events_genl_wait(fd, 2, NULL)) != 0) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO,
+               "PROCESS EVENTS: cannot register for taskstats exit notifications of CPUs '%s' "
+               "(apps.plugin needs CAP_NET_ADMIN for this)", cpumask);
+        close(fd);
+        return -1;
+    }
+
+    // the thread blocks in poll(), not in recv()
+    tv.tv_sec = 0;
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    listener.taskstats_family = family;
+    return fd;
+}
+
+static void proc_events_taskstats_add(struct taskstats *ts) {
+    if(unlikely(ts->version < PROC_EVENTS_TASKSTATS_MIN_VERSION)) {
+        // without ac_tgid we cannot tell the threads of running processes
+        // from the processes that exited - we would count threads twice
+        if(!listener.taskstats_old_version) {
+            listener.taskstats_old_version = true;
+            nd_log(NDLS_COLLECTORS, NDLP_NOTICE,
+                   "PROCESS EVENTS: the kernel taskstats version is %u, but at least %u is needed. "
+                   "Short-lived processes will not be accounted.",
+                   (unsigned)ts->version, (unsigned)PROC_EVENTS_TASKSTATS_MIN_VERSION);
+        }
+        return;
+    }
+
+    spinlock_lock(&events.spinlock);
+    if(likely(events.exited.used < PROC_EVENTS_MAX_EXITED)) {
+        struct exited_task *t = &events.exited.tasks[events.exited.used++];
+        t->pid = (pid_t)ts->ac_pid;
+        t->tgid = (pid_t)ts->ac_tgid;
+        t->ppid = (pid_t)ts->ac_ppid;
+        t->uid = ts->ac_uid;
+        t->gid = ts->ac_gid;
+        memcpy(t->comm, ts->ac_comm, sizeof(t->comm));
+        t->comm[sizeof(t->comm) - 1] = '\0';
+        t->etime = ts->ac_etime;
+        t->utime = ts->ac_utime;
+        t->stime = ts->ac_stime;
+        t->minflt = ts->ac_minflt;
+        t->majflt = ts->ac_majflt;
+        t->read_char = ts->read_char;
+        t->write_char = ts->write_char;
+        t->read_syscalls = ts->read_syscalls;
+        t->write_syscalls = ts->write_syscalls;
+        t->read_bytes = ts->read_bytes;
+        t->write_bytes = ts->write_bytes;
+        t->nvcsw = ts->nvcsw;
+        t->nivcsw = ts->nivcsw;
+    }
+    else
+        events.lost_exits++;
+    spinlock_unlock(&events.spinlock);
+}
+
+static void proc_events_taskstats_parse(char *buf, int len) {
+    for(struct nlmsghdr *nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len) ; nlh = NLMSG_NEXT(nlh, len)) {
+        if(nlh->nlmsg_type != listener.taskstats_family)
+            continue;
+
+        struct genlmsghdr *gh = NLMSG_DATA(nlh);
+        if(gh->cmd != TASKSTATS_CMD_NEW)
+            continue;
+
+        struct nlattr *na = (struct nlattr *)((char *)gh + GENL_HDRLEN);
+        int rem = (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+        for(; PE_NLA_OK(na, rem) ; na = PE_NLA_NEXT(na, rem)) {
+            // each task sends a pid + stats, the last task of a thread group
+            // may also send a tgid + stats, which has only delay accounting
+            if(PE_NLA_TYPE(na) != TASKSTATS_TYPE_AGGR_PID)
+                continue;
+
+            struct nlattr *nna = PE_NLA_DATA(na);
+            int nrem = PE_NLA_PAYLOAD(na);
+            for(; PE_NLA_OK(nna, nrem) ; nna = PE_NLA_NEXT(nna, nrem)) {
+                if(PE_NLA_TYPE(nna) != TASKSTATS_TYPE_STATS)
+                    continue;
+
+                // older kernels have a smaller structure
+                struct taskstats ts = { 0 };
+                size_t size = MIN((size_t)PE_NLA_PAYLOAD(nna), sizeof(ts));
+                memcpy(&ts, PE_NLA_DATA(nna), size);
+                proc_events_taskstats_add(&ts);
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// the events thread
+
+static void proc_events_thread(void *arg __maybe_unused) {
+    static char buf[65536] __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    struct pollfd pfd[2];
+    nfds_t nfds = 0;
+    if(listener.connector_fd != -1)
+        pfd[nfds++] = (struct pollfd){ .fd = listener.connector_fd, .events = POLLIN };
+    if(listener.taskstats_fd != -1)
+        pfd[nfds++] = (struct pollfd){ .fd = listener.taskstats_fd, .events = POLLIN };
+
+    while(nfds) {
+        if(poll(pfd, nfds, -1) == -1) {
+            if(errno == EINTR) continue;
+            nd_log(NDLS_COLLECTORS, NDLP_ERR, "PROCESS EVENTS: poll() failed: %s", strerror(errno));
+            break;
+        }
+
+        for(nfds_t i = 0; i < nfds ;i++) {
+            if(!(pfd[i].revents & (POLLIN | POLLERR)))
+                continue;
+
+            bool connector = pfd[i].fd == listener.connector_fd;
+            int len = (int)recv(pfd[i].fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if(len < 0) {
+                if(errno == ENOBUFS) {
+                    // the kernel dropped messages
+                    spinlock_lock(&events.spinlock);
+                    if(connector) {
+                        events.forked.overflow = true;
+                        events.lost_events++;
+                    }
+                    else
+                        events.lost_exits++;
+                    spinlock_unlock(&events.spinlock);
+                }
+                continue;
+            }
+
+            if(connector)
+                proc_events_connector_parse(buf, len);
+            else
+                proc_events_taskstats_parse(buf, len);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// initialization
+
+// the pids of the events are the pids of the initial pid namespace,
+// so the /proc we read has to be of the same namespace
+static bool proc_events_initial_pid_namespace(void) {
+    if(*netdata_configured_host_prefix)
+        // we read the /proc of the host
+        return true;
+
+    procfile *ff = procfile_open("/proc/self/status", " \t:", PROCFILE_FLAG_NO_ERROR_ON_FILE_IO);
+    if(!ff) return true;
+
+    bool ret = true;
+    ff = procfile_readall(ff);
+    if(ff) {
+        for(size_t l = 0; l < procfile_lines(ff) ;l++) {
+            if(strcmp(procfile_lineword(ff, l, 0), "NSpid") == 0) {
+                // one pid per nested namespace
+                ret = procfile_linewords(ff, l) <= 2;
+                break;
+            }
+        }
+    }
+
+    procfile_close(ff);
+    return ret;
+}
+
+bool apps_proc_events_init(void) {
+    if(!enable_process_events)
+        return false;
+
+    if(!proc_events_initial_pid_namespace()) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO,
+               "PROCESS EVENTS: apps.plugin runs in a pid namespace, process events are disabled.");
+        enable_process_events = false;
+        return false;
+    }
+
+    listener.connector_fd = proc_events_connector_open();
+    listener.taskstats_fd = proc_events_taskstats_open();
+
+    collector.connector = listener.connector_fd != -1;
+    collector.taskstats = listener.taskstats_fd != -1;
+
+    if(!collector.connector && !collector.taskstats) {
+        nd_log(NDLS_COLLECTORS, NDLP_INFO, "PROCESS EVENTS: not available, apps.plugin will scan /proc on every iteration.");
+        enable_process_events = false;
+        return false;
+    }
+
+    if(collector.connector) {
+        events.forked.pids = mallocz(PROC_EVENTS_MAX_FORKED * sizeof(pid_t));
+        collector.pids = mallocz(PROC_EVENTS_MAX_FORKED * sizeof(pid_t));
+    }
+
+    if(collector.taskstats) {
+        events.exited.tasks = mallocz(PROC_EVENTS_MAX_EXITED * sizeof(struct exited_task));
+        collector.tasks = mallocz(PROC_EVENTS_MAX_EXITED * sizeof(struct exited_task));
+    }
+
+    nd_log(NDLS_COLLECTORS, NDLP_INFO,
+           "PROCESS EVENTS: new processes are found %s, short-lived processes are %s.",
+           collector.connector ? "with the proc connector" : "by scanning /proc",
+           collector.taskstats ? "accounted with taskstats" : "not accounted");
+
+    nd_thread_create("APPS_EVENTS", NETDATA_THREAD_OPTION_DONT_LOG, proc_events_thread, NULL);
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// the collector side
+
+bool apps_proc_events_collect_new_pids(void) {
+    if(!collector.connector)
+        return false;
+
+    spinlock_lock(&events.spinlock);
+    SWAP(events.forked.pids, collector.pids);
+    size_t used = events.forked.used;
+    bool overflow = events.forked.overflow;
+    size_t forks = events.forks;
+    events.forked.used = 0;
+    events.forked.overflow = false;
+    spinlock_unlock(&events.spinlock);
+
+    // the events are in fork order, so parents are read before their children
+    for(size_t i = 0; i < used ;i++)
+        incrementally_collect_data_for_pid(collector.pids[i], NULL);
+
+    usec_t now_ut = now_monotonic_usec();
+    if(!overflow && collector.last_scan_ut &&
+        now_ut - collector.last_scan_ut < (usec_t)process_events_rescan_seconds * USEC_PER_SEC)
+        return true;
+
+    // we have to scan /proc
+    collector.periodic_scan = !overflow && collector.last_scan_ut;
+    collector.forks_before_scan = forks;
+    collector.last_scan_ut = now_ut;
+    collector.scans++;
+    return false;
+}
+
+void apps_proc_events_scan_completed(size_t new_pids) {
+    if(!collector.connector || !collector.periodic_scan)
+        return;
+
+    collector.periodic_scan = false;
+
+    if(new_pids && !collector.forks_before_scan) {
+        // the connector does not deliver events in this network namespace
+        nd_log(NDLS_COLLECTORS, NDLP_NOTICE,
+               "PROCESS EVENTS: the proc connector did not report any of the %zu new processes found in /proc. "
+               "apps.plugin will scan /proc on every iteration.", new_pids);
+        collector.connector = false;
+    }
+    else if(new_pids)
+        debug_log("PROCESS EVENTS: %zu new processes were found by scanning /proc", new_pids);
+}
+
+static inline kernel_uint_t exited_rate(uint64_t value, uint64_t multiplier, usec_t dt) {
+    return (kernel_uint_t)((NETDATA_DOUBLE)value * (NETDATA_DOUBLE)multiplier * (NETDATA_DOUBLE)USEC_PER_SEC / (NETDATA_DOUBLE)dt);
+}
+
+static int compar_exited_task(const void *a, const void *b) {
+    const struct exited_task *t1 = a, *t2 = b;
+    if(t1->tgid != t2->tgid) return (t1->tgid < t2->tgid) ? -1 : 1;
+    if(t1->pid != t2->pid) return (t1->pid < t2->pid) ? -1 : 1;
+    return 0;
+}
+
+static void short_lived_pid_set_values(struct pid_stat *p, struct exited_task *leader, struct exited_task *sum, usec_t dt) {
+    p->short_lived = true;
+    p->read = true;
+    p->updated = true;
+    p->keep = false;
+    p->keeploops = 0;
+
+    p->ppid = leader->ppid;
+    p->uid = leader->uid;
+    p->gid = leader->gid;
+    update_pid_comm(p, leader->comm);
+
+    memset(p->values, 0, sizeof(p->values));
+    p->values[PDF_UTIME]    = exited_rate(sum->utime, NSEC_PER_USEC, dt);
+    p->values[PDF_STIME]    = exited_rate(sum->stime, NSEC_PER_USEC, dt);
+    p->values[PDF_MINFLT]   = exited_rate(sum->minflt, RATES_DETAIL, dt);
+    p->values[PDF_MAJFLT]   = exited_rate(sum->majflt, RATES_DETAIL, dt);
+    p->values[PDF_VOLCTX]   = exited_rate(sum->nvcsw, RATES_DETAIL, dt);
+    p->values[PDF_NVOLCTX]  = exited_rate(sum->nivcsw, RATES_DETAIL, dt);
+    p->values[PDF_LREAD]    = exited_rate(sum->read_char, RATES_DETAIL, dt);
+    p->values[PDF_LWRITE]   = exited_rate(sum->write_char, RATES_DETAIL, dt);
+    p->values[PDF_OREAD]    = exited_rate(sum->read_syscalls, RATES_DETAIL, dt);
+    p->values[PDF_OWRITE]   = exited_rate(sum->write_syscalls, RATES_DETAIL, dt);
+    p->values[PDF_PREAD]    = exited_rate(sum->read_bytes, RATES_DETAIL, dt);
+    p->values[PDF_PWRITE]   = exited_rate(sum->write_bytes, RATES_DETAIL, dt);
+    p->values[PDF_UPTIME]   = leader->etime / USEC_PER_SEC;
+
+    // it is not running anymore
+    p->values[PDF_PROCESSES] = 0;
+    p->values[PDF_THREADS]   = 0;
+}
+
+void apps_proc_events_account_exited_pids(void) {
+    if(!collector.taskstats)
+        return;
+
+    spinlock_lock(&events.spinlock);
+    SWAP(events.exited.tasks, collector.tasks);
+    size_t used = events.exited.used;
+    events.exited.used = 0;
+    spinlock_unlock(&events.spinlock);
+
+    usec_t now_ut = now_monotonic_usec();
+    usec_t dt = collector.last_accounting_ut ? now_ut - collector.last_accounting_ut : 0;
+    collector.last_accounting_ut = now_ut;
+
+    // the first time, we don't know the duration these resources were spent in
+    if(!used || !dt)
+        return;
+
+    // bring the threads of each process together
+    qsort(collector.tasks, used, sizeof(struct exited_task), compar_exited_task);
+
+    bool added = false;
+    for(size_t i = 0; i < used ;) {
+        pid_t tgid = collector.tasks[i].tgid;
+        struct exited_task *leader = NULL;
+        struct exited_task sum = { 0 };
+
+        for(; i < used && collector.tasks[i].tgid == tgid ;i++) {
+            struct exited_task *t = &collector.tasks[i];
+            if(t->pid == tgid) leader = t;
+
+            sum.utime += t->utime;
+            sum.stime += t->stime;
+            sum.minflt += t->minflt;
+            sum.majflt += t->majflt;
+            sum.nvcsw += t->nvcsw;
+            sum.nivcsw += t->nivcsw;
+            sum.read_char += t->read_char;
+            sum.write_char += t->write_char;
+            sum.read_syscalls += t->read_syscalls;
+            sum.write_syscalls += t->write_syscalls;
+            sum.read_bytes += t->read_bytes;
+            sum.write_bytes += t->write_bytes;
+        }
+
+        // threads of running processes are accounted by their processes
+        if(!leader || tgid < INIT_PID)
+            continue;
+
+        // a process we have seen running is accounted already (see process_exited_pids())
+        struct pid_stat *p = find_pid_entry(tgid);
+        if(p && p->comm && !p->short_lived)
+            continue;
+
+        if(!p)
+            p = get_or_allocate_pid_entry(tgid);
+
+        short_lived_pid_set_values(p, leader, &sum, dt);
+        collector.short_lived++;
+        added = true;
+    }
+
+    if(!added)
+        return;
+
+    // the parents of short-lived processes may be gone too - they have been adopted
+    for(struct pid_stat *p = root_of_pids(); p ; p = p->next) {
+        if(p->short_lived && p->updated && p->ppid && !find_pid_entry(p->ppid))
+            p->ppid = INIT_PID;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// the resource usage chart
+
+void apps_proc_events_send_resource_usage(usec_t dt) {
+    if(!enable_process_events)
+        return;
+
+    static bool created_charts = false;
+    if(unlikely(!created_charts)) {
+        created_charts = true;
+
+        fprintf(stdout,
+                "CHART netdata.apps_process_events '' 'Apps Plugin Process Events' 'events/s' apps.plugin netdata.apps_process_events line 140002 %1$d\n"
+                "DIMENSION forks '' incremental 1 1\n"
+                "DIMENSION execs '' incremental 1 1\n"
+                "DIMENSION exits '' incremental 1 1\n"
+                "DIMENSION short_lived 'short lived' incremental 1 1\n"
+                "DIMENSION scans '' incremental 1 1\n"
+                "DIMENSION lost_events 'lost events' incremental 1 1\n"
+                "DIMENSION lost_exits 'lost exits' incremental 1 1\n"
+                , update_every
+        );
+    }
+
+    spinlock_lock(&events.spinlock);
+    size_t forks = events.forks;
+    size_t lost_events = events.lost_events;
+    size_t lost_exits = events.lost_exits;
+    spinlock_unlock(&events.spinlock);
+
+    fprintf(stdout,
+            "BEGIN netdata.apps_process_events %"PRIu64"\n"
+            "SET forks = %zu\n"
+            "SET execs = %zu\n"
+            "SET exits = %zu\n"
+            "SET short_lived = %zu\n"
+            "SET scans = %zu\n"
+            "SET lost_events = %zu\n"
+            "SET lost_exits = %zu\n"
+            "END\n"
+            , dt
+            , forks
+            , __atomic_load_n(&events.execs, __ATOMIC_RELAXED)
+            , __atomic_load_n(&events.exits, __ATOMIC_RELAXED)
+            , collector.short_lived
+            , collector.scans
+            , lost_events
+            , lost_exits
+    );
+}
+
+#endif
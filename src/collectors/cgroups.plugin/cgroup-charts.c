@@ -1519,3 +1519,30 @@ void update_pids_current_chart(struct cgroup *cg) {
     rrddim_set_by_pointer(chart, cg->st_pids_rd_pids_current, (collected_number)cg->pids_current.pids_current);
     rrdset_done(chart);
 }
+
+void update_read_time_chart(struct cgroup *cg) {
+    RRDSET *chart = cg->st_read_time;
+
+    if (unlikely(!cg->st_read_time)) {
+        char buff[RRD_ID_LENGTH_MAX + 1];
+        chart = cg->st_read_time = rrdset_create_localhost(
+            cgroup_chart_type(buff, cg),
+            "read_time",
+            NULL,
+            "netdata",
+            k8s_is_kubepod(cg) ? "k8s.cgroup.read_time" : "cgroup.read_time",
+            "Time spent reading the cgroup files",
+            "microseconds",
+            PLUGIN_CGROUPS_NAME,
+            PLUGIN_CGROUPS_MODULE_CGROUPS_NAME,
+            NETDATA_CHART_PRIO_CGROUPS_CONTAINERS + 2500,
+            cgroup_update_every,
+            RRDSET_TYPE_LINE);
+
+        rrdset_update_rrdlabels(chart, cg->chart_labels);
+        cg->st_read_time_rd = rrddim_add(chart, "read", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+    }
+
+    rrddim_set_by_pointer(chart, cg->st_read_time_rd, (collected_number)cg->read_ut);
+    rrdset_done(chart);
+}
@@ -2,6 +2,8 @@
 
 #include "cgroup-internals.h"
 
+#include <sys/inotify.h>
+
 // discovery cgroup thread worker jobs
 #define WORKER_DISCOVERY_INIT               0
 #define WORKER_DISCOVERY_FIND               1
@@ -90,6 +92,9 @@ static inline void cgroup_free(struct cgroup *cg) {
     if(cg->st_queued_ops) rrdset_is_obsolete___safe_from_collector_thread(cg->st_queued_ops);
     if(cg->st_merged_ops) rrdset_is_obsolete___safe_from_collector_thread(cg->st_merged_ops);
     if(cg->st_pids) rrdset_is_obsolete___safe_from_collector_thread(cg->st_pids);
+    if(cg->st_read_time) rrdset_is_obsolete___safe_from_collector_thread(cg->st_read_time);
+
+    cgroup_files_close(cg);
 
     freez(cg->filename_cpuset_cpus);
     freez(cg->filename_cpu_cfs_period);
@@ -226,10 +231,104 @@ static char *cgroup_parse_resolved_name_and_labels(struct cgroup *cg, char *data
     return name;
 }
 
-static inline void discovery_rename_cgroup(struct cgroup *cg) {
-    if (!cg->pending_renames) {
+// ----------------------------------------------------------------------------
+// rename cgroups
+//
+// The rename script is run for many cgroups at once (up to CGROUP_RENAME_BATCH scripts
+// run in parallel), and each batch is given CGROUP_RENAME_TIMEOUT_UT to respond.
+// The output of the script is cached by cgroup id, so that cgroups removed and created
+// again with the same id (e.g. restarted containers) keep their names when the script
+// fails or times out for them. The script is always run first, since a new cgroup with
+// the same id may be something else. The cache keeps the cgroups that exist, and the
+// removed ones for CGROUP_RENAME_CACHE_TTL_UT.
+
+#define CGROUP_RENAME_BATCH 8
+#define CGROUP_RENAME_TIMEOUT_UT (30 * USEC_PER_SEC)
+#define CGROUP_RENAME_CACHE_TTL_UT (600 * USEC_PER_SEC)
+
+struct cgroup_rename_cache_entry {
+    usec_t expires_ut;          // 0 = the cgroup exists
+    char output[];              // the output of the rename script
+};
+
+static DICTIONARY *cgroup_rename_cache = NULL;
+
+static void discovery_rename_cache_set(const char *id, const char *output) {
+    if(unlikely(!cgroup_rename_cache))
+        cgroup_rename_cache = dictionary_create(DICT_OPTION_SINGLE_THREADED);
+
+    size_t len = strlen(output);
+    struct cgroup_rename_cache_entry *e = mallocz(sizeof(*e) + len + 1);
+    e->expires_ut = 0;
+    memcpy(e->output, output, len + 1);
+    dictionary_set(cgroup_rename_cache, id, e, sizeof(*e) + len + 1);
+    freez(e);
+}
+
+static void discovery_rename_cache_release(struct cgroup *cg) {
+    if(!cgroup_rename_cache)
+        return;
+
+    struct cgroup_rename_cache_entry *e = dictionary_get(cgroup_rename_cache, cg->id);
+    if(e)
+        e->expires_ut = now_monotonic_usec() + CGROUP_RENAME_CACHE_TTL_UT;
+}
+
+static void discovery_rename_cache_cleanup(void) {
+    if(!cgroup_rename_cache)
         return;
+
+    usec_t now_ut = now_monotonic_usec();
+    struct cgroup_rename_cache_entry *e;
+    dfe_start_write(cgroup_rename_cache, e) {
+        if(e->expires_ut && e->expires_ut < now_ut)
+            dictionary_del(cgroup_rename_cache, e_dfe.name);
     }
+    dfe_done(e);
+    dictionary_garbage_collect(cgroup_rename_cache);
+}
+
+static void discovery_rename_cache_destroy(void) {
+    dictionary_destroy(cgroup_rename_cache);
+    cgroup_rename_cache = NULL;
+}
+
+static inline void discovery_rename_cgroup_apply(struct cgroup *cg, char *output) {
+    char *name = cgroup_parse_resolved_name_and_labels(cg, output);
+
+    freez(cg->name);
+    cg->name = strdupz(name);
+
+    freez(cg->chart_id);
+    cg->chart_id = cgroup_chart_id_strdupz(name);
+
+    substitute_dots_in_id(cg->chart_id);
+    cg->hash_chart_id = simple_hash(cg->chart_id);
+}
+
+static inline bool discovery_rename_cgroup_from_cache(struct cgroup *cg) {
+    if(!cgroup_rename_cache)
+        return false;
+
+    struct cgroup_rename_cache_entry *e = dictionary_get(cgroup_rename_cache, cg->id);
+    if(!e)
+        return false;
+
+    netdata_log_debug(D_CGROUP, "renaming cgroup '%s' with the cached output of the rename script, since the script failed", cg->id);
+
+    // the cgroup exists again
+    e->expires_ut = 0;
+
+    // parsing modifies the output
+    char buffer[8192];
+    strncpyz(buffer, e->output, sizeof(buffer) - 1);
+
+    cg->pending_renames = 0;
+    discovery_rename_cgroup_apply(cg, buffer);
+    return true;
+}
+
+static inline POPEN_INSTANCE *discovery_rename_cgroup_start(struct cgroup *cg) {
     cg->pending_renames--;
 
     netdata_log_debug(D_CGROUP, "looking for the name of cgroup '%s' with chart id '%s'", cg->id, cg->chart_id);
@@ -238,14 +337,37 @@ static inline void discovery_rename_cgroup(struct cgroup *cg) {
     POPEN_INSTANCE *instance = spawn_popen_run_variadic(cgroups_rename_script, cg->id, cg->intermediate_id, NULL);
     if (!instance) {
         collector_error("CGROUP: cannot popen(%s \"%s\", \"r\").", cgroups_rename_script, cg->intermediate_id);
-        cg->pending_renames = 0;
-        cg->processed = 1;
-        return;
+        if(!discovery_rename_cgroup_from_cache(cg)) {
+            cg->pending_renames = 0;
+            cg->processed = 1;
+        }
     }
 
+    return instance;
+}
+
+static inline void discovery_rename_cgroup_finish(struct cgroup *cg, POPEN_INSTANCE *instance, usec_t deadline_ut) {
     char buffer[8192]; // we need some size for labels
-    char *new_name = fgets(buffer, sizeof(buffer), spawn_popen_stdout(instance));
-    int exit_code = spawn_popen_wait(instance);
+    char *new_name = NULL;
+    int exit_code;
+
+    struct pollfd pfd = {
+        .fd = spawn_popen_read_fd(instance),
+        .events = POLLIN,
+    };
+
+    usec_t now_ut = now_monotonic_usec();
+    int timeout_ms = (deadline_ut > now_ut) ? (int)((deadline_ut - now_ut) / USEC_PER_MS) : 0;
+
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        collector_error("CGROUP: the rename script for cgroup '%s' did not respond in time, killing it.", cg->id);
+        spawn_popen_kill(instance, 0);
+        exit_code = -1;
+    }
+    else {
+        new_name = fgets(buffer, sizeof(buffer), spawn_popen_stdout(instance));
+        exit_code = spawn_popen_wait(instance);
+    }
 
     switch (exit_code) {
         case 0:
@@ -258,26 +380,65 @@ static inline void discovery_rename_cgroup(struct cgroup *cg) {
             break;
 
         default:
+            // the script failed or timed out - use its last output for this cgroup id, if we have it
+            if (discovery_rename_cgroup_from_cache(cg))
+                return;
             break;
     }
 
-    if (cg->pending_renames || cg->processed)
+    if (cg->pending_renames) {
+        // the discovery may run more frequently than this, when inotify finds new cgroups
+        cg->rename_next_ut = now_monotonic_usec() + cgroup_check_for_new_every * USEC_PER_SEC;
+        return;
+    }
+    if (cg->processed)
         return;
     if (!new_name || !*new_name || *new_name == '\n')
         return;
     if (!(new_name = trim(new_name)))
         return;
 
-    char *name = cgroup_parse_resolved_name_and_labels(cg, new_name);
+    discovery_rename_cache_set(cg->id, new_name);
+    discovery_rename_cgroup_apply(cg, new_name);
+}
 
-    freez(cg->name);
-    cg->name = strdupz(name);
+static inline void discovery_rename_cgroups_batch(struct cgroup **cgs, POPEN_INSTANCE **instances, size_t used) {
+    // the scripts of the batch are all running, collect their output
+    usec_t deadline_ut = now_monotonic_usec() + CGROUP_RENAME_TIMEOUT_UT;
+    for(size_t i = 0; i < used ;i++)
+        discovery_rename_cgroup_finish(cgs[i], instances[i], deadline_ut);
+}
 
-    freez(cg->chart_id);
-    cg->chart_id = cgroup_chart_id_strdupz(name);
+static inline void discovery_rename_cgroups(void) {
+    struct cgroup *cgs[CGROUP_RENAME_BATCH];
+    POPEN_INSTANCE *instances[CGROUP_RENAME_BATCH];
+    size_t used = 0;
 
-    substitute_dots_in_id(cg->chart_id);
-    cg->hash_chart_id = simple_hash(cg->chart_id);
+    usec_t now_ut = now_monotonic_usec();
+
+    for (struct cgroup *cg = discovered_cgroup_root; cg && service_running(SERVICE_COLLECTORS); cg = cg->discovered_next) {
+        if (!cg->available || cg->processed || cg->first_time_seen || !cg->pending_renames)
+            continue;
+
+        if (cg->rename_next_ut > now_ut)
+            continue;
+
+        worker_is_busy(WORKER_DISCOVERY_PROCESS_RENAME);
+
+        POPEN_INSTANCE *instance = discovery_rename_cgroup_start(cg);
+        if (!instance)
+            continue;
+
+        cgs[used] = cg;
+        instances[used] = instance;
+        if (++used == CGROUP_RENAME_BATCH) {
+            discovery_rename_cgroups_batch(cgs, instances, used);
+            used = 0;
+        }
+    }
+
+    if (used)
+        discovery_rename_cgroups_batch(cgs, instances, used);
 }
 
 static void is_cgroup_procs_exist(netdata_ebpf_cgroup_shm_body_t *out, char *id) {
@@ -344,6 +505,9 @@ static inline struct cgroup *discovery_cgroup_add(const char *id) {
 
     struct cgroup *cg = callocz(1, sizeof(struct cgroup));
 
+    for(size_t f = 0; f < CGROUP_FILES_MAX ;f++)
+        cg->fds[f] = -1;
+
     cg->id = strdupz(id);
     cg->hash = simple_hash(cg->id);
 
@@ -427,6 +591,203 @@ static inline void discovery_find_cgroup_in_dir(const char *dir) {
     cgroup_root_count++;
 }
 
+// ----------------------------------------------------------------------------
+// inotify - find the cgroups as they are created and removed
+//
+// The directories of one cgroups hierarchy (the unified one, or cpuacct on v1) are watched
+// for created and removed sub-directories. The created ones are walked when the events
+// settle, so that bursts (e.g. a pod and its containers) are processed together.
+// The full scans are still done, every 'rescan all cgroups every', and when events are lost.
+
+#define CGROUP_INOTIFY_EVENTS (IN_CREATE | IN_DELETE | IN_ONLYDIR)
+#define CGROUP_INOTIFY_POLL_UT (100 * USEC_PER_MS)      // how frequently the events are read
+#define CGROUP_INOTIFY_MAX_DELAY_UT (USEC_PER_SEC)      // the max time to wait for the events to settle
+
+static struct {
+    int fd;                     // -1 = inotify is not used
+    const char *base;           // the hierarchy watched
+    Pvoid_t JudyL_wd;           // watch descriptor -> the cgroup id of the directory
+    size_t watches;
+
+    bool overflow;              // events have been lost, a full scan is needed
+
+    usec_t first_event_ut;      // the first event not processed yet (0 = none)
+    usec_t last_event_ut;
+
+    struct {
+        char **ids;             // the cgroups created since the last time
+        size_t used;
+        size_t size;
+    } created;
+} cgroup_inotify = { .fd = -1 };
+
+static void discovery_inotify_init(void) {
+    if(!cgroup_use_inotify)
+        return;
+
+    const char *base = NULL;
+    if(cgroup_use_unified_cgroups)
+        base = cgroup_unified_exist ? cgroup_unified_base : NULL;
+    else if(cgroup_enable_cpuacct)
+        base = cgroup_cpuacct_base;
+    else if(cgroup_enable_memory)
+        base = cgroup_memory_base;
+    else if(cgroup_enable_blkio)
+        base = cgroup_blkio_base;
+
+    if(!base)
+        return;
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd == -1) {
+        collector_error("CGROUP: cannot initialize inotify, new cgroups will be found every %d seconds.", cgroup_check_for_new_every);
+        return;
+    }
+
+    cgroup_inotify.fd = fd;
+    cgroup_inotify.base = base;
+    collector_info("CGROUP: using inotify to find new cgroups in '%s', all cgroups will be rescanned every %d seconds.", base, cgroup_rescan_every);
+}
+
+static void discovery_inotify_destroy(void) {
+    if(cgroup_inotify.fd == -1)
+        return;
+
+    close(cgroup_inotify.fd);
+    cgroup_inotify.fd = -1;
+
+    Word_t wd = 0;
+    Pvoid_t *PValue;
+    bool first = true;
+    while((PValue = JudyLFirstThenNext(cgroup_inotify.JudyL_wd, &wd, &first)))
+        freez(*PValue);
+    JudyLFreeArray(&cgroup_inotify.JudyL_wd, PJE0);
+
+    for(size_t i = 0; i < cgroup_inotify.created.used ;i++)
+        freez(cgroup_inotify.created.ids[i]);
+    freez(cgroup_inotify.created.ids);
+    memset(&cgroup_inotify.created, 0, sizeof(cgroup_inotify.created));
+}
+
+static void discovery_inotify_watch(const char *base, const char *dirpath, const char *relative_path) {
+    if(cgroup_inotify.fd == -1 || base != cgroup_inotify.base)
+        return;
+
+    // we are only interested in the directories we descend into
+    if(!matches_search_cgroup_paths(relative_path))
+        return;
+
+    int wd = inotify_add_watch(cgroup_inotify.fd, dirpath, CGROUP_INOTIFY_EVENTS);
+    if(wd == -1) {
+        nd_log_limit_static_global_var(erl, 3600, 0);
+        nd_log_limit(&erl, NDLS_COLLECTORS, NDLP_WARNING,
+                     "CGROUP: cannot watch '%s' with inotify (%zu directories watched), "
+                     "its new cgroups will be found by the full scans.",
+                     dirpath, cgroup_inotify.watches);
+        return;
+    }
+
+    // watching a directory again gives the same watch descriptor
+    Pvoid_t *PValue = JudyLIns(&cgroup_inotify.JudyL_wd, (Word_t)wd, PJE0);
+    if(!*PValue) {
+        *PValue = strdupz(relative_path);
+        cgroup_inotify.watches++;
+    }
+}
+
+static void discovery_inotify_unwatch(int wd) {
+    Pvoid_t *PValue = JudyLGet(cgroup_inotify.JudyL_wd, (Word_t)wd, PJE0);
+    if(!PValue)
+        return;
+
+    freez(*PValue);
+    JudyLDel(&cgroup_inotify.JudyL_wd, (Word_t)wd, PJE0);
+    cgroup_inotify.watches--;
+}
+
+static void discovery_inotify_process_event(struct inotify_event *ev) {
+    if(ev->mask & IN_Q_OVERFLOW) {
+        cgroup_inotify.overflow = true;
+        return;
+    }
+
+    if(ev->mask & IN_IGNORED) {
+        // the directory has been removed
+        discovery_inotify_unwatch(ev->wd);
+        return;
+    }
+
+    if(!(ev->mask & IN_ISDIR) || !ev->len)
+        return;
+
+    Pvoid_t *PValue = JudyLGet(cgroup_inotify.JudyL_wd, (Word_t)ev->wd, PJE0);
+    if(!PValue)
+        return;
+
+    const char *parent = *PValue;
+    char id[FILENAME_MAX + 1];
+    snprintfz(id, FILENAME_MAX, "%s/%s", (parent[0] == '/' && parent[1] == '\0') ? "" : parent, ev->name);
+
+    if(ev->mask & IN_CREATE) {
+        if(cgroup_inotify.created.used == cgroup_inotify.created.size) {
+            cgroup_inotify.created.size = cgroup_inotify.created.size ? cgroup_inotify.created.size * 2 : 64;
+            cgroup_inotify.created.ids = reallocz(cgroup_inotify.created.ids, cgroup_inotify.created.size * sizeof(char *));
+        }
+        cgroup_inotify.created.ids[cgroup_inotify.created.used++] = strdupz(id);
+    }
+    else if(ev->mask & IN_DELETE) {
+        struct cgroup *cg = discovery_cgroup_find(id);
+        if(cg)
+            cg->available = 0;
+    }
+    else
+        return;
+
+    usec_t now_ut = now_monotonic_usec();
+    if(!cgroup_inotify.first_event_ut)
+        cgroup_inotify.first_event_ut = now_ut;
+    cgroup_inotify.last_event_ut = now_ut;
+}
+
+static void discovery_inotify_read_events(void) {
+    char buffer[65536] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while(true) {
+        ssize_t len = read(cgroup_inotify.fd, buffer, sizeof(buffer));
+        if(len <= 0) {
+            if(len == -1 && errno != EAGAIN && errno != EINTR) {
+                collector_error("CGROUP: cannot read inotify events, new cgroups will be found every %d seconds.", cgroup_check_for_new_every);
+                discovery_inotify_destroy();
+            }
+            return;
+        }
+
+        for(char *p = buffer; p < &buffer[len] ; ) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ev->len;
+            discovery_inotify_process_event(ev);
+        }
+    }
+}
+
+static inline bool discovery_inotify_events_settled(usec_t now_ut) {
+    if(!cgroup_inotify.first_event_ut)
+        return false;
+
+    return now_ut - cgroup_inotify.last_event_ut >= CGROUP_INOTIFY_POLL_UT ||
+           now_ut - cgroup_inotify.first_event_ut >= CGROUP_INOTIFY_MAX_DELAY_UT;
+}
+
+static inline void discovery_inotify_reset(void) {
+    for(size_t i = 0; i < cgroup_inotify.created.used ;i++)
+        freez(cgroup_inotify.created.ids[i]);
+    cgroup_inotify.created.used = 0;
+
+    cgroup_inotify.first_event_ut = 0;
+    cgroup_inotify.last_event_ut = 0;
+    cgroup_inotify.overflow = false;
+}
+
 static inline int discovery_find_walkdir(const char *base, const char *dirpath) {
     if (!dirpath)
         dirpath = base;
@@ -449,6 +810,7 @@ static inline int discovery_find_walkdir(const char *base, const char *dirpath)
     }
     ret = 1;
 
+    discovery_inotify_watch(base, dirpath, relative_path);
     discovery_find_cgroup_in_dir(relative_path);
 
     struct dirent *de = NULL;
@@ -787,6 +1149,7 @@ static inline void discovery_cleanup_all_cgroups() {
             else
                 last->discovered_next = cg->discovered_next;
 
+            discovery_rename_cache_release(cg);
             cgroup_free(cg);
 
             if(!last)
@@ -1186,20 +1549,9 @@ static inline void discovery_process_cgroup(struct cgroup *cg) {
         return;
     }
 
-    if (cg->first_time_seen) {
-        worker_is_busy(WORKER_DISCOVERY_PROCESS_FIRST_TIME);
-        discovery_process_first_time_seen_cgroup(cg);
-        if (unlikely(cg->first_time_seen || cg->processed)) {
-            return;
-        }
-    }
-
-    if (cg->pending_renames) {
-        worker_is_busy(WORKER_DISCOVERY_PROCESS_RENAME);
-        discovery_rename_cgroup(cg);
-        if (unlikely(cg->pending_renames || cg->processed)) {
-            return;
-        }
+    if (cg->first_time_seen || cg->pending_renames) {
+        // not ready yet, it will be tried again
+        return;
     }
 
     cg->processed = 1;
@@ -1256,19 +1608,16 @@ static inline void discovery_process_cgroup(struct cgroup *cg) {
     read_cgroup_network_interfaces(cg);
 }
 
-static inline void discovery_find_all_cgroups() {
-    netdata_log_debug(D_CGROUP, "searching for cgroups");
-
-    worker_is_busy(WORKER_DISCOVERY_INIT);
-    discovery_mark_as_unavailable_all_cgroups();
-
-    worker_is_busy(WORKER_DISCOVERY_FIND);
-    if (!cgroup_use_unified_cgroups) {
-        discovery_find_all_cgroups_v1();
-    } else {
-        discovery_find_all_cgroups_v2();
+static inline void discovery_process_all_cgroups() {
+    for (struct cgroup *cg = discovered_cgroup_root; cg && service_running(SERVICE_COLLECTORS); cg = cg->discovered_next) {
+        if (cg->available && !cg->processed && cg->first_time_seen) {
+            worker_is_busy(WORKER_DISCOVERY_PROCESS_FIRST_TIME);
+            discovery_process_first_time_seen_cgroup(cg);
+        }
     }
 
+    discovery_rename_cgroups();
+
     for (struct cgroup *cg = discovered_cgroup_root; cg && service_running(SERVICE_COLLECTORS); cg = cg->discovered_next) {
         worker_is_busy(WORKER_DISCOVERY_PROCESS);
         discovery_process_cgroup(cg);
@@ -1290,10 +1639,48 @@ static inline void discovery_find_all_cgroups() {
 
     worker_is_busy(WORKER_DISCOVERY_SHARE);
     discovery_share_cgroups_with_ebpf();
+}
+
+static inline void discovery_find_all_cgroups() {
+    netdata_log_debug(D_CGROUP, "searching for cgroups");
+
+    worker_is_busy(WORKER_DISCOVERY_INIT);
+    discovery_mark_as_unavailable_all_cgroups();
+
+    // the full scan finds everything inotify has seen
+    discovery_inotify_reset();
+
+    worker_is_busy(WORKER_DISCOVERY_FIND);
+    if (!cgroup_use_unified_cgroups) {
+        discovery_find_all_cgroups_v1();
+    } else {
+        discovery_find_all_cgroups_v2();
+    }
+
+    discovery_process_all_cgroups();
+    discovery_rename_cache_cleanup();
 
     netdata_log_debug(D_CGROUP, "done searching for cgroups");
 }
 
+static inline void discovery_find_changed_cgroups() {
+    netdata_log_debug(D_CGROUP, "processing %zu new cgroups found by inotify", cgroup_inotify.created.used);
+
+    worker_is_busy(WORKER_DISCOVERY_FIND);
+    for (size_t i = 0; i < cgroup_inotify.created.used; i++) {
+        char dirpath[FILENAME_MAX + 1];
+        snprintfz(dirpath, FILENAME_MAX, "%s%s", cgroup_inotify.base, cgroup_inotify.created.ids[i]);
+
+        // short-lived cgroups may have been removed already;
+        // walking it also finds and watches the cgroups created in it
+        if (access(dirpath, F_OK) == 0)
+            discovery_find_walkdir(cgroup_inotify.base, dirpath);
+    }
+    discovery_inotify_reset();
+
+    discovery_process_all_cgroups();
+}
+
 void cgroup_discovery_worker(void *ptr)
 {
     UNUSED(ptr);
@@ -1322,19 +1709,43 @@ void cgroup_discovery_worker(void *ptr)
 
     netdata_cgroup_ebpf_initialize_shm();
 
+    discovery_inotify_init();
+    usec_t last_full_scan_ut = 0;
+
     while (service_running(SERVICE_COLLECTORS)) {
         worker_is_idle();
 
+        bool signaled = true;
         netdata_mutex_lock(&discovery_thread.mutex);
-        netdata_cond_wait(&discovery_thread.cond_var, &discovery_thread.mutex);
+        if (cgroup_inotify.fd == -1)
+            netdata_cond_wait(&discovery_thread.cond_var, &discovery_thread.mutex);
+        else
+            signaled = netdata_cond_timedwait(&discovery_thread.cond_var, &discovery_thread.mutex, CGROUP_INOTIFY_POLL_UT * NSEC_PER_USEC) == 0;
         netdata_mutex_unlock(&discovery_thread.mutex);
 
         if (unlikely(!service_running(SERVICE_COLLECTORS)))
             break;
 
-        discovery_find_all_cgroups();
+        if (cgroup_inotify.fd != -1)
+            discovery_inotify_read_events();
+
+        usec_t now_ut = now_monotonic_usec();
+
+        if (cgroup_inotify.fd == -1 || cgroup_inotify.overflow || !last_full_scan_ut ||
+            now_ut - last_full_scan_ut >= (usec_t)cgroup_rescan_every * USEC_PER_SEC) {
+            discovery_find_all_cgroups();
+            last_full_scan_ut = now_ut;
+        }
+        else if (discovery_inotify_events_settled(now_ut))
+            discovery_find_changed_cgroups();
+        else if (signaled)
+            // every 'check for new cgroups every', for the cgroups waiting to be processed or renamed
+            discovery_process_all_cgroups();
     }
 
+    discovery_inotify_destroy();
+    discovery_rename_cache_destroy();
+
     // free all cgroups
     netdata_mutex_lock(&cgroup_root_mutex);
     while(cgroup_root) {
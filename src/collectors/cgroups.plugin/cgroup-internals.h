@@ -124,6 +124,33 @@ struct cpuacct_cpu_shares {
     unsigned long long shares;
 };
 
+// the files of a cgroup kept open across iterations
+typedef enum __attribute__((packed)) cgroup_file {
+    CGROUP_FILE_CPUACCT_STAT = 0,           // v1 cpuacct.stat, v2 cpu.stat
+    CGROUP_FILE_CPUACCT_USAGE,              // v1 cpuacct.usage_percpu
+    CGROUP_FILE_CPU_STAT,                   // v1 cpu.stat
+    CGROUP_FILE_CPU_SHARES,                 // v1 cpu.shares, v2 cpu.weight
+    CGROUP_FILE_MEMORY_STAT,
+    CGROUP_FILE_MEMORY_USAGE,
+    CGROUP_FILE_MEMORY_SWAP_USAGE,
+    CGROUP_FILE_MEMORY_FAILCNT,
+    CGROUP_FILE_IO_SERVICE_BYTES,           // v1
+    CGROUP_FILE_IO_SERVICED,                // v1
+    CGROUP_FILE_THROTTLE_IO_SERVICE_BYTES,  // v1
+    CGROUP_FILE_THROTTLE_IO_SERVICED,       // v1
+    CGROUP_FILE_IO_MERGED,                  // v1
+    CGROUP_FILE_IO_QUEUED,                  // v1
+    CGROUP_FILE_IO_STAT,                    // v2, both the bytes and the operations
+    CGROUP_FILE_PIDS_CURRENT,
+    CGROUP_FILE_CPU_PRESSURE,
+    CGROUP_FILE_IO_PRESSURE,
+    CGROUP_FILE_MEMORY_PRESSURE,
+    CGROUP_FILE_IRQ_PRESSURE,
+
+    // terminator
+    CGROUP_FILES_MAX,
+} CGROUP_FILE;
+
 struct cgroup_network_interface {
     const char *host_device;
     const char *container_device;
@@ -150,6 +177,7 @@ struct cgroup {
     bool function_ready; // true after the first iteration of chart creation/update
 
     char pending_renames;
+    usec_t rename_next_ut;   // the next time the rename script may run for this cgroup
 
     char *id;
     uint32_t hash;
@@ -192,6 +220,12 @@ struct cgroup {
     struct pressure memory_pressure;
     struct pressure irq_pressure;
 
+    int fds[CGROUP_FILES_MAX];      // the open files, -1 = not open
+    usec_t read_ut;                 // the time spent reading the files, in the last iteration
+
+    RRDSET *st_read_time;
+    RRDDIM *st_read_time_rd;
+
     // Cpu
     RRDSET *st_cpu;
     RRDDIM *st_cpu_rd_user;
@@ -275,6 +309,7 @@ extern char services_chart_id_prefix[];
 extern netdata_mutex_t cgroup_root_mutex;
 
 void cgroup_discovery_worker(void *ptr);
+void cgroup_files_close(struct cgroup *cg);
 
 extern bool is_inside_k8s;
 extern long system_page_size;
@@ -288,7 +323,13 @@ extern bool cgroup_enable_blkio;
 extern bool cgroup_enable_pressure;
 extern bool cgroup_enable_cpuacct_cpu_shares;
 
+extern bool cgroup_keep_files_open;
+extern int cgroup_read_threads;
+extern bool cgroup_enable_read_time_charts;
+
 extern int cgroup_check_for_new_every;
+extern bool cgroup_use_inotify;
+extern int cgroup_rescan_every;
 extern int cgroup_update_every;
 
 extern char *cgroup_cpuacct_base;
@@ -423,6 +464,7 @@ void update_io_queued_ops_chart(struct cgroup *cg);
 void update_io_merged_ops_chart(struct cgroup *cg);
 
 void update_pids_current_chart(struct cgroup *cg);
+void update_read_time_chart(struct cgroup *cg);
 
 void update_cpu_some_pressure_chart(struct cgroup *cg);
 void update_cpu_some_pressure_stall_time_chart(struct cgroup *cg);
@@ -22,7 +22,13 @@ bool cgroup_enable_memory = true;
 bool cgroup_enable_cpuacct = true;
 bool cgroup_enable_cpuacct_cpu_shares = false;
 
+bool cgroup_keep_files_open = true;
+int cgroup_read_threads = 0;               // 0 = auto
+bool cgroup_enable_read_time_charts = false;
+
 int cgroup_check_for_new_every = 10;
+bool cgroup_use_inotify = true;
+int cgroup_rescan_every = 300;             // the full scans, when inotify finds the new cgroups
 int cgroup_update_every = 1;
 char *cgroup_cpuacct_base = NULL;
 char *cgroup_cpuset_base = NULL;
@@ -241,6 +247,16 @@ void read_cgroup_plugin_configuration() {
         inicfg_set_duration_seconds(&netdata_config, "plugin:cgroups", "check for new cgroups every", cgroup_check_for_new_every);
     }
 
+    cgroup_use_inotify = inicfg_get_boolean(&netdata_config, "plugin:cgroups", "use inotify to find new cgroups", cgroup_use_inotify);
+    cgroup_rescan_every = (int)inicfg_get_duration_seconds(&netdata_config, "plugin:cgroups", "rescan all cgroups every", cgroup_rescan_every);
+    if(cgroup_rescan_every < cgroup_check_for_new_every) {
+        cgroup_rescan_every = cgroup_check_for_new_every;
+        inicfg_set_duration_seconds(&netdata_config, "plugin:cgroups", "rescan all cgroups every", cgroup_rescan_every);
+    }
+
+    cgroup_read_threads = (int)inicfg_get_number(&netdata_config, "plugin:cgroups", "read threads", cgroup_read_threads);
+    cgroup_enable_read_time_charts = inicfg_get_boolean(&netdata_config, "plugin:cgroups", "enable read time charts", cgroup_enable_read_time_charts);
+
     cgroup_use_unified_cgroups = inicfg_get_boolean_ondemand(&netdata_config, "plugin:cgroups", "use unified cgroups", CONFIG_BOOLEAN_AUTO);
     if (cgroup_use_unified_cgroups == CONFIG_BOOLEAN_AUTO)
         cgroup_use_unified_cgroups = (cgroups_try_detect_version() == CGROUPS_V2);
@@ -326,6 +342,12 @@ void read_cgroup_plugin_configuration() {
     cgroup_root_max = (int)inicfg_get_number(&netdata_config, "plugin:cgroups", "max cgroups to allow", cgroup_root_max);
     cgroup_max_depth = (int)inicfg_get_number(&netdata_config, "plugin:cgroups", "max cgroups depth to monitor", cgroup_max_depth);
 
+    // keep the files open by default, only when all the cgroups we may have fit in a quarter of our files limit
+    if((rlim_t)cgroup_root_max * CGROUP_FILES_MAX > rlimit_nofile.rlim_cur / 4)
+        cgroup_keep_files_open = false;
+
+    cgroup_keep_files_open = inicfg_get_boolean(&netdata_config, "plugin:cgroups", "keep files open", cgroup_keep_files_open);
+
     enabled_cgroup_paths = simple_pattern_create(
             inicfg_get(&netdata_config, "plugin:cgroups", "enable by default cgroups matching",
             // ----------------------------------------------------------------
@@ -464,71 +486,178 @@ static unsigned long long calc_percentage(unsigned long long value, unsigned lon
 }
 
 // ----------------------------------------------------------------------------
-// read values from /sys
+// the files of the cgroups
+//
+// The files of each cgroup are opened once and kept open across iterations (they are
+// re-read with pread()). They are parsed into the procfiles of the thread reading the
+// cgroup, so that the memory needed does not grow with the number of cgroups.
+
+typedef struct cgroup_reader {
+    procfile *ff;                   // the default separators
+    procfile *ff_pressure;          // the separators of the pressure files
+} CGROUP_READER;
+
+// called when a file of a cgroup cannot be read, right after the failure
+static inline void cgroups_check_set(void) {
+    // running out of file descriptors does not mean the cgroups changed
+    if(errno == EMFILE || errno == ENFILE)
+        return;
 
-static inline void cgroup_read_cpuacct_stat(struct cpuacct_stat *cp) {
-    static procfile *ff = NULL;
+    // the cgroups are read in parallel
+    __atomic_store_n(&cgroups_check, 1, __ATOMIC_RELAXED);
+}
 
-    if(likely(cp->filename)) {
-        ff = procfile_reopen(ff, cp->filename, NULL, CGROUP_PROCFILE_FLAG);
-        if(unlikely(!ff)) {
-            cp->updated = 0;
-            cgroups_check = 1;
-            return;
+static inline bool cgroup_files_kept_open(void) {
+    // it is switched off by the threads reading the cgroups, when they run out of file descriptors
+    return __atomic_load_n(&cgroup_keep_files_open, __ATOMIC_RELAXED);
+}
+
+static inline void cgroup_file_close(struct cgroup *cg, CGROUP_FILE id) {
+    if(cg->fds[id] != -1) {
+        close(cg->fds[id]);
+        cg->fds[id] = -1;
+    }
+}
+
+void cgroup_files_close(struct cgroup *cg) {
+    for(size_t id = 0; id < CGROUP_FILES_MAX ;id++)
+        cgroup_file_close(cg, id);
+}
+
+static inline int cgroup_file_open(struct cgroup *cg, CGROUP_FILE id, const char *filename) {
+    if(likely(cg->fds[id] != -1))
+        return cg->fds[id];
+
+    cg->fds[id] = open(filename, O_RDONLY | O_CLOEXEC);
+
+    if(unlikely(cg->fds[id] == -1 && (errno == EMFILE || errno == ENFILE) && cgroup_files_kept_open())) {
+        // we keep too many files open - switch to open/read/close for all cgroups,
+        // the files already open are closed the next time they are read
+        if(__atomic_exchange_n(&cgroup_keep_files_open, false, __ATOMIC_RELAXED))
+            nd_log(NDLS_COLLECTORS, NDLP_WARNING,
+                   "CGROUP: too many open files, the files of the cgroups will not be kept open "
+                   "(set [plugin:cgroups].keep files open = no, or increase the open files limit of Netdata)");
+
+        // free the files of this cgroup and try once more
+        cgroup_files_close(cg);
+        cg->fds[id] = open(filename, O_RDONLY | O_CLOEXEC);
+    }
+
+    return cg->fds[id];
+}
+
+// read and parse a file of a cgroup - returns NULL when the file cannot be read
+static procfile *cgroup_file_read(CGROUP_READER *r, struct cgroup *cg, CGROUP_FILE id, const char *filename, bool pressure) {
+    int fd = cgroup_file_open(cg, id, filename);
+    if(unlikely(fd == -1))
+        return NULL;
+
+    procfile **ff = pressure ? &r->ff_pressure : &r->ff;
+    bool ok = procfile_pread(ff, fd);
+
+    // the cgroup may have been removed, the file is opened again next time
+    if(unlikely(!ok || !cgroup_files_kept_open()))
+        cgroup_file_close(cg, id);
+
+    return ok ? *ff : NULL;
+}
+
+// like read_single_number_file(), for a file of a cgroup
+static int cgroup_file_read_number(struct cgroup *cg, CGROUP_FILE id, const char *filename, unsigned long long *value) {
+    *value = 0;
+
+    int fd = cgroup_file_open(cg, id, filename);
+    if(unlikely(fd == -1))
+        return 1;
+
+    char buffer[30 + 1];
+    ssize_t r = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if(unlikely(r == -1)) {
+        cgroup_file_close(cg, id);
+        return 2;
+    }
+
+    buffer[r] = '\0';
+    *value = str2ull(buffer, NULL);
+
+    if(unlikely(!cgroup_files_kept_open()))
+        cgroup_file_close(cg, id);
+
+    return 0;
+}
+
+// the files with a key and a value on each line
+typedef struct cgroup_key {
+    const char *name;
+    uint32_t hash;                  // set by read_cgroup_plugin_configuration()
+    unsigned long long *value;
+} CGROUP_KEY;
+
+// set the values of the keys found in ff, stopping when all of them have been found
+static size_t cgroup_parse_keys(procfile *ff, CGROUP_KEY *keys, size_t count) {
+    size_t found = 0, lines = procfile_lines(ff);
+
+    for(size_t l = 0; l < lines && found < count ;l++) {
+        const char *s = procfile_lineword(ff, l, 0);
+        uint32_t hash = simple_hash(s);
+
+        for(size_t k = 0; k < count ;k++) {
+            if(unlikely(keys[k].hash == hash && !strcmp(keys[k].name, s))) {
+                *keys[k].value = str2ull(procfile_lineword(ff, l, 1), NULL);
+                found++;
+                break;
+            }
         }
+    }
 
-        ff = procfile_readall(ff);
+    return found;
+}
+
+// ----------------------------------------------------------------------------
+// read values from /sys
+
+static inline void cgroup_read_cpuacct_stat(CGROUP_READER *r, struct cgroup *cg) {
+    struct cpuacct_stat *cp = &cg->cpuacct_stat;
+
+    if(likely(cp->filename)) {
+        procfile *ff = cgroup_file_read(r, cg, CGROUP_FILE_CPUACCT_STAT, cp->filename, false);
         if(unlikely(!ff)) {
             cp->updated = 0;
-            cgroups_check = 1;
+            cgroups_check_set();
             return;
         }
 
-        unsigned long i, lines = procfile_lines(ff);
-
-        if(unlikely(lines < 1)) {
+        if(unlikely(procfile_lines(ff) < 1)) {
             collector_error("CGROUP: file '%s' should have 1+ lines.", cp->filename);
             cp->updated = 0;
             return;
         }
 
-        for(i = 0; i < lines ; i++) {
-            char *s = procfile_lineword(ff, i, 0);
-            uint32_t hash = simple_hash(s);
-
-            if(unlikely(hash == user_hash && !strcmp(s, "user")))
-                cp->user = str2ull(procfile_lineword(ff, i, 1), NULL);
-
-            else if(unlikely(hash == system_hash && !strcmp(s, "system")))
-                cp->system = str2ull(procfile_lineword(ff, i, 1), NULL);
-        }
+        CGROUP_KEY keys[] = {
+            { "user",   user_hash,   &cp->user   },
+            { "system", system_hash, &cp->system },
+        };
+        cgroup_parse_keys(ff, keys, sizeof(keys) / sizeof(keys[0]));
 
         cp->updated = 1;
     }
 }
 
-static inline void cgroup_read_cpuacct_cpu_stat(struct cpuacct_cpu_throttling *cp) {
-    if (unlikely(!cp->filename)) {
-        return;
-    }
+static inline void cgroup_read_cpuacct_cpu_stat(CGROUP_READER *r, struct cgroup *cg) {
+    struct cpuacct_cpu_throttling *cp = &cg->cpuacct_cpu_throttling;
 
-    static procfile *ff = NULL;
-    ff = procfile_reopen(ff, cp->filename, NULL, CGROUP_PROCFILE_FLAG);
-    if (unlikely(!ff)) {
-        cp->updated = 0;
-        cgroups_check = 1;
+    if (unlikely(!cp->filename)) {
         return;
     }
 
-    ff = procfile_readall(ff);
+    procfile *ff = cgroup_file_read(r, cg, CGROUP_FILE_CPU_STAT, cp->filename, false);
     if (unlikely(!ff)) {
         cp->updated = 0;
-        cgroups_check = 1;
+        cgroups_check_set();
         return;
     }
 
-    unsigned long lines = procfile_lines(ff);
-    if (unlikely(lines < 3)) {
+    if (unlikely(procfile_lines(ff) < 3)) {
         collector_error("CGROUP: file '%s' should have 3 lines.", cp->filename);
         cp->updated = 0;
         return;
@@ -537,47 +666,35 @@ static inline void cgroup_read_cpuacct_cpu_stat(struct cpuacct_cpu_throttling *c
     unsigned long long nr_periods_last = cp->nr_periods; 
     unsigned long long nr_throttled_last = cp->nr_throttled; 
 
-    for (unsigned long i = 0; i < lines; i++) {
-        char *s = procfile_lineword(ff, i, 0);
-        uint32_t hash = simple_hash(s);
+    CGROUP_KEY keys[] = {
+        { "nr_periods",     nr_periods_hash,     &cp->nr_periods     },
+        { "nr_throttled",   nr_throttled_hash,   &cp->nr_throttled   },
+        { "throttled_time", throttled_time_hash, &cp->throttled_time },
+    };
+    cgroup_parse_keys(ff, keys, sizeof(keys) / sizeof(keys[0]));
 
-        if (unlikely(hash == nr_periods_hash && !strcmp(s, "nr_periods"))) {
-            cp->nr_periods = str2ull(procfile_lineword(ff, i, 1), NULL);
-        } else if (unlikely(hash == nr_throttled_hash && !strcmp(s, "nr_throttled"))) {
-            cp->nr_throttled = str2ull(procfile_lineword(ff, i, 1), NULL);
-        } else if (unlikely(hash == throttled_time_hash && !strcmp(s, "throttled_time"))) {
-            cp->throttled_time = str2ull(procfile_lineword(ff, i, 1), NULL);
-        }
-    }
     cp->nr_throttled_perc =
         calc_percentage(calc_delta(cp->nr_throttled, nr_throttled_last), calc_delta(cp->nr_periods, nr_periods_last));
 
     cp->updated = 1;
 }
 
-static inline void cgroup2_read_cpuacct_cpu_stat(struct cpuacct_stat *cp, struct cpuacct_cpu_throttling *cpt) {
-    static procfile *ff = NULL;
-    if (unlikely(!cp->filename)) {
-        return;
-    }
+static inline void cgroup2_read_cpuacct_cpu_stat(CGROUP_READER *r, struct cgroup *cg) {
+    struct cpuacct_stat *cp = &cg->cpuacct_stat;
+    struct cpuacct_cpu_throttling *cpt = &cg->cpuacct_cpu_throttling;
 
-    ff = procfile_reopen(ff, cp->filename, NULL, CGROUP_PROCFILE_FLAG);
-    if (unlikely(!ff)) {
-        cp->updated = 0;
-        cgroups_check = 1;
+    if (unlikely(!cp->filename)) {
         return;
     }
 
-    ff = procfile_readall(ff);
+    procfile *ff = cgroup_file_read(r, cg, CGROUP_FILE_CPUACCT_STAT, cp->filename, false);
     if (unlikely(!ff)) {
         cp->updated = 0;
-        cgroups_check = 1;
+        cgroups_check_set();
         return;
     }
 
-    unsigned long lines = procfile_lines(ff);
-
-    if (unlikely(lines < 3)) {
+    if (unlikely(procfile_lines(ff) < 3)) {
         collector_error("CGROUP: file '%s' should have at least 3 lines.", cp->filename);
         cp->updated = 0;
         return;
@@ -585,23 +702,18 @@ static inline void cgroup2_read_cpuacct_cpu_stat(struct cpuacct_stat *cp, struct
 
     unsigned long long nr_periods_last = cpt->nr_periods; 
     unsigned long long nr_throttled_last = cpt->nr_throttled; 
-
-    for (unsigned long i = 0; i < lines; i++) {
-        char *s = procfile_lineword(ff, i, 0);
-        uint32_t hash = simple_hash(s);
-
-        if (unlikely(hash == user_usec_hash && !strcmp(s, "user_usec"))) {
-            cp->user = str2ull(procfile_lineword(ff, i, 1), NULL);
-        } else if (unlikely(hash == system_usec_hash && !strcmp(s, "system_usec"))) {
-            cp->system = str2ull(procfile_lineword(ff, i, 1), NULL);
-        } else if (unlikely(hash == nr_periods_hash && !strcmp(s, "nr_periods"))) {
-            cpt->nr_periods = str2ull(procfile_lineword(ff, i, 1), NULL);
-        } else if (unlikely(hash == nr_throttled_hash && !strcmp(s, "nr_throttled"))) {
-            cpt->nr_throttled = str2ull(procfile_lineword(ff, i, 1), NULL);
-        } else if (unlikely(hash == throttled_usec_hash && !strcmp(s, "throttled_usec"))) {
-            cpt->throttled_time = str2ull(procfile_lineword(ff, i, 1), NULL) * 1000; // usec -> ns
-        }
-    }
+    unsigned long long throttled_usec = cpt->throttled_time / 1000;
+
+    CGROUP_KEY keys[] = {
+        { "user_usec",      user_usec_hash,      &cp->user          },
+        { "system_usec",    system_usec_hash,    &cp->system        },
+        { "nr_periods",     nr_periods_hash,     &cpt->nr_periods   },
+        { "nr_throttled",   nr_throttled_hash,   &cpt->nr_throttled },
+        { "throttled_usec", throttled_usec_hash, &throttled_usec    },
+    };
+    cgroup_parse_keys(ff, keys, sizeof(keys) / sizeof(keys[0]));
+
+    cpt->throttled_time = throttled_usec * 1000; // usec -> ns
     cpt->nr_throttled_perc =
         calc_percentage(calc_delta(cpt->nr_throttled, nr_throttled_last), calc_delta(cpt->nr_periods, nr_periods_last));
 
@@ -609,35 +721,30 @@ static inline void cgroup2_read_cpuacct_cpu_stat(struct cpuacct_stat *cp, struct
     cpt->updated = 1;
 }
 
-static inline void cgroup_read_cpuacct_cpu_shares(struct cpuacct_cpu_shares *cp) {
+static inline void cgroup_read_cpuacct_cpu_shares(struct cgroup *cg) {
+    struct cpuacct_cpu_shares *cp = &cg->cpuacct_cpu_shares;
+
     if (unlikely(!cp->filename)) {
         return;
     }
 
-    if (unlikely(read_single_number_file(cp->filename, &cp->shares))) {
+    if (unlikely(cgroup_file_read_number(cg, CGROUP_FILE_CPU_SHARES, cp->filename, &cp->shares))) {
         cp->updated = 0;
-        cgroups_check = 1;
+        cgroups_check_set();
         return;
     }
 
     cp->updated = 1;
 }
 
-static inline void cgroup_read_cpuacct_usage(struct cpuacct_usage *ca) {
-    static procfile *ff = NULL;
+static inline void cgroup_read_cpuacct_usage(CGROUP_READER *r, struct cgroup *cg) {
+    struct cpuacct_usage *ca = &cg->cpuacct_usage;
 
     if(likely(ca->filename)) {
-        ff = procfile_reopen(ff, ca->filename, NULL, CGROUP_PROCFILE_FLAG);
-        if(unlikely(!ff)) {
-            ca->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
-
-        ff = procfile_readall(ff);
+        procfile *ff = cgroup_file_read(r, cg, CGROUP_FILE_CPUACCT_USAGE, ca->filename, false);
         if(unlikely(!ff)) {
             ca->updated = 0;
-            cgroups_check = 1;
+            cgroups_check_set();
             return;
         }
 
@@ -677,21 +784,12 @@ static inline void cgroup_read_cpuacct_usage(struct cpuacct_usage *ca) {
     }
 }
 
-static inline void cgroup_read_blkio(struct blkio *io) {
+static inline void cgroup_read_blkio(CGROUP_READER *r, struct cgroup *cg, CGROUP_FILE id, struct blkio *io) {
     if (likely(io->filename)) {
-        static procfile *ff = NULL;
-
-        ff = procfile_reopen(ff, io->filename, NULL, CGROUP_PROCFILE_FLAG);
-        if (unlikely(!ff)) {
-            io->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
-
-        ff = procfile_readall(ff);
+        procfile *ff = cgroup_file_read(r, cg, id, io->filename, false);
         if (unlikely(!ff)) {
             io->updated = 0;
-            cgroups_check = 1;
+            cgroups_check_set();
             return;
         }
 
@@ -720,59 +818,48 @@ static inline void cgroup_read_blkio(struct blkio *io) {
     }
 }
 
-static inline void cgroup2_read_blkio(struct blkio *io, unsigned int word_offset) {
-    if (likely(io->filename)) {
-        static procfile *ff = NULL;
-
-        ff = procfile_reopen(ff, io->filename, NULL, CGROUP_PROCFILE_FLAG);
-        if (unlikely(!ff)) {
-            io->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
+// io.stat has both the bytes and the operations, so it is read once for both
+static inline void cgroup2_read_blkio(CGROUP_READER *r, struct cgroup *cg) {
+    struct blkio *bytes = &cg->io_service_bytes, *ops = &cg->io_serviced;
 
-        ff = procfile_readall(ff);
+    const char *filename = bytes->filename ? bytes->filename : ops->filename;
+    if (likely(filename)) {
+        procfile *ff = cgroup_file_read(r, cg, CGROUP_FILE_IO_STAT, filename, false);
         if (unlikely(!ff)) {
-            io->updated = 0;
-            cgroups_check = 1;
+            bytes->updated = ops->updated = 0;
+            cgroups_check_set();
             return;
         }
 
         unsigned long i, lines = procfile_lines(ff);
 
         if (unlikely(lines < 1)) {
-            collector_error("CGROUP: file '%s' should have 1+ lines.", io->filename);
-            io->updated = 0;
+            collector_error("CGROUP: file '%s' should have 1+ lines.", filename);
+            bytes->updated = ops->updated = 0;
             return;
         }
 
-        io->Read = 0;
-        io->Write = 0;
+        bytes->Read = bytes->Write = 0;
+        ops->Read = ops->Write = 0;
 
         for (i = 0; i < lines; i++) {
-            io->Read += str2ull(procfile_lineword(ff, i, 2 + word_offset), NULL);
-            io->Write += str2ull(procfile_lineword(ff, i, 4 + word_offset), NULL);
+            bytes->Read += str2ull(procfile_lineword(ff, i, 2), NULL);
+            bytes->Write += str2ull(procfile_lineword(ff, i, 4), NULL);
+            ops->Read += str2ull(procfile_lineword(ff, i, 2 + 4), NULL);
+            ops->Write += str2ull(procfile_lineword(ff, i, 4 + 4), NULL);
         }
 
-        io->updated = 1;
+        bytes->updated = bytes->filename ? 1 : 0;
+        ops->updated = ops->filename ? 1 : 0;
     }
 }
 
-static inline void cgroup2_read_pressure(struct pressure *res) {
-    static procfile *ff = NULL;
-
+static inline void cgroup2_read_pressure(CGROUP_READER *r, struct cgroup *cg, CGROUP_FILE id, struct pressure *res) {
     if (likely(res->filename)) {
-        ff = procfile_reopen(ff, res->filename, " =", CGROUP_PROCFILE_FLAG);
+        procfile *ff = cgroup_file_read(r, cg, id, res->filename, true);
         if (unlikely(!ff)) {
             res->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
-
-        ff = procfile_readall(ff);
-        if (unlikely(!ff)) {
-            res->updated = 0;
-            cgroups_check = 1;
+            cgroups_check_set();
             return;
         }
 
@@ -809,21 +896,14 @@ static inline void cgroup2_read_pressure(struct pressure *res) {
     }
 }
 
-static inline void cgroup_read_memory(struct memory *mem, char parent_cg_is_unified) {
-    static procfile *ff = NULL;
+static inline void cgroup_read_memory(CGROUP_READER *r, struct cgroup *cg, char parent_cg_is_unified) {
+    struct memory *mem = &cg->memory;
 
     if(likely(mem->filename_detailed)) {
-        ff = procfile_reopen(ff, mem->filename_detailed, NULL, CGROUP_PROCFILE_FLAG);
-        if(unlikely(!ff)) {
-            mem->updated_detailed = 0;
-            cgroups_check = 1;
-            goto memory_next;
-        }
-
-        ff = procfile_readall(ff);
+        procfile *ff = cgroup_file_read(r, cg, CGROUP_FILE_MEMORY_STAT, mem->filename_detailed, false);
         if(unlikely(!ff)) {
             mem->updated_detailed = 0;
-            cgroups_check = 1;
+            cgroups_check_set();
             goto memory_next;
         }
 
@@ -888,7 +968,7 @@ static inline void cgroup_read_memory(struct memory *mem, char parent_cg_is_unif
 memory_next:
 
     if (likely(mem->filename_usage_in_bytes)) {
-        mem->updated_usage_in_bytes = !read_single_number_file(mem->filename_usage_in_bytes, &mem->usage_in_bytes);
+        mem->updated_usage_in_bytes = !cgroup_file_read_number(cg, CGROUP_FILE_MEMORY_USAGE, mem->filename_usage_in_bytes, &mem->usage_in_bytes);
     }
 
     if (likely(mem->updated_usage_in_bytes && mem->updated_detailed)) {
@@ -898,61 +978,179 @@ memory_next:
 
     if (likely(mem->filename_msw_usage_in_bytes)) {
         mem->updated_msw_usage_in_bytes =
-            !read_single_number_file(mem->filename_msw_usage_in_bytes, &mem->msw_usage_in_bytes);
+            !cgroup_file_read_number(cg, CGROUP_FILE_MEMORY_SWAP_USAGE, mem->filename_msw_usage_in_bytes, &mem->msw_usage_in_bytes);
     }
 
     if (likely(mem->filename_failcnt)) {
-        mem->updated_failcnt = !read_single_number_file(mem->filename_failcnt, &mem->failcnt);
+        mem->updated_failcnt = !cgroup_file_read_number(cg, CGROUP_FILE_MEMORY_FAILCNT, mem->filename_failcnt, &mem->failcnt);
     }
 }
 
-static void cgroup_read_pids_current(struct pids *pids) {
+static void cgroup_read_pids_current(struct cgroup *cg) {
+    struct pids *pids = &cg->pids_current;
     pids->updated = 0;
 
     if (unlikely(!pids->filename))
         return;
 
-    pids->updated = !read_single_number_file(pids->filename, &pids->pids_current);
+    pids->updated = !cgroup_file_read_number(cg, CGROUP_FILE_PIDS_CURRENT, pids->filename, &pids->pids_current);
 }
 
-static inline void read_cgroup(struct cgroup *cg) {
+static inline void read_cgroup(CGROUP_READER *r, struct cgroup *cg) {
     netdata_log_debug(D_CGROUP, "reading metrics for cgroups '%s'", cg->id);
+    usec_t started_ut = now_monotonic_high_precision_usec();
+
     if (!(cg->options & CGROUP_OPTIONS_IS_UNIFIED)) {
-        cgroup_read_cpuacct_stat(&cg->cpuacct_stat);
-        cgroup_read_cpuacct_usage(&cg->cpuacct_usage);
-        cgroup_read_cpuacct_cpu_stat(&cg->cpuacct_cpu_throttling);
-        cgroup_read_cpuacct_cpu_shares(&cg->cpuacct_cpu_shares);
-        cgroup_read_memory(&cg->memory, 0);
-        cgroup_read_blkio(&cg->io_service_bytes);
-        cgroup_read_blkio(&cg->io_serviced);
-        cgroup_read_blkio(&cg->throttle_io_service_bytes);
-        cgroup_read_blkio(&cg->throttle_io_serviced);
-        cgroup_read_blkio(&cg->io_merged);
-        cgroup_read_blkio(&cg->io_queued);
-        cgroup_read_pids_current(&cg->pids_current);
+        cgroup_read_cpuacct_stat(r, cg);
+        cgroup_read_cpuacct_usage(r, cg);
+        cgroup_read_cpuacct_cpu_stat(r, cg);
+        cgroup_read_cpuacct_cpu_shares(cg);
+        cgroup_read_memory(r, cg, 0);
+        cgroup_read_blkio(r, cg, CGROUP_FILE_IO_SERVICE_BYTES, &cg->io_service_bytes);
+        cgroup_read_blkio(r, cg, CGROUP_FILE_IO_SERVICED, &cg->io_serviced);
+        cgroup_read_blkio(r, cg, CGROUP_FILE_THROTTLE_IO_SERVICE_BYTES, &cg->throttle_io_service_bytes);
+        cgroup_read_blkio(r, cg, CGROUP_FILE_THROTTLE_IO_SERVICED, &cg->throttle_io_serviced);
+        cgroup_read_blkio(r, cg, CGROUP_FILE_IO_MERGED, &cg->io_merged);
+        cgroup_read_blkio(r, cg, CGROUP_FILE_IO_QUEUED, &cg->io_queued);
+        cgroup_read_pids_current(cg);
     } else {
-        cgroup2_read_blkio(&cg->io_service_bytes, 0);
-        cgroup2_read_blkio(&cg->io_serviced, 4);
-        cgroup2_read_cpuacct_cpu_stat(&cg->cpuacct_stat, &cg->cpuacct_cpu_throttling);
-        cgroup_read_cpuacct_cpu_shares(&cg->cpuacct_cpu_shares);
-        cgroup2_read_pressure(&cg->cpu_pressure);
-        cgroup2_read_pressure(&cg->io_pressure);
-        cgroup2_read_pressure(&cg->memory_pressure);
-        cgroup2_read_pressure(&cg->irq_pressure);
-        cgroup_read_memory(&cg->memory, 1);
-        cgroup_read_pids_current(&cg->pids_current);
+        cgroup2_read_blkio(r, cg);
+        cgroup2_read_cpuacct_cpu_stat(r, cg);
+        cgroup_read_cpuacct_cpu_shares(cg);
+        cgroup2_read_pressure(r, cg, CGROUP_FILE_CPU_PRESSURE, &cg->cpu_pressure);
+        cgroup2_read_pressure(r, cg, CGROUP_FILE_IO_PRESSURE, &cg->io_pressure);
+        cgroup2_read_pressure(r, cg, CGROUP_FILE_MEMORY_PRESSURE, &cg->memory_pressure);
+        cgroup2_read_pressure(r, cg, CGROUP_FILE_IRQ_PRESSURE, &cg->irq_pressure);
+        cgroup_read_memory(r, cg, 1);
+        cgroup_read_pids_current(cg);
+    }
+
+    cg->read_ut = now_monotonic_high_precision_usec() - started_ut;
+}
+
+// ----------------------------------------------------------------------------
+// reading the cgroups in parallel
+//
+// On hosts with thousands of containers, reading their files is most of the work
+// of the plugin. The cgroups are distributed to the threads of the executor (the
+// caller works too). Each thread parses into its own procfiles, and writes only to the cgroups
+// it reads.
+
+#define CGROUP_READ_MAX_THREADS 8
+#define CGROUP_READ_CGROUPS_PER_THREAD 32   // the minimum number of cgroups to wake up a thread
+
+static struct {
+    struct cgroup **cgs;            // the cgroups to be read in this iteration
+    size_t used, size;
+    size_t next;                    // the next cgroup to be read, atomically incremented
+
+    size_t threads;                 // including the caller
+    CGROUP_READER *readers;         // one per thread
+    ND_EXECUTOR_GROUP *group;
+
+    usec_t wall_ut;                 // the time the last iteration took
+    usec_t busy_ut;                 // the sum of the times of the cgroups read in the last iteration
+} cgroup_read = { 0 };
+
+static void cgroup_read_run(size_t slot, void *ptr __maybe_unused) {
+    CGROUP_READER *r = &cgroup_read.readers[slot];
+
+    size_t i;
+    while((i = __atomic_fetch_add(&cgroup_read.next, 1, __ATOMIC_RELAXED)) < cgroup_read.used)
+        read_cgroup(r, cgroup_read.cgs[i]);
+}
+
+static void cgroup_read_init(void) {
+    if(cgroup_read_threads <= 0) {
+        // one thread for every 4 CPUs, reading the files is mostly waiting for the kernel
+        size_t cpus = netdata_conf_cpus();
+        cgroup_read.threads = MIN(MAX(cpus / 4, 1), CGROUP_READ_MAX_THREADS);
     }
+    else
+        cgroup_read.threads = (size_t)cgroup_read_threads;
+
+    cgroup_read.readers = callocz(cgroup_read.threads, sizeof(CGROUP_READER));
+    for(size_t t = 0; t < cgroup_read.threads ;t++) {
+        cgroup_read.readers[t].ff = procfile_create(NULL, CGROUP_PROCFILE_FLAG);
+        cgroup_read.readers[t].ff_pressure = procfile_create(" =", CGROUP_PROCFILE_FLAG);
+    }
+
+    // the caller uses reader 0, the threads of the executor the rest
+    cgroup_read.group = nd_executor_group_get("cgroups", cgroup_read.threads);
+
+    collector_info("CGROUP: reading the cgroups with up to %zu threads", cgroup_read.threads);
+}
+
+static void cgroup_read_destroy(void) {
+    if(!cgroup_read.readers)
+        return;
+
+    for(size_t t = 0; t < cgroup_read.threads ;t++) {
+        procfile_close(cgroup_read.readers[t].ff);
+        procfile_close(cgroup_read.readers[t].ff_pressure);
+    }
+
+    freez(cgroup_read.readers);
+    freez(cgroup_read.cgs);
+    memset(&cgroup_read, 0, sizeof(cgroup_read));
 }
 
 static inline void read_all_discovered_cgroups(struct cgroup *root) {
     netdata_log_debug(D_CGROUP, "reading metrics for all cgroups");
 
-    struct cgroup *cg;
-    for (cg = root; cg; cg = cg->next) {
+    if(unlikely(!cgroup_read.readers))
+        cgroup_read_init();
+
+    usec_t started_ut = now_monotonic_high_precision_usec();
+
+    cgroup_read.used = 0;
+    for (struct cgroup *cg = root; cg; cg = cg->next) {
         if (cg->enabled && !cg->pending_renames) {
-            read_cgroup(cg);
+            if(unlikely(cgroup_read.used == cgroup_read.size)) {
+                cgroup_read.size = cgroup_read.size ? cgroup_read.size * 2 : 256;
+                cgroup_read.cgs = reallocz(cgroup_read.cgs, cgroup_read.size * sizeof(struct cgroup *));
+            }
+            cgroup_read.cgs[cgroup_read.used++] = cg;
         }
     }
+
+    size_t active = MIN(cgroup_read.threads, MAX(cgroup_read.used / CGROUP_READ_CGROUPS_PER_THREAD, 1));
+    cgroup_read.next = 0;
+
+    nd_executor_parallel(cgroup_read.group, ND_EXECUTOR_PRIORITY_HIGH, active, cgroup_read_run, NULL);
+
+    cgroup_read.wall_ut = now_monotonic_high_precision_usec() - started_ut;
+    cgroup_read.busy_ut = 0;
+    for(size_t i = 0; i < cgroup_read.used ;i++)
+        cgroup_read.busy_ut += cgroup_read.cgs[i]->read_ut;
+}
+
+static void update_cgroups_read_time_chart(void) {
+    static RRDSET *st = NULL;
+    static RRDDIM *rd_wall = NULL, *rd_busy = NULL;
+
+    if(unlikely(!st)) {
+        st = rrdset_create_localhost(
+            "netdata",
+            "plugin_cgroups_read_time",
+            NULL,
+            "cgroups.plugin",
+            NULL,
+            "cgroups.plugin time spent reading the files of the cgroups",
+            "microseconds",
+            PLUGIN_CGROUPS_NAME,
+            "stats",
+            132110,
+            cgroup_update_every,
+            RRDSET_TYPE_LINE);
+
+        rd_wall = rrddim_add(st, "elapsed", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        rd_busy = rrddim_add(st, "threads", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+    }
+
+    rrddim_set_by_pointer(st, rd_wall, (collected_number)cgroup_read.wall_ut);
+    rrddim_set_by_pointer(st, rd_busy, (collected_number)cgroup_read.busy_ut);
+    rrdset_done(st);
 }
 
 // update CPU and memory limits
@@ -1269,6 +1467,10 @@ void update_cgroup_charts() {
                 update_pids_current_chart(cg);
         }
 
+        if (unlikely(cgroup_enable_read_time_charts)) {
+            update_read_time_chart(cg);
+        }
+
         if (cg->options & CGROUP_OPTIONS_IS_UNIFIED) {
             if (likely(cg->cpu_pressure.updated)) {
                     if (cg->cpu_pressure.some.available) {
@@ -1330,6 +1532,8 @@ static void cgroup_main_cleanup(void *pptr) {
 
     worker_unregister();
 
+    cgroup_read_destroy();
+
     usec_t max = 2 * USEC_PER_SEC, step = 50000;
 
     if (!__atomic_load_n(&discovery_thread.exited, __ATOMIC_RELAXED)) {
@@ -1454,6 +1658,7 @@ void cgroups_main(void *ptr) {
 
         worker_is_busy(WORKER_CGROUPS_CHART);
 
+        update_cgroups_read_time_chart();
         update_cgroup_charts();
         update_cgroup_systemd_services_charts();
 
@@ -67,7 +67,7 @@ static int was_sched_process_exec_enabled = 0;
 static int was_sched_process_fork_enabled = 0;
 
 static netdata_idx_t *process_hash_values = NULL;
-ebpf_process_stat_t *process_stat_vector = NULL;
+static ebpf_map_batch_t process_batch = {.fd = -1};
 static netdata_syscall_stat_t process_aggregated_data[NETDATA_KEY_PUBLISH_PROCESS_END];
 static netdata_publish_syscall_t process_publish_aggregated[NETDATA_KEY_PUBLISH_PROCESS_END];
 
@@ -984,7 +984,7 @@ static void ebpf_process_exit(void *pptr)
     }
 
     freez(process_hash_values);
-    freez(process_stat_vector);
+    ebpf_map_batch_destroy(&process_batch);
 
     ebpf_process_disable_tracepoints();
 
@@ -1510,18 +1510,15 @@ void collect_data_for_all_processes(int tbl_pid_stats_fd, int maps_per_core)
         return;
 
     pids_fd[NETDATA_EBPF_PIDS_PROCESS_IDX] = tbl_pid_stats_fd;
-    size_t length = sizeof(ebpf_process_stat_t);
-    if (maps_per_core)
-        length *= ebpf_nprocs;
-
-    if (tbl_pid_stats_fd != -1) {
-        uint32_t key = 0, next_key = 0;
-        while (bpf_map_get_next_key(tbl_pid_stats_fd, &key, &next_key) == 0) {
-            if (bpf_map_lookup_elem(tbl_pid_stats_fd, &key, process_stat_vector)) {
-                goto end_process_loop;
-            }
+    ebpf_map_batch_prepare(&process_batch, tbl_pid_stats_fd, sizeof(uint32_t), sizeof(ebpf_process_stat_t), maps_per_core);
+
+    uint32_t n;
+    while ((n = ebpf_map_batch_next(&process_batch))) {
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t key = *(uint32_t *)ebpf_map_batch_key(&process_batch, i);
+            ebpf_process_stat_t *values = ebpf_map_batch_value(&process_batch, i);
 
-            ebpf_process_apps_accumulator(process_stat_vector, maps_per_core);
+            ebpf_process_apps_accumulator(values, maps_per_core);
 
             netdata_ebpf_pid_stats_t *local_pid =
                 netdata_ebpf_get_shm_pointer_unsafe(key, NETDATA_EBPF_PIDS_PROCESS_IDX);
@@ -1530,24 +1527,20 @@ void collect_data_for_all_processes(int tbl_pid_stats_fd, int maps_per_core)
 
             ebpf_publish_process_t *w = &local_pid->process;
 
-            if (!w->ct || w->ct != process_stat_vector[0].ct) {
-                w->ct = process_stat_vector[0].ct;
-                w->create_thread = process_stat_vector[0].create_thread;
-                w->exit_call = process_stat_vector[0].exit_call;
-                w->create_thread = process_stat_vector[0].create_thread;
-                w->create_process = process_stat_vector[0].create_process;
-                w->release_call = process_stat_vector[0].release_call;
-                w->task_err = process_stat_vector[0].task_err;
+            if (!w->ct || w->ct != values[0].ct) {
+                w->ct = values[0].ct;
+                w->create_thread = values[0].create_thread;
+                w->exit_call = values[0].exit_call;
+                w->create_thread = values[0].create_thread;
+                w->create_process = values[0].create_process;
+                w->release_call = values[0].release_call;
+                w->task_err = values[0].task_err;
             } else {
                 if (kill((pid_t)key, 0)) { // No PID found
                     if (netdata_ebpf_reset_shm_pointer_unsafe(tbl_pid_stats_fd, key, NETDATA_EBPF_PIDS_CACHESTAT_IDX))
                         memset(w, 0, sizeof(*w));
                 }
             }
-
-        end_process_loop:
-            memset(process_stat_vector, 0, length);
-            key = next_key;
         }
     }
 
@@ -1660,7 +1653,6 @@ static void ebpf_process_allocate_global_vectors(size_t length)
     memset(process_aggregated_data, 0, length * sizeof(netdata_syscall_stat_t));
     memset(process_publish_aggregated, 0, length * sizeof(netdata_publish_syscall_t));
     process_hash_values = callocz(ebpf_nprocs, sizeof(netdata_idx_t));
-    process_stat_vector = callocz(ebpf_nprocs, sizeof(ebpf_process_stat_t));
 }
 
 static void change_syscalls()
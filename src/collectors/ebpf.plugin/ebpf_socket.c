@@ -92,7 +92,7 @@ static netdata_idx_t *socket_hash_values = NULL;
 static netdata_syscall_stat_t socket_aggregated_data[NETDATA_MAX_SOCKET_VECTOR];
 static netdata_publish_syscall_t socket_publish_aggregated[NETDATA_MAX_SOCKET_VECTOR];
 
-netdata_socket_t *socket_values;
+static ebpf_map_batch_t socket_batch = {.fd = -1};
 
 ebpf_network_viewer_port_list_t *listen_ports = NULL;
 ebpf_addresses_t tcp_v6_connect_address = {.function = "tcp_v6_connect", .hash = 0, .addr = 0, .type = 0};
@@ -1753,118 +1753,106 @@ static void ebpf_socket_translate(netdata_socket_plus_t *dst, netdata_socket_idx
  */
 static void ebpf_update_array_vectors(ebpf_module_t *em)
 {
-    netdata_socket_idx_t key = {};
-    netdata_socket_idx_t next_key = {};
-
     int maps_per_core = em->maps_per_core;
     int fd = em->maps[NETDATA_SOCKET_OPEN_SOCKET].map_fd;
+    int end = (maps_per_core) ? ebpf_nprocs : 1;
 
-    netdata_socket_t *values = socket_values;
-    size_t length = sizeof(netdata_socket_t);
-    int test, end;
-    if (maps_per_core) {
-        length *= ebpf_nprocs;
-        end = ebpf_nprocs;
-    } else
-        end = 1;
-
-    // We need to reset the values when we are working on kernel 4.15 or newer, because kernel does not create
-    // values for specific processor unless it is used to store data. As result of this behavior one the next socket
-    // can have values from the previous one.
-    memset(values, 0, length);
+    // The values are reset for every batch, because kernel does not create values for specific processor unless
+    // it is used to store data. As result of this behavior one the next socket could have values from the previous one.
+    ebpf_map_batch_prepare(&socket_batch, fd, sizeof(netdata_socket_idx_t), sizeof(netdata_socket_t), maps_per_core);
     time_t update_time = time(NULL);
-    while (bpf_map_get_next_key(fd, &key, &next_key) == 0) {
-        test = bpf_map_lookup_elem(fd, &key, values);
-        bool deleted = true;
-        if (test < 0) {
-            goto end_socket_loop;
-        }
-
-        if (key.pid > (uint32_t)pid_max) {
-            goto end_socket_loop;
-        }
+    uint32_t n;
+    while ((n = ebpf_map_batch_next(&socket_batch))) {
+        for (uint32_t i = 0; i < n; i++) {
+            netdata_socket_idx_t key;
+            memcpy(&key, ebpf_map_batch_key(&socket_batch, i), sizeof(key));
+            netdata_socket_t *values = ebpf_map_batch_value(&socket_batch, i);
+            bool deleted = true;
+
+            if (key.pid > (uint32_t)pid_max) {
+                goto end_socket_loop;
+            }
 
-        ebpf_hash_socket_accumulator(values, end);
+            ebpf_hash_socket_accumulator(values, end);
 
-        // We update UDP to show info with charts, but we do not show them with functions
-        /*
-        if (key.dport == NETDATA_EBPF_UDP_PORT && values[0].protocol == IPPROTO_UDP) {
-            bpf_map_delete_elem(fd, &key);
-            goto end_socket_loop;
-        }
-         */
+            // We update UDP to show info with charts, but we do not show them with functions
+            /*
+            if (key.dport == NETDATA_EBPF_UDP_PORT && values[0].protocol == IPPROTO_UDP) {
+                bpf_map_delete_elem(fd, &key);
+                goto end_socket_loop;
+            }
+             */
 
-        // Discard non-bind sockets
-        if (!key.daddr.addr64[0] && !key.daddr.addr64[1] && !key.saddr.addr64[0] && !key.saddr.addr64[1]) {
-            bpf_map_delete_elem(fd, &key);
-            goto end_socket_loop;
-        }
+            // Discard non-bind sockets
+            if (!key.daddr.addr64[0] && !key.daddr.addr64[1] && !key.saddr.addr64[0] && !key.saddr.addr64[1]) {
+                bpf_map_delete_elem(fd, &key);
+                goto end_socket_loop;
+            }
 
-        // When socket is not allowed, we do not append it to table, but we are still keeping it to accumulate data.
-        if (!ebpf_is_socket_allowed(&key, values)) {
-            goto end_socket_loop;
-        }
+            // When socket is not allowed, we do not append it to table, but we are still keeping it to accumulate data.
+            if (!ebpf_is_socket_allowed(&key, values)) {
+                goto end_socket_loop;
+            }
 
-        // Get PID structure
-        rw_spinlock_write_lock(&ebpf_judy_pid.index.rw_spinlock);
-        PPvoid_t judy_array = &ebpf_judy_pid.index.JudyLArray;
-        netdata_ebpf_judy_pid_stats_t *pid_ptr = ebpf_get_pid_from_judy_unsafe(judy_array, key.pid);
-        if (!pid_ptr) {
-            goto end_socket_loop;
-        }
+            // Get PID structure
+            rw_spinlock_write_lock(&ebpf_judy_pid.index.rw_spinlock);
+            PPvoid_t judy_array = &ebpf_judy_pid.index.JudyLArray;
+            netdata_ebpf_judy_pid_stats_t *pid_ptr = ebpf_get_pid_from_judy_unsafe(judy_array, key.pid);
+            if (!pid_ptr) {
+                goto end_socket_loop;
+            }
 
-        // Get Socket structure
-        rw_spinlock_write_lock(&pid_ptr->socket_stats.rw_spinlock);
-        netdata_socket_plus_t **socket_pptr = (netdata_socket_plus_t **)ebpf_judy_insert_unsafe(
-            &pid_ptr->socket_stats.JudyLArray, values[0].first_timestamp);
-        netdata_socket_plus_t *socket_ptr = *socket_pptr;
-        bool translate = false;
-        if (likely(*socket_pptr == NULL)) {
-            *socket_pptr = aral_mallocz(aral_socket_table);
+            // Get Socket structure
+            rw_spinlock_write_lock(&pid_ptr->socket_stats.rw_spinlock);
+            netdata_socket_plus_t **socket_pptr = (netdata_socket_plus_t **)ebpf_judy_insert_unsafe(
+                &pid_ptr->socket_stats.JudyLArray, values[0].first_timestamp);
+            netdata_socket_plus_t *socket_ptr = *socket_pptr;
+            bool translate = false;
+            if (likely(*socket_pptr == NULL)) {
+                *socket_pptr = aral_mallocz(aral_socket_table);
 
-            socket_ptr = *socket_pptr;
+                socket_ptr = *socket_pptr;
 
-            translate = true;
-        }
-        uint64_t prev_period = socket_ptr->data.current_timestamp;
-        memcpy(&socket_ptr->data, &values[0], sizeof(netdata_socket_t));
-        if (translate) {
-            ebpf_socket_translate(socket_ptr, &key);
-            deleted = false;
-        } else { // Check socket was updated
-            deleted = false;
-            if (prev_period) {
-                if (values[0].current_timestamp > prev_period) // Socket updated
+                translate = true;
+            }
+            uint64_t prev_period = socket_ptr->data.current_timestamp;
+            memcpy(&socket_ptr->data, &values[0], sizeof(netdata_socket_t));
+            if (translate) {
+                ebpf_socket_translate(socket_ptr, &key);
+                deleted = false;
+            } else { // Check socket was updated
+                deleted = false;
+                if (prev_period) {
+                    if (values[0].current_timestamp > prev_period) // Socket updated
+                        socket_ptr->last_update = update_time;
+                    else if ((update_time - socket_ptr->last_update) > em->update_every) {
+                        // Socket was not updated since last read
+                        deleted = true;
+                        JudyLDel(&pid_ptr->socket_stats.JudyLArray, values[0].first_timestamp, PJE0);
+                        aral_freez(aral_socket_table, socket_ptr);
+                    }
+                } else // First time
                     socket_ptr->last_update = update_time;
-                else if ((update_time - socket_ptr->last_update) > em->update_every) {
-                    // Socket was not updated since last read
-                    deleted = true;
-                    JudyLDel(&pid_ptr->socket_stats.JudyLArray, values[0].first_timestamp, PJE0);
-                    aral_freez(aral_socket_table, socket_ptr);
-                }
-            } else // First time
-                socket_ptr->last_update = update_time;
-        }
+            }
 
-        rw_spinlock_write_unlock(&pid_ptr->socket_stats.rw_spinlock);
-        rw_spinlock_write_unlock(&ebpf_judy_pid.index.rw_spinlock);
+            rw_spinlock_write_unlock(&pid_ptr->socket_stats.rw_spinlock);
+            rw_spinlock_write_unlock(&ebpf_judy_pid.index.rw_spinlock);
 
-    end_socket_loop: ;// the empty statement is here to allow code to be compiled by old compilers
-        netdata_ebpf_pid_stats_t *local_pid =
-            netdata_ebpf_get_shm_pointer_unsafe(key.pid, NETDATA_EBPF_PIDS_SOCKET_IDX);
-        if (!local_pid)
-            continue;
-        ebpf_socket_publish_apps_t *curr = &local_pid->socket;
-
-        if (!deleted)
-            ebpf_socket_fill_publish_apps(curr, values);
-        else {
-            netdata_ebpf_reset_shm_pointer_unsafe(fd, key.pid, NETDATA_EBPF_PIDS_SOCKET_IDX);
-            memset(curr, 0, sizeof(*curr));
-            bpf_map_delete_elem(fd, &key);
+        end_socket_loop: ;// the empty statement is here to allow code to be compiled by old compilers
+            netdata_ebpf_pid_stats_t *local_pid =
+                netdata_ebpf_get_shm_pointer_unsafe(key.pid, NETDATA_EBPF_PIDS_SOCKET_IDX);
+            if (!local_pid)
+                continue;
+            ebpf_socket_publish_apps_t *curr = &local_pid->socket;
+
+            if (!deleted)
+                ebpf_socket_fill_publish_apps(curr, values);
+            else {
+                netdata_ebpf_reset_shm_pointer_unsafe(fd, key.pid, NETDATA_EBPF_PIDS_SOCKET_IDX);
+                memset(curr, 0, sizeof(*curr));
+                bpf_map_delete_elem(fd, &key);
+            }
         }
-        memset(values, 0, length);
-        memcpy(&key, &next_key, sizeof(key));
     }
 }
 /**
@@ -2835,7 +2823,6 @@ static void ebpf_socket_initialize_global_vectors()
 
     aral_socket_table = ebpf_allocate_pid_aral(NETDATA_EBPF_SOCKET_ARAL_TABLE_NAME, sizeof(netdata_socket_plus_t));
 
-    socket_values = callocz((size_t)ebpf_nprocs, sizeof(netdata_socket_t));
 
     ebpf_load_addresses(&tcp_v6_connect_address, -1);
 }
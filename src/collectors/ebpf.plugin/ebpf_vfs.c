@@ -10,7 +10,7 @@ static char *vfs_id_names[NETDATA_KEY_PUBLISH_VFS_END] =
 static netdata_idx_t *vfs_hash_values = NULL;
 static netdata_syscall_stat_t vfs_aggregated_data[NETDATA_KEY_PUBLISH_VFS_END];
 static netdata_publish_syscall_t vfs_publish_aggregated[NETDATA_KEY_PUBLISH_VFS_END];
-netdata_ebpf_vfs_t *vfs_vector = NULL;
+static ebpf_map_batch_t vfs_batch = {.fd = -1};
 
 static ebpf_local_maps_t vfs_maps[] = {
     {.name = "tbl_vfs_pid",
@@ -1301,38 +1301,31 @@ static void vfs_apps_accumulator(netdata_ebpf_vfs_t *out, int maps_per_core)
  */
 static void ebpf_vfs_read_apps(int maps_per_core)
 {
-    netdata_ebpf_vfs_t *vv = vfs_vector;
     int fd = vfs_maps[NETDATA_VFS_PID].map_fd;
-    size_t length = sizeof(netdata_ebpf_vfs_t);
-    if (maps_per_core)
-        length *= ebpf_nprocs;
-
-    uint32_t key = 0, next_key = 0;
-    while (bpf_map_get_next_key(fd, &key, &next_key) == 0) {
-        if (bpf_map_lookup_elem(fd, &key, vv)) {
-            goto end_vfs_loop;
-        }
+    ebpf_map_batch_prepare(&vfs_batch, fd, sizeof(uint32_t), sizeof(netdata_ebpf_vfs_t), maps_per_core);
 
-        vfs_apps_accumulator(vv, maps_per_core);
+    uint32_t n;
+    while ((n = ebpf_map_batch_next(&vfs_batch))) {
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t key = *(uint32_t *)ebpf_map_batch_key(&vfs_batch, i);
+            netdata_ebpf_vfs_t *vv = ebpf_map_batch_value(&vfs_batch, i);
 
-        netdata_ebpf_pid_stats_t *local_pid = netdata_ebpf_get_shm_pointer_unsafe(key, NETDATA_EBPF_PIDS_VFS_IDX);
-        if (!local_pid)
-            continue;
-        netdata_publish_vfs_t *publish = &local_pid->vfs;
-
-        if (!publish->ct || publish->ct != vv->ct) {
-            vfs_aggregate_set_vfs(publish, vv);
-        } else {
-            if (kill((pid_t)key, 0)) { // No PID found
-                if (netdata_ebpf_reset_shm_pointer_unsafe(fd, key, NETDATA_EBPF_PIDS_VFS_IDX))
-                    memset(publish, 0, sizeof(*publish));
+            vfs_apps_accumulator(vv, maps_per_core);
+
+            netdata_ebpf_pid_stats_t *local_pid = netdata_ebpf_get_shm_pointer_unsafe(key, NETDATA_EBPF_PIDS_VFS_IDX);
+            if (!local_pid)
+                continue;
+            netdata_publish_vfs_t *publish = &local_pid->vfs;
+
+            if (!publish->ct || publish->ct != vv->ct) {
+                vfs_aggregate_set_vfs(publish, vv);
+            } else {
+                if (kill((pid_t)key, 0)) { // No PID found
+                    if (netdata_ebpf_reset_shm_pointer_unsafe(fd, key, NETDATA_EBPF_PIDS_VFS_IDX))
+                        memset(publish, 0, sizeof(*publish));
+                }
             }
         }
-
-    end_vfs_loop:
-        // We are cleaning to avoid passing data read from one process to other.
-        memset(vv, 0, length);
-        key = next_key;
     }
 }
 
@@ -2855,8 +2848,6 @@ void ebpf_vfs_create_apps_charts(struct ebpf_module *em, void *ptr)
  */
 static void ebpf_vfs_allocate_global_vectors()
 {
-    vfs_vector = callocz(ebpf_nprocs, sizeof(netdata_ebpf_vfs_t));
-
     memset(vfs_aggregated_data, 0, sizeof(vfs_aggregated_data));
     memset(vfs_publish_aggregated, 0, sizeof(vfs_publish_aggregated));
 
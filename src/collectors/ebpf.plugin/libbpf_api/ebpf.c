@@ -1681,3 +1681,170 @@ void ebpf_select_host_prefix(char *output, size_t length, char *syscall, int kve
     }
 }
 
+/*****************************************************************
+ *
+ *  BATCHED READING OF HASH TABLES
+ *
+ *****************************************************************/
+
+/**
+ * Map batch prepare
+ *
+ * Prepare the buffers to read a table. It is called every time before reading the table, the buffers are
+ * allocated only when the table or the size of its elements change.
+ *
+ * @param b          the structure used to read the table.
+ * @param fd         the table file descriptor.
+ * @param key_size   the size of a key.
+ * @param value_size the size of a value, for a single core.
+ * @param per_cpu    is this a per-CPU table?
+ */
+void ebpf_map_batch_prepare(ebpf_map_batch_t *b, int fd, uint32_t key_size, uint32_t value_size, bool per_cpu)
+{
+    if (per_cpu) {
+        // the kernel stores the value of every possible core, aligned to 8 bytes
+        int cpus = libbpf_num_possible_cpus();
+        if (cpus < 1)
+            cpus = (int)sysconf(_SC_NPROCESSORS_CONF);
+        value_size = ((value_size + 7) & ~7U) * (uint32_t)cpus;
+    }
+
+    if (b->keys && (b->fd != fd || b->key_size != key_size || b->value_size != value_size))
+        ebpf_map_batch_destroy(b);
+
+    b->fd = fd;
+    b->started = false;
+    b->finished = false;
+
+    if (b->keys)
+        return;
+
+    b->key_size = key_size;
+    b->value_size = value_size;
+    b->size = EBPF_MAP_BATCH_SIZE;
+    b->keys = callocz(b->size, key_size);
+    b->values = callocz(b->size, value_size);
+    // the batch token of hash tables is a bucket index
+    b->position = callocz(1, MAX(key_size, sizeof(uint64_t)));
+}
+
+/**
+ * Map batch destroy
+ *
+ * @param b the structure used to read the table.
+ */
+void ebpf_map_batch_destroy(ebpf_map_batch_t *b)
+{
+    freez(b->keys);
+    freez(b->values);
+    freez(b->position);
+    b->keys = NULL;
+    b->values = NULL;
+    b->position = NULL;
+}
+
+/**
+ * Map batch next fallback
+ *
+ * Read the next elements one by one, for kernels without bpf_map_lookup_batch().
+ *
+ * @param b the structure used to read the table.
+ *
+ * @return It returns the number of elements read.
+ */
+static uint32_t ebpf_map_batch_next_fallback(ebpf_map_batch_t *b)
+{
+    uint32_t n = 0;
+    while (n < b->size) {
+        void *key = ebpf_map_batch_key(b, n);
+        if (bpf_map_get_next_key(b->fd, b->started ? b->position : NULL, key)) {
+            if (!b->started && errno != ENOENT) {
+                // kernels older than 4.12 do not accept a NULL key, start from a zeroed key like before
+                memset(b->position, 0, b->key_size);
+                b->started = true;
+                continue;
+            }
+
+            b->finished = true;
+            break;
+        }
+
+        b->started = true;
+        memcpy(b->position, key, b->key_size);
+
+        // the element may be deleted after we got its key
+        if (!bpf_map_lookup_elem(b->fd, key, ebpf_map_batch_value(b, n)))
+            n++;
+    }
+
+    return n;
+}
+
+/**
+ * Map batch next
+ *
+ * Read the next elements of the table. The loop reading a table is:
+ *
+ *     ebpf_map_batch_prepare(&batch, fd, sizeof(key), sizeof(value), maps_per_core);
+ *     uint32_t n;
+ *     while ((n = ebpf_map_batch_next(&batch))) {
+ *         for (uint32_t i = 0; i < n; i++) {
+ *             key = ebpf_map_batch_key(&batch, i);
+ *             value = ebpf_map_batch_value(&batch, i);
+ *         }
+ *     }
+ *
+ * The elements read can be deleted while the batch is processed.
+ *
+ * @param b the structure used to read the table.
+ *
+ * @return It returns the number of elements read, 0 when the whole table has been read.
+ */
+uint32_t ebpf_map_batch_next(ebpf_map_batch_t *b)
+{
+    if (b->finished || b->fd == -1)
+        return 0;
+
+    // the kernel does not set the values of the cores that have not used an element
+    memset(b->values, 0, (size_t)b->size * b->value_size);
+
+    if (b->fallback)
+        return ebpf_map_batch_next_fallback(b);
+
+    while (true) {
+        uint32_t count = b->size;
+        int ret = bpf_map_lookup_batch(
+            b->fd, b->started ? b->position : NULL, b->position, b->keys, b->values, &count, NULL);
+
+        if (ret == 0) {
+            b->started = true;
+            return count;
+        }
+
+        int err = errno;
+        if (err == ENOENT) {
+            // this is the last batch
+            b->finished = true;
+            return count;
+        }
+
+        if (err == ENOSPC && !count) {
+            // a bucket of the table has more elements than the batch
+            uint32_t size = b->size * 2;
+            b->keys = reallocz(b->keys, (size_t)size * b->key_size);
+            b->values = reallocz(b->values, (size_t)size * b->value_size);
+            memset(b->values, 0, (size_t)size * b->value_size);
+            b->size = size;
+            continue;
+        }
+
+        if (!b->started && (err == EINVAL || err == ENOTSUP || err == ENOSYS || err == 524 /* ENOTSUPP */)) {
+            b->fallback = true;
+            return ebpf_map_batch_next_fallback(b);
+        }
+
+        b->finished = true;
+        return 0;
+    }
+}
+
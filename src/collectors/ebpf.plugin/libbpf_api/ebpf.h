@@ -492,6 +492,42 @@ int ebpf_statistic_create_aral_chart(char *name, ebpf_module_t *em);
 void ebpf_statistic_obsolete_aral_chart(ebpf_module_t *em, int prio);
 void ebpf_send_data_aral_chart(ARAL *memory, ebpf_module_t *em);
 
+// Batched reading of hash tables
+//
+// bpf_map_lookup_batch() reads many elements with one syscall (kernel 5.6 or newer). On older kernels the
+// elements are read one by one, with bpf_map_get_next_key() and bpf_map_lookup_elem(), so the callers have
+// a single code path.
+#define EBPF_MAP_BATCH_SIZE 256
+
+typedef struct ebpf_map_batch {
+    int fd;
+    uint32_t key_size;
+    uint32_t value_size;        // the stride of the values, all cores included for per-CPU tables
+    uint32_t size;              // the elements read at once
+
+    uint8_t *keys;
+    uint8_t *values;
+    uint8_t *position;          // the batch token of the kernel, or the last key read by the fallback
+
+    bool started;
+    bool finished;
+    bool fallback;              // the kernel does not support bpf_map_lookup_batch()
+} ebpf_map_batch_t;
+
+void ebpf_map_batch_prepare(ebpf_map_batch_t *b, int fd, uint32_t key_size, uint32_t value_size, bool per_cpu);
+uint32_t ebpf_map_batch_next(ebpf_map_batch_t *b);
+void ebpf_map_batch_destroy(ebpf_map_batch_t *b);
+
+static inline void *ebpf_map_batch_key(ebpf_map_batch_t *b, uint32_t i)
+{
+    return &b->keys[(size_t)i * b->key_size];
+}
+
+static inline void *ebpf_map_batch_value(ebpf_map_batch_t *b, uint32_t i)
+{
+    return &b->values[(size_t)i * b->value_size];
+}
+
 int ebpf_can_plugin_load_code(int kver, char *plugin_name);
 int ebpf_adjust_memory_limit();
 
@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "irqs_common.h"
+
+// the same separators procfile uses for these files: its defaults and ':'
+static bool irqs_separators[256];
+
+__attribute__((constructor)) static void irqs_initialize_separators(void) {
+    for(int i = 0; i < 256 ;i++)
+        irqs_separators[i] = (i == ':' || isspace(i) || (!isprint(i) && !IS_UTF8_BYTE(i)));
+}
+
+static inline char *irqs_skip_separators(char *s, char *e) {
+    // the columns are aligned with spaces, skip them 8 at a time
+    while(e - s >= 8) {
+        uint64_t v;
+        memcpy(&v, s, sizeof(v));
+        if(v != 0x2020202020202020ULL)
+            break;
+        s += 8;
+    }
+
+    while(s < e && irqs_separators[(unsigned char)*s])
+        s++;
+    return s;
+}
+
+static inline char *irqs_skip_word(char *s, char *e) {
+    while(s < e && !irqs_separators[(unsigned char)*s])
+        s++;
+    return s;
+}
+
+size_t irqs_split_lines(IRQS_LINES *il, char *data, size_t len) {
+    char *s = data, *e = &data[len];
+    il->used = 0;
+
+    while(true) {
+        if(unlikely(il->used == il->size)) {
+            il->size = il->size ? il->size * 2 : 256;
+            il->lines = reallocz(il->lines, il->size * sizeof(IRQS_LINE));
+        }
+
+        char *nl = memchr(s, '\n', e - s);
+        IRQS_LINE *line = &il->lines[il->used++];
+        line->s = s;
+        line->len = (nl ? nl : e) - s;
+
+        if(!nl)
+            break;
+
+        s = nl + 1;
+    }
+
+    return il->used;
+}
+
+int irqs_count_cpus(IRQS_LINE *header) {
+    char *s = header->s, *e = &header->s[header->len];
+    int cpus = 0;
+
+    while((s = irqs_skip_separators(s, e)) < e) {
+        char *w = s;
+        s = irqs_skip_word(s, e);
+        if(s - w >= 3 && strncmp(w, "CPU", 3) == 0)
+            cpus++;
+    }
+
+    return cpus;
+}
+
+static inline void irqs_copy_word(char *dst, size_t size, const char *w, size_t len) {
+    if(len > size - 1)
+        len = size - 1;
+
+    memcpy(dst, w, len);
+    dst[len] = '\0';
+}
+
+bool irqs_parse_line(struct interrupt *irr, IRQS_LINE *line, int cpus, bool with_name) {
+    XXH64_hash_t hash = XXH3_64bits(line->s, line->len);
+    if(irr->used && irr->hash == hash)
+        // the line is the same - nothing changed since the last time
+        return true;
+
+    irr->used = 0;
+    irr->total = 0;
+    irr->hash = hash;
+
+    char *s = line->s, *e = &line->s[line->len];
+
+    // the id
+    s = irqs_skip_separators(s, e);
+    char *id = s;
+    s = irqs_skip_word(s, e);
+    if(s == id)
+        return false;
+
+    irqs_copy_word(irr->id, sizeof(irr->id), id, s - id);
+
+    // the values of the CPUs
+    int c;
+    for(c = 0; c < cpus ;c++) {
+        s = irqs_skip_separators(s, e);
+        if(unlikely(s == e))
+            break;
+
+        // str2ull() stops at the first separator, and the line is followed by
+        // a newline or the terminating null of the procfile
+        char *end;
+        irr->cpu[c].value = str2ull(s, &end);
+        irr->total += irr->cpu[c].value;
+        s = irqs_skip_word(end, e);
+    }
+
+    for(; c < cpus ;c++)
+        irr->cpu[c].value = 0;
+
+    // the name
+    char *last = NULL;
+    size_t last_len = 0, more_words = 0;
+    if(with_name && isdigit((uint8_t)irr->id[0])) {
+        while((s = irqs_skip_separators(s, e)) < e) {
+            last = s;
+            s = irqs_skip_word(s, e);
+            last_len = s - last;
+            more_words++;
+        }
+    }
+
+    if(more_words >= 2) {
+        size_t idlen = strlen(irr->id);
+        irqs_copy_word(irr->name, sizeof(irr->name), last, last_len);
+        size_t nlen = strlen(irr->name);
+        if(likely(nlen + 1 + idlen <= MAX_INTERRUPT_NAME)) {
+            irr->name[nlen] = '_';
+            strncpyz(&irr->name[nlen + 1], irr->id, MAX_INTERRUPT_NAME - nlen - 1);
+        }
+        else {
+            irr->name[MAX_INTERRUPT_NAME - idlen - 1] = '_';
+            strncpyz(&irr->name[MAX_INTERRUPT_NAME - idlen], irr->id, idlen);
+        }
+    }
+    else
+        strncpyz(irr->name, irr->id, MAX_INTERRUPT_NAME);
+
+    irr->used = 1;
+    return true;
+}
+
+// parse a cpulist, like "0-15,32-47"
+static void irqs_parse_cpulist(const char *s, int node, int cpus, int *cpu_node) {
+    while(*s) {
+        char *end;
+        long from = strtol(s, &end, 10);
+        if(end == s)
+            break;
+
+        long to = from;
+        s = end;
+        if(*s == '-') {
+            to = strtol(s + 1, &end, 10);
+            s = end;
+        }
+
+        for(long c = from; c <= to && c < cpus ;c++)
+            if(c >= 0)
+                cpu_node[c] = node;
+
+        while(*s && !isdigit((uint8_t)*s))
+            s++;
+    }
+}
+
+size_t irqs_cpus_numa_nodes(int cpus, int *cpu_node) {
+    for(int c = 0; c < cpus ;c++)
+        cpu_node[c] = -1;
+
+    char dirname[FILENAME_MAX + 1];
+    snprintfz(dirname, FILENAME_MAX, "%s%s", netdata_configured_host_prefix, "/sys/devices/system/node");
+
+    DIR *dir = opendir(dirname);
+    if(!dir)
+        return 0;
+
+    size_t nodes = 0;
+    struct dirent *de;
+    while((de = readdir(dir))) {
+        if(strncmp(de->d_name, "node", 4) != 0 || !isdigit((uint8_t)de->d_name[4]))
+            continue;
+
+        int node = str2i(&de->d_name[4]);
+
+        char filename[FILENAME_MAX + 1];
+        char cpulist[4096 + 1];
+        snprintfz(filename, FILENAME_MAX, "%s/%s/cpulist", dirname, de->d_name);
+        if(read_txt_file(filename, cpulist, sizeof(cpulist)) != 0)
+            continue;
+
+        irqs_parse_cpulist(cpulist, node, cpus, cpu_node);
+
+        if((size_t)node + 1 > nodes)
+            nodes = (size_t)node + 1;
+    }
+    closedir(dir);
+
+    return nodes;
+}
+
+void irqs_numa_charts(IRQS_NUMA *numa, struct interrupt *irrs, size_t lines, int cpus,
+                      const char *type, const char *family, const char *context, const char *title,
+                      const char *units, const char *module, long priority, int update_every) {
+    if(unlikely(!numa->initialized)) {
+        numa->initialized = true;
+        numa->cpu_node = mallocz(cpus * sizeof(int));
+        numa->nodes = irqs_cpus_numa_nodes(cpus, numa->cpu_node);
+        if(numa->nodes) {
+            numa->values = mallocz(numa->nodes * sizeof(unsigned long long));
+            numa->st = callocz(numa->nodes, sizeof(RRDSET *));
+            numa->node_cpus = callocz(numa->nodes, sizeof(size_t));
+            for(int c = 0; c < cpus ;c++)
+                if(numa->cpu_node[c] >= 0)
+                    numa->node_cpus[numa->cpu_node[c]]++;
+        }
+        else
+            collector_info("%s: no NUMA nodes found, the per NUMA node charts are disabled.", module);
+    }
+
+    if(!numa->nodes)
+        return;
+
+    if(unlikely(lines > numa->lines)) {
+        numa->owner = reallocz(numa->owner, lines * sizeof(RRDDIM *));
+        numa->rd = reallocz(numa->rd, lines * numa->nodes * sizeof(RRDDIM *));
+        memset(&numa->owner[numa->lines], 0, (lines - numa->lines) * sizeof(RRDDIM *));
+        numa->lines = lines;
+    }
+
+    for(size_t n = 0; n < numa->nodes ;n++) {
+        if(unlikely(!numa->st[n] && numa->node_cpus[n])) {
+            char id[50 + 1];
+            snprintfz(id, sizeof(id) - 1, "node%zu", n);
+
+            numa->st[n] = rrdset_create_localhost(
+                    type
+                    , id
+                    , NULL
+                    , family
+                    , context
+                    , title
+                    , units
+                    , PLUGIN_PROC_NAME
+                    , module
+                    , priority + (long)n
+                    , update_every
+                    , RRDSET_TYPE_STACKED
+            );
+
+            rrdlabels_add(numa->st[n]->rrdlabels, "numa_node", id, RRDLABEL_SRC_AUTO);
+        }
+    }
+
+    for(size_t l = 0; l < lines ;l++) {
+        struct interrupt *irr = irrindex(irrs, l, cpus);
+
+        // only the interrupts that appear on the system chart
+        if(!irr->used || !irr->rd)
+            continue;
+
+        RRDDIM **rd = &numa->rd[l * numa->nodes];
+        if(unlikely(numa->owner[l] != irr->rd)) {
+            // a new interrupt on this line, or a renamed one
+            for(size_t n = 0; n < numa->nodes ;n++) {
+                if(!numa->st[n]) {
+                    rd[n] = NULL;
+                    continue;
+                }
+
+                rd[n] = rrddim_add(numa->st[n], irr->id, irr->name, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+                rrddim_reset_name(numa->st[n], rd[n], irr->name);
+            }
+            numa->owner[l] = irr->rd;
+        }
+
+        memset(numa->values, 0, numa->nodes * sizeof(unsigned long long));
+        for(int c = 0; c < cpus ;c++) {
+            int n = numa->cpu_node[c];
+            if(likely(n >= 0 && (size_t)n < numa->nodes))
+                numa->values[n] += irr->cpu[c].value;
+        }
+
+        for(size_t n = 0; n < numa->nodes ;n++)
+            if(rd[n])
+                rrddim_set_by_pointer(numa->st[n], rd[n], (collected_number)numa->values[n]);
+    }
+
+    for(size_t n = 0; n < numa->nodes ;n++)
+        if(numa->st[n])
+            rrdset_done(numa->st[n]);
+}
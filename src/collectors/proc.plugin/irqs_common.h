@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_IRQS_COMMON_H
+#define NETDATA_IRQS_COMMON_H 1
+
+#include "plugin_proc.h"
+
+// the parsing of /proc/interrupts and /proc/softirqs
+//
+// Both files are tables with a column per CPU, so on machines with hundreds of CPUs
+// they are very large. We read them without splitting them into words
+// (PROCFILE_FLAG_NO_PARSE), and we parse the numbers of a line only when the line
+// is different from the last time we saw it (checked with a hash of the line).
+
+#define MAX_INTERRUPT_NAME 50
+
+struct cpu_interrupt {
+    unsigned long long value;
+    RRDDIM *rd;
+};
+
+struct interrupt {
+    int used;
+    XXH64_hash_t hash;              // the hash of the line, the last time we parsed it
+    char id[MAX_INTERRUPT_NAME + 1];
+    char name[MAX_INTERRUPT_NAME + 1];
+    RRDDIM *rd;
+    unsigned long long total;
+    struct cpu_interrupt cpu[];
+};
+
+// since each interrupt is variable in size
+// we use this to calculate its record size
+#define recordsize(cpus) (sizeof(struct interrupt) + ((cpus) * sizeof(struct cpu_interrupt)))
+
+// given a base, get a pointer to each record
+#define irrindex(base, line, cpus) ((struct interrupt *)&((char *)(base))[(line) * recordsize(cpus)])
+
+typedef struct irqs_line {
+    char *s;
+    size_t len;
+} IRQS_LINE;
+
+typedef struct irqs_lines {
+    size_t used;
+    size_t size;
+    IRQS_LINE *lines;
+} IRQS_LINES;
+
+// split the data of a procfile into lines - the lines are not null terminated
+size_t irqs_split_lines(IRQS_LINES *il, char *data, size_t len);
+
+// count the CPUxx columns of the header line
+int irqs_count_cpus(IRQS_LINE *header);
+
+// parse a line into irr, unless the line is the same with the one irr was parsed from.
+// with_name is for /proc/interrupts: numbered interrupts are named after their last word.
+// returns false when the line has no id.
+bool irqs_parse_line(struct interrupt *irr, IRQS_LINE *line, int cpus, bool with_name);
+
+// the charts of the interrupts of each NUMA node, summing the CPUs of the node
+typedef struct irqs_numa {
+    bool initialized;
+    size_t nodes;
+    int *cpu_node;                  // the NUMA node of each CPU
+    size_t *node_cpus;              // the number of CPUs of each node (memory only nodes have none)
+    unsigned long long *values;     // the sum of a line, per node
+    RRDSET **st;                    // the chart of each node
+
+    size_t lines;
+    RRDDIM **owner;                 // the system chart dimension each line had, when we added its dimensions
+    RRDDIM **rd;                    // the dimensions of each line, rd[line * nodes + node]
+} IRQS_NUMA;
+
+void irqs_numa_charts(IRQS_NUMA *numa, struct interrupt *irrs, size_t lines, int cpus,
+                      const char *type, const char *family, const char *context, const char *title,
+                      const char *units, const char *module, long priority, int update_every);
+
+// the NUMA node of each CPU, from /sys/devices/system/node/nodeX/cpulist
+// returns the number of NUMA nodes found (0 = no NUMA information)
+// cpu_node[] gets -1 for CPUs not found in any node
+size_t irqs_cpus_numa_nodes(int cpus, int *cpu_node);
+
+#endif //NETDATA_IRQS_COMMON_H
@@ -13,6 +13,12 @@ static struct proc_module {
 
     RRDDIM *rd;
 
+    // the time spent reading and parsing the files of this module, in the last iteration
+    usec_t read_ut;
+    usec_t parse_ut;
+    RRDDIM *rd_read;
+    RRDDIM *rd_parse;
+
 } proc_modules[] = {
 
     // system metrics
@@ -82,12 +88,135 @@ static struct proc_module {
     {.name = NULL, .dim = NULL, .func = NULL}
 };
 
-#if WORKER_UTILIZATION_MAX_JOB_TYPES < 36
-#error WORKER_UTILIZATION_MAX_JOB_TYPES has to be at least 36
+#define WORKER_PROC_PREFETCH 36
+
+#if WORKER_UTILIZATION_MAX_JOB_TYPES < 37
+#error WORKER_UTILIZATION_MAX_JOB_TYPES has to be at least 37
 #endif
 
 static ND_THREAD *netdev_thread = NULL;
 
+// ----------------------------------------------------------------------------
+// prefetching - the modules register the procfiles they read on every iteration,
+// so that all of them are read in parallel before the modules run, and so that
+// we know how much time each module spends reading and parsing files
+
+#define PROC_PREFETCH_MAX 64
+
+static struct {
+    bool enabled;
+    PROCFILE_BATCH *batch;
+
+    size_t count;
+    procfile **ffs[PROC_PREFETCH_MAX];
+    struct proc_module *modules[PROC_PREFETCH_MAX];
+} proc_prefetch = { 0 };
+
+static __thread struct proc_module *proc_running_module = NULL;
+
+void proc_plugin_prefetch(procfile **ff) {
+    struct proc_module *pm = proc_running_module;
+    if(unlikely(!pm))
+        return;
+
+    for(size_t i = 0; i < proc_prefetch.count ;i++)
+        if(proc_prefetch.ffs[i] == ff)
+            return;
+
+    if(unlikely(proc_prefetch.count >= PROC_PREFETCH_MAX))
+        return;
+
+    proc_prefetch.ffs[proc_prefetch.count] = ff;
+    proc_prefetch.modules[proc_prefetch.count] = pm;
+    proc_prefetch.count++;
+}
+
+// the files a module read itself are accounted while it runs,
+// here we add the files read for it in advance
+static void proc_prefetch_account(void) {
+    for(size_t i = 0; i < proc_prefetch.count ;) {
+        procfile *ff = *proc_prefetch.ffs[i];
+        struct proc_module *pm = proc_prefetch.modules[i];
+
+        if(ff && !ff->prefetched) {
+            pm->read_ut += ff->stats.last_read_ut;
+            pm->parse_ut += ff->stats.last_parse_ut;
+        }
+
+        if(!ff || ff->prefetched || !pm->enabled) {
+            // the module did not read this file in this iteration,
+            // stop prefetching it - it will be registered again when the module reads it
+            if(ff) ff->prefetched = false;
+
+            proc_prefetch.count--;
+            proc_prefetch.ffs[i] = proc_prefetch.ffs[proc_prefetch.count];
+            proc_prefetch.modules[i] = proc_prefetch.modules[proc_prefetch.count];
+            continue;
+        }
+
+        i++;
+    }
+}
+
+static void proc_prefetch_charts(int update_every) {
+    static RRDSET *st_read = NULL, *st_parse = NULL;
+
+    bool have_times = false;
+    for(size_t i = 0; proc_modules[i].name && !have_times ;i++)
+        have_times = proc_modules[i].read_ut || proc_modules[i].parse_ut;
+
+    if(unlikely(!st_read && !have_times))
+        return;
+
+    if(unlikely(!st_read)) {
+        st_read = rrdset_create_localhost(
+            "netdata",
+            "plugin_proc_read_time",
+            NULL,
+            "proc.plugin",
+            NULL,
+            "proc.plugin time spent reading files",
+            "microseconds",
+            PLUGIN_PROC_NAME,
+            "stats",
+            132100,
+            update_every,
+            RRDSET_TYPE_STACKED);
+
+        st_parse = rrdset_create_localhost(
+            "netdata",
+            "plugin_proc_parse_time",
+            NULL,
+            "proc.plugin",
+            NULL,
+            "proc.plugin time spent parsing files",
+            "microseconds",
+            PLUGIN_PROC_NAME,
+            "stats",
+            132101,
+            update_every,
+            RRDSET_TYPE_STACKED);
+    }
+
+    for(size_t i = 0; proc_modules[i].name ;i++) {
+        struct proc_module *pm = &proc_modules[i];
+
+        if(!pm->rd_read) {
+            if(!pm->read_ut && !pm->parse_ut)
+                continue;
+
+            pm->rd_read = rrddim_add(st_read, pm->dim, NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+            pm->rd_parse = rrddim_add(st_parse, pm->dim, NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        }
+
+        rrddim_set_by_pointer(st_read, pm->rd_read, (collected_number)pm->read_ut);
+        rrddim_set_by_pointer(st_parse, pm->rd_parse, (collected_number)pm->parse_ut);
+    }
+
+    rrdset_done(st_read);
+    rrdset_done(st_parse);
+}
+
 static void proc_main_cleanup(void *pptr)
 {
     struct netdata_static_thread *static_thread = CLEANUP_FUNCTION_GET_PTR(pptr);
@@ -103,6 +232,8 @@ static void proc_main_cleanup(void *pptr)
     }
 
     nd_thread_join(netdev_thread);
+    procfile_batch_destroy(proc_prefetch.batch);
+    proc_prefetch.batch = NULL;
     worker_unregister();
 
     static_thread->enabled = NETDATA_MAIN_THREAD_EXITED;
@@ -233,6 +364,17 @@ void proc_main(void *ptr)
         worker_register_job_name(i, proc_modules[i].dim);
     }
 
+    // read the files of all modules in parallel, before running the modules
+    size_t cpus = netdata_conf_cpus();
+    proc_prefetch.enabled = inicfg_get_boolean(&netdata_config, "plugin:proc", "parallel file reads",
+                                               cpus >= 16 ? CONFIG_BOOLEAN_YES : CONFIG_BOOLEAN_NO);
+    if(proc_prefetch.enabled) {
+        size_t threads = (size_t)inicfg_get_number_range(&netdata_config, "plugin:proc", "parallel file read threads",
+                                                          (long long)MIN(MAX(cpus / 32, 2), 8), 1, 32);
+        proc_prefetch.batch = procfile_batch_create(threads);
+    }
+    worker_register_job_name(WORKER_PROC_PREFETCH, "prefetch");
+
     heartbeat_t hb;
     heartbeat_init(&hb, localhost->rrd_update_every * USEC_PER_SEC);
 
@@ -256,19 +398,42 @@ void proc_main(void *ptr)
         if(unlikely(!service_running(SERVICE_COLLECTORS)))
             break;
 
+        if(proc_prefetch.enabled && proc_prefetch.count) {
+            worker_is_busy(WORKER_PROC_PREFETCH);
+            procfile_batch_readall(proc_prefetch.batch, proc_prefetch.ffs, proc_prefetch.count);
+        }
+
         for(i = 0; proc_modules[i].name; i++) {
             if(unlikely(!service_running(SERVICE_COLLECTORS)))
                 break;
 
             struct proc_module *pm = &proc_modules[i];
+            pm->read_ut = pm->parse_ut = 0;
             if(unlikely(!pm->enabled))
                 continue;
 
+            usec_t read_ut, parse_ut;
+            procfile_thread_times(&read_ut, &parse_ut);
+
             worker_is_busy(i);
             lgs[LGS_MODULE_ID] = ND_LOG_FIELD_CB(NDF_MODULE, log_proc_module, pm);
+            proc_running_module = pm;
             pm->enabled = !pm->func(localhost->rrd_update_every, hb_dt);
+            proc_running_module = NULL;
             lgs[LGS_MODULE_ID] = ND_LOG_FIELD_TXT(NDF_MODULE, "proc.plugin");
+
+            // the files the module read with procfile_readall(), without prefetching
+            usec_t read_ut_after, parse_ut_after;
+            procfile_thread_times(&read_ut_after, &parse_ut_after);
+            pm->read_ut += read_ut_after - read_ut;
+            pm->parse_ut += parse_ut_after - parse_ut;
         }
+
+        if(unlikely(!service_running(SERVICE_COLLECTORS)))
+            break;
+
+        proc_prefetch_account();
+        proc_prefetch_charts(localhost->rrd_update_every);
     }
 }
 
@@ -47,6 +47,10 @@ int do_proc_pagetypeinfo(int update_every, usec_t dt);
 int do_sys_class_infiniband(int update_every, usec_t dt);
 int do_sys_class_drm(int update_every, usec_t dt);
 int get_numa_node_count(void);
+
+// call it before procfile_readall() on a file the module reads on every iteration,
+// to have it read in parallel with the files of the other modules
+void proc_plugin_prefetch(procfile **ff);
 int do_run_reboot_required(int update_every, usec_t dt);
 
 // Plugin cleanup functions
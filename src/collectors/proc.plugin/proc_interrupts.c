@@ -1,33 +1,10 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "plugin_proc.h"
+#include "irqs_common.h"
 
 #define PLUGIN_PROC_MODULE_INTERRUPTS_NAME "/proc/interrupts"
 #define CONFIG_SECTION_PLUGIN_PROC_INTERRUPTS "plugin:" PLUGIN_PROC_CONFIG_NAME ":" PLUGIN_PROC_MODULE_INTERRUPTS_NAME
 
-#define MAX_INTERRUPT_NAME 50
-
-struct cpu_interrupt {
-    unsigned long long value;
-    RRDDIM *rd;
-};
-
-struct interrupt {
-    int used;
-    char *id;
-    char name[MAX_INTERRUPT_NAME + 1];
-    RRDDIM *rd;
-    unsigned long long total;
-    struct cpu_interrupt cpu[];
-};
-
-// since each interrupt is variable in size
-// we use this to calculate its record size
-#define recordsize(cpus) (sizeof(struct interrupt) + ((cpus) * sizeof(struct cpu_interrupt)))
-
-// given a base, get a pointer to each record
-#define irrindex(base, line, cpus) ((struct interrupt *)&((char *)(base))[(line) * recordsize(cpus)])
-
 static inline struct interrupt *get_interrupts_array(size_t lines, int cpus) {
     static struct interrupt *irrs = NULL;
     static size_t allocated = 0;
@@ -41,6 +18,7 @@ static inline struct interrupt *get_interrupts_array(size_t lines, int cpus) {
         // reset all interrupt RRDDIM pointers as any line could have shifted
         for(l = 0; l < lines ;l++) {
             struct interrupt *irr = irrindex(irrs, l, cpus);
+            irr->used = 0;
             irr->rd = NULL;
             irr->name[0] = '\0';
             for(c = 0; c < cpus ;c++)
@@ -56,41 +34,39 @@ static inline struct interrupt *get_interrupts_array(size_t lines, int cpus) {
 int do_proc_interrupts(int update_every, usec_t dt) {
     (void)dt;
     static procfile *ff = NULL;
-    static int cpus = -1, do_per_core = CONFIG_BOOLEAN_INVALID;
+    static int cpus = -1, do_per_core = CONFIG_BOOLEAN_INVALID, do_per_numa_node = CONFIG_BOOLEAN_INVALID;
     struct interrupt *irrs = NULL;
 
     if(unlikely(do_per_core == CONFIG_BOOLEAN_INVALID))
         do_per_core = inicfg_get_boolean_ondemand(&netdata_config, CONFIG_SECTION_PLUGIN_PROC_INTERRUPTS, "interrupts per core", CONFIG_BOOLEAN_NO);
 
+    if(unlikely(do_per_numa_node == CONFIG_BOOLEAN_INVALID))
+        do_per_numa_node = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_PLUGIN_PROC_INTERRUPTS, "interrupts per numa node", CONFIG_BOOLEAN_NO);
+
     if(unlikely(!ff)) {
         char filename[FILENAME_MAX + 1];
         snprintfz(filename, FILENAME_MAX, "%s%s", netdata_configured_host_prefix, "/proc/interrupts");
-        ff = procfile_open(inicfg_get(&netdata_config, CONFIG_SECTION_PLUGIN_PROC_INTERRUPTS, "filename to monitor", filename), " \t:", PROCFILE_FLAG_DEFAULT);
+        ff = procfile_open(inicfg_get(&netdata_config, CONFIG_SECTION_PLUGIN_PROC_INTERRUPTS, "filename to monitor", filename), " \t:", PROCFILE_FLAG_NO_PARSE);
     }
     if(unlikely(!ff))
         return 1;
 
+    proc_plugin_prefetch(&ff);
     ff = procfile_readall(ff);
     if(unlikely(!ff))
         return 0; // we return 0, so that we will retry to open it next time
 
-    size_t lines = procfile_lines(ff), l;
-    size_t words = procfile_linewords(ff, 0);
+    static IRQS_LINES il = { 0 };
+    size_t lines = irqs_split_lines(&il, ff->data, ff->len), l;
 
-    if(unlikely(!lines)) {
+    if(unlikely(!ff->len)) {
         collector_error("Cannot read /proc/interrupts, zero lines reported.");
         return 1;
     }
 
     // find how many CPUs are there
-    if(unlikely(cpus == -1)) {
-        uint32_t w;
-        cpus = 0;
-        for(w = 0; w < words ; w++) {
-            if(likely(strncmp(procfile_lineword(ff, 0, w), "CPU", 3) == 0))
-                cpus++;
-        }
-    }
+    if(unlikely(cpus == -1))
+        cpus = irqs_count_cpus(&il.lines[0]);
 
     if(unlikely(!cpus)) {
         collector_error("PLUGIN: PROC_INTERRUPTS: Cannot find the number of CPUs in /proc/interrupts");
@@ -101,49 +77,10 @@ int do_proc_interrupts(int update_every, usec_t dt) {
     irrs = get_interrupts_array(lines, cpus);
     irrs[0].used = 0;
 
-    // loop through all lines
+    // loop through all lines - the unchanged ones are not parsed again
     for(l = 1; l < lines ;l++) {
         struct interrupt *irr = irrindex(irrs, l, cpus);
-        irr->used = 0;
-        irr->total = 0;
-
-        words = procfile_linewords(ff, l);
-        if(unlikely(!words)) continue;
-
-        irr->id = procfile_lineword(ff, l, 0);
-        if(unlikely(!irr->id || !irr->id[0])) continue;
-
-        size_t idlen = strlen(irr->id);
-        if(irr->id[idlen - 1] == ':')
-            irr->id[--idlen] = '\0';
-
-        int c;
-        for(c = 0; c < cpus ;c++) {
-            if(likely((c + 1) < (int)words))
-                irr->cpu[c].value = str2ull(procfile_lineword(ff, l, (uint32_t) (c + 1)), NULL);
-            else
-                irr->cpu[c].value = 0;
-
-            irr->total += irr->cpu[c].value;
-        }
-
-        if(unlikely(isdigit(irr->id[0]) && (uint32_t)(cpus + 2) < words)) {
-            strncpyz(irr->name, procfile_lineword(ff, l, words - 1), MAX_INTERRUPT_NAME);
-            size_t nlen = strlen(irr->name);
-            if(likely(nlen + 1 + idlen <= MAX_INTERRUPT_NAME)) {
-                irr->name[nlen] = '_';
-                strncpyz(&irr->name[nlen + 1], irr->id, MAX_INTERRUPT_NAME - nlen - 1);
-            }
-            else {
-                irr->name[MAX_INTERRUPT_NAME - idlen - 1] = '_';
-                strncpyz(&irr->name[MAX_INTERRUPT_NAME - idlen], irr->id, idlen);
-            }
-        }
-        else {
-            strncpyz(irr->name, irr->id, MAX_INTERRUPT_NAME);
-        }
-
-        irr->used = 1;
+        irqs_parse_line(irr, &il.lines[l], cpus, true);
     }
 
     static RRDSET *st_system_interrupts = NULL;
@@ -241,5 +178,12 @@ int do_proc_interrupts(int update_every, usec_t dt) {
         }
     }
 
+    if(do_per_numa_node) {
+        static IRQS_NUMA numa = { 0 };
+        irqs_numa_charts(&numa, irrs, lines, cpus,
+                         "numa_node_interrupts", "interrupts", "cpu.numa_node_interrupts", "NUMA Node Interrupts", "interrupts/s",
+                         PLUGIN_PROC_MODULE_INTERRUPTS_NAME, NETDATA_CHART_PRIO_INTERRUPTS_PER_CORE + cpus, update_every);
+    }
+
     return 0;
 }
@@ -33,6 +33,7 @@ int do_proc_loadavg(int update_every, usec_t dt) {
             return 1;
     }
 
+    proc_plugin_prefetch(&ff);
     ff = procfile_readall(ff);
     if(unlikely(!ff))
         return 0; // we return 0, so that we will retry to open it next time
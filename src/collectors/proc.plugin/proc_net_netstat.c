@@ -352,6 +352,7 @@ static void do_proc_net_snmp6(int update_every) {
         }
     }
 
+    proc_plugin_prefetch(&ff_snmp6);
     ff_snmp6 = procfile_readall(ff_snmp6);
     if (unlikely(!ff_snmp6))
         return;
@@ -1547,6 +1548,7 @@ int do_proc_net_netstat(int update_every, usec_t dt) {
         if(unlikely(!ff_netstat)) return 1;
     }
 
+    proc_plugin_prefetch(&ff_netstat);
     ff_netstat = procfile_readall(ff_netstat);
     if(unlikely(!ff_netstat)) return 0; // we return 0, so that we will retry to open it next time
 
@@ -1593,6 +1595,7 @@ int do_proc_net_netstat(int update_every, usec_t dt) {
         if(unlikely(!ff_snmp)) return 1;
     }
 
+    proc_plugin_prefetch(&ff_snmp);
     ff_snmp = procfile_readall(ff_snmp);
     if(unlikely(!ff_snmp)) return 0; // we return 0, so that we will retry to open it next time
 
@@ -36,6 +36,7 @@ int do_proc_net_softnet_stat(int update_every, usec_t dt) {
         if(unlikely(!ff)) return 1;
     }
 
+    proc_plugin_prefetch(&ff);
     ff = procfile_readall(ff);
     if(unlikely(!ff)) return 0; // we return 0, so that we will retry to open it next time
 
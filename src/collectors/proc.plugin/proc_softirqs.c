@@ -1,32 +1,9 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "plugin_proc.h"
+#include "irqs_common.h"
 
 #define PLUGIN_PROC_MODULE_SOFTIRQS_NAME "/proc/softirqs"
 
-#define MAX_INTERRUPT_NAME 50
-
-struct cpu_interrupt {
-    unsigned long long value;
-    RRDDIM *rd;
-};
-
-struct interrupt {
-    int used;
-    char *id;
-    char name[MAX_INTERRUPT_NAME + 1];
-    RRDDIM *rd;
-    unsigned long long total;
-    struct cpu_interrupt cpu[];
-};
-
-// since each interrupt is variable in size
-// we use this to calculate its record size
-#define recordsize(cpus) (sizeof(struct interrupt) + ((cpus) * sizeof(struct cpu_interrupt)))
-
-// given a base, get a pointer to each record
-#define irrindex(base, line, cpus) ((struct interrupt *)&((char *)(base))[(line) * recordsize(cpus)])
-
 static inline struct interrupt *get_interrupts_array(size_t lines, int cpus) {
     static struct interrupt *irrs = NULL;
     static size_t allocated = 0;
@@ -40,6 +17,7 @@ static inline struct interrupt *get_interrupts_array(size_t lines, int cpus) {
         // reset all interrupt RRDDIM pointers as any line could have shifted
         for(l = 0; l < lines ;l++) {
             struct interrupt *irr = irrindex(irrs, l, cpus);
+            irr->used = 0;
             irr->rd = NULL;
             irr->name[0] = '\0';
             for(c = 0; c < cpus ;c++)
@@ -55,39 +33,37 @@ static inline struct interrupt *get_interrupts_array(size_t lines, int cpus) {
 int do_proc_softirqs(int update_every, usec_t dt) {
     (void)dt;
     static procfile *ff = NULL;
-    static int cpus = -1, do_per_core = CONFIG_BOOLEAN_INVALID;
+    static int cpus = -1, do_per_core = CONFIG_BOOLEAN_INVALID, do_per_numa_node = CONFIG_BOOLEAN_INVALID;
     struct interrupt *irrs = NULL;
 
     if(unlikely(do_per_core == CONFIG_BOOLEAN_INVALID))
         do_per_core = inicfg_get_boolean_ondemand(&netdata_config, "plugin:proc:/proc/softirqs", "interrupts per core", CONFIG_BOOLEAN_NO);
 
+    if(unlikely(do_per_numa_node == CONFIG_BOOLEAN_INVALID))
+        do_per_numa_node = inicfg_get_boolean(&netdata_config, "plugin:proc:/proc/softirqs", "interrupts per numa node", CONFIG_BOOLEAN_NO);
+
     if(unlikely(!ff)) {
         char filename[FILENAME_MAX + 1];
         snprintfz(filename, FILENAME_MAX, "%s%s", netdata_configured_host_prefix, "/proc/softirqs");
-        ff = procfile_open(inicfg_get(&netdata_config, "plugin:proc:/proc/softirqs", "filename to monitor", filename), " \t:", PROCFILE_FLAG_DEFAULT);
+        ff = procfile_open(inicfg_get(&netdata_config, "plugin:proc:/proc/softirqs", "filename to monitor", filename), " \t:", PROCFILE_FLAG_NO_PARSE);
         if(unlikely(!ff)) return 1;
     }
 
+    proc_plugin_prefetch(&ff);
     ff = procfile_readall(ff);
     if(unlikely(!ff)) return 0; // we return 0, so that we will retry to open it next time
 
-    size_t lines = procfile_lines(ff), l;
-    size_t words = procfile_linewords(ff, 0);
+    static IRQS_LINES il = { 0 };
+    size_t lines = irqs_split_lines(&il, ff->data, ff->len), l;
 
-    if(unlikely(!lines)) {
+    if(unlikely(!ff->len)) {
         collector_error("Cannot read /proc/softirqs, zero lines reported.");
         return 1;
     }
 
     // find how many CPUs are there
-    if(unlikely(cpus == -1)) {
-        uint32_t w;
-        cpus = 0;
-        for(w = 0; w < words ; w++) {
-            if(likely(strncmp(procfile_lineword(ff, 0, w), "CPU", 3) == 0))
-                cpus++;
-        }
-    }
+    if(unlikely(cpus == -1))
+        cpus = irqs_count_cpus(&il.lines[0]);
 
     if(unlikely(!cpus)) {
         collector_error("PLUGIN: PROC_SOFTIRQS: Cannot find the number of CPUs in /proc/softirqs");
@@ -98,31 +74,10 @@ int do_proc_softirqs(int update_every, usec_t dt) {
     irrs = get_interrupts_array(lines, cpus);
     irrs[0].used = 0;
 
-    // loop through all lines
+    // loop through all lines - the unchanged ones are not parsed again
     for(l = 1; l < lines ;l++) {
         struct interrupt *irr = irrindex(irrs, l, cpus);
-        irr->used = 0;
-        irr->total = 0;
-
-        words = procfile_linewords(ff, l);
-        if(unlikely(!words)) continue;
-
-        irr->id = procfile_lineword(ff, l, 0);
-        if(unlikely(!irr->id || !irr->id[0])) continue;
-
-        int c;
-        for(c = 0; c < cpus ;c++) {
-            if(likely((c + 1) < (int)words))
-                irr->cpu[c].value = str2ull(procfile_lineword(ff, l, (uint32_t) (c + 1)), NULL);
-            else
-                irr->cpu[c].value = 0;
-
-            irr->total += irr->cpu[c].value;
-        }
-
-        strncpyz(irr->name, irr->id, MAX_INTERRUPT_NAME);
-
-        irr->used = 1;
+        irqs_parse_line(irr, &il.lines[l], cpus, false);
     }
 
     // --------------------------------------------------------------------
@@ -239,5 +194,12 @@ int do_proc_softirqs(int update_every, usec_t dt) {
         }
     }
 
+    if(do_per_numa_node) {
+        static IRQS_NUMA numa = { 0 };
+        irqs_numa_charts(&numa, irrs, lines, cpus,
+                         "numa_node_softirqs", "softirqs", "cpu.numa_node_softirqs", "NUMA Node softirqs", "softirqs/s",
+                         PLUGIN_PROC_MODULE_SOFTIRQS_NAME, NETDATA_CHART_PRIO_SOFTIRQS_PER_CORE + cpus, update_every);
+    }
+
     return 0;
 }
@@ -140,6 +140,7 @@ int do_proc_vmstat(int update_every, usec_t dt) {
         if(unlikely(!ff)) return 1;
     }
 
+    proc_plugin_prefetch(&ff);
     ff = procfile_readall(ff);
     if(unlikely(!ff)) return 0; // we return 0, so that we will retry to open it next time
 
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "statsd-benchmark.h"
+
+// A statsd load generator, to find the rate at which a running netdata starts
+// dropping UDP packets. It sends a mix of counters, gauges, timers and histograms
+// at increasing rates, and checks the UDP receive errors of the kernel after each step.
+// Run it against a running netdata with: netdata -W statsdbench[=HOST:PORT]
+// Drops are measured on this host, so netdata has to run on the same host
+// (and network namespace) for them to be accurate.
+
+#define STATSD_BENCH_DEFAULT_DESTINATION "localhost:8125"
+#define STATSD_BENCH_STEP_SECONDS 5
+#define STATSD_BENCH_BATCH 64                   // packets per sendmmsg() call
+#define STATSD_BENCH_METRICS 1000               // unique metric names per type
+#define STATSD_BENCH_PACKET_SIZE 128
+#define STATSD_BENCH_MAX_DROP_RATIO 0.001       // a step with more drops than this fails
+
+static const size_t statsd_bench_rates[] = {
+    50000, 100000, 200000, 400000, 800000, 1600000, 3200000, 0
+};
+
+typedef struct {
+    int fd;
+    size_t packets_per_second;
+    usec_t duration_ut;
+    size_t sent;
+    size_t errors;
+    uint32_t seed;
+} STATSD_BENCH_SENDER;
+
+static size_t statsd_bench_packet(char *dst, size_t size, uint32_t n) {
+    uint32_t id = (n / 4) % STATSD_BENCH_METRICS;
+
+    switch(n % 4) {
+        case 0:  return snprintfz(dst, size, "netdata.bench.counter%u:1|c", id);
+        case 1:  return snprintfz(dst, size, "netdata.bench.gauge%u:%u|g", id, n % 1000);
+        case 2:  return snprintfz(dst, size, "netdata.bench.timer%u:%u|ms", id, n % 500);
+        default: return snprintfz(dst, size, "netdata.bench.histogram%u:%u|h|@0.5", id, n % 2000);
+    }
+}
+
+static void statsd_bench_sender_thread(void *arg) {
+    STATSD_BENCH_SENDER *s = arg;
+
+    char buffers[STATSD_BENCH_BATCH][STATSD_BENCH_PACKET_SIZE];
+    struct iovec iovecs[STATSD_BENCH_BATCH];
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[STATSD_BENCH_BATCH];
+    memset(msgs, 0, sizeof(msgs));
+#endif
+
+    uint32_t n = s->seed;
+    usec_t started_ut = now_monotonic_high_precision_usec();
+    usec_t usec_per_batch = (usec_t)STATSD_BENCH_BATCH * USEC_PER_SEC / s->packets_per_second;
+    usec_t next_ut = started_ut;
+
+    while(true) {
+        usec_t now_ut = now_monotonic_high_precision_usec();
+        if(now_ut - started_ut >= s->duration_ut)
+            break;
+
+        if(now_ut < next_ut) {
+            sleep_usec(next_ut - now_ut);
+            continue;
+        }
+        next_ut += usec_per_batch;
+
+        for(size_t i = 0; i < STATSD_BENCH_BATCH ;i++) {
+            iovecs[i].iov_base = buffers[i];
+            iovecs[i].iov_len = statsd_bench_packet(buffers[i], sizeof(buffers[i]), n++);
+#ifdef HAVE_SENDMMSG
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+#endif
+        }
+
+#ifdef HAVE_SENDMMSG
+        int rc = sendmmsg(s->fd, msgs, STATSD_BENCH_BATCH, 0);
+        if(rc > 0)
+            s->sent += rc;
+        if(rc < STATSD_BENCH_BATCH)
+            s->errors += STATSD_BENCH_BATCH - (rc > 0 ? rc : 0);
+#else
+        for(size_t i = 0; i < STATSD_BENCH_BATCH ;i++) {
+            if(send(s->fd, iovecs[i].iov_base, iovecs[i].iov_len, 0) > 0)
+                s->sent++;
+            else
+                s->errors++;
+        }
+#endif
+    }
+
+    s->duration_ut = now_monotonic_high_precision_usec() - started_ut;
+}
+
+// the sum of the UDP and UDP-Lite receive buffer errors of this host
+static bool statsd_bench_udp_rcvbuf_errors(uint64_t *errors) {
+    FILE *fp = fopen("/proc/net/snmp", "r");
+    if(!fp)
+        return false;
+
+    char header[4096], values[4096];
+    bool found = false;
+    *errors = 0;
+
+    while(fgets(header, sizeof(header), fp)) {
+        if(strncmp(header, "Udp:", 4) != 0 && strncmp(header, "UdpLite:", 8) != 0)
+            continue;
+
+        if(!fgets(values, sizeof(values), fp))
+            break;
+
+        char *hs = NULL, *vs = NULL;
+        char *h = strtok_r(header, " \n", &hs);
+        char *v = strtok_r(values, " \n", &vs);
+        while(h && v) {
+            if(strcmp(h, "RcvbufErrors") == 0) {
+                *errors += str2ull(v, NULL);
+                found = true;
+            }
+            h = strtok_r(NULL, " \n", &hs);
+            v = strtok_r(NULL, " \n", &vs);
+        }
+    }
+
+    fclose(fp);
+    return found;
+}
+
+static int statsd_bench_connect(const char *destination) {
+    char buf[strlen(destination) + 1];
+    strncpyz(buf, destination, sizeof(buf) - 1);
+
+    const char *host = buf, *port = "8125";
+    char *colon = strrchr(buf, ':');
+    if(colon) {
+        *colon = '\0';
+        port = colon + 1;
+    }
+
+    if(*host == '[') {
+        // [ipv6]:port
+        host++;
+        char *e = strchr(host, ']');
+        if(e) *e = '\0';
+    }
+
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_DGRAM,
+    }, *result = NULL;
+
+    int r = getaddrinfo(host, port, &hints, &result);
+    if(r != 0) {
+        fprintf(stderr, "Cannot resolve '%s': %s\n", destination, gai_strerror(r));
+        return -1;
+    }
+
+    int fd = -1;
+    for(struct addrinfo *rp = result; rp ; rp = rp->ai_next) {
+        fd = socket(rp->ai_family, rp->ai_socktype | SOCK_CLOEXEC, rp->ai_protocol);
+        if(fd < 0)
+            continue;
+
+        if(connect(fd, rp->ai_addr, rp->ai_addrlen) == 0)
+            break;
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(result);
+
+    if(fd < 0)
+        fprintf(stderr, "Cannot connect a UDP socket to '%s': %s\n", destination, strerror(errno));
+
+    return fd;
+}
+
+int statsd_benchmark(const char *destination) {
+    if(!destination || !*destination)
+        destination = STATSD_BENCH_DEFAULT_DESTINATION;
+
+    size_t threads = os_get_system_cpus() / 2;
+    if(threads < 1) threads = 1;
+    if(threads > 8) threads = 8;
+
+    uint64_t errors_before, errors_after;
+    bool have_errors = statsd_bench_udp_rcvbuf_errors(&errors_before);
+    if(!have_errors)
+        fprintf(stderr, "Cannot read the UDP receive errors from /proc/net/snmp - drops will not be reported.\n");
+
+    fprintf(stderr, "Sending statsd metrics to '%s' with %zu threads, %d seconds per step.\n"
+                    "Watch the netdata.statsd_packets chart of the agent to see what it received.\n\n",
+            destination, threads, STATSD_BENCH_STEP_SECONDS);
+
+    fprintf(stderr, "%12s %12s %12s %12s %12s\n", "target pps", "sent pps", "send errors", "drops", "drops %");
+
+    STATSD_BENCH_SENDER senders[threads];
+    ND_THREAD *thread_ids[threads];
+    size_t max_ok_rate = 0;
+    int ret = 0;
+
+    for(size_t r = 0; statsd_bench_rates[r] ;r++) {
+        size_t rate = statsd_bench_rates[r];
+
+        for(size_t t = 0; t < threads ;t++) {
+            senders[t] = (STATSD_BENCH_SENDER){
+                .fd = statsd_bench_connect(destination),
+                .packets_per_second = rate / threads,
+                .duration_ut = STATSD_BENCH_STEP_SECONDS * USEC_PER_SEC,
+                .seed = (uint32_t)(t * 7919),
+            };
+
+            if(senders[t].fd < 0) {
+                while(t--) close(senders[t].fd);
+                return 1;
+            }
+        }
+
+        if(have_errors)
+            statsd_bench_udp_rcvbuf_errors(&errors_before);
+
+        for(size_t t = 0; t < threads ;t++) {
+            char tag[NETDATA_THREAD_TAG_MAX + 1];
+            snprintfz(tag, NETDATA_THREAD_TAG_MAX, "STATSDBENCH[%zu]", t);
+            thread_ids[t] = nd_thread_create(tag, NETDATA_THREAD_OPTION_DONT_LOG, statsd_bench_sender_thread, &senders[t]);
+        }
+
+        size_t sent = 0, send_errors = 0;
+        usec_t duration_ut = 0;
+        for(size_t t = 0; t < threads ;t++) {
+            nd_thread_join(thread_ids[t]);
+            close(senders[t].fd);
+            sent += senders[t].sent;
+            send_errors += senders[t].errors;
+            duration_ut = MAX(duration_ut, senders[t].duration_ut);
+        }
+
+        // let the receiver drain its socket buffers
+        sleep_usec(200 * USEC_PER_MS);
+
+        uint64_t drops = 0;
+        if(have_errors && statsd_bench_udp_rcvbuf_errors(&errors_after))
+            drops = errors_after - errors_before;
+
+        double sent_pps = duration_ut ? (double)sent * USEC_PER_SEC / (double)duration_ut : 0;
+        double drop_ratio = sent ? (double)drops / (double)sent : 0;
+
+        fprintf(stderr, "%12zu %12.0f %12zu %12"PRIu64" %11.3f%%\n",
+                rate, sent_pps, send_errors, drops, drop_ratio * 100.0);
+
+        if(drop_ratio > STATSD_BENCH_MAX_DROP_RATIO)
+            break;
+
+        if(sent_pps < (double)rate * 0.9) {
+            fprintf(stderr, "\nThe load generator cannot send faster than %.0f packets/s on this host.\n", sent_pps);
+            max_ok_rate = (size_t)sent_pps;
+            break;
+        }
+
+        max_ok_rate = rate;
+    }
+
+    if(max_ok_rate)
+        fprintf(stderr, "\nstatsd received up to %zu packets/s without dropping more than %.1f%% of them.\n",
+                max_ok_rate, STATSD_BENCH_MAX_DROP_RATIO * 100.0);
+    else {
+        fprintf(stderr, "\nstatsd dropped packets even at the lowest rate.\n");
+        ret = 1;
+    }
+
+    return ret;
+}
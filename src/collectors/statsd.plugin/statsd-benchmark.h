@@ -0,0 +1,11 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_STATSD_BENCHMARK_H
+#define NETDATA_STATSD_BENCHMARK_H
+
+#include "libnetdata/libnetdata.h"
+
+int statsd_benchmark(const char *destination);
+int statsd_parser_unittest(void);
+
+#endif //NETDATA_STATSD_BENCHMARK_H
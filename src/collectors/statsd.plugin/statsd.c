@@ -1,6 +1,11 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "database/rrd.h"
+#include "statsd-benchmark.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #define STATSD_CHART_PREFIX "statsd"
 
@@ -23,7 +28,7 @@
 // DO NOT ENABLE MULTITHREADING - IT IS NOT WELL TESTED
 // #define STATSD_MULTITHREADED 1
 
-#define STATSD_DICTIONARY_OPTIONS (DICT_OPTION_DONT_OVERWRITE_VALUE | DICT_OPTION_ADD_IN_FRONT)
+#define STATSD_DICTIONARY_OPTIONS (DICT_OPTION_DONT_OVERWRITE_VALUE | DICT_OPTION_ADD_IN_FRONT | DICT_OPTION_INDEX_HASHTABLE)
 #define STATSD_DECIMAL_DETAIL 1000 // floating point values get multiplied by this, with the same divisor
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -60,6 +65,8 @@ typedef struct statsd_histogram_extensions {
     uint32_t size;
     uint32_t used;
     NETDATA_DOUBLE *values;   // dynamic array of values collected
+
+    DDSKETCH *sketch;         // when set, values are counted in this sketch instead of the array above
 } STATSD_METRIC_HISTOGRAM_EXTENSIONS;
 
 typedef struct statsd_metric_histogram { // histogram and timer
@@ -95,6 +102,7 @@ typedef enum __attribute__((packed)) statsd_metric_options {
     STATSD_METRIC_OPTION_USEFUL                       = 0x00000080, // set when the charting thread finds the metric useful (i.e. used in a chart)
     STATSD_METRIC_OPTION_COLLECTION_FULL_LOGGED       = 0x00000100, // set when the collection is full for this metric
     STATSD_METRIC_OPTION_UPDATED_CHART_METADATA       = 0x00000200, // set when the private chart metadata have been updated via tags
+    STATSD_METRIC_OPTION_HISTOGRAM_SKETCH             = 0x00000400, // histograms and timers use a DDSketch instead of keeping all values
     STATSD_METRIC_OPTION_OBSOLETE                     = 0x00004000, // set when the metric is obsoleted
 } STATS_METRIC_OPTIONS;
 
@@ -216,10 +224,17 @@ typedef struct statsd_app_chart {
     struct statsd_app_chart *next;
 } STATSD_APP_CHART;
 
+typedef enum __attribute__((packed)) statsd_histogram_algorithm {
+    STATSD_HISTOGRAM_ALGORITHM_DEFAULT = 0,     // use the global setting
+    STATSD_HISTOGRAM_ALGORITHM_EXACT,
+    STATSD_HISTOGRAM_ALGORITHM_DDSKETCH,
+} STATSD_HISTOGRAM_ALGORITHM;
+
 typedef struct statsd_app {
     const char *name;
     SIMPLE_PATTERN *metrics;
     STATS_METRIC_OPTIONS default_options;
+    STATSD_HISTOGRAM_ALGORITHM histograms_algorithm;
     RRD_DB_MODE rrd_memory_mode;
     int32_t rrd_history_entries;
     DICTIONARY *dict;
@@ -229,6 +244,35 @@ typedef struct statsd_app {
     struct statsd_app *next;
 } STATSD_APP;
 
+// --------------------------------------------------------------------------------------------------------------------
+// per thread shards - when there are multiple UDP receiving threads, each thread
+// aggregates gauges, counters, meters, timers and histograms in its own index
+// and the flushing thread merges them into the shared index before flushing
+
+#define STATSD_SHARD_TYPES (STATSD_METRIC_TYPE_HISTOGRAM + 1)
+
+typedef struct statsd_shard_sample {
+    NETDATA_DOUBLE value;
+    uint32_t samples;
+} STATSD_SHARD_SAMPLE;
+
+typedef struct statsd_shard_metric {
+    uint32_t count;                 // events received since the last merge
+    bool absolute;                  // gauges: an absolute value has been received
+    NETDATA_DOUBLE value;           // gauges: the value, or the increment when not absolute
+    collected_number sum;           // counters and meters: the sum of the values
+    uint32_t used;                  // histograms and timers: the values received since the last merge
+    uint32_t size;
+    STATSD_SHARD_SAMPLE *samples;
+} STATSD_SHARD_METRIC;
+
+typedef struct statsd_shard {
+    SPINLOCK spinlock;              // held by the receiving thread while processing a packet
+    uint32_t active;                // the buffer the receiving thread writes to, the other one is merged
+    DICTIONARY *dict[2][STATSD_SHARD_TYPES];
+    LISTEN_SOCKETS sockets;         // the SO_REUSEPORT UDP sockets of this shard (empty for the first one)
+} STATSD_SHARD;
+
 // --------------------------------------------------------------------------------------------------------------------
 // global statsd data
 
@@ -236,6 +280,7 @@ struct collection_thread_status {
     SPINLOCK spinlock;
     bool initializing;
     uint32_t max_sockets;
+    STATSD_SHARD *shard;
 
     ND_THREAD *thread;
 };
@@ -278,9 +323,13 @@ static struct statsd {
     uint32_t dictionary_max_unique;
     double histogram_percentile;
     char *histogram_percentile_str;
+    NETDATA_DOUBLE histogram_sketch_relative_error;
+    uint32_t histogram_sketch_max_bins;
 
     int threads;
     struct collection_thread_status *collection_threads_status;
+    STATSD_SHARD *shards;           // one per thread, when sharding is enabled
+    SPINLOCK shared_spinlock;       // serializes the updates of the shared indexes, when sharding is enabled
 
     LISTEN_SOCKETS sockets;
 } statsd = {
@@ -352,6 +401,8 @@ static struct statsd {
         .apps = NULL,
         .histogram_percentile = 95.0,
         .histogram_increase_step = 10,
+        .histogram_sketch_relative_error = DDSKETCH_DEFAULT_RELATIVE_ERROR,
+        .histogram_sketch_max_bins = DDSKETCH_DEFAULT_MAX_BINS,
         .dictionary_max_unique = 200,
         .threads = 0,
         .collection_threads_status = NULL,
@@ -383,6 +434,9 @@ static void dictionary_metric_insert_callback(const DICTIONARY_ITEM *item, void
     if (m->type == STATSD_METRIC_TYPE_HISTOGRAM || m->type == STATSD_METRIC_TYPE_TIMER) {
         m->histogram.ext = callocz(1,sizeof(STATSD_METRIC_HISTOGRAM_EXTENSIONS));
         netdata_mutex_init(&m->histogram.ext->mutex);
+
+        if(m->options & STATSD_METRIC_OPTION_HISTOGRAM_SKETCH)
+            m->histogram.ext->sketch = ddsketch_create(statsd.histogram_sketch_relative_error, statsd.histogram_sketch_max_bins);
     }
 
     __atomic_fetch_add(&index->metrics, 1, __ATOMIC_RELAXED);
@@ -394,6 +448,8 @@ static void dictionary_metric_delete_callback(const DICTIONARY_ITEM *item, void
     STATSD_METRIC *m = (STATSD_METRIC *)value;
 
     if(m->type == STATSD_METRIC_TYPE_HISTOGRAM || m->type == STATSD_METRIC_TYPE_TIMER) {
+        ddsketch_destroy(m->histogram.ext->sketch);
+        freez(m->histogram.ext->values);
         freez(m->histogram.ext);
         m->histogram.ext = NULL;
     }
@@ -403,19 +459,20 @@ static void dictionary_metric_delete_callback(const DICTIONARY_ITEM *item, void
     freez(m->dimname);
 }
 
-static inline STATSD_METRIC *statsd_find_or_add_metric(STATSD_INDEX *index, const char *name) {
+// name_len is the length of name (without the terminating NUL), or -1 to compute it
+static inline STATSD_METRIC *statsd_find_or_add_metric(STATSD_INDEX *index, const char *name, ssize_t name_len) {
     netdata_log_debug(D_STATSD, "searching for metric '%s' under '%s'", name, index->name);
 
 #ifdef STATSD_MULTITHREADED
     // avoid the write lock of dictionary_set() for existing metrics
-    STATSD_METRIC *m = dictionary_get(index->dict, name);
-    if(!m) m = dictionary_set(index->dict, name, NULL, sizeof(STATSD_METRIC));
+    STATSD_METRIC *m = dictionary_get_advanced(index->dict, name, name_len);
+    if(!m) m = dictionary_set_advanced(index->dict, name, name_len, NULL, sizeof(STATSD_METRIC), NULL);
 #else
     // no locks here, go faster
     // this will call the dictionary_metric_insert_callback() if an item
     // is inserted, otherwise it will return the existing one.
     // We used the flag DICT_OPTION_DONT_OVERWRITE_VALUE to support this.
-    STATSD_METRIC *m = dictionary_set(index->dict, name, NULL, sizeof(STATSD_METRIC));
+    STATSD_METRIC *m = dictionary_set_advanced(index->dict, name, name_len, NULL, sizeof(STATSD_METRIC), NULL);
 #endif
 
     index->events++;
@@ -532,6 +589,51 @@ static inline void statsd_process_counter_or_meter(STATSD_METRIC *m, const char
 #define statsd_process_counter(m, value, sampling) statsd_process_counter_or_meter(m, value, sampling)
 #define statsd_process_meter(m, value, sampling) statsd_process_counter_or_meter(m, value, sampling)
 
+// the flush may switch the metric between the values array and the sketch,
+// so the writers hold the same lock the switch does
+static inline void statsd_histogram_reset(STATSD_METRIC *m) {
+    STATSD_METRIC_HISTOGRAM_EXTENSIONS *ext = m->histogram.ext;
+
+    netdata_mutex_lock(&ext->mutex);
+
+    ext->used = 0;
+    if(ext->sketch)
+        ddsketch_reset(ext->sketch);
+
+    netdata_mutex_unlock(&ext->mutex);
+}
+
+static inline void statsd_histogram_add(STATSD_METRIC *m, NETDATA_DOUBLE v, long long samples) {
+    STATSD_METRIC_HISTOGRAM_EXTENSIONS *ext = m->histogram.ext;
+
+    netdata_mutex_lock(&ext->mutex);
+
+    if(ext->sketch) {
+        // constant memory - the sampled value is counted 'samples' times
+        ddsketch_add(ext->sketch, v, samples > 0 ? (uint64_t)samples : 0);
+    }
+    else {
+        while(samples-- > 0) {
+            if(unlikely(ext->used == ext->size)) {
+                ext->size += statsd.histogram_increase_step;
+                ext->values = reallocz(ext->values, sizeof(NETDATA_DOUBLE) * ext->size);
+            }
+
+            ext->values[ext->used++] = v;
+        }
+    }
+
+    netdata_mutex_unlock(&ext->mutex);
+}
+
+static inline long long statsd_histogram_samples(const char *sampling) {
+    NETDATA_DOUBLE sampling_rate = statsd_parse_sampling_rate(sampling);
+    if(unlikely(isless(sampling_rate, 0.01))) sampling_rate = 0.01;
+    if(unlikely(isgreater(sampling_rate, 1.0))) sampling_rate = 1.0;
+
+    return llrintndd(1.0 / sampling_rate);
+}
+
 static inline void statsd_process_histogram_or_timer(STATSD_METRIC *m, const char *value, const char *sampling, const char *type) {
     if(!is_metric_useful_for_collection(m)) return;
 
@@ -541,7 +643,7 @@ static inline void statsd_process_histogram_or_timer(STATSD_METRIC *m, const cha
     }
 
     if(unlikely(m->reset)) {
-        m->histogram.ext->used = 0;
+        statsd_histogram_reset(m);
         statsd_reset_metric(m);
     }
 
@@ -549,24 +651,7 @@ static inline void statsd_process_histogram_or_timer(STATSD_METRIC *m, const cha
         // magic loading of metric, without affecting anything
     }
     else {
-        NETDATA_DOUBLE v = statsd_parse_float(value, 1.0);
-        NETDATA_DOUBLE sampling_rate = statsd_parse_sampling_rate(sampling);
-        if(unlikely(isless(sampling_rate, 0.01))) sampling_rate = 0.01;
-        if(unlikely(isgreater(sampling_rate, 1.0))) sampling_rate = 1.0;
-
-        long long samples = llrintndd(1.0 / sampling_rate);
-        while(samples-- > 0) {
-
-            if(unlikely(m->histogram.ext->used == m->histogram.ext->size)) {
-                netdata_mutex_lock(&m->histogram.ext->mutex);
-                m->histogram.ext->size += statsd.histogram_increase_step;
-                m->histogram.ext->values = reallocz(m->histogram.ext->values, sizeof(NETDATA_DOUBLE) * m->histogram.ext->size);
-                netdata_mutex_unlock(&m->histogram.ext->mutex);
-            }
-
-            m->histogram.ext->values[m->histogram.ext->used++] = v;
-        }
-
+        statsd_histogram_add(m, statsd_parse_float(value, 1.0), statsd_histogram_samples(sampling));
         metric_update_counters_and_obsoletion(m);
     }
 }
@@ -641,6 +726,209 @@ static inline void statsd_process_dictionary(STATSD_METRIC *m, const char *value
 }
 
 
+// --------------------------------------------------------------------------------------------------------------------
+// statsd shards - thread local aggregation, merged into the shared indexes at flush time
+
+static __thread STATSD_SHARD *statsd_thread_shard = NULL;
+
+static void dictionary_shard_metric_delete_callback(const DICTIONARY_ITEM *item __maybe_unused, void *value, void *data __maybe_unused) {
+    STATSD_SHARD_METRIC *sm = value;
+    freez(sm->samples);
+}
+
+static void statsd_shard_init(STATSD_SHARD *shard) {
+    spinlock_init(&shard->spinlock);
+    shard->active = 0;
+
+    for(size_t b = 0; b < 2 ;b++) {
+        for(size_t t = 0; t < STATSD_SHARD_TYPES ;t++) {
+            shard->dict[b][t] = dictionary_create_advanced(
+                DICT_OPTION_SINGLE_THREADED | DICT_OPTION_DONT_OVERWRITE_VALUE | DICT_OPTION_FIXED_SIZE,
+                &dictionary_stats_category_collectors, sizeof(STATSD_SHARD_METRIC));
+            dictionary_register_delete_callback(shard->dict[b][t], dictionary_shard_metric_delete_callback, NULL);
+        }
+    }
+}
+
+static void statsd_shard_cleanup(STATSD_SHARD *shard) {
+    for(size_t b = 0; b < 2 ;b++) {
+        for(size_t t = 0; t < STATSD_SHARD_TYPES ;t++) {
+            dictionary_destroy(shard->dict[b][t]);
+            shard->dict[b][t] = NULL;
+        }
+    }
+
+    listen_sockets_close(&shard->sockets);
+}
+
+// returns false when the metric has to be processed in the shared indexes
+static bool statsd_shard_process_metric(STATSD_SHARD *shard, const char *name, size_t name_len, const char *value, const char *type, const char *sampling) {
+    if(unlikely(value_is_zinit(value)))
+        return false;
+
+    STATSD_METRIC_TYPE mt;
+    char t0 = type[0], t1 = type[1];
+    if(t0 == 'g' && t1 == '\0')
+        mt = STATSD_METRIC_TYPE_GAUGE;
+    else if((t0 == 'c' || t0 == 'C') && t1 == '\0')
+        mt = STATSD_METRIC_TYPE_COUNTER;
+    else if(t0 == 'm' && t1 == '\0')
+        mt = STATSD_METRIC_TYPE_METER;
+    else if(t0 == 'h' && t1 == '\0')
+        mt = STATSD_METRIC_TYPE_HISTOGRAM;
+    else if(t0 == 'm' && t1 == 's' && type[2] == '\0')
+        mt = STATSD_METRIC_TYPE_TIMER;
+    else
+        return false;
+
+    // empty values are logged by the shared processors (we accept them for counters and meters)
+    if((!value || !*value) && mt != STATSD_METRIC_TYPE_COUNTER && mt != STATSD_METRIC_TYPE_METER)
+        return false;
+
+    STATSD_SHARD_METRIC *sm = dictionary_set_advanced(shard->dict[shard->active][mt], name, (ssize_t)name_len, NULL, sizeof(STATSD_SHARD_METRIC), NULL);
+
+    switch(mt) {
+        case STATSD_METRIC_TYPE_GAUGE:
+            if(unlikely(*value == '+' || *value == '-'))
+                sm->value += statsd_parse_float(value, 1.0) / statsd_parse_sampling_rate(sampling);
+            else {
+                sm->value = statsd_parse_float(value, 1.0);
+                sm->absolute = true;
+            }
+            break;
+
+        case STATSD_METRIC_TYPE_COUNTER:
+        case STATSD_METRIC_TYPE_METER:
+            sm->sum += llrintndd((NETDATA_DOUBLE) statsd_parse_int(value, 1) / statsd_parse_sampling_rate(sampling));
+            break;
+
+        default: {
+            long long samples = statsd_histogram_samples(sampling);
+            if(samples <= 0)
+                break;
+
+            if(unlikely(sm->used == sm->size)) {
+                sm->size += statsd.histogram_increase_step;
+                sm->samples = reallocz(sm->samples, sizeof(STATSD_SHARD_SAMPLE) * sm->size);
+            }
+
+            sm->samples[sm->used++] = (STATSD_SHARD_SAMPLE){
+                .value = statsd_parse_float(value, 1.0),
+                .samples = (uint32_t)samples,
+            };
+            break;
+        }
+    }
+
+    sm->count++;
+    return true;
+}
+
+static inline void statsd_shard_merge_metric(STATSD_INDEX *index, const char *name, STATSD_SHARD_METRIC *sm) {
+    STATSD_METRIC *m = statsd_find_or_add_metric(index, name, -1);
+    index->events += sm->count - 1;
+
+    if(is_metric_useful_for_collection(m)) {
+        if(unlikely(m->reset)) {
+            if(m->type == STATSD_METRIC_TYPE_HISTOGRAM || m->type == STATSD_METRIC_TYPE_TIMER)
+                statsd_histogram_reset(m);
+
+            statsd_reset_metric(m);
+        }
+
+        switch(m->type) {
+            case STATSD_METRIC_TYPE_GAUGE:
+                if(sm->absolute)
+                    m->gauge.value = sm->value;
+                else
+                    m->gauge.value += sm->value;
+                break;
+
+            case STATSD_METRIC_TYPE_COUNTER:
+            case STATSD_METRIC_TYPE_METER:
+                m->counter.value += sm->sum;
+                break;
+
+            default:
+                for(uint32_t i = 0; i < sm->used ;i++)
+                    statsd_histogram_add(m, sm->samples[i].value, sm->samples[i].samples);
+                break;
+        }
+
+        m->events += sm->count;
+        m->count += sm->count;
+        m->last_collected = now_realtime_sec();
+        m->options &= ~STATSD_METRIC_OPTION_OBSOLETE;
+    }
+
+    sm->count = 0;
+    sm->absolute = false;
+    sm->value = 0;
+    sm->sum = 0;
+    sm->used = 0;
+}
+
+static STATSD_INDEX *statsd_shard_type_index(STATSD_METRIC_TYPE type) {
+    switch(type) {
+        case STATSD_METRIC_TYPE_GAUGE:      return &statsd.gauges;
+        case STATSD_METRIC_TYPE_COUNTER:    return &statsd.counters;
+        case STATSD_METRIC_TYPE_METER:      return &statsd.meters;
+        case STATSD_METRIC_TYPE_TIMER:      return &statsd.timers;
+        default:                            return &statsd.histograms;
+    }
+}
+
+#define STATSD_SHARD_MERGE_BATCH 64      // the metrics merged per acquisition of the shared lock
+
+// called by the flushing thread, before flushing the shared indexes
+static void statsd_shards_merge(void) {
+    if(!statsd.shards)
+        return;
+
+    for(int i = 0; i < statsd.threads ;i++) {
+        STATSD_SHARD *shard = &statsd.shards[i];
+
+        // switch the receiving thread to the other buffer,
+        // so that it is not blocked while we merge this one
+        spinlock_lock(&shard->spinlock);
+        uint32_t merge = shard->active;
+        shard->active = !merge;
+        spinlock_unlock(&shard->spinlock);
+
+        // the shared lock is taken per batch of metrics,
+        // so that the receiving threads updating the shared indexes do not wait for the whole shard
+        size_t merged = 0;
+        bool locked = false;
+        for(size_t t = 0; t < STATSD_SHARD_TYPES ;t++) {
+            STATSD_INDEX *index = statsd_shard_type_index((STATSD_METRIC_TYPE)t);
+
+            STATSD_SHARD_METRIC *sm;
+            dfe_start_write(shard->dict[merge][t], sm) {
+                if(sm->count) {
+                    if(!locked) {
+                        spinlock_lock(&statsd.shared_spinlock);
+                        locked = true;
+                    }
+
+                    statsd_shard_merge_metric(index, sm_dfe.name, sm);
+
+                    if(++merged % STATSD_SHARD_MERGE_BATCH == 0) {
+                        spinlock_unlock(&statsd.shared_spinlock);
+                        locked = false;
+                    }
+                }
+                else
+                    // not received during the last interval, let it go
+                    dictionary_del(shard->dict[merge][t], sm_dfe.name);
+            }
+            dfe_done(sm);
+        }
+
+        if(locked)
+            spinlock_unlock(&statsd.shared_spinlock);
+    }
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // statsd parsing
 
@@ -677,50 +965,45 @@ static inline const char *statsd_parse_field_trim(const char *start, char *end)
     return start;
 }
 
-static void statsd_process_metric(const char *name, const char *value, const char *type, const char *sampling, const char *tags) {
-    netdata_log_debug(D_STATSD, "STATSD: raw metric '%s', value '%s', type '%s', sampling '%s', tags '%s'", name?name:"(null)", value?value:"(null)", type?type:"(null)", sampling?sampling:"(null)", tags?tags:"(null)");
-
-    if(unlikely(!name || !*name)) return;
-    if(unlikely(!type || !*type)) type = "m";
-
+static void statsd_process_metric_shared(const char *name, size_t name_len, const char *value, const char *type, const char *sampling, const char *tags) {
     STATSD_METRIC *m = NULL;
 
     char t0 = type[0], t1 = type[1];
     if(unlikely(t0 == 'g' && t1 == '\0')) {
         statsd_process_gauge(
-            m = statsd_find_or_add_metric(&statsd.gauges, name),
+            m = statsd_find_or_add_metric(&statsd.gauges, name, name_len),
             value, sampling);
     }
     else if(unlikely((t0 == 'c' || t0 == 'C') && t1 == '\0')) {
         // etsy/statsd uses 'c'
         // brubeck     uses 'C'
         statsd_process_counter(
-            m = statsd_find_or_add_metric(&statsd.counters, name),
+            m = statsd_find_or_add_metric(&statsd.counters, name, name_len),
             value, sampling);
     }
     else if(unlikely(t0 == 'm' && t1 == '\0')) {
         statsd_process_meter(
-            m = statsd_find_or_add_metric(&statsd.meters, name),
+            m = statsd_find_or_add_metric(&statsd.meters, name, name_len),
             value, sampling);
     }
     else if(unlikely(t0 == 'h' && t1 == '\0')) {
         statsd_process_histogram(
-            m = statsd_find_or_add_metric(&statsd.histograms, name),
+            m = statsd_find_or_add_metric(&statsd.histograms, name, name_len),
             value, sampling);
     }
     else if(unlikely(t0 == 's' && t1 == '\0')) {
         statsd_process_set(
-            m = statsd_find_or_add_metric(&statsd.sets, name),
+            m = statsd_find_or_add_metric(&statsd.sets, name, name_len),
             value);
     }
     else if(unlikely(t0 == 'd' && t1 == '\0')) {
         statsd_process_dictionary(
-            m = statsd_find_or_add_metric(&statsd.dictionaries, name),
+            m = statsd_find_or_add_metric(&statsd.dictionaries, name, name_len),
             value);
     }
     else if(unlikely(t0 == 'm' && t1 == 's' && type[2] == '\0')) {
         statsd_process_timer(
-            m = statsd_find_or_add_metric(&statsd.timers, name),
+            m = statsd_find_or_add_metric(&statsd.timers, name, name_len),
             value, sampling);
     }
     else {
@@ -771,9 +1054,33 @@ static void statsd_process_metric(const char *name, const char *value, const cha
     }
 }
 
-static inline size_t statsd_process(char *buffer, size_t size, int require_newlines) {
+static void statsd_process_metric(const char *name, size_t name_len, const char *value, const char *type, const char *sampling, const char *tags) {
+    netdata_log_debug(D_STATSD, "STATSD: raw metric '%s', value '%s', type '%s', sampling '%s', tags '%s'", name?name:"(null)", value?value:"(null)", type?type:"(null)", sampling?sampling:"(null)", tags?tags:"(null)");
+
+    if(unlikely(!name || !*name)) return;
+    if(unlikely(!type || !*type)) type = "m";
+
+    STATSD_SHARD *shard = statsd_thread_shard;
+    if(likely(!shard)) {
+        statsd_process_metric_shared(name, name_len, value, type, sampling, tags);
+        return;
+    }
+
+    // tags update the metadata of the shared metric, so these go to the shared index
+    if((!tags || !*tags) && statsd_shard_process_metric(shard, name, name_len, value, type, sampling))
+        return;
+
+    spinlock_lock(&statsd.shared_spinlock);
+    statsd_process_metric_shared(name, name_len, value, type, sampling, tags);
+    spinlock_unlock(&statsd.shared_spinlock);
+}
+
+typedef void (*STATSD_METRIC_CB)(const char *name, size_t name_len, const char *value, const char *type, const char *sampling, const char *tags);
+
+// the byte-by-byte parser - statsd_process_buffer() below must produce the same metrics,
+// it is kept as the reference for statsd_parser_unittest()
+static inline size_t statsd_process_buffer_reference(char *buffer, size_t size, int require_newlines, STATSD_METRIC_CB cb) {
     buffer[size] = '\0';
-    netdata_log_debug(D_STATSD, "RECEIVED: %zu bytes: '%s'", size, buffer);
 
     const char *s = buffer;
     while(*s) {
@@ -824,8 +1131,9 @@ static inline size_t statsd_process(char *buffer, size_t size, int require_newli
         else
             s = statsd_parse_skip_spaces(s);
 
-        statsd_process_metric(
-                  statsd_parse_field_trim(name, name_end)
+        name = statsd_parse_field_trim(name, name_end);
+        cb(
+                  name, strlen(name)
                 , statsd_parse_field_trim(value, value_end)
                 , statsd_parse_field_trim(type, type_end)
                 , statsd_parse_field_trim(sampling, sampling_end)
@@ -837,6 +1145,222 @@ static inline size_t statsd_process(char *buffer, size_t size, int require_newli
 }
 
 
+// --------------------------------------------------------------------------------------------------------------------
+// statsd structural scanner - finds the delimiters of 64 bytes at once, and the parser
+// walks the bitmap, instead of checking every byte against every delimiter
+
+#define STATSD_CHAR_NAME_END    0x01    // ':' '=' '|'
+#define STATSD_CHAR_FIELD_END   0x02    // '|' '@' '#'
+#define STATSD_CHAR_LINE_END    0x04    // '\r' '\n' '\0'
+#define STATSD_CHAR_NEWLINE     0x08    // '\n' '\0'
+
+static const uint8_t statsd_char_class[256] = {
+    ['\0'] = STATSD_CHAR_LINE_END | STATSD_CHAR_NEWLINE,
+    ['\n'] = STATSD_CHAR_LINE_END | STATSD_CHAR_NEWLINE,
+    ['\r'] = STATSD_CHAR_LINE_END,
+    [':']  = STATSD_CHAR_NAME_END,
+    ['=']  = STATSD_CHAR_NAME_END,
+    ['|']  = STATSD_CHAR_NAME_END | STATSD_CHAR_FIELD_END,
+    ['@']  = STATSD_CHAR_FIELD_END,
+    ['#']  = STATSD_CHAR_FIELD_END,
+};
+
+typedef struct statsd_scanner {
+    const char *block;          // the first byte of the scanned block
+    const char *end;            // the end of the data
+    uint64_t mask;              // bit N is set when block[N] is a structural character
+} STATSD_SCANNER;
+
+static inline uint64_t statsd_structural_mask(const char *p, size_t len) {
+    uint64_t mask = 0;
+
+#if defined(__SSE2__)
+    if(likely(len == 64)) {
+        const __m128i colon = _mm_set1_epi8(':'), equal = _mm_set1_epi8('='), pipe = _mm_set1_epi8('|');
+        const __m128i at = _mm_set1_epi8('@'), hash = _mm_set1_epi8('#'), zero = _mm_setzero_si128();
+        const __m128i cr = _mm_set1_epi8('\r'), nl = _mm_set1_epi8('\n');
+
+        for(size_t i = 0; i < 4 ;i++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + i * 16));
+            __m128i m = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, equal)),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, pipe), _mm_cmpeq_epi8(v, at))),
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, hash), _mm_cmpeq_epi8(v, zero)),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, nl))));
+
+            mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(m) << (i * 16);
+        }
+
+        return mask;
+    }
+#elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    if(likely(len == 64)) {
+        // SWAR - 8 bytes at a time, finding the zero bytes of (word ^ delimiter)
+        static const uint64_t delimiters[] = {
+            0x3a3a3a3a3a3a3a3aULL, // ':'
+            0x3d3d3d3d3d3d3d3dULL, // '='
+            0x7c7c7c7c7c7c7c7cULL, // '|'
+            0x4040404040404040ULL, // '@'
+            0x2323232323232323ULL, // '#'
+            0x0d0d0d0d0d0d0d0dULL, // '\r'
+            0x0a0a0a0a0a0a0a0aULL, // '\n'
+            0x0000000000000000ULL, // '\0'
+        };
+        const uint64_t low7 = 0x7f7f7f7f7f7f7f7fULL;
+
+        for(size_t i = 0; i < 8 ;i++) {
+            uint64_t w;
+            memcpy(&w, p + i * 8, sizeof(w));
+
+            uint64_t found = 0;
+            for(size_t d = 0; d < sizeof(delimiters) / sizeof(delimiters[0]) ;d++) {
+                uint64_t t = w ^ delimiters[d];
+                found |= ~(((t & low7) + low7) | t | low7);  // 0x80 on the bytes that are zero
+            }
+
+            // gather the high bit of each byte into 8 bits
+            mask |= (((found >> 7) * 0x0102040810204080ULL) >> 56) << (i * 8);
+        }
+
+        return mask;
+    }
+#endif
+
+    for(size_t i = 0; i < len ;i++)
+        mask |= (uint64_t)(statsd_char_class[(uint8_t)p[i]] != 0) << i;
+
+    return mask;
+}
+
+static inline void statsd_scanner_load(STATSD_SCANNER *sc, const char *s) {
+    size_t len = (size_t)(sc->end - s);
+    sc->block = s;
+    sc->mask = statsd_structural_mask(s, len < 64 ? len : 64);
+}
+
+// returns the first character at or after 's' that belongs to any of 'classes', or the end of the data
+static inline char *statsd_scanner_find(STATSD_SCANNER *sc, const char *s, uint8_t classes) {
+    classes |= STATSD_CHAR_LINE_END;
+
+    while(s < sc->end) {
+        if(unlikely(s < sc->block || s >= sc->block + 64))
+            statsd_scanner_load(sc, s);
+
+        uint64_t m = sc->mask >> (s - sc->block);
+        while(m) {
+            const char *c = s + __builtin_ctzll(m);
+            if(statsd_char_class[(uint8_t)*c] & classes)
+                return (char *)c;
+            m &= m - 1;
+        }
+
+        s = sc->block + 64;
+    }
+
+    return (char *)sc->end;
+}
+
+// trims the spaces around [start, end) and terminates it, returning the length in *len
+static inline const char *statsd_parse_field_trim_len(const char *start, char *end, size_t *len) {
+    while(start < end && (*start == ' ' || *start == '\t'))
+        start++;
+
+    *end = '\0';
+    while(end > start && (end[-1] == ' ' || end[-1] == '\t'))
+        *--end = '\0';
+
+    *len = (size_t)(end - start);
+    return start;
+}
+
+static inline size_t statsd_process_buffer(char *buffer, size_t size, int require_newlines, STATSD_METRIC_CB cb) {
+    buffer[size] = '\0';
+    netdata_log_debug(D_STATSD, "RECEIVED: %zu bytes: '%s'", size, buffer);
+
+    STATSD_SCANNER sc = { .end = buffer + size, };
+    statsd_scanner_load(&sc, buffer);
+
+    const char *s = buffer;
+    while(*s) {
+        const char *name = NULL, *value = NULL, *type = NULL, *sampling = NULL, *tags = NULL;
+        char *name_end = NULL, *value_end = NULL, *type_end = NULL, *sampling_end = NULL, *tags_end = NULL;
+
+        s = name_end = statsd_scanner_find(&sc, name = s, STATSD_CHAR_NAME_END);
+        if(name == name_end) {
+            if (*s) {
+                s++;
+                s = statsd_parse_skip_spaces(s);
+            }
+            continue;
+        }
+
+        if(likely(*s == ':' || *s == '='))
+            s = value_end = statsd_scanner_find(&sc, value = ++s, STATSD_CHAR_FIELD_END);
+
+        if(likely(*s == '|'))
+            s = type_end = statsd_scanner_find(&sc, type = ++s, STATSD_CHAR_FIELD_END);
+
+        while(*s == '|' || *s == '@' || *s == '#') {
+            // parse all the fields that may be appended
+
+            if ((*s == '|' && s[1] == '@') || *s == '@') {
+                s = sampling_end = statsd_scanner_find(&sc, sampling = ++s, STATSD_CHAR_FIELD_END);
+                if (*sampling == '@') sampling++;
+            }
+            else if ((*s == '|' && s[1] == '#') || *s == '#') {
+                s = tags_end = statsd_scanner_find(&sc, tags = ++s, STATSD_CHAR_FIELD_END);
+                if (*tags == '#') tags++;
+            }
+            else {
+                // unknown field, skip it
+                s = statsd_scanner_find(&sc, ++s, STATSD_CHAR_FIELD_END);
+            }
+        }
+
+        // skip everything until the end of the line
+        if(*s != '\n')
+            s = statsd_scanner_find(&sc, s, STATSD_CHAR_NEWLINE);
+        while(*s == '\r')
+            // a '\r' in the middle of a line (the scanner stops at all line ends)
+            s = statsd_scanner_find(&sc, s + 1, STATSD_CHAR_NEWLINE);
+
+        if(unlikely(require_newlines && *s != '\n' && s > buffer)) {
+            // move the remaining data to the beginning
+            size -= (name - buffer);
+            memmove(buffer, name, size);
+            return size;
+        }
+        else
+            s = statsd_parse_skip_spaces(s);
+
+        size_t name_len;
+        name = statsd_parse_field_trim_len(name, name_end, &name_len);
+
+        cb(
+                  name, name_len
+                , statsd_parse_field_trim(value, value_end)
+                , statsd_parse_field_trim(type, type_end)
+                , statsd_parse_field_trim(sampling, sampling_end)
+                , statsd_parse_field_trim(tags, tags_end)
+        );
+    }
+
+    return 0;
+}
+
+static inline size_t statsd_process(char *buffer, size_t size, int require_newlines) {
+    STATSD_SHARD *shard = statsd_thread_shard;
+    if(likely(!shard))
+        return statsd_process_buffer(buffer, size, require_newlines, statsd_process_metric);
+
+    spinlock_lock(&shard->spinlock);
+    size_t ret = statsd_process_buffer(buffer, size, require_newlines, statsd_process_metric);
+    spinlock_unlock(&shard->spinlock);
+    return ret;
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // statsd pollfd interface
 
@@ -1012,16 +1536,17 @@ static int statsd_rcv_callback(POLLINFO *pi, nd_poll_event_t *events) {
                     }
                 } else if (rc) {
                     // data received
-                    statsd.udp_socket_reads++;
-                    statsd.udp_packets_received += rc;
+                    // multiple threads may receive UDP packets
+                    __atomic_add_fetch(&statsd.udp_socket_reads, 1, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&statsd.udp_packets_received, (size_t)rc, __ATOMIC_RELAXED);
 
                     size_t i, total_size = 0;
                     for (i = 0; i < (size_t)rc; ++i) {
                         size_t len = (size_t)d->msgs[i].msg_len;
-                        statsd.udp_bytes_read += len;
                         total_size += len;
                         statsd_process(d->msgs[i].msg_hdr.msg_iov->iov_base, len, 0);
                     }
+                    __atomic_add_fetch(&statsd.udp_bytes_read, total_size, __ATOMIC_RELAXED);
 
                     pulse_statsd_received_bytes(total_size);
                 }
@@ -1041,9 +1566,9 @@ static int statsd_rcv_callback(POLLINFO *pi, nd_poll_event_t *events) {
                     }
                 } else if (rc) {
                     // data received
-                    statsd.udp_socket_reads++;
-                    statsd.udp_packets_received++;
-                    statsd.udp_bytes_read += rc;
+                    __atomic_add_fetch(&statsd.udp_socket_reads, 1, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&statsd.udp_packets_received, 1, __ATOMIC_RELAXED);
+                    __atomic_add_fetch(&statsd.udp_bytes_read, (size_t)rc, __ATOMIC_RELAXED);
                     statsd_process(d->buffer, (size_t) rc, 0);
 
                     pulse_statsd_received_bytes(rc);
@@ -1114,6 +1639,10 @@ void statsd_collector_thread(void *ptr) {
 
     collector_info("STATSD collector thread started with taskid %d", gettid_cached());
 
+    // the first shard receives from the shared sockets, the rest from their own clones
+    statsd_thread_shard = status->shard;
+    LISTEN_SOCKETS *sockets = (status->shard && status->shard->sockets.opened) ? &status->shard->sockets : &statsd.sockets;
+
     struct statsd_udp *d = callocz(sizeof(struct statsd_udp), 1);
     d->status = status;
 
@@ -1134,7 +1663,7 @@ void statsd_collector_thread(void *ptr) {
     }
 #endif
 
-    poll_events(&statsd.sockets
+    poll_events(sockets
             , statsd_add_callback
             , statsd_del_callback
             , statsd_rcv_callback
@@ -1408,6 +1937,14 @@ static int statsd_readfile(const char *filename, STATSD_APP *app, STATSD_APP_CHA
                 if (!strcmp(value, "yes") || !strcmp(value, "on"))
                     app->default_options |= STATSD_METRIC_OPTION_SHOW_GAPS_WHEN_NOT_COLLECTED;
             }
+            else if (!strcmp(name, "histograms algorithm")) {
+                if (!strcmp(value, "ddsketch"))
+                    app->histograms_algorithm = STATSD_HISTOGRAM_ALGORITHM_DDSKETCH;
+                else if (!strcmp(value, "exact"))
+                    app->histograms_algorithm = STATSD_HISTOGRAM_ALGORITHM_EXACT;
+                else
+                    collector_error("STATSD: ignoring unknown histograms algorithm '%s' at line %zu of file '%s'.", value, line, filename);
+            }
             else if (!strcmp(name, "memory mode")) {
                 // this is not supported anymore
                 // with the implementation of storage engines, all charts have the same storage engine always
@@ -1965,24 +2502,70 @@ static inline void statsd_flush_dictionary(STATSD_METRIC *m) {
     metric_check_obsoletion(m);
 }
 
+// switch the metric between the exact values array and the sketch, when an app changed its algorithm
+static inline void statsd_histogram_check_algorithm(STATSD_METRIC *m) {
+    STATSD_METRIC_HISTOGRAM_EXTENSIONS *ext = m->histogram.ext;
+    bool want_sketch = (m->options & STATSD_METRIC_OPTION_HISTOGRAM_SKETCH) ? true : false;
+
+    if(likely(want_sketch == (ext->sketch != NULL)))
+        return;
+
+    netdata_mutex_lock(&ext->mutex);
+
+    if(want_sketch) {
+        ext->sketch = ddsketch_create(statsd.histogram_sketch_relative_error, statsd.histogram_sketch_max_bins);
+
+        for(uint32_t i = 0; i < ext->used; i++)
+            ddsketch_add(ext->sketch, ext->values[i], 1);
+
+        freez(ext->values);
+        ext->values = NULL;
+        ext->size = ext->used = 0;
+    }
+    else {
+        // the values in the sketch cannot be restored - this interval is lost
+        ddsketch_destroy(ext->sketch);
+        ext->sketch = NULL;
+        ext->used = 0;
+    }
+
+    netdata_mutex_unlock(&ext->mutex);
+}
+
 static inline void statsd_flush_timer_or_histogram(STATSD_METRIC *m, const char *dim, const char *family, const char *units) {
     netdata_log_debug(D_STATSD, "flushing %s metric '%s'", dim, m->name);
 
+    statsd_histogram_check_algorithm(m);
+
+    DDSKETCH *sketch = m->histogram.ext->sketch;
+    bool has_values = sketch ? sketch->count > 0 : m->histogram.ext->used > 0;
+
     int updated = 0;
-    if(unlikely(!m->reset && m->count && m->histogram.ext->used > 0)) {
+    if(unlikely(!m->reset && m->count && has_values)) {
         netdata_mutex_lock(&m->histogram.ext->mutex);
 
-        size_t len = m->histogram.ext->used;
-        NETDATA_DOUBLE *series = m->histogram.ext->values;
-        sort_series(series, len);
-
-        m->histogram.ext->last_min = (collected_number)roundndd(series[0] * statsd.decimal_detail);
-        m->histogram.ext->last_max = (collected_number)roundndd(series[len - 1] * statsd.decimal_detail);
-        m->last = (collected_number)roundndd(average(series, len) * statsd.decimal_detail);
-        m->histogram.ext->last_stddev = (collected_number)roundndd(standard_deviation(series, len) * statsd.decimal_detail);
-        m->histogram.ext->last_sum = (collected_number)roundndd(sum(series, len) * statsd.decimal_detail);
-        m->histogram.ext->last_median = (collected_number)roundndd(median_on_sorted_series(series, len) * statsd.decimal_detail);
-        m->histogram.ext->last_percentile = (collected_number)roundndd(percentile_on_sorted_series(series, len,  statsd.histogram_percentile / 100) * statsd.decimal_detail);
+        if(sketch) {
+            m->histogram.ext->last_min = (collected_number)roundndd(sketch->min * statsd.decimal_detail);
+            m->histogram.ext->last_max = (collected_number)roundndd(sketch->max * statsd.decimal_detail);
+            m->last = (collected_number)roundndd(ddsketch_average(sketch) * statsd.decimal_detail);
+            m->histogram.ext->last_stddev = (collected_number)roundndd(ddsketch_stddev(sketch) * statsd.decimal_detail);
+            m->histogram.ext->last_sum = (collected_number)roundndd(sketch->sum * statsd.decimal_detail);
+            m->histogram.ext->last_median = (collected_number)roundndd(ddsketch_quantile(sketch, 0.5) * statsd.decimal_detail);
+            m->histogram.ext->last_percentile = (collected_number)roundndd(ddsketch_quantile(sketch, statsd.histogram_percentile / 100) * statsd.decimal_detail);
+        }
+        else {
+            size_t len = m->histogram.ext->used;
+            NETDATA_DOUBLE *series = m->histogram.ext->values;
+            sort_series(series, len);
+
+            m->histogram.ext->last_min = (collected_number)roundndd(series[0] * statsd.decimal_detail);
+            m->histogram.ext->last_max = (collected_number)roundndd(series[len - 1] * statsd.decimal_detail);
+            m->last = (collected_number)roundndd(average(series, len) * statsd.decimal_detail);
+            m->histogram.ext->last_stddev = (collected_number)roundndd(standard_deviation(series, len) * statsd.decimal_detail);
+            m->histogram.ext->last_sum = (collected_number)roundndd(sum(series, len) * statsd.decimal_detail);
+            m->histogram.ext->last_median = (collected_number)roundndd(median_on_sorted_series(series, len) * statsd.decimal_detail);
+            m->histogram.ext->last_percentile = (collected_number)roundndd(percentile_on_sorted_series(series, len,  statsd.histogram_percentile / 100) * statsd.decimal_detail);
+        }
 
         netdata_mutex_unlock(&m->histogram.ext->mutex);
 
@@ -2125,6 +2708,12 @@ static inline void check_if_metric_is_for_app(STATSD_INDEX *index, STATSD_METRIC
             else
                 m->options &= ~STATSD_METRIC_OPTION_SHOW_GAPS_WHEN_NOT_COLLECTED;
 
+            // the flush switches the metric to the app's algorithm
+            if(app->histograms_algorithm == STATSD_HISTOGRAM_ALGORITHM_DDSKETCH)
+                m->options |= STATSD_METRIC_OPTION_HISTOGRAM_SKETCH;
+            else if(app->histograms_algorithm == STATSD_HISTOGRAM_ALGORITHM_EXACT)
+                m->options &= ~STATSD_METRIC_OPTION_HISTOGRAM_SKETCH;
+
             m->options |= STATSD_METRIC_OPTION_PRIVATE_CHART_CHECKED;
 
             // check if there is a chart in this app, willing to get this metric
@@ -2413,6 +3002,13 @@ static void statsd_main_cleanup(void *pptr) {
     collector_info("STATSD: closing sockets...");
     listen_sockets_close(&statsd.sockets);
 
+    if(statsd.shards) {
+        for(int i = 0; i < statsd.threads ;i++)
+            statsd_shard_cleanup(&statsd.shards[i]);
+        freez(statsd.shards);
+        statsd.shards = NULL;
+    }
+
     // destroy the dictionaries
     dictionary_destroy(statsd.gauges.dict);
     dictionary_destroy(statsd.meters.dict);
@@ -2446,9 +3042,10 @@ static void statsd_main_cleanup(void *pptr) {
 #define WORKER_STATSD_FLUSH_SETS 5
 #define WORKER_STATSD_FLUSH_DICTIONARIES 6
 #define WORKER_STATSD_FLUSH_STATS 7
+#define WORKER_STATSD_MERGE_SHARDS 8
 
-#if WORKER_UTILIZATION_MAX_JOB_TYPES < 8
-#error WORKER_UTILIZATION_MAX_JOB_TYPES has to be at least 8
+#if WORKER_UTILIZATION_MAX_JOB_TYPES < 9
+#error WORKER_UTILIZATION_MAX_JOB_TYPES has to be at least 9
 #endif
 
 void *statsd_main(void *ptr) {
@@ -2463,6 +3060,7 @@ void *statsd_main(void *ptr) {
     worker_register_job_name(WORKER_STATSD_FLUSH_SETS, "sets");
     worker_register_job_name(WORKER_STATSD_FLUSH_DICTIONARIES, "dictionaries");
     worker_register_job_name(WORKER_STATSD_FLUSH_STATS, "statistics");
+    worker_register_job_name(WORKER_STATSD_MERGE_SHARDS, "merge shards");
 
     statsd.gauges.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
     statsd.meters.dict = dictionary_create_advanced(STATSD_DICTIONARY_OPTIONS | DICT_OPTION_FIXED_SIZE, &dictionary_stats_category_collectors, sizeof(STATSD_METRIC));
@@ -2539,6 +3137,29 @@ void *statsd_main(void *ptr) {
         statsd.histogram_percentile_str = strdupz(buffer);
     }
 
+    {
+        const char *algorithm = inicfg_get(&netdata_config, CONFIG_SECTION_STATSD, "histograms and timers algorithm", "exact");
+        if(!strcmp(algorithm, "ddsketch")) {
+            statsd.histograms.default_options |= STATSD_METRIC_OPTION_HISTOGRAM_SKETCH;
+            statsd.timers.default_options |= STATSD_METRIC_OPTION_HISTOGRAM_SKETCH;
+        }
+        else if(strcmp(algorithm, "exact") != 0)
+            collector_error("STATSD: unknown histograms and timers algorithm '%s', using 'exact'", algorithm);
+    }
+
+    statsd.histogram_sketch_relative_error =
+        inicfg_get_double(&netdata_config,
+        CONFIG_SECTION_STATSD, "histograms and timers sketch relative error percent", statsd.histogram_sketch_relative_error * 100.0) / 100.0;
+
+    if(!(statsd.histogram_sketch_relative_error > 0.0 && statsd.histogram_sketch_relative_error < 0.5)) {
+        collector_error("STATSD: invalid histograms and timers sketch relative error %0.5f%% given", (double)(statsd.histogram_sketch_relative_error * 100.0));
+        statsd.histogram_sketch_relative_error = DDSKETCH_DEFAULT_RELATIVE_ERROR;
+    }
+
+    statsd.histogram_sketch_max_bins =
+        (uint32_t)inicfg_get_number_range(&netdata_config,
+        CONFIG_SECTION_STATSD, "histograms and timers sketch max bins", statsd.histogram_sketch_max_bins, 64, 65536);
+
     statsd.dictionary_max_unique =
         inicfg_get_number(&netdata_config, CONFIG_SECTION_STATSD, "dictionaries max unique dimensions", statsd.dictionary_max_unique);
 
@@ -2583,7 +3204,11 @@ void *statsd_main(void *ptr) {
         inicfg_set_number(&netdata_config, CONFIG_SECTION_STATSD, "collector threads", statsd.threads);
     }
 #else
-    statsd.threads = 1;
+    statsd.threads = (int)inicfg_get_number_range(&netdata_config, CONFIG_SECTION_STATSD, "udp receiving threads", 1, 1, 256);
+
+    // each thread gets its own UDP sockets on the same ports, and the kernel distributes the packets among them
+    if(statsd.threads > 1)
+        statsd.sockets.udp_reuse_port = true;
 #endif
 
     // read custom application definitions
@@ -2600,11 +3225,30 @@ void *statsd_main(void *ptr) {
         goto cleanup;
     }
 
+    int i;
+    if(statsd.sockets.udp_reuse_port) {
+        spinlock_init(&statsd.shared_spinlock);
+        statsd.shards = callocz((size_t)statsd.threads, sizeof(STATSD_SHARD));
+
+        for(i = 0; i < statsd.threads ;i++) {
+            statsd_shard_init(&statsd.shards[i]);
+
+            if(i && !listen_sockets_clone_udp_reuseport(&statsd.shards[i].sockets, &statsd.sockets)) {
+                collector_error("STATSD: cannot open more UDP sockets with reuse port, using %d receiving threads", i);
+                statsd_shard_cleanup(&statsd.shards[i]);
+                statsd.threads = i;
+                break;
+            }
+        }
+
+    }
+
     statsd.collection_threads_status = callocz((size_t)statsd.threads, sizeof(struct collection_thread_status));
 
-    int i;
     for(i = 0; i < statsd.threads ;i++) {
-        statsd.collection_threads_status[i].max_sockets = max_sockets / statsd.threads;
+        // with shards, only the first thread accepts TCP connections
+        statsd.collection_threads_status[i].max_sockets = statsd.shards ? max_sockets : max_sockets / statsd.threads;
+        statsd.collection_threads_status[i].shard = statsd.shards ? &statsd.shards[i] : NULL;
         char tag[NETDATA_THREAD_TAG_MAX + 1];
         snprintfz(tag, NETDATA_THREAD_TAG_MAX, "STATSD_IN[%d]", i + 1);
         spinlock_init(&statsd.collection_threads_status[i].spinlock);
@@ -2829,6 +3473,9 @@ void *statsd_main(void *ptr) {
         worker_is_idle();
         heartbeat_next(&hb);
 
+        worker_is_busy(WORKER_STATSD_MERGE_SHARDS);
+        statsd_shards_merge();
+
         worker_is_busy(WORKER_STATSD_FLUSH_GAUGES);
         statsd_flush_index_metrics(&statsd.gauges,     statsd_flush_gauge);
 
@@ -2913,3 +3560,158 @@ void *statsd_main(void *ptr) {
 cleanup: ; // added semi-colon to prevent older gcc error: label at end of compound statement
     return NULL;
 }
+
+
+// --------------------------------------------------------------------------------------------------------------------
+// statsd parser unittest - the vectorized parser has to match the reference one
+
+static BUFFER *statsd_parser_unittest_wb = NULL;
+static size_t statsd_parser_unittest_metrics = 0;
+
+static void statsd_parser_unittest_record(const char *name, size_t name_len, const char *value, const char *type, const char *sampling, const char *tags) {
+    buffer_sprintf(statsd_parser_unittest_wb, "[%s](%zu%s) [%s] [%s] [%s] [%s]\n",
+                   name, name_len, name_len == strlen(name) ? "" : " WRONG LENGTH",
+                   value ? value : "(null)", type ? type : "(null)",
+                   sampling ? sampling : "(null)", tags ? tags : "(null)");
+}
+
+static void statsd_parser_unittest_count(const char *name __maybe_unused, size_t name_len, const char *value __maybe_unused, const char *type __maybe_unused, const char *sampling __maybe_unused, const char *tags __maybe_unused) {
+    statsd_parser_unittest_metrics += name_len;
+}
+
+static bool statsd_parser_unittest_compare(const char *input, size_t len, int require_newlines) {
+    char buf1[len + 1], buf2[len + 1];
+    memcpy(buf1, input, len);
+    memcpy(buf2, input, len);
+
+    BUFFER *expected = buffer_create(0, NULL);
+    BUFFER *got = buffer_create(0, NULL);
+
+    statsd_parser_unittest_wb = expected;
+    size_t r1 = statsd_process_buffer_reference(buf1, len, require_newlines, statsd_parser_unittest_record);
+    buffer_sprintf(expected, "remaining %zu: '%.*s'\n", r1, (int)r1, buf1);
+
+    statsd_parser_unittest_wb = got;
+    size_t r2 = statsd_process_buffer(buf2, len, require_newlines, statsd_parser_unittest_record);
+    buffer_sprintf(got, "remaining %zu: '%.*s'\n", r2, (int)r2, buf2);
+
+    statsd_parser_unittest_wb = NULL;
+
+    bool ok = strcmp(buffer_tostring(expected), buffer_tostring(got)) == 0;
+    if(!ok)
+        fprintf(stderr, "STATSD parser mismatch on input '%.*s' (require newlines %d)\nEXPECTED:\n%sGOT:\n%s\n",
+                (int)len, input, require_newlines, buffer_tostring(expected), buffer_tostring(got));
+
+    buffer_free(expected);
+    buffer_free(got);
+    return ok;
+}
+
+static double statsd_parser_unittest_benchmark(const char *title, const char *data, size_t len, bool reference) {
+    char *buf = mallocz(len + 1);
+    size_t loops = 0, bytes = 0;
+
+    usec_t started_ut = now_monotonic_high_precision_usec(), duration_ut;
+    do {
+        for(size_t i = 0; i < 100 ;i++) {
+            memcpy(buf, data, len);
+            if(reference)
+                statsd_process_buffer_reference(buf, len, 0, statsd_parser_unittest_count);
+            else
+                statsd_process_buffer(buf, len, 0, statsd_parser_unittest_count);
+        }
+        loops += 100;
+        bytes += len * 100;
+        duration_ut = now_monotonic_high_precision_usec() - started_ut;
+    } while(duration_ut < USEC_PER_SEC);
+
+    freez(buf);
+
+    double mb_per_sec = (double)bytes / 1024.0 / 1024.0 * USEC_PER_SEC / (double)duration_ut;
+    fprintf(stderr, "  %-24s: %8.1f MiB/s, %zu buffers of %zu bytes\n", title, mb_per_sec, loops, len);
+    return mb_per_sec;
+}
+
+int statsd_parser_unittest(void) {
+    static const char *cases[] = {
+        "a:1|c\n",
+        "a=1|c",
+        "  spaced name  :  2  | g \n",
+        "x:1|ms|@0.1|#tag1:v,units:ms\n",
+        "x:1|h@0.5#units:s\r\n",
+        "x:1|h|#units:s|@0.25\n",
+        "noval\n",
+        ":1|c\n",
+        "\n\n  \n\t\n",
+        "a:1|c|unknown|@0.2\n",
+        "a:1\n",
+        "a|c\n",
+        "a:1|c\r\nb:2|g",
+        "a@b:1|c\na#b:2|c\n",
+        "a:1\r|c\nb:2|c\n",
+        "v:-1|g\nv:+1|g\n",
+        "a:1|c\nb:2",
+        "a:1|c\nb:2|",
+        "a:|c\na:1|\n",
+        "||||\n@@@\n###\n:::\n===\n",
+        "this.is.a.very.long.metric.name.that.crosses.the.64.bytes.block.boundary.of.the.scanner:12345.678|ms|@0.5|#units:milliseconds,name:latency,family:app\n"
+        "and.another.one.that.also.is.longer.than.one.block.of.the.structural.scanner:1|c\n",
+        NULL
+    };
+
+    size_t errors = 0, checks = 0;
+
+    for(size_t i = 0; cases[i] ;i++) {
+        for(int rn = 0; rn <= 1 ;rn++) {
+            checks++;
+            if(!statsd_parser_unittest_compare(cases[i], strlen(cases[i]), rn))
+                errors++;
+        }
+    }
+
+    // embedded NUL characters stop both parsers
+    {
+        const char with_nul[] = "a:1|c\nb:2|c\0c:3|c\n";
+        checks++;
+        if(!statsd_parser_unittest_compare(with_nul, sizeof(with_nul) - 1, 0))
+            errors++;
+    }
+
+    // random inputs, made of the characters the parsers care about
+    {
+        static const char alphabet[] = "ab :=|@#\r\n\t1.-,";
+        char input[300];
+        for(size_t i = 0; i < 20000 ;i++) {
+            size_t len = (size_t)(os_random32() % sizeof(input));
+            for(size_t c = 0; c < len ;c++)
+                input[c] = alphabet[os_random32() % (sizeof(alphabet) - 1)];
+
+            checks++;
+            if(!statsd_parser_unittest_compare(input, len, (int)(i % 2)))
+                errors++;
+        }
+    }
+
+    fprintf(stderr, "STATSD parser: %zu checks, %zu errors\n", checks, errors);
+
+    // benchmark - a UDP packet sized buffer of typical metrics
+    {
+        char data[8192];
+        size_t len = 0;
+        for(size_t i = 0; len < sizeof(data) - 200 ;i++) {
+            switch(i % 4) {
+                case 0: len += snprintfz(&data[len], sizeof(data) - len, "myapp.requests.endpoint%zu.count:1|c\n", i); break;
+                case 1: len += snprintfz(&data[len], sizeof(data) - len, "myapp.queue.size%zu:%zu|g\n", i, i * 7); break;
+                case 2: len += snprintfz(&data[len], sizeof(data) - len, "myapp.response.time%zu:%zu.5|ms|@0.5\n", i, i % 300); break;
+                default: len += snprintfz(&data[len], sizeof(data) - len, "myapp.payload%zu:%zu|h|#units:bytes\n", i, i * 13); break;
+            }
+        }
+
+        fprintf(stderr, "STATSD parser benchmark:\n");
+        double ref = statsd_parser_unittest_benchmark("reference (per byte)", data, len, true);
+        double vec = statsd_parser_unittest_benchmark("structural scanner", data, len, false);
+        fprintf(stderr, "  speedup: %.2fx\n", ref > 0 ? vec / ref : 0);
+    }
+
+    return errors ? 1 : 0;
+}
@@ -178,6 +178,7 @@ void netdata_conf_dbengine_init(const char *hostname) {
     // ----------------------------------------------------------------------------------------------------------------
 
     dbengine_use_direct_io = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_DB, "dbengine use direct io", dbengine_use_direct_io);
+    dbengine_use_huge_pages = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_DB, "dbengine use huge pages", dbengine_use_huge_pages);
     dbengine_journal_v2_unmount_time = inicfg_get_duration_seconds(&netdata_config, CONFIG_SECTION_DB, "dbengine journal v2 unmount time", nd_profile.dbengine_journal_v2_unmount_time);
 
     unsigned read_num = (unsigned)inicfg_get_number(&netdata_config, CONFIG_SECTION_DB, "dbengine pages per extent", DEFAULT_PAGES_PER_EXTENT);
@@ -430,6 +431,12 @@ void netdata_conf_section_db(void) {
     }
     gap_when_lost_iterations_above += 2;
 
+    // ------------------------------------------------------------------------
+    // the memory kept for the pages of the queries
+
+    onewayalloc_pool_retained_max_set(
+        inicfg_get_size_bytes(&netdata_config, CONFIG_SECTION_DB, "query memory pool size", 64ULL * 1024 * 1024));
+
     // ------------------------------------------------------------------------
 
     netdata_conf_dbengine_pre_logs();
@@ -3,27 +3,25 @@
 #include "netdata-conf-global.h"
 #include "daemon/common.h"
 
+static OS_EFFECTIVE_CPUS effective_cpus = { 0 };
+
 size_t netdata_conf_cpus(void) {
     static size_t processors = 0;
 
     if(processors)
         return processors;
 
-    SPINLOCK spinlock = SPINLOCK_INITIALIZER;
+    static SPINLOCK spinlock = SPINLOCK_INITIALIZER;
     spinlock_lock(&spinlock);
     size_t p = 0;
 
     if(processors)
         goto skip;
 
-#if defined(OS_LINUX)
-    p = os_read_cpuset_cpus("/sys/fs/cgroup/cpuset.cpus", p);
-    if(!p)
-        p = os_read_cpuset_cpus("/sys/fs/cgroup/cpuset/cpuset.cpus", p);
-#endif
-
-    if(!p)
-        p = os_get_system_cpus_uncached();
+    // the cpus we can actually use - the cgroup quota and cpuset of a container,
+    // or our scheduler affinity, may be a lot less than the cpus of the host
+    effective_cpus = os_get_effective_cpus();
+    p = effective_cpus.effective;
 
     p = inicfg_get_number(&netdata_config, CONFIG_SECTION_GLOBAL, "cpu cores", p);
     if(p < 1)
@@ -40,6 +38,28 @@ skip:
     return processors;
 }
 
+void netdata_conf_cpus_report(void) {
+    size_t cpus = netdata_conf_cpus();
+
+    nd_log(NDLS_DAEMON, NDLP_INFO,
+           "CPUS: using %zu cpus for sizing the threads of the agent "
+           "(system %zu, scheduler affinity %zu, cgroup cpuset %zu, cgroup quota %.2f, effective %zu)",
+           cpus, effective_cpus.system, effective_cpus.affinity, effective_cpus.cpuset,
+           effective_cpus.quota, effective_cpus.effective);
+
+    size_t evictors = 0, flushers = 0;
+#ifdef ENABLE_DBENGINE
+    evictors = pgc_max_evictors();
+    flushers = pgc_max_flushers();
+#endif
+
+    nd_log(NDLS_DAEMON, NDLP_INFO,
+           "CPUS: web server threads %zu, libuv worker threads %d, executor threads %zu, "
+           "replication threads %zu, dbengine evictors %zu, dbengine flushers %zu",
+           netdata_conf_web_query_threads(), libuv_worker_threads, nd_executor_threads(),
+           stream_send.replication.threads, evictors, flushers);
+}
+
 void netdata_conf_glibc_malloc_initialize(size_t wanted_arenas, size_t trim_threshold __maybe_unused) {
     wanted_arenas = inicfg_get_number(&netdata_config, CONFIG_SECTION_GLOBAL, "glibc malloc arena max for plugins", wanted_arenas);
     if(wanted_arenas < 1 || wanted_arenas > os_get_system_cpus_cached(true)) {
@@ -153,5 +153,7 @@ void netdata_conf_web_security_init(void) {
 
     tls_version    = inicfg_get(&netdata_config, CONFIG_SECTION_WEB, "tls version",  "1.3");
     tls_ciphers    = inicfg_get(&netdata_config, CONFIG_SECTION_WEB, "tls ciphers",  "none");
+
+    netdata_ssl_kernel_tls = inicfg_get_boolean(&netdata_config, CONFIG_SECTION_WEB, "ssl kernel tls offload", netdata_ssl_kernel_tls);
 }
 
@@ -9,6 +9,7 @@
 #include "web/mcp/mcp.h"
 
 #include "database/engine/page_test.h"
+#include "collectors/statsd.plugin/statsd-benchmark.h"
 #include <curl/curl.h>
 
 #ifdef OS_WINDOWS
@@ -154,6 +155,14 @@ int help(int exitcode) {
             "                           size of E MiB, an optional disk space limit\n"
             "                           of F MiB, G libuv workers (default 16) and exit.\n\n"
 #endif
+            "  -W statsdbench[=HOST:PORT]\n"
+            "                           Send statsd UDP packets to a running netdata at\n"
+            "                           increasing rates, report the rate packets start\n"
+            "                           being dropped and exit.\n\n"
+            "  -W stringbench[=FILE]    Report the memory of the STRINGs and measure\n"
+            "                           their operations per second with an increasing\n"
+            "                           number of threads and exit. FILE has one name\n"
+            "                           per line (e.g. a dump of the names of a parent).\n\n"
             "  -W set section option value\n"
             "                           set netdata.conf option from the command line.\n\n"
             "  -W buildinfo             Print the version, the configure options,\n"
@@ -402,11 +411,17 @@ int netdata_main(int argc, char **argv) {
                             if (dictionary_unittest(10000)) return 1;
                             if (aral_unittest(10000)) return 1;
                             if (rrdlabels_unittest()) return 1;
+                            if (rrdset_definition_unittest()) return 1;
                             if (ctx_unittest()) return 1;
                             if (uuid_unittest()) return 1;
                             if (dyncfg_unittest()) return 1;
                             if (eval_unittest()) return 1;
                             if (duration_unittest()) return 1;
+                            if (ddsketch_unittest()) return 1;
+                            if (statsd_parser_unittest()) return 1;
+                            if (procfile_unittest()) return 1;
+                            if (nd_executor_unittest()) return 1;
+                            if (stream_delta_unittest()) return 1;
                             if (unittest_waiting_queue()) return 1;
                             if (uuidmap_unittest()) return 1;
 #ifdef HAVE_LIBBACKTRACE
@@ -448,10 +463,38 @@ int netdata_main(int argc, char **argv) {
                             unittest_running = true;
                             return rwlocks_stress_test();
                         }
+                        else if(strcmp(optarg, "ktlstest") == 0) {
+                            unittest_running = true;
+                            return netdata_ssl_ktls_benchmark();
+                        }
+                        else if(strcmp(optarg, "statsdparsertest") == 0) {
+                            unittest_running = true;
+                            return statsd_parser_unittest();
+                        }
+                        else if(strcmp(optarg, "procfiletest") == 0) {
+                            unittest_running = true;
+                            return procfile_unittest();
+                        }
+                        else if(strcmp(optarg, "executortest") == 0) {
+                            unittest_running = true;
+                            return nd_executor_unittest();
+                        }
+                        else if(strcmp(optarg, "streamdeltatest") == 0) {
+                            unittest_running = true;
+                            return stream_delta_unittest();
+                        }
+                        else if(strcmp(optarg, "statsdbench") == 0 || strncmp(optarg, "statsdbench=", 12) == 0) {
+                            unittest_running = true;
+                            return statsd_benchmark(optarg[11] == '=' ? &optarg[12] : NULL);
+                        }
                         else if(strcmp(optarg, "stringtest") == 0)  {
                             unittest_running = true;
                             return string_unittest(10000);
                         }
+                        else if(strcmp(optarg, "stringbench") == 0 || strncmp(optarg, "stringbench=", 12) == 0)  {
+                            unittest_running = true;
+                            return string_benchmark(optarg[11] == '=' ? &optarg[12] : NULL);
+                        }
                         else if(strcmp(optarg, "rrdlabelstest") == 0) {
                             unittest_running = true;
                             rrdlabels_aral_init(true);
@@ -901,6 +944,15 @@ int netdata_main(int argc, char **argv) {
         // this has to run before starting any other threads that use workers
         workers_utilization_enable();
 
+    lock_contention_enable(inicfg_get_boolean(&netdata_config, CONFIG_SECTION_PULSE, "lock contention", CONFIG_BOOLEAN_NO));
+
+    // ----------------------------------------------------------------------------------------------------------------
+    delta_startup_time("executor");
+
+    // the threads shared by all components that run work in parallel
+    nd_executor_init((size_t)inicfg_get_number_range(
+        &netdata_config, CONFIG_SECTION_GLOBAL, "executor threads", (long long)netdata_conf_cpus(), 1, 1024));
+
     // ----------------------------------------------------------------------------------------------------------------
     delta_startup_time("replication");
 
@@ -1156,6 +1208,8 @@ int netdata_main(int argc, char **argv) {
     // ----------------------------------------------------------------------------------------------------------------
     delta_startup_time("done");
 
+    netdata_conf_cpus_report();
+
     nd_log_register_fatal_final_cb(netdata_exit_fatal);
     daemon_status_file_startup_step(NULL);
     daemon_status_file_update_status(DAEMON_STATUS_RUNNING);
@@ -10,6 +10,12 @@ struct aral_info {
 
     RRDSET *st_utilization;
     RRDDIM *rd_utilization;
+
+    RRDSET *st_magazines;
+    RRDDIM *rd_magazines_hits, *rd_magazines_misses;
+
+    RRDSET *st_huge_pages;
+    RRDDIM *rd_huge_pages_hugetlb, *rd_huge_pages_thp, *rd_huge_pages_normal;
 };
 
 DEFINE_JUDYL_TYPED(ARAL_STATS, struct aral_info *);
@@ -174,6 +180,80 @@ void pulse_aral_do(bool extended) {
             rrddim_set_by_pointer(ai->st_utilization, ai->rd_utilization, (collected_number)(utilization * 1000.0));
             rrdset_done(ai->st_utilization);
         }
+
+        size_t magazine_hits = __atomic_load_n(&stats->magazines.hits, __ATOMIC_RELAXED);
+        size_t magazine_misses = __atomic_load_n(&stats->magazines.misses, __ATOMIC_RELAXED);
+        if(ai->st_magazines || magazine_hits + magazine_misses) {
+            if (unlikely(!ai->st_magazines)) {
+                char id[256];
+
+                snprintfz(id, sizeof(id), "aral_%s_magazines", ai->name);
+                netdata_fix_chart_id(id);
+
+                ai->st_magazines = rrdset_create_localhost(
+                    "netdata",
+                    id,
+                    NULL,
+                    "ARAL",
+                    "netdata.aral_magazines",
+                    "Array Allocator Thread Magazines Hit Ratio",
+                    "%",
+                    "netdata",
+                    "pulse",
+                    910002,
+                    localhost->rrd_update_every,
+                    RRDSET_TYPE_STACKED);
+
+                rrdlabels_add(ai->st_magazines->rrdlabels, "ARAL", ai->name, RRDLABEL_SRC_AUTO);
+
+                ai->rd_magazines_hits   = rrddim_add(ai->st_magazines, "hits", NULL, 1, 1, RRD_ALGORITHM_PCENT_OVER_DIFF_TOTAL);
+                ai->rd_magazines_misses = rrddim_add(ai->st_magazines, "misses", NULL, 1, 1, RRD_ALGORITHM_PCENT_OVER_DIFF_TOTAL);
+            }
+
+            rrddim_set_by_pointer(ai->st_magazines, ai->rd_magazines_hits, (collected_number)magazine_hits);
+            rrddim_set_by_pointer(ai->st_magazines, ai->rd_magazines_misses, (collected_number)magazine_misses);
+            rrdset_done(ai->st_magazines);
+        }
+
+        size_t hugetlb_bytes = __atomic_load_n(&stats->huge_pages.hugetlb_bytes, __ATOMIC_RELAXED);
+        size_t thp_bytes = __atomic_load_n(&stats->huge_pages.thp_bytes, __ATOMIC_RELAXED);
+        if(ai->st_huge_pages || hugetlb_bytes + thp_bytes) {
+            if (unlikely(!ai->st_huge_pages)) {
+                char id[256];
+
+                snprintfz(id, sizeof(id), "aral_%s_huge_pages", ai->name);
+                netdata_fix_chart_id(id);
+
+                ai->st_huge_pages = rrdset_create_localhost(
+                    "netdata",
+                    id,
+                    NULL,
+                    "ARAL",
+                    "netdata.aral_huge_pages",
+                    "Array Allocator Memory by Page Type",
+                    "bytes",
+                    "netdata",
+                    "pulse",
+                    910003,
+                    localhost->rrd_update_every,
+                    RRDSET_TYPE_STACKED);
+
+                rrdlabels_add(ai->st_huge_pages->rrdlabels, "ARAL", ai->name, RRDLABEL_SRC_AUTO);
+
+                ai->rd_huge_pages_hugetlb = rrddim_add(ai->st_huge_pages, "hugetlb", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+                ai->rd_huge_pages_thp     = rrddim_add(ai->st_huge_pages, "thp", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+                ai->rd_huge_pages_normal  = rrddim_add(ai->st_huge_pages, "normal", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+            }
+
+            // the huge pages include the structures and the padding of their ARAL pages
+            size_t total_bytes = allocated_total + structures_bytes + padding_bytes;
+            size_t normal_bytes = (total_bytes > hugetlb_bytes + thp_bytes) ? total_bytes - hugetlb_bytes - thp_bytes : 0;
+
+            rrddim_set_by_pointer(ai->st_huge_pages, ai->rd_huge_pages_hugetlb, (collected_number)hugetlb_bytes);
+            rrddim_set_by_pointer(ai->st_huge_pages, ai->rd_huge_pages_thp, (collected_number)thp_bytes);
+            rrddim_set_by_pointer(ai->st_huge_pages, ai->rd_huge_pages_normal, (collected_number)normal_bytes);
+            rrdset_done(ai->st_huge_pages);
+        }
     }
 
     spinlock_unlock(&globals.spinlock);
@@ -119,8 +119,8 @@ void pulse_daemon_memory_do(bool extended __maybe_unused) {
         sqlite3_int64 sqlite3_memory_used_current = 0, sqlite3_memory_used_highwater = 0;
         sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &sqlite3_memory_used_current, &sqlite3_memory_used_highwater, 1);
 
-        size_t strings_memory = 0, strings_index = 0;
-        string_statistics(NULL, NULL, NULL, NULL, NULL, &strings_memory, &strings_index, NULL, NULL);
+        STRING_MEMORY strings_memory;
+        string_memory_statistics(&strings_memory);
         
         size_t health_log_memory = aral_used_bytes_from_stats(health_alarm_entry_aral_stats());
 
@@ -179,7 +179,8 @@ void pulse_daemon_memory_do(bool extended __maybe_unused) {
                               (collected_number)pulse_ml_get_current_memory_usage());
 
         rrddim_set_by_pointer(st_memory, rd_strings,
-                              (collected_number)(strings_memory + strings_index));
+                              (collected_number)(strings_memory.text + strings_memory.headers +
+                                                 strings_memory.arena + strings_memory.index));
 
         rrddim_set_by_pointer(st_memory, rd_streaming,
                               (collected_number)netdata_buffers_statistics.rrdhost_senders + (collected_number)netdata_buffers_statistics.rrdhost_receivers);
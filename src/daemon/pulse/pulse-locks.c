@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define PULSE_INTERNALS 1
+#include "pulse-locks.h"
+
+#define PULSE_LOCKS_MAX_SITES 2048
+
+static const char *lock_type_id(LOCK_CONTENTION_TYPE type) {
+    switch(type) {
+        case LOCK_CONTENTION_SPINLOCK:
+            return "spinlock";
+
+        case LOCK_CONTENTION_RW_SPINLOCK_READ:
+            return "rwread";
+
+        case LOCK_CONTENTION_RW_SPINLOCK_WRITE:
+            return "rwwrite";
+
+        case LOCK_CONTENTION_WAITQ:
+            return "waitq";
+
+        default:
+            return "unknown";
+    }
+}
+
+void pulse_locks_do(bool extended __maybe_unused) {
+    if(!lock_contention_enabled)
+        return;
+
+    {
+        static RRDSET *st = NULL;
+        static RRDDIM *rd[LOCK_CONTENTION_TYPE_MAX] = { 0 };
+
+        if(unlikely(!st)) {
+            st = rrdset_create_localhost(
+                "netdata"
+                , "lock_contention_wait_time"
+                , NULL
+                , "spinlocks"
+                , "netdata.lock_contention_wait_time"
+                , "Netdata Time Waiting for Locks"
+                , "milliseconds/s"
+                , "netdata"
+                , "pulse"
+                , 920010
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_STACKED
+            );
+
+            for(size_t t = 0; t < LOCK_CONTENTION_TYPE_MAX ;t++)
+                rd[t] = rrddim_add(st, lock_contention_type_name(t), NULL, 1, USEC_PER_MS, RRD_ALGORITHM_INCREMENTAL);
+        }
+
+        uint64_t wait_ut[LOCK_CONTENTION_TYPE_MAX], contended[LOCK_CONTENTION_TYPE_MAX];
+        lock_contention_totals(wait_ut, contended);
+
+        for(size_t t = 0; t < LOCK_CONTENTION_TYPE_MAX ;t++)
+            rrddim_set_by_pointer(st, rd[t], (collected_number)wait_ut[t]);
+
+        rrdset_done(st);
+    }
+
+    {
+        static RRDSET *st = NULL;
+        static LOCK_CONTENTION_SITE *sites = NULL;
+
+        if(unlikely(!st)) {
+            st = rrdset_create_localhost(
+                "netdata"
+                , "lock_contention_wait_time_per_site"
+                , NULL
+                , "spinlocks"
+                , "netdata.lock_contention_wait_time_per_site"
+                , "Netdata Time Waiting for Locks per Call Site"
+                , "milliseconds/s"
+                , "netdata"
+                , "pulse"
+                , 920011
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_STACKED
+            );
+
+            sites = mallocz(PULSE_LOCKS_MAX_SITES * sizeof(*sites));
+        }
+
+        size_t used = lock_contention_sites(sites, PULSE_LOCKS_MAX_SITES);
+        for(size_t i = 0; i < used ;i++) {
+            char id[RRD_ID_LENGTH_MAX + 1];
+            snprintfz(id, sizeof(id), "%s_%s", lock_type_id(sites[i].type), sites[i].function);
+
+            RRDDIM *rd = rrddim_find(st, id, false);
+            if(!rd) rd = rrddim_add(st, id, NULL, 1, USEC_PER_MS, RRD_ALGORITHM_INCREMENTAL);
+            rrddim_set_by_pointer(st, rd, (collected_number)sites[i].wait_ut);
+        }
+
+        rrdset_done(st);
+    }
+}
@@ -301,6 +301,44 @@ void pulse_network_do(bool extended __maybe_unused) {
         rrdset_done(st_bytes);
     }
 
+    NETDATA_SSL_KTLS_STATISTICS ktls;
+    netdata_ssl_ktls_get_statistics(&ktls);
+    if(ktls.handshakes) {
+        static RRDSET *st_ktls = NULL;
+        static RRDDIM *rd_handshakes = NULL,
+                      *rd_send_offloaded = NULL,
+                      *rd_recv_offloaded = NULL,
+                      *rd_fallbacks = NULL;
+
+        if (unlikely(!st_ktls)) {
+            st_ktls = rrdset_create_localhost(
+                "netdata"
+                , "network_ktls"
+                , NULL
+                , PULSE_NETWORK_CHART_FAMILY
+                , "netdata.network_ktls"
+                , "Netdata Kernel TLS Offload"
+                , "connections/s"
+                , "netdata"
+                , "pulse"
+                , PULSE_NETWORK_CHART_PRIORITY + 10
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            rd_handshakes     = rrddim_add(st_ktls, "handshakes", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_send_offloaded = rrddim_add(st_ktls, "tx offloaded", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_recv_offloaded = rrddim_add(st_ktls, "rx offloaded", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_fallbacks      = rrddim_add(st_ktls, "userspace fallbacks", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+        }
+
+        rrddim_set_by_pointer(st_ktls, rd_handshakes, (collected_number) ktls.handshakes);
+        rrddim_set_by_pointer(st_ktls, rd_send_offloaded, (collected_number) ktls.send_offloaded);
+        rrddim_set_by_pointer(st_ktls, rd_recv_offloaded, (collected_number) ktls.recv_offloaded);
+        rrddim_set_by_pointer(st_ktls, rd_fallbacks, (collected_number) ktls.fallbacks);
+        rrdset_done(st_ktls);
+    }
+
     if(aclk_online()) {
         struct mqtt_wss_stats t = aclk_statistics();
         if (t.bytes_rx || t.bytes_tx) {
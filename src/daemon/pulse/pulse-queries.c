@@ -259,4 +259,39 @@ void pulse_queries_do(bool extended __maybe_unused) {
 
         rrdset_done(st_points_generated);
     }
+
+    if(extended) {
+        static RRDSET *st_pool = NULL;
+        static RRDDIM *rd_reused = NULL, *rd_fresh = NULL, *rd_released = NULL;
+
+        ONEWAYALLOC_POOL_STATISTICS ps;
+        onewayalloc_pool_statistics(&ps);
+
+        if (unlikely(!st_pool)) {
+            st_pool = rrdset_create_localhost(
+                "netdata"
+                , "queries_memory_pool"
+                , NULL
+                , "Time-Series Queries"
+                , NULL
+                , "Netdata Queries Memory Pages"
+                , "bytes/s"
+                , "netdata"
+                , "pulse"
+                , 131003
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE
+            );
+
+            rd_reused = rrddim_add(st_pool, "reused", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_fresh = rrddim_add(st_pool, "allocated", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_released = rrddim_add(st_pool, "released", NULL, -1, 1, RRD_ALGORITHM_INCREMENTAL);
+        }
+
+        rrddim_set_by_pointer(st_pool, rd_reused, (collected_number)ps.reused_bytes);
+        rrddim_set_by_pointer(st_pool, rd_fresh, (collected_number)ps.fresh_bytes);
+        rrddim_set_by_pointer(st_pool, rd_released, (collected_number)ps.released_bytes);
+
+        rrdset_done(st_pool);
+    }
 }
@@ -9,7 +9,7 @@ void pulse_string_do(bool extended) {
     static RRDSET *st_ops = NULL, *st_entries = NULL, *st_mem = NULL;
     static RRDDIM *rd_ops_inserts = NULL, *rd_ops_deletes = NULL;
     static RRDDIM *rd_entries_entries = NULL;
-    static RRDDIM *rd_mem = NULL;
+    static RRDDIM *rd_mem_text = NULL, *rd_mem_headers = NULL, *rd_mem_arena = NULL;
     static RRDDIM *rd_mem_idx = NULL;
 #ifdef NETDATA_INTERNAL_CHECKS
     static RRDDIM *rd_entries_refs = NULL, *rd_ops_releases = NULL,  *rd_ops_duplications = NULL, *rd_ops_searches = NULL;
@@ -19,6 +19,9 @@ void pulse_string_do(bool extended) {
 
     string_statistics(&inserts, &deletes, &searches, &entries, &references, &memory, &memory_index, &duplications, &releases);
 
+    STRING_MEMORY sm;
+    string_memory_statistics(&sm);
+
     if (unlikely(!st_ops)) {
         st_ops = rrdset_create_localhost(
             "netdata"
@@ -94,11 +97,15 @@ void pulse_string_do(bool extended) {
             , localhost->rrd_update_every
             , RRDSET_TYPE_STACKED);
 
-        rd_mem     = rrddim_add(st_mem, "memory", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
-        rd_mem_idx = rrddim_add(st_mem, "index", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        rd_mem_text    = rrddim_add(st_mem, "text", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        rd_mem_headers = rrddim_add(st_mem, "headers", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        rd_mem_arena   = rrddim_add(st_mem, "arena", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        rd_mem_idx     = rrddim_add(st_mem, "index", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
     }
 
-    rrddim_set_by_pointer(st_mem, rd_mem, (collected_number)memory);
-    rrddim_set_by_pointer(st_mem, rd_mem_idx, (collected_number)memory_index);
+    rrddim_set_by_pointer(st_mem, rd_mem_text, (collected_number)sm.text);
+    rrddim_set_by_pointer(st_mem, rd_mem_headers, (collected_number)sm.headers);
+    rrddim_set_by_pointer(st_mem, rd_mem_arena, (collected_number)sm.arena);
+    rrddim_set_by_pointer(st_mem, rd_mem_idx, (collected_number)sm.index);
     rrdset_done(st_mem);
 }
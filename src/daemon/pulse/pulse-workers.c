@@ -154,6 +154,7 @@ static struct worker_utilization all_workers_utilization[] = {
     { .name = "PGCEVICT",    .family = "workers dbengine eviction",       .priority = 1000000 },
     { .name = "BACKFILL",    .family = "workers backfill",                .priority = 1000000 },
     { .name = "WEBSOCKET",   .family = "workers websocket",               .priority = 1000000 },
+    { .name = "EXECUTOR",    .family = "workers executor",                .priority = 1000000 },
 
     // has to be terminated with a NULL
     { .name = NULL,          .family = NULL       }
@@ -21,9 +21,10 @@
 #define WORKER_JOB_NETWORK              15
 #define WORKER_JOB_PARENTS              16
 #define WORKER_JOB_MEMORY_EXTENDED      17
+#define WORKER_JOB_LOCKS                18
 
-#if WORKER_UTILIZATION_MAX_JOB_TYPES < 17
-#error "WORKER_UTILIZATION_MAX_JOB_TYPES has to be at least 14"
+#if WORKER_UTILIZATION_MAX_JOB_TYPES < 19
+#error "WORKER_UTILIZATION_MAX_JOB_TYPES has to be at least 19"
 #endif
 
 bool pulse_enabled = true;
@@ -50,6 +51,7 @@ static void pulse_register_workers(void) {
     worker_register_job_name(WORKER_JOB_NETWORK, "network");
     worker_register_job_name(WORKER_JOB_PARENTS, "parents");
     worker_register_job_name(WORKER_JOB_MEMORY_EXTENDED, "memory extended");
+    worker_register_job_name(WORKER_JOB_LOCKS, "locks");
 }
 
 void pulse_thread_main(void *ptr) {
@@ -130,6 +132,9 @@ void pulse_thread_main(void *ptr) {
         worker_is_busy(WORKER_JOB_PARENTS);
         pulse_parents_do(pulse_extended_enabled);
 
+        worker_is_busy(WORKER_JOB_LOCKS);
+        pulse_locks_do(pulse_extended_enabled);
+
         // keep this last to have access to the memory counters
         // exposed by everyone else
         worker_is_busy(WORKER_JOB_DAEMON);
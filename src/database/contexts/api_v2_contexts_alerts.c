@@ -236,8 +236,8 @@ static void alerts_v2_insert_callback(const DICTIONARY_ITEM *item __maybe_unused
     t->classification = rrdlabels_create();
     t->component = rrdlabels_create();
     t->type = rrdlabels_create();
-    if (string_strlen(rc->rrdset->context))
-        rrdlabels_add(t->context, string2str(rc->rrdset->context), "yes", RRDLABEL_SRC_AUTO);
+    if (string_strlen(rrdset_def(rc->rrdset)->context))
+        rrdlabels_add(t->context, string2str(rrdset_def(rc->rrdset)->context), "yes", RRDLABEL_SRC_AUTO);
     if (string_strlen(rc->config.recipient))
         rrdlabels_add(t->recipient, string2str(rc->config.recipient), "yes", RRDLABEL_SRC_AUTO);
     if (string_strlen(rc->config.classification))
@@ -257,8 +257,8 @@ static void alerts_v2_insert_callback(const DICTIONARY_ITEM *item __maybe_unused
 static bool alerts_v2_conflict_callback(const DICTIONARY_ITEM *item __maybe_unused, void *old_value, void *new_value, void *data __maybe_unused) {
     struct alert_v2_entry *t = old_value, *n = new_value;
     RRDCALC *rc = n->tmp;
-    if (string_strlen(rc->rrdset->context))
-        rrdlabels_add(t->context, string2str(rc->rrdset->context), "yes", RRDLABEL_SRC_AUTO);
+    if (string_strlen(rrdset_def(rc->rrdset)->context))
+        rrdlabels_add(t->context, string2str(rrdset_def(rc->rrdset)->context), "yes", RRDLABEL_SRC_AUTO);
     if (string_strlen(rc->config.recipient))
         rrdlabels_add(t->recipient, string2str(rc->config.recipient), "yes", RRDLABEL_SRC_AUTO);
     if (string_strlen(rc->config.classification))
@@ -672,10 +672,10 @@ static void alert_instances_v2_insert_callback(const DICTIONARY_ITEM *item __may
     struct sql_alert_instance_v2_entry *t = value;
     RRDCALC *rc = t->tmp;
 
-    t->context = rc->rrdset->context;
+    t->context = rrdset_def(rc->rrdset)->context;
     t->chart_id = rc->rrdset->id;
     t->chart_name = rc->rrdset->name;
-    t->family = rc->rrdset->family;
+    t->family = rrdset_def(rc->rrdset)->family;
     t->units = rc->config.units;
     t->classification = rc->config.classification;
     t->type = rc->config.type;
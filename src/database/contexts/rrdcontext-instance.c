@@ -264,8 +264,8 @@ void rrdinstance_trigger_updates(RRDINSTANCE *ri, const char *function) {
     RRDSET *st = ri->rrdset;
 
     if(likely(st)) {
-        if(unlikely((unsigned int) st->priority != ri->priority)) {
-            ri->priority = st->priority;
+        if(unlikely((unsigned int) rrdset_def(st)->priority != ri->priority)) {
+            ri->priority = rrdset_def(st)->priority;
             rrd_flag_set_updated(ri, RRD_FLAG_UPDATE_REASON_CHANGED_METADATA);
         }
         if(unlikely(st->update_every != ri->update_every_s)) {
@@ -290,13 +290,15 @@ void rrdinstance_trigger_updates(RRDINSTANCE *ri, const char *function) {
 // RRDINSTANCE HOOKS ON RRDSET
 
 inline void rrdinstance_from_rrdset(RRDSET *st) {
+    const RRDSET_DEFINITION *def = rrdset_def(st);
+
     RRDCONTEXT trc = {
-            .id = string_dup(st->context),
-            .title = string_dup(st->title),
-            .units = string_dup(st->units),
-            .family = string_dup(st->family),
-            .priority = st->priority,
-            .chart_type = st->chart_type,
+            .id = string_dup(def->context),
+            .title = string_dup(def->title),
+            .units = string_dup(def->units),
+            .family = string_dup(def->family),
+            .priority = def->priority,
+            .chart_type = def->chart_type,
             .flags = RRD_FLAG_NONE, // no need for atomics
             .rrdhost = st->rrdhost,
     };
@@ -308,11 +310,11 @@ inline void rrdinstance_from_rrdset(RRDSET *st) {
         .uuid = uuidmap_create(st->chart_uuid),
         .id = string_dup(st->id),
         .name = string_dup(st->name),
-        .units = string_dup(st->units),
-        .family = string_dup(st->family),
-        .title = string_dup(st->title),
-        .chart_type = st->chart_type,
-        .priority = st->priority,
+        .units = string_dup(def->units),
+        .family = string_dup(def->family),
+        .title = string_dup(def->title),
+        .chart_type = def->chart_type,
+        .priority = def->priority,
         .update_every_s = st->update_every,
         .flags = RRD_FLAG_NONE, // no need for atomics
         .rrdset = st,
@@ -113,9 +113,9 @@ ALWAYS_INLINE void rrdcontext_db_rotation(void) {
 
 int rrdcontext_find_dimension_uuid(RRDSET *st, const char *id, nd_uuid_t *store_uuid) {
     if(!st->rrdhost) return 1;
-    if(!st->context) return 2;
+    if(!rrdset_def(st)->context) return 2;
 
-    RRDCONTEXT_ACQUIRED *rca = (RRDCONTEXT_ACQUIRED *)dictionary_get_and_acquire_item(st->rrdhost->rrdctx.contexts, string2str(st->context));
+    RRDCONTEXT_ACQUIRED *rca = (RRDCONTEXT_ACQUIRED *)dictionary_get_and_acquire_item(st->rrdhost->rrdctx.contexts, string2str(rrdset_def(st)->context));
     if(!rca) return 3;
 
     RRDCONTEXT *rc = rrdcontext_acquired_value(rca);
@@ -147,9 +147,9 @@ int rrdcontext_find_dimension_uuid(RRDSET *st, const char *id, nd_uuid_t *store_
 
 int rrdcontext_find_chart_uuid(RRDSET *st, nd_uuid_t *store_uuid) {
     if(!st->rrdhost) return 1;
-    if(!st->context) return 2;
+    if(!rrdset_def(st)->context) return 2;
 
-    RRDCONTEXT_ACQUIRED *rca = (RRDCONTEXT_ACQUIRED *)dictionary_get_and_acquire_item(st->rrdhost->rrdctx.contexts, string2str(st->context));
+    RRDCONTEXT_ACQUIRED *rca = (RRDCONTEXT_ACQUIRED *)dictionary_get_and_acquire_item(st->rrdhost->rrdctx.contexts, string2str(rrdset_def(st)->context));
     if(!rca) return 3;
 
     RRDCONTEXT *rc = rrdcontext_acquired_value(rca);
@@ -2053,6 +2053,9 @@ PGC *pgc_create(const char *name,
                 &pgc_aral_statistics,
                 NULL, NULL,
                 false, false, false);
+
+            if(dbengine_use_huge_pages)
+                aral_huge_pages_enable(cache->index[part].aral);
         }
 #endif
     }
@@ -311,6 +311,9 @@ void pgd_init_arals(void) {
                 0,
                 &pgd_aral_statistics,
                 NULL, NULL, false, false, true);
+
+            if(dbengine_use_huge_pages)
+                aral_huge_pages_enable(arals[arals_slot(slot, partition)]);
         }
     }
 
@@ -60,6 +60,7 @@ void pdc_init(void) {
             NULL, NULL, false, false, true
             );
 
+    aral_magazines_enable(pdc_globals.pdc.ar);
     pulse_aral_register(pdc_globals.pdc.ar, "pdc");
 }
 
@@ -89,6 +90,7 @@ void page_details_init(void) {
             NULL,
             NULL, NULL, false, false, true
     );
+    aral_magazines_enable(pdc_globals.pd.ar);
     pulse_aral_register(pdc_globals.pd.ar, "pd");
 }
 
@@ -118,6 +120,7 @@ void epdl_init(void) {
             NULL,
             NULL, NULL, false, false, true
     );
+    aral_magazines_enable(pdc_globals.epdl.ar);
     pulse_aral_register(pdc_globals.epdl.ar, "epdl");
 }
 
@@ -148,6 +151,7 @@ void deol_init(void) {
             NULL, NULL, false, false, true
     );
 
+    aral_magazines_enable(pdc_globals.deol.ar);
     pulse_aral_register(pdc_globals.deol.ar, "deol");
 }
 
@@ -178,6 +182,7 @@ void epdl_extent_init(void) {
             NULL, NULL, false, false, true
     );
 
+    aral_magazines_enable(pdc_globals.epdl_extent.ar);
     pulse_aral_register(pdc_globals.epdl_extent.ar, "epdl_extent");
 }
 
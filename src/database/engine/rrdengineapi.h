@@ -15,6 +15,7 @@
 
 extern uint64_t dbengine_out_of_memory_protection;
 extern bool dbengine_use_all_ram_for_caches;
+extern bool dbengine_use_huge_pages;
 
 extern int default_rrdeng_page_cache_mb;
 extern int default_rrdeng_extent_cache_mb;
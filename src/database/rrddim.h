@@ -108,7 +108,19 @@ struct rrddim {
         struct {
             uint32_t sent_version;
             uint32_t dim_slot;
+
+            // STREAM_CAP_DELTA - the last value sent upstream
+            bool delta;                                 // true when the parent can repeat the last value sent
+            SN_FLAGS delta_flags;
+            collected_number delta_collected;
+            NETDATA_DOUBLE delta_value;
         } snd;
+
+        struct {
+            // STREAM_CAP_DELTA - the last value received from the child
+            bool delta;                                 // true when the last value received can be repeated
+            SN_FLAGS delta_flags;
+        } rcv;
     } stream;
 
     // ------------------------------------------------------------------------
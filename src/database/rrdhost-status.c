@@ -243,6 +243,10 @@ static void rrdhost_status_stream_internal(RRDHOST_STATUS *s) {
                 s->stream.sent_bytes_on_this_connection_per_type,
                 stats->bytes_sent_by_type,
                 MIN(sizeof(s->stream.sent_bytes_on_this_connection_per_type), sizeof(stats->bytes_sent_by_type)));
+
+            s->stream.commits_on_this_connection = stats->commits;
+            s->stream.batches_on_this_connection = stats->batches;
+            s->stream.sends_on_this_connection = stats->sends;
         }
 
         if (rrdhost_flag_check(host, RRDHOST_FLAG_STREAM_SENDER_CONNECTED)) {
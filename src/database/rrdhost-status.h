@@ -161,6 +161,9 @@ typedef struct rrdhost_status_t {
         } replication;
 
         size_t sent_bytes_on_this_connection_per_type[STREAM_TRAFFIC_TYPE_MAX];
+        size_t commits_on_this_connection;
+        size_t batches_on_this_connection;
+        size_t sends_on_this_connection;
     } stream;
 
     struct {
@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "rrd.h"
+
+typedef struct rrdset_definition_entry {
+    RRDSET_DEFINITION def;                          // must be first - it is also the JudyHS key
+    size_t refcount;
+} RRDSET_DEFINITION_ENTRY;
+
+// a definition replaced on a live chart, waiting for the lock-free readers to stop using it
+typedef struct rrdset_definition_retired {
+    const RRDSET_DEFINITION *def;
+    usec_t retired_ut;
+    struct rrdset_definition_retired *prev, *next;
+} RRDSET_DEFINITION_RETIRED;
+
+// readers use st->def only for the duration of a single call, never across blocking operations,
+// so keeping the retired definitions for this long is enough for all of them to finish
+#define RRDSET_DEFINITION_RETIRE_GRACE_UT (60 * USEC_PER_SEC)
+
+static struct {
+    SPINLOCK spinlock;
+    size_t count;
+    size_t references;
+    Pvoid_t JudyHS;
+
+    struct {
+        size_t count;
+        RRDSET_DEFINITION_RETIRED *base;            // oldest first
+    } retired;
+} global_definitions = {
+    .spinlock = SPINLOCK_INITIALIZER,
+    .count = 0,
+    .references = 0,
+    .JudyHS = (Pvoid_t) NULL,
+    .retired = {
+        .count = 0,
+        .base = NULL,
+    },
+};
+
+static void rrdset_definition_retired_cleanup(usec_t now_ut);
+
+static inline void RRDSET_DEFINITION_MEMORY_DELTA(int64_t judy_mem, int64_t item_size) {
+    // accounted as part of the rrdset memory
+    __atomic_fetch_add(&dictionary_stats_category_rrdset.memory.index, judy_mem, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&dictionary_stats_category_rrdset.memory.dict, item_size, __ATOMIC_RELAXED);
+}
+
+static inline void rrdset_definition_key_freez(RRDSET_DEFINITION *key) {
+    string_freez(key->family);
+    string_freez(key->title);
+    string_freez(key->units);
+    string_freez(key->context);
+    string_freez(key->plugin_name);
+    string_freez(key->module_name);
+}
+
+void rrdset_definition_copy(RRDSET_DEFINITION *key, const RRDSET_DEFINITION *def) {
+    memset(key, 0, sizeof(*key));
+    key->family = string_dup(def->family);
+    key->title = string_dup(def->title);
+    key->units = string_dup(def->units);
+    key->context = string_dup(def->context);
+    key->plugin_name = string_dup(def->plugin_name);
+    key->module_name = string_dup(def->module_name);
+    key->priority = def->priority;
+    key->chart_type = def->chart_type;
+}
+
+const RRDSET_DEFINITION *rrdset_definition_acquire(RRDSET_DEFINITION *key) {
+    rrdset_definition_retired_cleanup(now_monotonic_usec());
+
+    // normalize the key, so that the padding bytes are always zero
+    RRDSET_DEFINITION k;
+    memset(&k, 0, sizeof(k));
+    k.family = key->family;
+    k.title = key->title;
+    k.units = key->units;
+    k.context = key->context;
+    k.plugin_name = key->plugin_name;
+    k.module_name = key->module_name;
+    k.priority = key->priority;
+    k.chart_type = key->chart_type;
+
+    RRDSET_DEFINITION_ENTRY *entry;
+
+    spinlock_lock(&global_definitions.spinlock);
+
+    JudyAllocThreadPulseReset();
+
+    Pvoid_t *PValue = JudyHSIns(&global_definitions.JudyHS, (void *)&k, sizeof(k), PJE0);
+
+    int64_t judy_mem = JudyAllocThreadPulseGetAndReset();
+
+    if(unlikely(!PValue || PValue == PJERR))
+        fatal("RRDSET DEFINITIONS: corrupted judyHS array");
+
+    if(*PValue) {
+        entry = *PValue;
+        rrdset_definition_key_freez(&k);
+        RRDSET_DEFINITION_MEMORY_DELTA(judy_mem, 0);
+    }
+    else {
+        entry = callocz(1, sizeof(*entry));
+        entry->def = k;
+        *PValue = entry;
+        RRDSET_DEFINITION_MEMORY_DELTA(judy_mem, sizeof(*entry));
+        global_definitions.count++;
+    }
+
+    entry->refcount++;
+    global_definitions.references++;
+
+    spinlock_unlock(&global_definitions.spinlock);
+
+    memset(key, 0, sizeof(*key));
+    return &entry->def;
+}
+
+void rrdset_definition_release(const RRDSET_DEFINITION *def) {
+    if(!def) return;
+
+    RRDSET_DEFINITION_ENTRY *entry = (RRDSET_DEFINITION_ENTRY *)def;
+
+    spinlock_lock(&global_definitions.spinlock);
+
+    global_definitions.references--;
+
+    if(--entry->refcount == 0) {
+        JudyAllocThreadPulseReset();
+
+        int rc = JudyHSDel(&global_definitions.JudyHS, (void *)&entry->def, sizeof(entry->def), PJE0);
+        if(unlikely(rc != 1))
+            fatal("RRDSET DEFINITIONS: cannot delete a definition from the judyHS array");
+
+        global_definitions.count--;
+
+        int64_t judy_mem = JudyAllocThreadPulseGetAndReset();
+        RRDSET_DEFINITION_MEMORY_DELTA(judy_mem, -(int64_t)sizeof(*entry));
+
+        rrdset_definition_key_freez(&entry->def);
+        freez(entry);
+    }
+
+    spinlock_unlock(&global_definitions.spinlock);
+}
+
+// release the retired definitions that have been retired before the grace period
+static void rrdset_definition_retired_cleanup(usec_t now_ut) {
+    RRDSET_DEFINITION_RETIRED *expired = NULL;
+
+    spinlock_lock(&global_definitions.spinlock);
+    while(global_definitions.retired.base &&
+           global_definitions.retired.base->retired_ut + RRDSET_DEFINITION_RETIRE_GRACE_UT <= now_ut) {
+        RRDSET_DEFINITION_RETIRED *r = global_definitions.retired.base;
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(global_definitions.retired.base, r, prev, next);
+        DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(expired, r, prev, next);
+        global_definitions.retired.count--;
+    }
+    spinlock_unlock(&global_definitions.spinlock);
+
+    while(expired) {
+        RRDSET_DEFINITION_RETIRED *r = expired;
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(expired, r, prev, next);
+        rrdset_definition_release(r->def);
+        freez(r);
+    }
+}
+
+void rrdset_definition_release_deferred(const RRDSET_DEFINITION *def) {
+    if(!def) return;
+
+    usec_t now_ut = now_monotonic_usec();
+
+    RRDSET_DEFINITION_RETIRED *r = mallocz(sizeof(*r));
+    r->def = def;
+    r->retired_ut = now_ut;
+    r->prev = r->next = NULL;
+
+    spinlock_lock(&global_definitions.spinlock);
+    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(global_definitions.retired.base, r, prev, next);
+    global_definitions.retired.count++;
+    spinlock_unlock(&global_definitions.spinlock);
+
+    rrdset_definition_retired_cleanup(now_ut);
+}
+
+void rrdset_definition_statistics(size_t *unique, size_t *references) {
+    spinlock_lock(&global_definitions.spinlock);
+    if(unique) *unique = global_definitions.count;
+    if(references) *references = global_definitions.references;
+    spinlock_unlock(&global_definitions.spinlock);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// unittest
+
+static void rrdset_definition_unittest_key(RRDSET_DEFINITION *key, const char *title, int32_t priority) {
+    memset(key, 0, sizeof(*key));
+    key->family = string_strdupz("family");
+    key->title = string_strdupz(title);
+    key->units = string_strdupz("units");
+    key->context = string_strdupz("unittest.context");
+    key->plugin_name = string_strdupz("unittest.plugin");
+    key->module_name = string_strdupz("unittest.module");
+    key->priority = priority;
+    key->chart_type = RRDSET_TYPE_LINE;
+}
+
+int rrdset_definition_unittest(void) {
+    size_t errors = 0, unique_before, refs_before, unique, refs;
+    rrdset_definition_statistics(&unique_before, &refs_before);
+
+    RRDSET_DEFINITION key;
+
+    rrdset_definition_unittest_key(&key, "title 1", 1);
+    const RRDSET_DEFINITION *d1 = rrdset_definition_acquire(&key);
+
+    rrdset_definition_unittest_key(&key, "title 1", 1);
+    const RRDSET_DEFINITION *d2 = rrdset_definition_acquire(&key);
+
+    rrdset_definition_unittest_key(&key, "title 2", 1);
+    const RRDSET_DEFINITION *d3 = rrdset_definition_acquire(&key);
+
+    rrdset_definition_unittest_key(&key, "title 1", 2);
+    const RRDSET_DEFINITION *d4 = rrdset_definition_acquire(&key);
+
+    if(d1 != d2) {
+        fprintf(stderr, "RRDSET DEFINITIONS: identical definitions are not shared\n");
+        errors++;
+    }
+
+    if(d1 == d3 || d1 == d4 || d3 == d4) {
+        fprintf(stderr, "RRDSET DEFINITIONS: different definitions are shared\n");
+        errors++;
+    }
+
+    if(strcmp(string2str(d3->title), "title 2") != 0 || d4->priority != 2) {
+        fprintf(stderr, "RRDSET DEFINITIONS: definition does not have the values given\n");
+        errors++;
+    }
+
+    rrdset_definition_statistics(&unique, &refs);
+    if(unique - unique_before != 3 || refs - refs_before != 4) {
+        fprintf(stderr, "RRDSET DEFINITIONS: expected 3 unique and 4 references, got %zu and %zu\n",
+                unique - unique_before, refs - refs_before);
+        errors++;
+    }
+
+    // modify a copy, the original should not change
+    rrdset_definition_copy(&key, d1);
+    string_freez(key.units);
+    key.units = string_strdupz("other units");
+    const RRDSET_DEFINITION *d5 = rrdset_definition_acquire(&key);
+    if(d5 == d1 || strcmp(string2str(d1->units), "units") != 0 || strcmp(string2str(d5->units), "other units") != 0) {
+        fprintf(stderr, "RRDSET DEFINITIONS: modifying a copy affected the original\n");
+        errors++;
+    }
+
+    // a deferred release keeps the definition alive until the grace period passes
+    rrdset_definition_release_deferred(d5);
+    rrdset_definition_statistics(&unique, &refs);
+    if(refs - refs_before != 5 || strcmp(string2str(d5->units), "other units") != 0) {
+        fprintf(stderr, "RRDSET DEFINITIONS: a deferred release freed the definition before the grace period\n");
+        errors++;
+    }
+    rrdset_definition_retired_cleanup(now_monotonic_usec() + RRDSET_DEFINITION_RETIRE_GRACE_UT);
+
+    rrdset_definition_release(d1);
+    rrdset_definition_release(d2);
+    rrdset_definition_release(d3);
+    rrdset_definition_release(d4);
+
+    rrdset_definition_statistics(&unique, &refs);
+    if(unique != unique_before || refs != refs_before) {
+        fprintf(stderr, "RRDSET DEFINITIONS: definitions leaked, expected %zu/%zu, got %zu/%zu\n",
+                unique_before, refs_before, unique, refs);
+        errors++;
+    }
+
+    fprintf(stderr, "RRDSET DEFINITIONS: %zu errors\n", errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_RRDSET_DEFINITION_H
+#define NETDATA_RRDSET_DEFINITION_H
+
+#include "libnetdata/libnetdata.h"
+#include "rrdset-type.h"
+
+// The immutable part of a chart definition, shared by all charts (of all hosts)
+// that have been defined identically. On parents with thousands of similar children,
+// each unique definition is stored once and every RRDSET just points to it.
+//
+// Definitions are content-addressed: since STRINGs are interned, the tuple of
+// STRING pointers (plus priority and chart type) is the identity of a definition.
+// They are never modified in place; changing a chart's metadata acquires a new
+// definition, publishes it atomically and releases the old one after a grace period,
+// so that readers can use rrdset_definition(st) without locks or references.
+
+typedef struct rrdset_definition {
+    STRING *family;                                 // grouping sets under the same family
+    STRING *title;                                  // title shown to user
+    STRING *units;                                  // units of measurement
+    STRING *context;                                // the template of this data set
+    STRING *plugin_name;                            // the name of the plugin that generated this
+    STRING *module_name;                            // the name of the plugin module that generated this
+    int32_t priority;                               // the sorting priority of this chart
+    RRDSET_TYPE chart_type;                         // line, area, stacked
+} RRDSET_DEFINITION;
+
+// find or add the definition described by key - the STRINGs of the key are consumed
+const RRDSET_DEFINITION *rrdset_definition_acquire(RRDSET_DEFINITION *key);
+
+// release a definition acquired by rrdset_definition_acquire()
+void rrdset_definition_release(const RRDSET_DEFINITION *def);
+
+// release a definition that may still be used by lock-free readers (e.g. one replaced on a live chart),
+// after a grace period
+void rrdset_definition_release_deferred(const RRDSET_DEFINITION *def);
+
+// initialize key with new references to the STRINGs of def, so that it can be modified and acquired
+void rrdset_definition_copy(RRDSET_DEFINITION *key, const RRDSET_DEFINITION *def);
+
+// the number of unique definitions and the number of charts using them
+void rrdset_definition_statistics(size_t *unique, size_t *references);
+
+int rrdset_definition_unittest(void);
+
+#endif //NETDATA_RRDSET_DEFINITION_H
@@ -75,20 +75,22 @@ static void rrdset_insert_callback(const DICTIONARY_ITEM *item __maybe_unused, v
     st->parts.type = string_strdupz(ctr->type);
     st->parts.name = string_strdupz(ctr->name);
 
-    st->family = (ctr->family && *ctr->family) ? rrd_string_strdupz(ctr->family) : rrd_string_strdupz(ctr->type);
-    st->context = (ctr->context && *ctr->context) ? rrd_string_strdupz(ctr->context) : rrd_string_strdupz(chart_full_id);
-
-    st->units = rrd_string_strdupz(ctr->units);
-    st->title = rrd_string_strdupz(ctr->title);
-    st->plugin_name = rrd_string_strdupz(ctr->plugin);
-    st->module_name = rrd_string_strdupz(ctr->module);
-    st->priority = ctr->priority;
+    RRDSET_DEFINITION def = {
+        .family = (ctr->family && *ctr->family) ? rrd_string_strdupz(ctr->family) : rrd_string_strdupz(ctr->type),
+        .context = (ctr->context && *ctr->context) ? rrd_string_strdupz(ctr->context) : rrd_string_strdupz(chart_full_id),
+        .units = rrd_string_strdupz(ctr->units),
+        .title = rrd_string_strdupz(ctr->title),
+        .plugin_name = rrd_string_strdupz(ctr->plugin),
+        .module_name = rrd_string_strdupz(ctr->module),
+        .priority = (int32_t)ctr->priority,
+        .chart_type = ctr->chart_type,
+    };
+    st->def = rrdset_definition_acquire(&def);
 
     st->db.entries = (ctr->memory_mode != RRD_DB_MODE_DBENGINE) ? align_entries_to_pagesize(ctr->memory_mode, ctr->history_entries) : 5;
     st->update_every = ctr->update_every;
     st->rrd_memory_mode = ctr->memory_mode;
 
-    st->chart_type = ctr->chart_type;
     st->rrdhost = host;
 
     rrdset_stream_send_chart_slot_assign(st);
@@ -176,12 +178,7 @@ static void rrdset_delete_callback(const DICTIONARY_ITEM *item __maybe_unused, v
     string_freez(st->parts.id);
     string_freez(st->parts.type);
     string_freez(st->parts.name);
-    string_freez(st->family);
-    string_freez(st->title);
-    string_freez(st->units);
-    string_freez(st->context);
-    string_freez(st->plugin_name);
-    string_freez(st->module_name);
+    rrdset_definition_release(st->def);
 
     freez(st->exporting_flags);
 
@@ -202,67 +199,54 @@ static bool rrdset_conflict_callback(const DICTIONARY_ITEM *item __maybe_unused,
 
     ctr->react_action = RRDSET_REACT_NONE;
 
-    if (unlikely(st->priority != ctr->priority)) {
-        st->priority = ctr->priority;
-        ctr->react_action |= RRDSET_REACT_UPDATED;
-    }
-
     if (unlikely(st->update_every != ctr->update_every)) {
         rrdset_set_update_every_s(st, ctr->update_every);
         ctr->react_action |= RRDSET_REACT_UPDATED;
     }
 
-    if(ctr->plugin && *ctr->plugin) {
-        STRING *old_plugin = st->plugin_name;
-        st->plugin_name = rrd_string_strdupz(ctr->plugin);
-        if (old_plugin != st->plugin_name)
-            ctr->react_action |= RRDSET_REACT_PLUGIN_UPDATED;
-        string_freez(old_plugin);
-    }
-
-    if(ctr->module && *ctr->module) {
-        STRING *old_module = st->module_name;
-        st->module_name = rrd_string_strdupz(ctr->module);
-        if (old_module != st->module_name)
-            ctr->react_action |= RRDSET_REACT_MODULE_UPDATED;
-        string_freez(old_module);
-    }
+    // the definition is shared with other charts, so we never modify it in place;
+    // we prepare a modified copy and we switch to the shared definition matching it
+    RRDSET_DEFINITION def;
+    rrdset_definition_copy(&def, st->def);
 
-    if(ctr->title && *ctr->title) {
-        STRING *old_title = st->title;
-        st->title = rrd_string_strdupz(ctr->title);
-        if(old_title != st->title)
-            ctr->react_action |= RRDSET_REACT_UPDATED;
-        string_freez(old_title);
-    }
-
-    if(ctr->units && *ctr->units) {
-        STRING *old_units = st->units;
-        st->units = rrd_string_strdupz(ctr->units);
-        if(old_units != st->units)
-            ctr->react_action |= RRDSET_REACT_UPDATED;
-        string_freez(old_units);
+    if (unlikely(def.priority != (int32_t)ctr->priority)) {
+        def.priority = (int32_t)ctr->priority;
+        ctr->react_action |= RRDSET_REACT_UPDATED;
     }
 
-    if(ctr->family && *ctr->family) {
-        STRING *old_family = st->family;
-        st->family = rrd_string_strdupz(ctr->family);
-        if(old_family != st->family)
-            ctr->react_action |= RRDSET_REACT_UPDATED;
-        string_freez(old_family);
+#define rrdset_definition_update_string(member, value, action) do {     \
+        if((value) && *(value)) {                                       \
+            STRING *_old = def.member;                                  \
+            def.member = rrd_string_strdupz(value);                     \
+            if(_old != def.member)                                      \
+                ctr->react_action |= (action);                          \
+            string_freez(_old);                                         \
+        }                                                               \
+    } while(0)
+
+    rrdset_definition_update_string(plugin_name, ctr->plugin, RRDSET_REACT_PLUGIN_UPDATED);
+    rrdset_definition_update_string(module_name, ctr->module, RRDSET_REACT_MODULE_UPDATED);
+    rrdset_definition_update_string(title, ctr->title, RRDSET_REACT_UPDATED);
+    rrdset_definition_update_string(units, ctr->units, RRDSET_REACT_UPDATED);
+    rrdset_definition_update_string(family, ctr->family, RRDSET_REACT_UPDATED);
+    rrdset_definition_update_string(context, ctr->context, RRDSET_REACT_UPDATED);
+
+#undef rrdset_definition_update_string
+
+    if(def.chart_type != ctr->chart_type) {
+        def.chart_type = ctr->chart_type;
+        ctr->react_action |= RRDSET_REACT_UPDATED;
     }
 
-    if(ctr->context && *ctr->context) {
-        STRING *old_context = st->context;
-        st->context = rrd_string_strdupz(ctr->context);
-        if(old_context != st->context)
-            ctr->react_action |= RRDSET_REACT_UPDATED;
-        string_freez(old_context);
+    const RRDSET_DEFINITION *new_def = rrdset_definition_acquire(&def);
+    if(new_def == st->def) {
+        // nothing changed - we only need to drop the extra reference we just got
+        rrdset_definition_release(new_def);
     }
-
-    if(st->chart_type != ctr->chart_type) {
-        st->chart_type = ctr->chart_type;
-        ctr->react_action |= RRDSET_REACT_UPDATED;
+    else {
+        // readers use st->def without locks, so the old definition is released after a grace period
+        const RRDSET_DEFINITION *old_def = __atomic_exchange_n(&st->def, new_def, __ATOMIC_ACQ_REL);
+        rrdset_definition_release_deferred(old_def);
     }
 
     rrdset_update_permanent_labels(st);
@@ -298,7 +282,7 @@ static void rrdset_react_callback(const DICTIONARY_ITEM *item __maybe_unused, vo
 
 void rrdset_index_init(RRDHOST *host) {
     if(!host->rrdset_root_index) {
-        host->rrdset_root_index = dictionary_create_advanced(DICT_OPTION_DONT_OVERWRITE_VALUE | DICT_OPTION_FIXED_SIZE,
+        host->rrdset_root_index = dictionary_create_advanced(DICT_OPTION_DONT_OVERWRITE_VALUE | DICT_OPTION_FIXED_SIZE | DICT_OPTION_INDEX_HASHTABLE,
                                                              &dictionary_stats_category_rrdset, sizeof(RRDSET));
 
         dictionary_register_insert_callback(host->rrdset_root_index, rrdset_insert_callback, NULL);
@@ -10,6 +10,7 @@ typedef struct rrdset_acquired RRDSET_ACQUIRED;
 typedef struct ml_chart rrd_ml_chart_t;
 
 #include "rrdset-type.h"
+#include "rrdset-definition.h"
 #include "rrdlabels.h"
 #include "rrd-database-mode.h"
 
@@ -94,22 +95,16 @@ struct rrdset {
 
     STRING *id;                                     // the unique ID of the rrdset as {type}.{id}
     STRING *name;                                   // the unique name of the rrdset as {type}.{name}
-    STRING *family;                                 // grouping sets under the same family
-    STRING *title;                                  // title shown to user
-    STRING *units;                                  // units of measurement
-    STRING *context;                                // the template of this data set
-    STRING *plugin_name;                            // the name of the plugin that generated this
-    STRING *module_name;                            // the name of the plugin module that generated this
-
-    int32_t priority;                               // the sorting priority of this chart
+
+    const RRDSET_DEFINITION *def;                   // family, title, units, context, plugin, module, priority, chart type
+                                                    // shared among all identically defined charts (of all hosts)
+
     int32_t update_every;                           // data collection frequency
 
     RRDLABELS *rrdlabels;                           // chart labels
 
     uint32_t version;                               // the metadata version (auto-increment)
 
-    RRDSET_TYPE chart_type;                         // line, area, stacked
-
     // ------------------------------------------------------------------------
     // operational state members
 
@@ -162,6 +157,7 @@ struct rrdset {
             uint32_t sent_version;
             uint32_t chart_slot;
             uint32_t dim_last_slot_used;
+            uint32_t delta_keyframe_countdown;      // BEGIN2 blocks until the next keyframe (STREAM_CAP_DELTA)
 #ifdef REPLICATION_TRACKING
             REPLAY_WHO who;
 #endif
@@ -236,13 +232,17 @@ struct rrdset {
 
 // --------------------------------------------------------------------------------------------------------------------
 
-#define rrdset_plugin_name(st) string2str((st)->plugin_name)
-#define rrdset_module_name(st) string2str((st)->module_name)
-#define rrdset_units(st) string2str((st)->units)
+// the chart definition may be replaced at any time by the collector,
+// readers load it once and use it for the duration of their call
+#define rrdset_def(st) __atomic_load_n(&(st)->def, __ATOMIC_ACQUIRE)
+
+#define rrdset_plugin_name(st) string2str(rrdset_def(st)->plugin_name)
+#define rrdset_module_name(st) string2str(rrdset_def(st)->module_name)
+#define rrdset_units(st) string2str(rrdset_def(st)->units)
 #define rrdset_parts_type(st) string2str((st)->parts.type)
-#define rrdset_family(st) string2str((st)->family)
-#define rrdset_title(st) string2str((st)->title)
-#define rrdset_context(st) string2str((st)->context)
+#define rrdset_family(st) string2str(rrdset_def(st)->family)
+#define rrdset_title(st) string2str(rrdset_def(st)->title)
+#define rrdset_context(st) string2str(rrdset_def(st)->context)
 #define rrdset_name(st) string2str((st)->name)
 #define rrdset_id(st) string2str((st)->id)
 
@@ -1052,9 +1052,9 @@ static int store_chart_metadata(RRDSET *st, sqlite3_stmt **res)
     SQLITE_BIND_FAIL(done, sqlite3_bind_text(*res, ++param, rrdset_units(st), -1, SQLITE_STATIC));
     SQLITE_BIND_FAIL(done, sqlite3_bind_text(*res, ++param, rrdset_plugin_name(st), -1, SQLITE_STATIC));
     SQLITE_BIND_FAIL(done, sqlite3_bind_text(*res, ++param, rrdset_module_name(st), -1, SQLITE_STATIC));
-    SQLITE_BIND_FAIL(done, sqlite3_bind_int(*res, ++param, (int) st->priority));
+    SQLITE_BIND_FAIL(done, sqlite3_bind_int(*res, ++param, (int) rrdset_def(st)->priority));
     SQLITE_BIND_FAIL(done, sqlite3_bind_int(*res, ++param, st->update_every));
-    SQLITE_BIND_FAIL(done, sqlite3_bind_int(*res, ++param, st->chart_type));
+    SQLITE_BIND_FAIL(done, sqlite3_bind_int(*res, ++param, rrdset_def(st)->chart_type));
     SQLITE_BIND_FAIL(done, sqlite3_bind_int(*res, ++param, st->rrd_memory_mode));
     SQLITE_BIND_FAIL(done, sqlite3_bind_int(*res, ++param, (int) st->db.entries));
 
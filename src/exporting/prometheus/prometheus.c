@@ -654,7 +654,7 @@ static int prometheus_rrdset_to_json(RRDSET *st, void *data)
             if (flags & RRDSET_FLAG_HETEROGENEOUS)
                 homogeneous = 0;
 
-            if (st->module_name == prometheus)
+            if (rrdset_def(st)->module_name == prometheus)
                 prometheus_collector = 1;
         }
         else {
@@ -186,7 +186,7 @@ void health_aggregate_alarms(RRDHOST *host, BUFFER *wb, BUFFER* contexts, RRDCAL
                 if (unlikely(!rrdset_is_available_for_exporting_and_alarms(rc->rrdset)))
                     continue;
                 if(unlikely(rc->rrdset
-                             && rc->rrdset->context == tok_string
+                             && rrdset_def(rc->rrdset)->context == tok_string
                              && ((status==RRDCALC_STATUS_RAISED)?(rc->status >= RRDCALC_STATUS_WARNING):rc->status == status)))
                     numberOfAlarms++;
             }
@@ -175,7 +175,7 @@ inline ALARM_ENTRY* health_create_alarm_entry(
     uint32_t alarm_event_id = rc->next_event_id++;
     STRING *name = rc->config.name;
     STRING *chart = rc->rrdset->id;
-    STRING *chart_context = rc->rrdset->context;
+    STRING *chart_context = rrdset_def(rc->rrdset)->context;
     STRING *chart_name = rc->rrdset->name;
     STRING *class = rc->config.classification;
     STRING *component = rc->config.component;
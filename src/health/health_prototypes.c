@@ -515,7 +515,7 @@ static bool prototype_matches_rrdset(RRDSET *st, RRD_ALERT_PROTOTYPE *ap) {
 
     // match the chart context
     if(ap->match.is_template && ap->match.on.context &&
-        ap->match.on.context != st->context)
+        ap->match.on.context != rrdset_def(st)->context)
         return false;
 
     if (st->rrdlabels && ap->match.chart_labels_pattern &&
@@ -443,7 +443,7 @@ SILENCE_TYPE health_silencers_check_silenced(RRDCALC *rc, const char *host) {
     for (s = silencers->silencers; s!=NULL; s=s->next){
         if (
             (!s->alarms_pattern || (rc->config.name && s->alarms_pattern && simple_pattern_matches_string(s->alarms_pattern, rc->config.name))) &&
-            (!s->contexts_pattern || (rc->rrdset && rc->rrdset->context && s->contexts_pattern && simple_pattern_matches_string(s->contexts_pattern, rc->rrdset->context))) &&
+            (!s->contexts_pattern || (rc->rrdset && rrdset_def(rc->rrdset)->context && s->contexts_pattern && simple_pattern_matches_string(s->contexts_pattern, rrdset_def(rc->rrdset)->context))) &&
             (!s->hosts_pattern || (host && s->hosts_pattern && simple_pattern_matches(s->hosts_pattern, host))) &&
             (!s->charts_pattern || (rc->chart && s->charts_pattern && simple_pattern_matches_string(s->charts_pattern, rc->chart)))
         ) {
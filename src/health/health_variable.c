@@ -425,11 +425,11 @@ log:
                string2str(variable),
                string2str(rc->config.name),
                string2str(rc->rrdset->id),
-               string2str(rc->rrdset->context),
+               rrdset_context(rc->rrdset),
                string2str(rc->rrdset->rrdhost->hostname),
                source,
                string2str(source_st->id),
-               string2str(source_st->context)
+               rrdset_context(source_st)
                );
     }
     else {
@@ -439,7 +439,7 @@ log:
                string2str(variable),
                string2str(rc->config.name),
                string2str(rc->rrdset->id),
-               string2str(rc->rrdset->context),
+               rrdset_context(rc->rrdset),
                string2str(rc->rrdset->rrdhost->hostname)
         );
     }
@@ -448,7 +448,7 @@ log:
     if(unlikely(wb)) {
         buffer_json_member_add_string(wb, "variable", string2str(variable));
         buffer_json_member_add_string(wb, "instance", string2str(st->id));
-        buffer_json_member_add_string(wb, "context", string2str(st->context));
+        buffer_json_member_add_string(wb, "context", string2str(rrdset_def(st)->context));
         buffer_json_member_add_boolean(wb, "found", found);
 
         if (found) {
@@ -457,7 +457,7 @@ log:
             {
                 buffer_json_member_add_string(wb, "description", source);
                 buffer_json_member_add_string(wb, "instance", string2str(source_st->id));
-                buffer_json_member_add_string(wb, "context", string2str(source_st->context));
+                buffer_json_member_add_string(wb, "context", string2str(rrdset_def(source_st)->context));
                 buffer_json_member_add_uint64(wb, "candidates", vbd.result.used ? vbd.result.used : 1);
             }
             buffer_json_object_close(wb); // source
@@ -118,7 +118,7 @@ static STRING *rrdcalc_replace_variables_with_rrdset_labels(const char *line, RR
         pos = m - temp + 1;
 
         if (!strcmp(var, RRDCALC_VAR_FAMILY)) {
-            char *buf = find_and_replace(temp, var, (rc->rrdset && rc->rrdset->family) ? rrdset_family(rc->rrdset) : "", m);
+            char *buf = find_and_replace(temp, var, (rc->rrdset && rrdset_def(rc->rrdset)->family) ? rrdset_family(rc->rrdset) : "", m);
             freez(temp);
             temp = buf;
         }
@@ -320,7 +320,7 @@ static void rrdcalc_rrdhost_insert_callback(const DICTIONARY_ITEM *item __maybe_
     rc->last_status_change = now_realtime_sec();
 
     if(!rc->config.units)
-        rc->config.units = string_dup(st->units);
+        rc->config.units = string_dup(rrdset_def(st)->units);
 
     // the following interferes with replication, changing the alert frequency to unexpected values
     // let's respect user configuration, so we disable it
@@ -266,7 +266,7 @@ void health_api_v1_chart_variables2json(RRDSET *st, BUFFER *wb) {
             tmp = (struct scored) {
                 .existing = false,
                 .chart = string_dup(rc->rrdset->id),
-                .context = string_dup(rc->rrdset->context),
+                .context = string_dup(rrdset_def(rc->rrdset)->context),
                 .value = rc->value,
                 .score = rrdlabels_common_count(rc->rrdset->rrdlabels, st->rrdlabels),
             };
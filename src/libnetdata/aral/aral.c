@@ -41,6 +41,7 @@ typedef struct aral_page {
 
     bool started_marked;
     bool mapped;
+    ND_HUGE_PAGES huge_pages;           // the kind of huge pages backing this page
     uint32_t size;                      // the allocation size of the page
     uint32_t max_elements;              // the number of elements that can fit on this page
     uint64_t elements_segmented;        // fast path for acquiring new elements in this page
@@ -80,6 +81,7 @@ typedef enum {
     ARAL_LOCKLESS           = (1 << 0),
     ARAL_ALLOCATED_STATS    = (1 << 1),
     ARAL_DONT_DUMP          = (1 << 2),
+    ARAL_HUGE_PAGES         = (1 << 3),
 } ARAL_OPTIONS;
 
 struct aral_ops {
@@ -137,6 +139,11 @@ struct aral {
 
     struct aral_ops ops[2];
 
+    struct {
+        uint64_t id;                    // non-zero when the threads cache free elements of this ARAL
+        uint32_t slot;                  // the magazine of the threads this ARAL uses
+    } magazines;
+
     struct aral_statistics *stats;
 };
 
@@ -513,7 +520,11 @@ static ALWAYS_INLINE size_t aral_next_allocation_size___adders_lock_needed(ARAL
         ar->ops[idx].adders.allocation_size = size;
     }
 
-    if(!ar->config.mmap.enabled && aral_malloc_use_mmap(ar, size)) {
+    if(ar->config.options & ARAL_HUGE_PAGES) {
+        // huge pages are allocated whole
+        size = memory_alignment(size, ND_HUGE_PAGE_SIZE);
+    }
+    else if(!ar->config.mmap.enabled && aral_malloc_use_mmap(ar, size)) {
         // when doing malloc, don't allocate entire pages, but only what needed
         size =
             aral_elements_in_page_size(ar, size) * ar->config.element_size +
@@ -527,6 +538,28 @@ static ALWAYS_INLINE size_t aral_next_allocation_size___adders_lock_needed(ARAL
 
 // --------------------------------------------------------------------------------------------------------------------
 
+static ALWAYS_INLINE void aral_huge_pages_account(ARAL *ar, ARAL_PAGE *page, bool added) {
+    size_t *bytes;
+
+    switch(page->huge_pages) {
+        case ND_HUGE_PAGES_HUGETLB:
+            bytes = &ar->stats->huge_pages.hugetlb_bytes;
+            break;
+
+        case ND_HUGE_PAGES_THP:
+            bytes = &ar->stats->huge_pages.thp_bytes;
+            break;
+
+        default:
+            return;
+    }
+
+    if(added)
+        __atomic_add_fetch(bytes, page->size, __ATOMIC_RELAXED);
+    else
+        __atomic_sub_fetch(bytes, page->size, __ATOMIC_RELAXED);
+}
+
 static ARAL_PAGE *aral_create_page___no_lock_needed(ARAL *ar, size_t size TRACE_ALLOCATIONS_FUNCTION_DEFINITION_PARAMS) {
     struct aral_page_type_stats *stats;
     ARAL_PAGE *page;
@@ -562,10 +595,16 @@ static ARAL_PAGE *aral_create_page___no_lock_needed(ARAL *ar, size_t size TRACE_
     else {
         size_t ARAL_PAGE_size = memory_alignment(sizeof(ARAL_PAGE), SYSTEM_REQUIRED_ALIGNMENT);
 
-        if (aral_malloc_use_mmap(ar, size)) {
+        if ((ar->config.options & ARAL_HUGE_PAGES) || aral_malloc_use_mmap(ar, size)) {
             bool mapped;
-            uint8_t *ptr =
-                nd_mmap_advanced(NULL, size, MAP_ANONYMOUS | MAP_PRIVATE, 1, false, ar->config.options & ARAL_DONT_DUMP, NULL);
+            ND_HUGE_PAGES huge_pages = ND_HUGE_PAGES_NONE;
+            uint8_t *ptr;
+
+            if(ar->config.options & ARAL_HUGE_PAGES)
+                ptr = nd_mmap_huge(size, ar->config.options & ARAL_DONT_DUMP, &huge_pages);
+            else
+                ptr = nd_mmap_advanced(NULL, size, MAP_ANONYMOUS | MAP_PRIVATE, 1, false, ar->config.options & ARAL_DONT_DUMP, NULL);
+
             if (ptr) {
                 mapped = true;
                 stats = &ar->stats->mmap;
@@ -579,6 +618,7 @@ static ARAL_PAGE *aral_create_page___no_lock_needed(ARAL *ar, size_t size TRACE_
             memset(page, 0, ARAL_PAGE_size);
             page->data = &ptr[ARAL_PAGE_size];
             page->mapped = mapped;
+            page->huge_pages = huge_pages;
         }
         else {
             uint8_t *ptr = mallocz(size);
@@ -614,6 +654,8 @@ static ARAL_PAGE *aral_create_page___no_lock_needed(ARAL *ar, size_t size TRACE_
     __atomic_add_fetch(&ar->stats->structures.allocations, 1, __ATOMIC_RELAXED);
     __atomic_add_fetch(&ar->stats->structures.allocated_bytes, structures_size, __ATOMIC_RELAXED);
 
+    aral_huge_pages_account(ar, page, true);
+
     // Initialize elements_segmented last with RELEASE
     __atomic_store_n(&page->elements_segmented, 0, __ATOMIC_RELEASE);
 
@@ -624,6 +666,8 @@ static void aral_del_page___no_lock_needed(ARAL *ar, ARAL_PAGE *page TRACE_ALLOC
     size_t idx = mark_to_idx(page->started_marked);
     __atomic_store_n(&ar->ops[idx].atomic.last_allocated_page, false, __ATOMIC_RELAXED);
 
+    aral_huge_pages_account(ar, page, false);
+
     struct aral_page_type_stats *stats;
     size_t max_elements = page->max_elements;
     size_t size = page->size;
@@ -913,6 +957,212 @@ static inline void aral_add_free_slot___no_lock_required(ARAL *ar, ARAL_PAGE *pa
     }
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// per thread magazines
+//
+// Each thread keeps a small LIFO cache (a magazine) of the elements it freed, for the ARALs
+// that have magazines enabled, and serves its next allocations from it without touching
+// the shared pages and their locks. When a magazine is full, half of it is returned to
+// the pages. The elements in the magazines are accounted as free, but they keep their
+// pages allocated, until the thread allocates them again, or exits.
+//
+// Each ARAL with magazines owns one of a few global slots, and the magazines of a thread are
+// indexed by that slot, so ARALs never share a magazine. When there are no free slots, the ARAL
+// works without magazines. A slot is given to another ARAL only after its ARAL is destroyed,
+// and the ids are never reused, so a magazine of a destroyed ARAL is detected and dropped
+// without any lookup.
+
+#if !defined(FSANITIZE_ADDRESS) && !defined(NETDATA_TRACE_ALLOCATIONS)
+#define ARAL_WITH_MAGAZINES 1
+#endif
+
+#define ARAL_MAGAZINE_SIZE 32                   // the elements a magazine can cache
+#define ARAL_THREAD_MAGAZINES 16                // the magazines of each thread
+#define ARAL_MAGAZINE_STATS_EVERY 256           // publish the hits and misses of a thread every so many operations
+
+typedef struct aral_magazine {
+    uint64_t id;                                // the id of the ARAL the elements belong to
+    uint32_t used;
+    uint32_t hits;
+    uint32_t misses;
+    void *elements[ARAL_MAGAZINE_SIZE];
+} ARAL_MAGAZINE;
+
+typedef struct aral_magazine_slot {
+    SPINLOCK spinlock;                          // taken only by the threads that exit, and the ARAL that is destroyed
+    uint64_t id;                                // the id of the ARAL owning the slot, zero when free
+    ARAL *ar;
+} ARAL_MAGAZINE_SLOT;
+
+static struct {
+    SPINLOCK spinlock;                          // serializes giving slots to ARALs
+    uint64_t last_id;
+    ARAL_MAGAZINE_SLOT slots[ARAL_THREAD_MAGAZINES];
+} aral_magazines_globals = {
+    .spinlock = SPINLOCK_INITIALIZER,
+};
+
+static void aral_freez_to_page(ARAL *ar, ARAL_PAGE *page, void *ptr, bool marked TRACE_ALLOCATIONS_FUNCTION_DEFINITION_PARAMS);
+
+#ifdef ARAL_WITH_MAGAZINES
+static __thread ARAL_MAGAZINE aral_thread_magazines[ARAL_THREAD_MAGAZINES];
+
+static void aral_magazine_publish_stats(ARAL *ar, ARAL_MAGAZINE *m) {
+    if(m->hits)
+        __atomic_add_fetch(&ar->stats->magazines.hits, m->hits, __ATOMIC_RELAXED);
+
+    if(m->misses)
+        __atomic_add_fetch(&ar->stats->magazines.misses, m->misses, __ATOMIC_RELAXED);
+
+    m->hits = m->misses = 0;
+}
+
+// return elements of a magazine to the pages of its ARAL
+static void aral_magazine_flush(ARAL *ar, ARAL_MAGAZINE *m, uint32_t elements) {
+    if(elements > m->used)
+        elements = m->used;
+
+    for(uint32_t i = 0; i < elements ;i++) {
+        void *ptr = m->elements[--m->used];
+
+        bool marked;
+        ARAL_PAGE *page = aral_get_page_pointer_after_element___do_NOT_have_aral_lock(ar, ptr, &marked);
+
+        // aral_freez_to_page() will account it as returned, again
+        aral_element_given(ar, page);
+        aral_freez_to_page(ar, page, ptr, marked);
+    }
+
+    __atomic_add_fetch(&ar->stats->magazines.flushes, elements, __ATOMIC_RELAXED);
+}
+
+static void aral_magazine_reset(ARAL_MAGAZINE *m, uint64_t id) {
+    m->id = id;
+    m->used = 0;
+    m->hits = m->misses = 0;
+}
+
+// return all the elements of a magazine to its ARAL, if it still exists
+static void aral_magazine_release(ARAL_MAGAZINE *m, ARAL_MAGAZINE_SLOT *slot) {
+    if(!m->id)
+        return;
+
+    spinlock_lock(&slot->spinlock);
+
+    if(slot->id == m->id) {
+        aral_magazine_flush(slot->ar, m, m->used);
+        aral_magazine_publish_stats(slot->ar, m);
+    }
+
+    spinlock_unlock(&slot->spinlock);
+
+    aral_magazine_reset(m, 0);
+}
+
+static ALWAYS_INLINE ARAL_MAGAZINE *aral_thread_magazine(ARAL *ar) {
+    ARAL_MAGAZINE *m = &aral_thread_magazines[ar->magazines.slot];
+
+    if(unlikely(m->id != ar->magazines.id)) {
+        // the ARAL it had is destroyed, and its elements with it
+        aral_magazine_reset(m, ar->magazines.id);
+    }
+
+    return m;
+}
+
+static ALWAYS_INLINE void *aral_magazine_pop(ARAL *ar) {
+    ARAL_MAGAZINE *m = aral_thread_magazine(ar);
+
+    void *ptr = NULL;
+    if(likely(m->used)) {
+        ptr = m->elements[--m->used];
+
+        bool marked;
+        ARAL_PAGE *page = aral_get_page_pointer_after_element___do_NOT_have_aral_lock(ar, ptr, &marked);
+        aral_element_given(ar, page);
+        m->hits++;
+    }
+    else
+        m->misses++;
+
+    if(unlikely(m->hits + m->misses >= ARAL_MAGAZINE_STATS_EVERY))
+        aral_magazine_publish_stats(ar, m);
+
+    return ptr;
+}
+
+static ALWAYS_INLINE void aral_magazine_push(ARAL *ar, ARAL_PAGE *page, void *ptr) {
+    ARAL_MAGAZINE *m = aral_thread_magazine(ar);
+
+    // the caller uses the ARAL, so it cannot be destroyed while we flush
+    if(unlikely(m->used == ARAL_MAGAZINE_SIZE))
+        aral_magazine_flush(ar, m, ARAL_MAGAZINE_SIZE / 2);
+
+    m->elements[m->used++] = ptr;
+    aral_element_returned(ar, page);
+}
+#endif
+
+void aral_thread_magazines_release(void) {
+#ifdef ARAL_WITH_MAGAZINES
+    for(size_t i = 0; i < ARAL_THREAD_MAGAZINES ;i++)
+        aral_magazine_release(&aral_thread_magazines[i], &aral_magazines_globals.slots[i]);
+#endif
+}
+
+void aral_magazines_enable(ARAL *ar) {
+#ifdef ARAL_WITH_MAGAZINES
+    if(ar->config.options & ARAL_LOCKLESS)
+        return;
+
+    spinlock_lock(&aral_magazines_globals.spinlock);
+    if(!ar->magazines.id) {
+        size_t i;
+        for(i = 0; i < ARAL_THREAD_MAGAZINES ;i++) {
+            ARAL_MAGAZINE_SLOT *slot = &aral_magazines_globals.slots[i];
+            if(slot->id)
+                continue;
+
+            spinlock_lock(&slot->spinlock);
+            slot->id = ++aral_magazines_globals.last_id;
+            slot->ar = ar;
+            spinlock_unlock(&slot->spinlock);
+
+            ar->magazines.slot = i;
+            ar->magazines.id = slot->id;
+            break;
+        }
+
+        if(i == ARAL_THREAD_MAGAZINES) {
+            nd_log_limit_static_global_var(erl, 3600, 0);
+            nd_log_limit(&erl, NDLS_DAEMON, NDLP_NOTICE,
+                         "ARAL: no free magazine slots for '%s', it will work without magazines",
+                         ar->config.name);
+        }
+    }
+    spinlock_unlock(&aral_magazines_globals.spinlock);
+#else
+    (void)ar;
+#endif
+}
+
+static void aral_magazines_disable(ARAL *ar) {
+    spinlock_lock(&aral_magazines_globals.spinlock);
+    if(ar->magazines.id) {
+        ARAL_MAGAZINE_SLOT *slot = &aral_magazines_globals.slots[ar->magazines.slot];
+
+        // wait for the threads that return elements to this ARAL while they exit
+        spinlock_lock(&slot->spinlock);
+        slot->id = 0;
+        slot->ar = NULL;
+        spinlock_unlock(&slot->spinlock);
+
+        ar->magazines.id = 0;
+        ar->magazines.slot = 0;
+    }
+    spinlock_unlock(&aral_magazines_globals.spinlock);
+}
+
 ALWAYS_INLINE void *aral_callocz_internal(ARAL *ar, bool marked TRACE_ALLOCATIONS_FUNCTION_DEFINITION_PARAMS) {
     void *r = aral_mallocz_internal(ar, marked TRACE_ALLOCATIONS_FUNCTION_CALL_PARAMS);
     memset(r, 0, ar->config.requested_element_size);
@@ -929,6 +1179,14 @@ void *aral_mallocz_internal(ARAL *ar, bool marked TRACE_ALLOCATIONS_FUNCTION_DEF
     return mallocz(ar->config.requested_element_size);
 #endif
 
+#ifdef ARAL_WITH_MAGAZINES
+    if(ar->magazines.id && !marked) {
+        void *ptr = aral_magazine_pop(ar);
+        if(ptr)
+            return ptr;
+    }
+#endif
+
     // reserve a slot on a free page
     ARAL_PAGE *page = aral_get_first_page_with_a_free_slot(ar, marked TRACE_ALLOCATIONS_FUNCTION_CALL_PARAMS);
     // the page returned has reserved a slot for us
@@ -998,6 +1256,17 @@ void aral_freez_internal(ARAL *ar, void *ptr TRACE_ALLOCATIONS_FUNCTION_DEFINITI
     bool marked;
     ARAL_PAGE *page = aral_get_page_pointer_after_element___do_NOT_have_aral_lock(ar, ptr, &marked);
 
+#ifdef ARAL_WITH_MAGAZINES
+    if(ar->magazines.id && !marked) {
+        aral_magazine_push(ar, page, ptr);
+        return;
+    }
+#endif
+
+    aral_freez_to_page(ar, page, ptr, marked TRACE_ALLOCATIONS_FUNCTION_CALL_PARAMS);
+}
+
+static void aral_freez_to_page(ARAL *ar, ARAL_PAGE *page, void *ptr, bool marked TRACE_ALLOCATIONS_FUNCTION_DEFINITION_PARAMS) {
     size_t idx = mark_to_idx(marked);
     __atomic_add_fetch(&ar->ops[idx].atomic.deallocators, 1, __ATOMIC_RELAXED);
 
@@ -1113,6 +1382,9 @@ void aral_freez_internal(ARAL *ar, void *ptr TRACE_ALLOCATIONS_FUNCTION_DEFINITI
 }
 
 void aral_destroy_internal(ARAL *ar TRACE_ALLOCATIONS_FUNCTION_DEFINITION_PARAMS) {
+    // the magazines of the threads will drop its elements
+    aral_magazines_disable(ar);
+
     aral_lock(ar);
 
     ARAL_PAGE **head_ptr = aral_pages_head_free(ar, false);
@@ -1177,6 +1449,9 @@ static size_t aral_max_allocation_size(ARAL *ar) {
     if(size < ar->config.min_required_page_size)
         size = ar->config.min_required_page_size;
 
+    if(ar->config.options & ARAL_HUGE_PAGES)
+        size = memory_alignment(size, ND_HUGE_PAGE_SIZE);
+
     return size;
 }
 
@@ -1288,6 +1563,18 @@ ARAL *aral_create(const char *name, size_t element_size, size_t initial_page_ele
     return ar;
 }
 
+void aral_huge_pages_enable(ARAL *ar) {
+#if !defined(FSANITIZE_ADDRESS) && !defined(NETDATA_TRACE_ALLOCATIONS)
+    // file backed pages cannot use huge pages
+    if(ar->config.mmap.enabled)
+        return;
+
+    ar->config.options |= ARAL_HUGE_PAGES;
+#else
+    (void)ar;
+#endif
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // global aral caching
 
@@ -23,6 +23,17 @@ struct aral_statistics {
 
     struct aral_page_type_stats malloc;
     struct aral_page_type_stats mmap;
+
+    struct {
+        PAD64(size_t) hits;             // allocations served by the magazines of the threads
+        PAD64(size_t) misses;           // allocations that found the magazine of the thread empty
+        PAD64(size_t) flushes;          // elements returned by the magazines to the pages
+    } magazines;
+
+    struct {
+        PAD64(size_t) hugetlb_bytes;    // pages backed by explicit huge pages
+        PAD64(size_t) thp_bytes;        // pages advised to use transparent huge pages
+    } huge_pages;
 };
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -95,6 +106,18 @@ struct aral_statistics *aral_by_size_statistics(void);
 
 // --------------------------------------------------------------------------------------------------------------------
 
+// let the threads cache the elements they free, to allocate them again without locking
+void aral_magazines_enable(ARAL *ar);
+
+// return the elements cached by the calling thread - to be called when a thread exits
+void aral_thread_magazines_release(void);
+
+// allocate the pages from 2 MiB huge pages, falling back to normal pages when they are not available
+// it should be called before the first allocation, and it is ignored for file backed ARALs
+void aral_huge_pages_enable(ARAL *ar);
+
+// --------------------------------------------------------------------------------------------------------------------
+
 #ifdef NETDATA_TRACE_ALLOCATIONS
 
 #define aral_callocz(ar) aral_callocz_internal(ar, false, __FILE__, __FUNCTION__, __LINE__)
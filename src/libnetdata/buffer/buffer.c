@@ -293,10 +293,49 @@ void buffer_free(BUFFER *b) {
     if(b->statistics)
         __atomic_sub_fetch(b->statistics, b->size + sizeof(BUFFER) + sizeof(BUFFER_OVERFLOW_EOF) + 2, __ATOMIC_RELAXED);
 
-    freez(b->buffer);
+    if(b->mmapped)
+        nd_munmap(b->buffer, b->size + sizeof(BUFFER_OVERFLOW_EOF) + 2);
+    else
+        freez(b->buffer);
+
     freez(b);
 }
 
+// Large buffers (e.g. multi-megabyte API responses) are moved to a private anonymous
+// mapping, which is then grown with mremap(). The kernel moves the pages to the new
+// size, so growing them never copies the data already in them, as realloc() may do.
+#define BUFFER_MMAP_MIN_SIZE (1024 * 1024)
+
+static bool buffer_increase_mmap(BUFFER *b, size_t size) {
+#if defined(MREMAP_MAYMOVE)
+    size_t old_alloc = b->size + sizeof(BUFFER_OVERFLOW_EOF) + 2;
+    size_t alloc = memory_alignment(size + sizeof(BUFFER_OVERFLOW_EOF) + 2, os_get_system_page_size());
+    char *p;
+
+    if(b->mmapped) {
+        p = nd_mremap(b->buffer, old_alloc, alloc);
+        if(p == MAP_FAILED)
+            return false;
+    }
+    else {
+        p = nd_mmap(NULL, alloc, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(p == MAP_FAILED)
+            return false;
+
+        // the last copy of this buffer
+        memcpy(p, b->buffer, b->len + 1);
+        freez(b->buffer);
+        b->mmapped = true;
+    }
+
+    b->buffer = p;
+    return true;
+#else
+    (void)b; (void)size;
+    return false;
+#endif
+}
+
 void buffer_increase(BUFFER *b, size_t free_size_required) {
     buffer_overflow_check(b);
 
@@ -312,8 +351,18 @@ void buffer_increase(BUFFER *b, size_t free_size_required) {
 
     netdata_log_debug(D_WEB_BUFFER, "Increasing data buffer from size %zu to %zu.", (size_t)b->size, (size_t)(b->size + increase));
 
-    b->buffer = reallocz(b->buffer, b->size + increase + sizeof(BUFFER_OVERFLOW_EOF) + 2);
-    b->size += increase;
+    size_t size = b->size + increase;
+    if(size >= BUFFER_MMAP_MIN_SIZE && buffer_increase_mmap(b, size)) {
+        // use all the pages we got
+        size = memory_alignment(size + sizeof(BUFFER_OVERFLOW_EOF) + 2, os_get_system_page_size()) - sizeof(BUFFER_OVERFLOW_EOF) - 2;
+        increase = size - b->size;
+    }
+    else if(b->mmapped)
+        fatal("BUFFER: cannot grow the mapping of a buffer from %zu to %zu bytes", (size_t)b->size, size);
+    else
+        b->buffer = reallocz(b->buffer, size + sizeof(BUFFER_OVERFLOW_EOF) + 2);
+
+    b->size = size;
 
     if(b->statistics)
         __atomic_add_fetch(b->statistics, increase, __ATOMIC_RELAXED);
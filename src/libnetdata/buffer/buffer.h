@@ -58,6 +58,7 @@ typedef struct web_buffer {
     HTTP_CONTENT_TYPE content_type;    // the content type of the data in the buffer
     BUFFER_OPTIONS options; // options related to the content
     uint16_t response_code;
+    bool mmapped;           // the buffer is a private mapping, grown with mremap() instead of realloc()
     time_t date;            // the timestamp this content has been generated
     time_t expires;         // the timestamp this content expires
     size_t *statistics;
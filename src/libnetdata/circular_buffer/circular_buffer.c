@@ -142,6 +142,26 @@ size_t cbuffer_next_unsafe(struct circular_buffer *buf, char **start) {
     return buf->size - buf->read;
 }
 
+// like cbuffer_next_unsafe(), but when the data wrap around the end of the buffer,
+// the second part is returned too, so that both can be written with one writev()
+size_t cbuffer_next_iovec_unsafe(struct circular_buffer *buf, struct iovec iov[2], int *iovcnt) {
+    char *start;
+    size_t len = cbuffer_next_unsafe(buf, &start);
+
+    iov[0].iov_base = start;
+    iov[0].iov_len = len;
+    *iovcnt = len ? 1 : 0;
+
+    if (buf->read > buf->write && buf->write) {
+        iov[1].iov_base = buf->data;
+        iov[1].iov_len = buf->write;
+        *iovcnt = 2;
+        len += buf->write;
+    }
+
+    return len;
+}
+
 ALWAYS_INLINE
 void cbuffer_flush(struct circular_buffer*buf) {
     buf->write = 0;
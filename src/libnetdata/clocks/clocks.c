@@ -368,6 +368,12 @@ inline void heartbeat_init(heartbeat_t *hb, usec_t step) {
 // it waits using the monotonic clock
 // it returns the dt using the realtime clock
 
+static heartbeat_before_sleep_cb_t heartbeat_before_sleep_cb = NULL;
+
+void heartbeat_set_before_sleep_callback(heartbeat_before_sleep_cb_t cb) {
+    __atomic_store_n(&heartbeat_before_sleep_cb, cb, __ATOMIC_RELEASE);
+}
+
 usec_t heartbeat_next(heartbeat_t *hb) {
     usec_t tick = hb->step;
 
@@ -379,6 +385,11 @@ usec_t heartbeat_next(heartbeat_t *hb) {
     if(next % clock_realtime_resolution)
         next = next - (next % clock_realtime_resolution) + clock_realtime_resolution;
 
+    // let the thread hand over any work it has accumulated, before sleeping
+    heartbeat_before_sleep_cb_t cb = __atomic_load_n(&heartbeat_before_sleep_cb, __ATOMIC_ACQUIRE);
+    if(cb)
+        cb();
+
     // sleep_usec() has a loop to guarantee we will sleep for at least the requested time.
     // According to the specs, when we sleep for a relative time, clock adjustments should
     // not affect the duration we sleep.
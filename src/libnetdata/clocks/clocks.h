@@ -149,6 +149,10 @@ void heartbeat_init(heartbeat_t *hb, usec_t step);
  */
 usec_t heartbeat_next(heartbeat_t *hb);
 
+// called by heartbeat_next() on the calling thread, just before it sleeps
+typedef void (*heartbeat_before_sleep_cb_t)(void);
+void heartbeat_set_before_sleep_callback(heartbeat_before_sleep_cb_t cb);
+
 void heartbeat_statistics(usec_t *min_ptr, usec_t *max_ptr, usec_t *average_ptr, size_t *count_ptr);
 
 void sleep_usec_with_now(usec_t usec, usec_t started_ut);
@@ -6,98 +6,265 @@
 #include "dictionary-internals.h"
 
 // ----------------------------------------------------------------------------
-// hashtable operations with simple hashtable
-
-//static inline bool compare_keys(void *key1, void *key2) {
-//    const char *k1 = key1;
-//    const char *k2 = key2;
-//    return strcmp(k1, k2) == 0;
-//}
-//
-//static inline void *item_to_key(DICTIONARY_ITEM *item) {
-//    return (void *)item_get_name(item);
-//}
-//
-//#define SIMPLE_HASHTABLE_VALUE_TYPE DICTIONARY_ITEM
-//#define SIMPLE_HASHTABLE_NAME _DICTIONARY
-//#define SIMPLE_HASHTABLE_VALUE2KEY_FUNCTION item_to_key
-//#define SIMPLE_HASHTABLE_COMPARE_KEYS_FUNCTION compare_keys
-//#include "..//simple_hashtable.h"
-
-//static inline size_t hashtable_init_hashtable(DICTIONARY *dict) {
-//    SIMPLE_HASHTABLE_DICTIONARY *ht = callocz(1, sizeof(*ht));
-//    simple_hashtable_init_DICTIONARY(ht, 4);
-//    dict->index.JudyHSArray = ht;
-//    return 0;
-//}
-//
-//static inline size_t hashtable_destroy_hashtable(DICTIONARY *dict) {
-//    SIMPLE_HASHTABLE_DICTIONARY *ht = dict->index.JudyHSArray;
-//    if(unlikely(!ht)) return 0;
-//
-//    size_t mem = sizeof(*ht) + ht->size * sizeof(SIMPLE_HASHTABLE_SLOT_DICTIONARY);
-//    simple_hashtable_destroy_DICTIONARY(ht);
-//    freez(ht);
-//    dict->index.JudyHSArray = NULL;
-//
-//    return mem;
-//}
-//
-//static inline void *hashtable_insert_hashtable(DICTIONARY *dict, const char *name, size_t name_len) {
-//    SIMPLE_HASHTABLE_DICTIONARY *ht = dict->index.JudyHSArray;
-//
-//    char key[name_len+1];
-//    memcpy(key, name, name_len);
-//    key[name_len] = '\0';
-//
-//    XXH64_hash_t hash = XXH3_64bits(name, name_len);
-//    SIMPLE_HASHTABLE_SLOT_DICTIONARY *sl = simple_hashtable_get_slot_DICTIONARY(ht, hash, key, true);
-//    sl->hash = hash; // we will need it in insert later - it is ok to overwrite - it is the same already
-//    return sl;
-//}
-//
-//static inline DICTIONARY_ITEM *hashtable_insert_handle_to_item_hashtable(DICTIONARY *dict, void *handle) {
-//    (void)dict;
-//    SIMPLE_HASHTABLE_SLOT_DICTIONARY *sl = handle;
-//    DICTIONARY_ITEM *item = SIMPLE_HASHTABLE_SLOT_DATA(sl);
-//    return item;
-//}
-//
-//static inline void hashtable_set_item_hashtable(DICTIONARY *dict, void *handle, DICTIONARY_ITEM *item) {
-//    SIMPLE_HASHTABLE_DICTIONARY *ht = dict->index.JudyHSArray;
-//    SIMPLE_HASHTABLE_SLOT_DICTIONARY *sl = handle;
-//    simple_hashtable_set_slot_DICTIONARY(ht, sl, sl->hash, item);
-//}
-//
-//static inline int hashtable_delete_hashtable(DICTIONARY *dict, const char *name, size_t name_len, DICTIONARY_ITEM *item_to_delete) {
-//    (void)item_to_delete;
-//    SIMPLE_HASHTABLE_DICTIONARY *ht = dict->index.JudyHSArray;
+// hashtable operations with an open addressing hash table (swiss table)
 //
-//    char key[name_len+1];
-//    memcpy(key, name, name_len);
-//    key[name_len] = '\0';
-//
-//    XXH64_hash_t hash = XXH3_64bits(name, name_len);
-//    SIMPLE_HASHTABLE_SLOT_DICTIONARY *sl = simple_hashtable_get_slot_DICTIONARY(ht, hash, key, false);
-//    DICTIONARY_ITEM *item = SIMPLE_HASHTABLE_SLOT_DATA(sl);
-//    if(!item) return 0; // return not-found
-//
-//    simple_hashtable_del_slot_DICTIONARY(ht, sl);
-//    return 1; // return deleted
-//}
-//
-//static inline DICTIONARY_ITEM *hashtable_get_hashtable(DICTIONARY *dict, const char *name, size_t name_len) {
-//    SIMPLE_HASHTABLE_DICTIONARY *ht = dict->index.JudyHSArray;
-//    if(unlikely(!ht)) return NULL;
-//
-//    char key[name_len+1];
-//    memcpy(key, name, name_len);
-//    key[name_len] = '\0';
-//
-//    XXH64_hash_t hash = XXH3_64bits(name, name_len);
-//    SIMPLE_HASHTABLE_SLOT_DICTIONARY *sl = simple_hashtable_get_slot_DICTIONARY(ht, hash, key, true);
-//    return SIMPLE_HASHTABLE_SLOT_DATA(sl);
-//}
+// The slots are organized in groups of 16. Each slot has a control byte, which is
+// either EMPTY, DELETED, or the low 7 bits of the hash of the item in the slot.
+// A lookup selects a group with the rest of the hash and compares all 16 control
+// bytes of it at once, so it touches the item of a slot only when its 7 bits match.
+// The groups are probed with triangular steps, which visit all the groups of a
+// power of 2 table. A lookup stops at the first group with an EMPTY slot.
+
+#define DICT_HT_GROUP_SLOTS 16
+#define DICT_HT_CTRL_EMPTY ((uint8_t)0x80)
+#define DICT_HT_CTRL_DELETED ((uint8_t)0xFE)
+#define dict_ht_h1(hash) ((hash) >> 7)
+#define dict_ht_h2(hash) ((uint8_t)((hash) & 0x7F))
+
+struct dict_hashtable {
+    uint8_t *ctrl;                      // the control bytes of the slots
+    DICTIONARY_ITEM **items;            // the items of the slots
+    uint32_t groups;                    // the number of groups, a power of 2
+    uint32_t used;                      // the slots with items
+    uint32_t deleted;                   // the slots marked DELETED
+};
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+// a bitmap of the slots of the group that have this control byte
+static inline uint32_t dict_ht_group_match(const uint8_t *ctrl, uint8_t byte) {
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+}
+
+// a bitmap of the slots of the group that are EMPTY or DELETED
+static inline uint32_t dict_ht_group_match_free(const uint8_t *ctrl) {
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+}
+#else
+// the same with 64-bit words, 8 control bytes at a time
+static inline uint32_t dict_ht_word_to_bitmap(uint64_t highbits) {
+    // one bit per byte, from the high bit of each byte
+    uint32_t bitmap = 0;
+    for(int i = 0; i < 8 ; i++)
+        if(highbits & (0x80ULL << (i * 8)))
+            bitmap |= (1U << i);
+    return bitmap;
+}
+
+static inline uint32_t dict_ht_group_match(const uint8_t *ctrl, uint8_t byte) {
+    uint32_t bitmap = 0;
+    for(int w = 0; w < 2 ; w++) {
+        uint64_t v;
+        memcpy(&v, &ctrl[w * 8], sizeof(v));
+        v ^= 0x0101010101010101ULL * byte;
+
+        // the bytes that are zero now, matched (this may report false positives after
+        // a true match, which the caller filters out by comparing the keys)
+        uint64_t zero = (v - 0x0101010101010101ULL) & ~v & 0x8080808080808080ULL;
+        bitmap |= dict_ht_word_to_bitmap(zero) << (w * 8);
+    }
+    return bitmap;
+}
+
+static inline uint32_t dict_ht_group_match_free(const uint8_t *ctrl) {
+    uint32_t bitmap = 0;
+    for(int w = 0; w < 2 ; w++) {
+        uint64_t v;
+        memcpy(&v, &ctrl[w * 8], sizeof(v));
+        bitmap |= dict_ht_word_to_bitmap(v & 0x8080808080808080ULL) << (w * 8);
+    }
+    return bitmap;
+}
+#endif
+
+static inline size_t dict_ht_memory(uint32_t groups) {
+    return sizeof(struct dict_hashtable) +
+           (size_t)groups * DICT_HT_GROUP_SLOTS * (sizeof(uint8_t) + sizeof(DICTIONARY_ITEM *));
+}
+
+static inline void dict_ht_allocate(struct dict_hashtable *ht, uint32_t groups) {
+    size_t slots = (size_t)groups * DICT_HT_GROUP_SLOTS;
+    ht->ctrl = mallocz(slots);
+    memset(ht->ctrl, DICT_HT_CTRL_EMPTY, slots);
+    ht->items = callocz(slots, sizeof(DICTIONARY_ITEM *));
+    ht->groups = groups;
+    ht->used = 0;
+    ht->deleted = 0;
+}
+
+static inline bool dict_ht_item_matches(DICTIONARY_ITEM *item, const char *name, size_t name_len) {
+    return item && item->key_len == name_len && memcmp(item_get_name(item), name, name_len) == 0;
+}
+
+// find the slot of a key, or UINT32_MAX
+static inline uint32_t dict_ht_find(struct dict_hashtable *ht, XXH64_hash_t hash, const char *name, size_t name_len) {
+    uint32_t mask = ht->groups - 1;
+    uint32_t g = (uint32_t)dict_ht_h1(hash) & mask;
+    uint8_t h2 = dict_ht_h2(hash);
+
+    for(uint32_t step = 1; step <= ht->groups ; step++) {
+        const uint8_t *ctrl = &ht->ctrl[(size_t)g * DICT_HT_GROUP_SLOTS];
+
+        uint32_t match = dict_ht_group_match(ctrl, h2);
+        while(match) {
+            uint32_t slot = g * DICT_HT_GROUP_SLOTS + (uint32_t)__builtin_ctz(match);
+            if(likely(dict_ht_item_matches(ht->items[slot], name, name_len)))
+                return slot;
+
+            match &= match - 1;
+        }
+
+        if(likely(dict_ht_group_match(ctrl, DICT_HT_CTRL_EMPTY)))
+            break;
+
+        g = (g + step) & mask;
+    }
+
+    return UINT32_MAX;
+}
+
+// the first EMPTY or DELETED slot on the probe sequence of a hash
+// the caller has to make sure the table has free slots
+static inline uint32_t dict_ht_find_free(struct dict_hashtable *ht, XXH64_hash_t hash) {
+    uint32_t mask = ht->groups - 1;
+    uint32_t g = (uint32_t)dict_ht_h1(hash) & mask;
+
+    for(uint32_t step = 1; ; step++) {
+        uint32_t match = dict_ht_group_match_free(&ht->ctrl[(size_t)g * DICT_HT_GROUP_SLOTS]);
+        if(match)
+            return g * DICT_HT_GROUP_SLOTS + (uint32_t)__builtin_ctz(match);
+
+        g = (g + step) & mask;
+    }
+}
+
+// rebuild the table with the given number of groups, dropping the DELETED slots
+static inline void dict_ht_resize(DICTIONARY *dict, struct dict_hashtable *ht, uint32_t groups) {
+    uint8_t *old_ctrl = ht->ctrl;
+    DICTIONARY_ITEM **old_items = ht->items;
+    size_t old_slots = (size_t)ht->groups * DICT_HT_GROUP_SLOTS;
+    size_t old_memory = dict_ht_memory(ht->groups);
+
+    dict_ht_allocate(ht, groups);
+
+    for(size_t i = 0; i < old_slots ; i++) {
+        if(old_ctrl[i] & 0x80)
+            continue;
+
+        DICTIONARY_ITEM *item = old_items[i];
+        XXH64_hash_t hash = XXH3_64bits(item_get_name(item), item->key_len);
+        uint32_t slot = dict_ht_find_free(ht, hash);
+        ht->ctrl[slot] = dict_ht_h2(hash);
+        ht->items[slot] = item;
+        ht->used++;
+    }
+
+    freez(old_ctrl);
+    freez(old_items);
+
+    __atomic_add_fetch(&dict->stats->memory.index, (long)dict_ht_memory(groups) - (long)old_memory, __ATOMIC_RELAXED);
+}
+
+static inline size_t hashtable_init_hashtable(DICTIONARY *dict) {
+    // allocated on the first insert
+    dict->index.hashtable = NULL;
+    return 0;
+}
+
+static inline size_t hashtable_destroy_hashtable(DICTIONARY *dict) {
+    struct dict_hashtable *ht = dict->index.hashtable;
+    if(unlikely(!ht)) return 0;
+
+    size_t mem = dict_ht_memory(ht->groups);
+    freez(ht->ctrl);
+    freez(ht->items);
+    freez(ht);
+    dict->index.hashtable = NULL;
+
+    __atomic_sub_fetch(&dict->stats->memory.index, (long)mem, __ATOMIC_RELAXED);
+    return mem;
+}
+
+static inline void *hashtable_insert_hashtable(DICTIONARY *dict, const char *name, size_t name_len) {
+    struct dict_hashtable *ht = dict->index.hashtable;
+    if(unlikely(!ht)) {
+        ht = dict->index.hashtable = mallocz(sizeof(*ht));
+        dict_ht_allocate(ht, 1);
+        __atomic_add_fetch(&dict->stats->memory.index, (long)dict_ht_memory(1), __ATOMIC_RELAXED);
+    }
+
+    XXH64_hash_t hash = XXH3_64bits(name, name_len);
+
+    uint32_t slot = dict_ht_find(ht, hash, name, name_len);
+    if(slot != UINT32_MAX)
+        return &ht->items[slot];
+
+    // keep the table at most 7/8 full, counting the DELETED slots
+    size_t slots = (size_t)ht->groups * DICT_HT_GROUP_SLOTS;
+    if(unlikely((size_t)(ht->used + ht->deleted + 1) * 8 > slots * 7)) {
+        // grow it, or just clean it up when most of the slots are DELETED
+        uint32_t groups = ((size_t)(ht->used + 1) * 2 > slots) ? ht->groups * 2 : ht->groups;
+        dict_ht_resize(dict, ht, groups);
+    }
+
+    slot = dict_ht_find_free(ht, hash);
+    if(ht->ctrl[slot] == DICT_HT_CTRL_DELETED)
+        ht->deleted--;
+
+    ht->ctrl[slot] = dict_ht_h2(hash);
+    ht->items[slot] = NULL;
+    ht->used++;
+
+    // the caller sets the item with hashtable_set_item_hashtable()
+    return &ht->items[slot];
+}
+
+static inline DICTIONARY_ITEM *hashtable_insert_handle_to_item_hashtable(DICTIONARY *dict, void *handle) {
+    (void)dict;
+    DICTIONARY_ITEM **item_pptr = handle;
+    return *item_pptr;
+}
+
+static inline void hashtable_set_item_hashtable(DICTIONARY *dict, void *handle, DICTIONARY_ITEM *item) {
+    (void)dict;
+    DICTIONARY_ITEM **item_pptr = handle;
+    *item_pptr = item;
+}
+
+static inline int hashtable_delete_hashtable(DICTIONARY *dict, const char *name, size_t name_len, DICTIONARY_ITEM *item) {
+    (void)item;
+    struct dict_hashtable *ht = dict->index.hashtable;
+    if(unlikely(!ht)) return 0;
+
+    XXH64_hash_t hash = XXH3_64bits(name, name_len);
+    uint32_t slot = dict_ht_find(ht, hash, name, name_len);
+    if(slot == UINT32_MAX)
+        return 0;
+
+    // when the group has an EMPTY slot, no lookup goes past it,
+    // so this slot can become EMPTY too
+    uint32_t g = slot / DICT_HT_GROUP_SLOTS;
+    if(dict_ht_group_match(&ht->ctrl[(size_t)g * DICT_HT_GROUP_SLOTS], DICT_HT_CTRL_EMPTY))
+        ht->ctrl[slot] = DICT_HT_CTRL_EMPTY;
+    else {
+        ht->ctrl[slot] = DICT_HT_CTRL_DELETED;
+        ht->deleted++;
+    }
+
+    ht->items[slot] = NULL;
+    ht->used--;
+    return 1;
+}
+
+static inline DICTIONARY_ITEM *hashtable_get_hashtable(DICTIONARY *dict, const char *name, size_t name_len) {
+    struct dict_hashtable *ht = dict->index.hashtable;
+    if(unlikely(!ht)) return NULL;
+
+    uint32_t slot = dict_ht_find(ht, XXH3_64bits(name, name_len), name, name_len);
+    return (slot == UINT32_MAX) ? NULL : ht->items[slot];
+}
 
 // ----------------------------------------------------------------------------
 // hashtable operations with Judy
@@ -216,44 +383,40 @@ static inline DICTIONARY_ITEM *hashtable_get_judy(DICTIONARY *dict, const char *
 // select the right hashtable
 
 static inline size_t hashtable_init_unsafe(DICTIONARY *dict) {
-    return hashtable_init_judy(dict);
-//    if(dict->options & DICT_OPTION_INDEX_JUDY)
-//        return hashtable_init_judy(dict);
-//    else
-//        return hashtable_init_hashtable(dict);
+    if(dict->options & DICT_OPTION_INDEX_HASHTABLE)
+        return hashtable_init_hashtable(dict);
+    else
+        return hashtable_init_judy(dict);
 }
 
 static inline size_t hashtable_destroy_unsafe(DICTIONARY *dict) {
     pointer_destroy_index(dict);
 
-//    if(dict->options & DICT_OPTION_INDEX_JUDY)
-    return hashtable_destroy_judy(dict);
-//    else
-//        return hashtable_destroy_hashtable(dict);
+    if(dict->options & DICT_OPTION_INDEX_HASHTABLE)
+        return hashtable_destroy_hashtable(dict);
+    else
+        return hashtable_destroy_judy(dict);
 }
 
 static inline void *hashtable_insert_unsafe(DICTIONARY *dict, const char *name, size_t name_len) {
-    return hashtable_insert_judy(dict, name, name_len);
-//    if(dict->options & DICT_OPTION_INDEX_JUDY)
-//        return hashtable_insert_judy(dict, name, name_len);
-//    else
-//        return hashtable_insert_hashtable(dict, name, name_len);
+    if(dict->options & DICT_OPTION_INDEX_HASHTABLE)
+        return hashtable_insert_hashtable(dict, name, name_len);
+    else
+        return hashtable_insert_judy(dict, name, name_len);
 }
 
 static inline DICTIONARY_ITEM *hashtable_insert_handle_to_item_unsafe(DICTIONARY *dict, void *handle) {
-    return hashtable_insert_handle_to_item_judy(dict, handle);
-//    if(dict->options & DICT_OPTION_INDEX_JUDY)
-//        return hashtable_insert_handle_to_item_judy(dict, handle);
-//    else
-//        return hashtable_insert_handle_to_item_hashtable(dict, handle);
+    if(dict->options & DICT_OPTION_INDEX_HASHTABLE)
+        return hashtable_insert_handle_to_item_hashtable(dict, handle);
+    else
+        return hashtable_insert_handle_to_item_judy(dict, handle);
 }
 
 static inline int hashtable_delete_unsafe(DICTIONARY *dict, const char *name, size_t name_len, DICTIONARY_ITEM *item) {
-    return hashtable_delete_judy(dict, name, name_len, item);
-//    if(dict->options & DICT_OPTION_INDEX_JUDY)
-//        return hashtable_delete_judy(dict, name, name_len, item);
-//    else
-//        return hashtable_delete_hashtable(dict, name, name_len, item);
+    if(dict->options & DICT_OPTION_INDEX_HASHTABLE)
+        return hashtable_delete_hashtable(dict, name, name_len, item);
+    else
+        return hashtable_delete_judy(dict, name, name_len, item);
 }
 
 static inline DICTIONARY_ITEM *hashtable_get_unsafe(DICTIONARY *dict, const char *name, size_t name_len) {
@@ -261,11 +424,10 @@ static inline DICTIONARY_ITEM *hashtable_get_unsafe(DICTIONARY *dict, const char
 
     DICTIONARY_ITEM *item;
 
-    item = hashtable_get_judy(dict, name, name_len);
-//    if(dict->options & DICT_OPTION_INDEX_JUDY)
-//        item = hashtable_get_judy(dict, name, name_len);
-//    else
-//        item = hashtable_get_hashtable(dict, name, name_len);
+    if(dict->options & DICT_OPTION_INDEX_HASHTABLE)
+        item = hashtable_get_hashtable(dict, name, name_len);
+    else
+        item = hashtable_get_judy(dict, name, name_len);
 
     if(item)
         pointer_check(dict, item);
@@ -274,11 +436,10 @@ static inline DICTIONARY_ITEM *hashtable_get_unsafe(DICTIONARY *dict, const char
 }
 
 static inline void hashtable_set_item_unsafe(DICTIONARY *dict, void *handle, DICTIONARY_ITEM *item) {
-    hashtable_set_item_judy(dict, handle, item);
-//    if(dict->options & DICT_OPTION_INDEX_JUDY)
-//        hashtable_set_item_judy(dict, handle, item);
-//    else
-//        hashtable_set_item_hashtable(dict, handle, item);
+    if(dict->options & DICT_OPTION_INDEX_HASHTABLE)
+        hashtable_set_item_hashtable(dict, handle, item);
+    else
+        hashtable_set_item_judy(dict, handle, item);
 }
 
 #endif //NETDATA_DICTIONARY_HASHTABLE_H
@@ -143,7 +143,8 @@ struct dictionary {
     ARAL *value_aral;
 
     struct {                            // support for multiple indexing engines
-        Pvoid_t JudyHSArray;        // the hash table
+        Pvoid_t JudyHSArray;        // the hash table, with DICT_OPTION_INDEX_JUDY
+        struct dict_hashtable *hashtable; // the hash table, with DICT_OPTION_INDEX_HASHTABLE
         RW_SPINLOCK rw_spinlock;        // protect the index
     } index;
 
@@ -311,6 +311,67 @@ static void dictionary_unittest_nonclone(DICTIONARY *dict, char **names, char **
     dictionary_unittest_run_and_measure_time(dict, "destroying empty dictionary", names, values, entries, errors, dictionary_unittest_destroy);
 }
 
+// compare the lookups of the index engines
+static void dictionary_unittest_index_engines(char **names, char **values, size_t entries, size_t *errors) {
+    const struct {
+        const char *name;
+        DICT_OPTIONS option;
+    } engines[] = {
+        { "judy", DICT_OPTION_INDEX_JUDY },
+        { "hashtable", DICT_OPTION_INDEX_HASHTABLE },
+    };
+
+    fprintf(stderr, "\nComparing the index engines, %zu items\n", entries);
+
+    for(size_t e = 0; e < _countof(engines) ;e++) {
+        DICTIONARY *dict = dictionary_create(
+            DICT_OPTION_SINGLE_THREADED | DICT_OPTION_NAME_LINK_DONT_CLONE | DICT_OPTION_VALUE_LINK_DONT_CLONE |
+            engines[e].option);
+
+        *errors += dictionary_unittest_set_nonclone(dict, names, values, entries);
+
+        size_t rounds = 10;
+        usec_t started = now_monotonic_usec();
+        for(size_t r = 0; r < rounds ;r++)
+            *errors += dictionary_unittest_get_nonclone(dict, names, values, entries);
+        usec_t dt_get = now_monotonic_usec() - started;
+
+        started = now_monotonic_usec();
+        for(size_t r = 0; r < rounds ;r++)
+            *errors += dictionary_unittest_get_nonexisting(dict, names, values, entries);
+        usec_t dt_get_nonexisting = now_monotonic_usec() - started;
+
+        // delete every other item, and check that the index finds exactly the rest
+        for(size_t i = 0; i < entries ;i += 2)
+            if(!dictionary_del(dict, names[i])) {
+                fprintf(stderr, ">>> %s() %s: cannot delete item %zu\n", __FUNCTION__, engines[e].name, i);
+                (*errors)++;
+            }
+
+        for(size_t i = 0; i < entries ;i++) {
+            void *val = dictionary_get(dict, names[i]);
+            if((i % 2 == 0 && val) || (i % 2 && val != values[i])) {
+                fprintf(stderr, ">>> %s() %s: wrong lookup of item %zu after deletions\n", __FUNCTION__, engines[e].name, i);
+                (*errors)++;
+            }
+        }
+
+        // add them back, reusing the deleted slots
+        *errors += dictionary_unittest_set_nonclone(dict, names, values, entries);
+        if(dictionary_entries(dict) != entries) {
+            fprintf(stderr, ">>> %s() %s: dictionary items do not match\n", __FUNCTION__, engines[e].name);
+            (*errors)++;
+        }
+
+        fprintf(stderr, "%40s ... %8.1f ns per lookup, %8.1f ns per non-existing lookup\n",
+                engines[e].name,
+                (double)dt_get * 1000.0 / (double)(entries * rounds),
+                (double)dt_get_nonexisting * 1000.0 / (double)(entries * rounds));
+
+        dictionary_destroy(dict);
+    }
+}
+
 struct dictionary_unittest_sorting {
     const char *old_name;
     const char *old_value;
@@ -1051,6 +1112,17 @@ int dictionary_unittest(size_t entries) {
     dict = dictionary_create(DICT_OPTION_NONE);
     dictionary_unittest_clone(dict, names, values, entries, &errors);
 
+    fprintf(stderr, "\nCreating dictionary single threaded, clone, hashtable index, %zu items\n", entries);
+    dict = dictionary_create(DICT_OPTION_SINGLE_THREADED | DICT_OPTION_INDEX_HASHTABLE);
+    dictionary_unittest_clone(dict, names, values, entries, &errors);
+
+    fprintf(stderr, "\nCreating dictionary multi threaded, non-clone, hashtable index, %zu items\n", entries);
+    dict = dictionary_create(
+        DICT_OPTION_NAME_LINK_DONT_CLONE | DICT_OPTION_VALUE_LINK_DONT_CLONE | DICT_OPTION_INDEX_HASHTABLE);
+    dictionary_unittest_nonclone(dict, names, values, entries, &errors);
+
+    dictionary_unittest_index_engines(names, values, entries, &errors);
+
     fprintf(stderr, "\nCreating dictionary single threaded, non-clone, add-in-front options, %zu items\n", entries);
     dict = dictionary_create(
         DICT_OPTION_SINGLE_THREADED | DICT_OPTION_NAME_LINK_DONT_CLONE | DICT_OPTION_VALUE_LINK_DONT_CLONE |
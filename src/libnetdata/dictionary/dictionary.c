@@ -235,11 +235,15 @@ void dictionary_static_items_aral_init(void) {
     if(unlikely(!dict_items_aral || !dict_shared_items_aral)) {
         spinlock_lock(&spinlock);
 
-        if(!dict_items_aral)
+        if(!dict_items_aral) {
             dict_items_aral = aral_by_size_acquire(sizeof(DICTIONARY_ITEM));
+            aral_magazines_enable(dict_items_aral);
+        }
 
-        if(!dict_shared_items_aral)
+        if(!dict_shared_items_aral) {
             dict_shared_items_aral = aral_by_size_acquire(sizeof(DICTIONARY_ITEM_SHARED));
+            aral_magazines_enable(dict_shared_items_aral);
+        }
 
         spinlock_unlock(&spinlock);
     }
@@ -572,8 +576,10 @@ static DICTIONARY *dictionary_create_internal(DICT_OPTIONS options, struct dicti
     else
         dict->value_aral = NULL;
 
-//    if(!(dict->options & (DICT_OPTION_INDEX_JUDY|DICT_OPTION_INDEX_HASHTABLE)))
-    dict->options |= DICT_OPTION_INDEX_JUDY;
+    if(dict->options & DICT_OPTION_INDEX_HASHTABLE)
+        dict->options &= ~DICT_OPTION_INDEX_JUDY;
+    else
+        dict->options |= DICT_OPTION_INDEX_JUDY;
 
     size_t dict_size = 0;
     dict_size += sizeof(DICTIONARY);
@@ -59,7 +59,7 @@ typedef enum __attribute__((packed)) dictionary_options {
     DICT_OPTION_ADD_IN_FRONT            = (1 << 4), // add dictionary items at the front of the linked list (default: at the end)
     DICT_OPTION_FIXED_SIZE              = (1 << 5), // the items of the dictionary have a fixed size
     DICT_OPTION_INDEX_JUDY              = (1 << 6), // the default, if no other indexing is set
-//    DICT_OPTION_INDEX_HASHTABLE         = (1 << 7), // use SIMPLE_HASHTABLE for indexing
+    DICT_OPTION_INDEX_HASHTABLE         = (1 << 7), // use an open addressing hash table for indexing (faster lookups)
 } DICT_OPTIONS;
 
 struct dictionary_stats {
@@ -0,0 +1,667 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "executor.h"
+
+#define WORKER_JOB_QUEUED ND_EXECUTOR_GROUPS_MAX
+
+typedef struct nd_executor_task {
+    nd_executor_cb cb;
+    void *data;
+    ND_EXECUTOR_GROUP *group;
+    ND_EXECUTOR_PRIORITY priority;
+
+    struct nd_executor_task *prev, *next;
+} ND_EXECUTOR_TASK;
+
+struct nd_executor_group {
+    size_t id;                  // the worker job id of the group
+    char name[ND_EXECUTOR_GROUP_NAME_MAX + 1];
+    size_t quota;               // max tasks running concurrently, 0 = no limit
+
+    SPINLOCK spinlock;
+    size_t running;             // the tasks given to the workers
+    ND_EXECUTOR_TASK *backlog[ND_EXECUTOR_PRIORITY_MAX]; // the tasks waiting for the quota
+};
+
+typedef struct {
+    SPINLOCK spinlock;
+    size_t count;               // read without the lock, to skip empty queues
+    ND_EXECUTOR_TASK *base;     // the owner takes from the tail, thieves from the head
+} ND_EXECUTOR_QUEUE;
+
+typedef struct nd_executor_worker {
+    size_t id;
+    ND_THREAD *thread;
+    size_t groups_registered;   // the groups registered as worker jobs by this thread
+    ND_EXECUTOR_QUEUE queues[ND_EXECUTOR_PRIORITY_MAX];
+} ND_EXECUTOR_WORKER;
+
+static struct {
+    bool running;
+    bool closing;               // no more tasks are accepted, they run in their callers
+    bool exit;                  // the workers exit when their queues are empty
+    size_t submitters;          // the nd_executor_submit() calls queueing a task now
+    size_t threads;
+    ND_EXECUTOR_WORKER *workers;
+    size_t next_worker;         // round robin for tasks submitted by non-workers
+
+    ARAL *ar_tasks;
+    size_t queued;              // tasks in the queues of all workers
+
+    // sleeping workers
+    netdata_mutex_t mutex;
+    netdata_cond_t cond;
+    size_t idle;
+
+    SPINLOCK groups_spinlock;
+    size_t groups_count;
+    ND_EXECUTOR_GROUP *groups[ND_EXECUTOR_GROUPS_MAX];
+} executor = {
+    .groups_spinlock = SPINLOCK_INITIALIZER,
+};
+
+static __thread ND_EXECUTOR_WORKER *executor_worker = NULL;
+
+// ----------------------------------------------------------------------------
+// groups
+
+ND_EXECUTOR_GROUP *nd_executor_group_get(const char *name, size_t quota) {
+    ND_EXECUTOR_GROUP *g = NULL;
+
+    spinlock_lock(&executor.groups_spinlock);
+
+    for(size_t i = 0; i < executor.groups_count ;i++) {
+        if(strcmp(executor.groups[i]->name, name) == 0) {
+            g = executor.groups[i];
+            break;
+        }
+    }
+
+    if(!g) {
+        size_t id = executor.groups_count;
+        if(id >= ND_EXECUTOR_GROUPS_MAX - 1) {
+            // the last group is shared by all the groups that do not fit
+            id = ND_EXECUTOR_GROUPS_MAX - 1;
+            name = "other";
+            quota = 0;
+            g = executor.groups[id];
+        }
+
+        if(!g) {
+            g = callocz(1, sizeof(*g));
+            g->id = id;
+            strncpyz(g->name, name, ND_EXECUTOR_GROUP_NAME_MAX);
+            spinlock_init(&g->spinlock);
+            executor.groups[id] = g;
+            __atomic_store_n(&executor.groups_count, id + 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    __atomic_store_n(&g->quota, quota, __ATOMIC_RELAXED);
+
+    spinlock_unlock(&executor.groups_spinlock);
+
+    return g;
+}
+
+static void executor_worker_register_groups(ND_EXECUTOR_WORKER *w) {
+    size_t count = __atomic_load_n(&executor.groups_count, __ATOMIC_ACQUIRE);
+    for(size_t i = w->groups_registered; i < count ;i++)
+        worker_register_job_name(i, executor.groups[i]->name);
+
+    w->groups_registered = count;
+}
+
+// ----------------------------------------------------------------------------
+// the queues of the workers
+
+static void executor_wake_up_a_worker(void) {
+    if(!__atomic_load_n(&executor.idle, __ATOMIC_SEQ_CST))
+        return;
+
+    netdata_mutex_lock(&executor.mutex);
+    netdata_cond_signal(&executor.cond);
+    netdata_mutex_unlock(&executor.mutex);
+}
+
+static void executor_dispatch(ND_EXECUTOR_TASK *t) {
+    ND_EXECUTOR_WORKER *w = executor_worker;
+    if(!w)
+        w = &executor.workers[__atomic_fetch_add(&executor.next_worker, 1, __ATOMIC_RELAXED) % executor.threads];
+
+    ND_EXECUTOR_QUEUE *q = &w->queues[t->priority];
+    spinlock_lock(&q->spinlock);
+    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(q->base, t, prev, next);
+    __atomic_add_fetch(&q->count, 1, __ATOMIC_RELAXED);
+    spinlock_unlock(&q->spinlock);
+
+    __atomic_add_fetch(&executor.queued, 1, __ATOMIC_SEQ_CST);
+    executor_wake_up_a_worker();
+}
+
+static ND_EXECUTOR_TASK *executor_queue_take(ND_EXECUTOR_QUEUE *q, bool steal) {
+    if(!__atomic_load_n(&q->count, __ATOMIC_RELAXED))
+        return NULL;
+
+    spinlock_lock(&q->spinlock);
+    ND_EXECUTOR_TASK *t = q->base;
+    if(t) {
+        if(!steal)
+            t = t->prev;
+
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(q->base, t, prev, next);
+        __atomic_sub_fetch(&q->count, 1, __ATOMIC_RELAXED);
+    }
+    spinlock_unlock(&q->spinlock);
+
+    if(t)
+        __atomic_sub_fetch(&executor.queued, 1, __ATOMIC_RELAXED);
+
+    return t;
+}
+
+static ND_EXECUTOR_TASK *executor_take(ND_EXECUTOR_WORKER *w) {
+    for(size_t p = 0; p < ND_EXECUTOR_PRIORITY_MAX ;p++) {
+        ND_EXECUTOR_TASK *t = executor_queue_take(&w->queues[p], false);
+        if(t) return t;
+
+        for(size_t i = 1; i < executor.threads ;i++) {
+            ND_EXECUTOR_WORKER *victim = &executor.workers[(w->id + i) % executor.threads];
+            t = executor_queue_take(&victim->queues[p], true);
+            if(t) return t;
+        }
+    }
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// quotas
+
+static void executor_task_done(ND_EXECUTOR_GROUP *g) {
+    ND_EXECUTOR_TASK *t = NULL;
+
+    spinlock_lock(&g->spinlock);
+    for(size_t p = 0; p < ND_EXECUTOR_PRIORITY_MAX ;p++) {
+        t = g->backlog[p];
+        if(t) {
+            DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(g->backlog[p], t, prev, next);
+            break;
+        }
+    }
+
+    if(!t)
+        g->running--;
+    spinlock_unlock(&g->spinlock);
+
+    // the task takes the place of the one finished
+    if(t)
+        executor_dispatch(t);
+}
+
+// ----------------------------------------------------------------------------
+// workers
+
+static void executor_run(ND_EXECUTOR_WORKER *w, ND_EXECUTOR_TASK *t) {
+    ND_EXECUTOR_GROUP *g = t->group;
+    nd_executor_cb cb = t->cb;
+    void *data = t->data;
+    aral_freez(executor.ar_tasks, t);
+
+    if(unlikely(g->id >= w->groups_registered))
+        executor_worker_register_groups(w);
+
+    worker_is_busy(g->id);
+    cb(data);
+    worker_is_idle();
+
+    executor_task_done(g);
+}
+
+static void executor_worker_thread(void *ptr) {
+    ND_EXECUTOR_WORKER *w = ptr;
+    executor_worker = w;
+
+    worker_register("EXECUTOR");
+    worker_register_job_custom_metric(WORKER_JOB_QUEUED, "queued tasks", "tasks", WORKER_METRIC_ABSOLUTE);
+    executor_worker_register_groups(w);
+
+    while(true) {
+        ND_EXECUTOR_TASK *t = executor_take(w);
+        if(t) {
+            worker_set_metric(WORKER_JOB_QUEUED, (NETDATA_DOUBLE)__atomic_load_n(&executor.queued, __ATOMIC_RELAXED));
+            executor_run(w, t);
+            continue;
+        }
+
+        netdata_mutex_lock(&executor.mutex);
+
+        if(executor.exit) {
+            // all the queues are empty
+            netdata_mutex_unlock(&executor.mutex);
+            break;
+        }
+
+        // the submitters check idle after adding to queued, so either they
+        // see us idle and signal, or we see their task here
+        __atomic_add_fetch(&executor.idle, 1, __ATOMIC_SEQ_CST);
+        while(!__atomic_load_n(&executor.queued, __ATOMIC_SEQ_CST) && !executor.exit)
+            netdata_cond_wait(&executor.cond, &executor.mutex);
+        __atomic_sub_fetch(&executor.idle, 1, __ATOMIC_SEQ_CST);
+
+        netdata_mutex_unlock(&executor.mutex);
+    }
+
+    executor_worker = NULL;
+    worker_unregister();
+}
+
+void nd_executor_init(size_t threads) {
+    if(executor.running || !threads)
+        return;
+
+    executor.ar_tasks = aral_create("executor-tasks", sizeof(ND_EXECUTOR_TASK), 0, 0, NULL, NULL, NULL, false, false, false);
+    netdata_mutex_init(&executor.mutex);
+    netdata_cond_init(&executor.cond);
+
+    executor.closing = false;
+    executor.exit = false;
+    executor.threads = threads;
+    executor.workers = callocz(threads, sizeof(ND_EXECUTOR_WORKER));
+    for(size_t i = 0; i < threads ;i++) {
+        ND_EXECUTOR_WORKER *w = &executor.workers[i];
+        w->id = i;
+        for(size_t p = 0; p < ND_EXECUTOR_PRIORITY_MAX ;p++)
+            spinlock_init(&w->queues[p].spinlock);
+    }
+
+    // the workers steal from each other, so all of them have to exist before any runs
+    __atomic_store_n(&executor.running, true, __ATOMIC_RELEASE);
+
+    for(size_t i = 0; i < threads ;i++) {
+        char tag[NETDATA_THREAD_TAG_MAX + 1];
+        snprintfz(tag, NETDATA_THREAD_TAG_MAX, "EXECUTOR[%zu]", i);
+        executor.workers[i].thread = nd_thread_create(tag, NETDATA_THREAD_OPTION_DONT_LOG, executor_worker_thread, &executor.workers[i]);
+    }
+
+    nd_log(NDLS_DAEMON, NDLP_INFO, "EXECUTOR: started %zu worker threads", threads);
+}
+
+void nd_executor_shutdown(void) {
+    if(!__atomic_load_n(&executor.running, __ATOMIC_ACQUIRE))
+        return;
+
+    // collectors may still be submitting - the new ones will run their tasks,
+    // and we wait for the ones already queueing, so that no task is queued after the workers exit
+    __atomic_store_n(&executor.closing, true, __ATOMIC_SEQ_CST);
+    while(__atomic_load_n(&executor.submitters, __ATOMIC_SEQ_CST))
+        tinysleep();
+
+    netdata_mutex_lock(&executor.mutex);
+    executor.exit = true;
+    netdata_cond_broadcast(&executor.cond);
+    netdata_mutex_unlock(&executor.mutex);
+
+    for(size_t i = 0; i < executor.threads ;i++)
+        nd_thread_join(executor.workers[i].thread);
+
+    // from now on, the tasks run in their callers
+    __atomic_store_n(&executor.running, false, __ATOMIC_RELEASE);
+
+    netdata_cond_destroy(&executor.cond);
+    netdata_mutex_destroy(&executor.mutex);
+    freez(executor.workers);
+    executor.workers = NULL;
+    executor.threads = 0;
+    aral_destroy(executor.ar_tasks);
+    executor.ar_tasks = NULL;
+}
+
+size_t nd_executor_threads(void) {
+    return __atomic_load_n(&executor.running, __ATOMIC_ACQUIRE) ? executor.threads : 0;
+}
+
+// ----------------------------------------------------------------------------
+// submitting work
+
+void nd_executor_submit(ND_EXECUTOR_GROUP *g, ND_EXECUTOR_PRIORITY priority, nd_executor_cb cb, void *data) {
+    // nd_executor_shutdown() waits for us while we are counted
+    __atomic_add_fetch(&executor.submitters, 1, __ATOMIC_SEQ_CST);
+
+    if(unlikely(!__atomic_load_n(&executor.running, __ATOMIC_ACQUIRE) || __atomic_load_n(&executor.closing, __ATOMIC_SEQ_CST))) {
+        __atomic_sub_fetch(&executor.submitters, 1, __ATOMIC_RELEASE);
+        cb(data);
+        return;
+    }
+
+    ND_EXECUTOR_TASK *t = aral_callocz(executor.ar_tasks);
+    t->cb = cb;
+    t->data = data;
+    t->group = g;
+    t->priority = (priority < ND_EXECUTOR_PRIORITY_MAX) ? priority : ND_EXECUTOR_PRIORITY_LOW;
+
+    spinlock_lock(&g->spinlock);
+    size_t quota = __atomic_load_n(&g->quota, __ATOMIC_RELAXED);
+    bool dispatch = !quota || g->running < quota;
+    if(dispatch)
+        g->running++;
+    else
+        DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(g->backlog[t->priority], t, prev, next);
+    spinlock_unlock(&g->spinlock);
+
+    if(dispatch)
+        executor_dispatch(t);
+
+    __atomic_sub_fetch(&executor.submitters, 1, __ATOMIC_RELEASE);
+}
+
+// ----------------------------------------------------------------------------
+// running work in parallel with the caller
+
+#define PARALLEL_CLOSED 1
+#define PARALLEL_STARTED_ONE 2
+
+typedef struct {
+    nd_executor_parallel_cb cb;
+    void *data;
+
+    size_t state;               // started helpers * PARALLEL_STARTED_ONE | PARALLEL_CLOSED
+    size_t finished;            // the helpers that finished, under the mutex
+    int32_t refcount;           // the caller and the helpers not run yet
+
+    netdata_mutex_t mutex;
+    netdata_cond_t cond;
+} ND_EXECUTOR_PARALLEL;
+
+static void executor_parallel_release(ND_EXECUTOR_PARALLEL *ep) {
+    if(__atomic_sub_fetch(&ep->refcount, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+
+    netdata_cond_destroy(&ep->cond);
+    netdata_mutex_destroy(&ep->mutex);
+    freez(ep);
+}
+
+static void executor_parallel_helper(void *ptr) {
+    ND_EXECUTOR_PARALLEL *ep = ptr;
+
+    size_t state = __atomic_load_n(&ep->state, __ATOMIC_ACQUIRE);
+    do {
+        if(state & PARALLEL_CLOSED) {
+            // the caller finished without us
+            executor_parallel_release(ep);
+            return;
+        }
+    } while(!__atomic_compare_exchange_n(&ep->state, &state, state + PARALLEL_STARTED_ONE,
+                                         false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    ep->cb(state / PARALLEL_STARTED_ONE + 1, ep->data);
+
+    netdata_mutex_lock(&ep->mutex);
+    ep->finished++;
+    netdata_cond_signal(&ep->cond);
+    netdata_mutex_unlock(&ep->mutex);
+
+    executor_parallel_release(ep);
+}
+
+size_t nd_executor_parallel(ND_EXECUTOR_GROUP *g, ND_EXECUTOR_PRIORITY priority, size_t slots, nd_executor_parallel_cb cb, void *data) {
+    if(!slots)
+        return 0;
+
+    size_t helpers = MIN(slots - 1, nd_executor_threads());
+    if(!helpers) {
+        cb(0, data);
+        return 1;
+    }
+
+    ND_EXECUTOR_PARALLEL *ep = callocz(1, sizeof(*ep));
+    ep->cb = cb;
+    ep->data = data;
+    ep->refcount = (int32_t)(helpers + 1);
+    netdata_mutex_init(&ep->mutex);
+    netdata_cond_init(&ep->cond);
+
+    for(size_t i = 0; i < helpers ;i++)
+        nd_executor_submit(g, priority, executor_parallel_helper, ep);
+
+    cb(0, data);
+
+    // the helpers not started yet will not start - wait for the ones that did
+    size_t started = __atomic_fetch_or(&ep->state, PARALLEL_CLOSED, __ATOMIC_ACQ_REL) / PARALLEL_STARTED_ONE;
+
+    netdata_mutex_lock(&ep->mutex);
+    while(ep->finished < started)
+        netdata_cond_wait(&ep->cond, &ep->mutex);
+    netdata_mutex_unlock(&ep->mutex);
+
+    executor_parallel_release(ep);
+
+    return started + 1;
+}
+
+// ----------------------------------------------------------------------------
+// unit test
+
+#define EXECUTOR_UNITTEST_THREADS 4
+#define EXECUTOR_UNITTEST_TASKS 50
+#define EXECUTOR_UNITTEST_QUOTA 2
+#define EXECUTOR_UNITTEST_SLOTS 8
+#define EXECUTOR_UNITTEST_CALLERS 8
+#define EXECUTOR_UNITTEST_CALLS 200
+
+static struct {
+    size_t running;
+    size_t max_running;
+    size_t done;
+    pid_t tid;
+} executor_ut;
+
+static void executor_unittest_task(void *data __maybe_unused) {
+    size_t running = __atomic_add_fetch(&executor_ut.running, 1, __ATOMIC_RELAXED);
+
+    size_t max = __atomic_load_n(&executor_ut.max_running, __ATOMIC_RELAXED);
+    while(running > max &&
+           !__atomic_compare_exchange_n(&executor_ut.max_running, &max, running, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+
+    __atomic_store_n(&executor_ut.tid, gettid_cached(), __ATOMIC_RELAXED);
+    sleep_usec(1000);
+
+    __atomic_sub_fetch(&executor_ut.running, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&executor_ut.done, 1, __ATOMIC_RELEASE);
+}
+
+static bool executor_unittest_wait_done(size_t expected) {
+    usec_t timeout_ut = now_monotonic_usec() + 30 * USEC_PER_SEC;
+    while(__atomic_load_n(&executor_ut.done, __ATOMIC_ACQUIRE) < expected && now_monotonic_usec() < timeout_ut)
+        sleep_usec(1000);
+
+    return __atomic_load_n(&executor_ut.done, __ATOMIC_ACQUIRE) == expected;
+}
+
+static void executor_unittest_reset(void) {
+    memset(&executor_ut, 0, sizeof(executor_ut));
+}
+
+static void executor_unittest_parallel_cb(size_t slot, void *data) {
+    size_t *runs = data;
+    __atomic_add_fetch(&runs[slot], 1, __ATOMIC_RELAXED);
+
+    // give the helpers the chance to start
+    if(slot == 0)
+        sleep_usec(200);
+}
+
+// returns the errors found
+static size_t executor_unittest_parallel_once(ND_EXECUTOR_GROUP *g, size_t slots, bool report) {
+    size_t runs[EXECUTOR_UNITTEST_SLOTS] = { 0 };
+    size_t errors = 0;
+
+    size_t ret = nd_executor_parallel(g, ND_EXECUTOR_PRIORITY_NORMAL, slots, executor_unittest_parallel_cb, runs);
+
+    size_t max = slots ? MIN(slots, nd_executor_threads() + 1) : 0;
+    if(ret > max || (slots && !ret)) {
+        if(report)
+            fprintf(stderr, "EXECUTOR: parallel with %zu slots returned %zu, expected 1 to %zu\n", slots, ret, max);
+        errors++;
+    }
+
+    for(size_t i = 0; i < EXECUTOR_UNITTEST_SLOTS ;i++) {
+        size_t expected = (i < ret) ? 1 : 0;
+        size_t got = __atomic_load_n(&runs[i], __ATOMIC_RELAXED);
+        if(got != expected) {
+            if(report)
+                fprintf(stderr, "EXECUTOR: parallel with %zu slots returned %zu, but slot %zu ran %zu times\n",
+                        slots, ret, i, got);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+struct executor_unittest_caller {
+    ND_EXECUTOR_GROUP *g;
+    size_t errors;
+};
+
+static void executor_unittest_caller_thread(void *ptr) {
+    struct executor_unittest_caller *c = ptr;
+
+    for(size_t i = 0; i < EXECUTOR_UNITTEST_CALLS ;i++)
+        c->errors += executor_unittest_parallel_once(c->g, 1 + i % EXECUTOR_UNITTEST_SLOTS, false);
+}
+
+// the tasks run synchronously in the caller, when the executor is not running
+static size_t executor_unittest_not_running(ND_EXECUTOR_GROUP *g, const char *when) {
+    size_t errors = 0;
+
+    if(nd_executor_threads() != 0) {
+        fprintf(stderr, "EXECUTOR: %s, the executor reports %zu threads\n", when, nd_executor_threads());
+        errors++;
+    }
+
+    executor_unittest_reset();
+    nd_executor_submit(g, ND_EXECUTOR_PRIORITY_NORMAL, executor_unittest_task, NULL);
+    if(executor_ut.done != 1 || executor_ut.tid != gettid_cached()) {
+        fprintf(stderr, "EXECUTOR: %s, a submitted task did not run in the caller\n", when);
+        errors++;
+    }
+
+    size_t runs[EXECUTOR_UNITTEST_SLOTS] = { 0 };
+    size_t ret = nd_executor_parallel(g, ND_EXECUTOR_PRIORITY_NORMAL, EXECUTOR_UNITTEST_SLOTS, executor_unittest_parallel_cb, runs);
+    if(ret != 1 || runs[0] != 1 || runs[1] != 0) {
+        fprintf(stderr, "EXECUTOR: %s, parallel returned %zu and ran slot 0 %zu times, expected only slot 0 once\n",
+                when, ret, runs[0]);
+        errors++;
+    }
+
+    return errors;
+}
+
+int nd_executor_unittest(void) {
+    size_t errors = 0;
+
+    if(nd_executor_threads()) {
+        fprintf(stderr, "EXECUTOR: the executor is already running, cannot test it\n");
+        return 1;
+    }
+
+    ND_EXECUTOR_GROUP *g_quota = nd_executor_group_get("unittest-quota", EXECUTOR_UNITTEST_QUOTA);
+    ND_EXECUTOR_GROUP *g_any = nd_executor_group_get("unittest", 0);
+
+    // 1. before the executor starts
+    errors += executor_unittest_not_running(g_any, "before init");
+
+    nd_executor_init(EXECUTOR_UNITTEST_THREADS);
+    if(nd_executor_threads() != EXECUTOR_UNITTEST_THREADS) {
+        fprintf(stderr, "EXECUTOR: started with %d threads, but it reports %zu\n",
+                EXECUTOR_UNITTEST_THREADS, nd_executor_threads());
+        errors++;
+    }
+
+    // 2. the quota of a group limits its concurrently running tasks, the rest wait in the backlog
+    executor_unittest_reset();
+    for(size_t i = 0; i < EXECUTOR_UNITTEST_TASKS ;i++)
+        nd_executor_submit(g_quota, i % ND_EXECUTOR_PRIORITY_MAX, executor_unittest_task, NULL);
+
+    if(!executor_unittest_wait_done(EXECUTOR_UNITTEST_TASKS)) {
+        fprintf(stderr, "EXECUTOR: only %zu of %d tasks of the quota group ran\n",
+                executor_ut.done, EXECUTOR_UNITTEST_TASKS);
+        errors++;
+    }
+
+    if(executor_ut.max_running > EXECUTOR_UNITTEST_QUOTA || !executor_ut.max_running) {
+        fprintf(stderr, "EXECUTOR: the quota group ran up to %zu tasks concurrently, its quota is %d\n",
+                executor_ut.max_running, EXECUTOR_UNITTEST_QUOTA);
+        errors++;
+    }
+
+    // the last task decrements running after it increments done
+    usec_t timeout_ut = now_monotonic_usec() + 10 * USEC_PER_SEC;
+    size_t running;
+    bool backlog_empty;
+    do {
+        spinlock_lock(&g_quota->spinlock);
+        running = g_quota->running;
+        backlog_empty = true;
+        for(size_t p = 0; p < ND_EXECUTOR_PRIORITY_MAX ;p++)
+            if(g_quota->backlog[p]) backlog_empty = false;
+        spinlock_unlock(&g_quota->spinlock);
+
+        if(!running && backlog_empty)
+            break;
+
+        sleep_usec(1000);
+    } while(now_monotonic_usec() < timeout_ut);
+
+    if(running || !backlog_empty) {
+        fprintf(stderr, "EXECUTOR: the quota group has %zu tasks running and %s backlog, after all its tasks finished\n",
+                running, backlog_empty ? "an empty" : "a non-empty");
+        errors++;
+    }
+
+    // 3. parallel runs each of the returned slots exactly once
+    errors += executor_unittest_parallel_once(g_any, 0, true);
+    errors += executor_unittest_parallel_once(g_any, 1, true);
+    for(size_t i = 0; i < 100 ;i++)
+        errors += executor_unittest_parallel_once(g_any, EXECUTOR_UNITTEST_SLOTS, true);
+
+    // 4. parallel called concurrently by several threads
+    struct executor_unittest_caller callers[EXECUTOR_UNITTEST_CALLERS];
+    ND_THREAD *threads[EXECUTOR_UNITTEST_CALLERS];
+    for(size_t i = 0; i < EXECUTOR_UNITTEST_CALLERS ;i++) {
+        callers[i] = (struct executor_unittest_caller){ .g = (i % 2) ? g_quota : g_any, .errors = 0 };
+        char tag[NETDATA_THREAD_TAG_MAX + 1];
+        snprintfz(tag, NETDATA_THREAD_TAG_MAX, "EXECUT-UT[%zu]", i);
+        threads[i] = nd_thread_create(tag, NETDATA_THREAD_OPTION_DONT_LOG, executor_unittest_caller_thread, &callers[i]);
+    }
+
+    for(size_t i = 0; i < EXECUTOR_UNITTEST_CALLERS ;i++) {
+        nd_thread_join(threads[i]);
+        if(callers[i].errors) {
+            fprintf(stderr, "EXECUTOR: concurrent caller %zu found %zu errors in parallel runs\n", i, callers[i].errors);
+            errors += callers[i].errors;
+        }
+    }
+
+    // 5. shutdown runs all the queued and backlogged tasks
+    executor_unittest_reset();
+    for(size_t i = 0; i < EXECUTOR_UNITTEST_TASKS ;i++)
+        nd_executor_submit(g_quota, ND_EXECUTOR_PRIORITY_LOW, executor_unittest_task, NULL);
+
+    nd_executor_shutdown();
+
+    if(executor_ut.done != EXECUTOR_UNITTEST_TASKS) {
+        fprintf(stderr, "EXECUTOR: shutdown returned after running %zu of %d queued tasks\n",
+                executor_ut.done, EXECUTOR_UNITTEST_TASKS);
+        errors++;
+    }
+
+    // 6. after shutdown, everything runs in the caller
+    errors += executor_unittest_not_running(g_any, "after shutdown");
+
+    fprintf(stderr, "EXECUTOR: %zu errors\n", errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_EXECUTOR_H
+#define NETDATA_EXECUTOR_H
+
+#include "libnetdata/libnetdata.h"
+
+/*
+ * EXECUTOR
+ * A pool of worker threads shared by all the components of the process, so that
+ * the work they run in parallel is bound by one number of threads, instead of the
+ * sum of many private pools.
+ *
+ * 1. Each worker has its own queues, one per priority
+ * 2. Tasks submitted by a worker go to its own queues and run LIFO (cache hot)
+ * 3. Idle workers steal the oldest tasks of the other workers
+ * 4. Higher priority tasks are always taken first, from any worker
+ * 5. Tasks belong to a group, which limits how many of them run concurrently
+ *
+ * When the executor is not running (no threads), tasks run in the caller.
+ *
+ * Be careful: tasks should not block waiting for other tasks, other than
+ * through nd_executor_parallel(), which never waits for work not yet started.
+ *
+ */
+
+typedef enum __attribute__((packed)) {
+    ND_EXECUTOR_PRIORITY_HIGH = 0,      // data collection
+    ND_EXECUTOR_PRIORITY_NORMAL,        // queries, maintenance
+    ND_EXECUTOR_PRIORITY_LOW,           // background work
+
+    // terminator
+    ND_EXECUTOR_PRIORITY_MAX,
+} ND_EXECUTOR_PRIORITY;
+
+#define ND_EXECUTOR_GROUPS_MAX 32
+#define ND_EXECUTOR_GROUP_NAME_MAX 30
+
+typedef struct nd_executor_group ND_EXECUTOR_GROUP;
+
+typedef void (*nd_executor_cb)(void *data);
+typedef void (*nd_executor_parallel_cb)(size_t slot, void *data);
+
+// start the workers - with 0 threads, all tasks run in their callers
+void nd_executor_init(size_t threads);
+
+// run all the queued tasks and stop the workers
+void nd_executor_shutdown(void);
+
+// the number of worker threads running
+size_t nd_executor_threads(void);
+
+// find or create a group - quota is the max tasks of the group running concurrently
+// (0 = no limit) - the quota of an existing group is updated
+ND_EXECUTOR_GROUP *nd_executor_group_get(const char *name, size_t quota);
+
+// run cb(data) in a worker thread
+void nd_executor_submit(ND_EXECUTOR_GROUP *g, ND_EXECUTOR_PRIORITY priority, nd_executor_cb cb, void *data);
+
+// run cb(slot, data) for up to `slots` slots in parallel, and wait for them to finish.
+// The caller runs slot 0. The other slots run only if a worker picks them up before
+// the caller finishes slot 0, so cb() has to share the work dynamically between the
+// slots (e.g. with an atomic index), not by slot number.
+// Returns the number of slots that ran (slots 0 to ret - 1).
+size_t nd_executor_parallel(ND_EXECUTOR_GROUP *g, ND_EXECUTOR_PRIORITY priority, size_t slots, nd_executor_parallel_cb cb, void *data);
+
+int nd_executor_unittest(void);
+
+#endif //NETDATA_EXECUTOR_H
@@ -80,6 +80,7 @@ extern const char *netdata_configured_host_prefix;
 #include "locks/locks.h"
 #include "locks/spinlock.h"
 #include "locks/rw-spinlock.h"
+#include "locks/lock-contention.h"
 #include "completion/completion.h"
 #include "libnetdata/locks/waitq.h"
 #include "clocks/clocks.h"
@@ -121,6 +122,7 @@ extern const char *netdata_configured_host_prefix;
 
 #include "eval/eval.h"
 #include "statistical/statistical.h"
+#include "statistical/ddsketch.h"
 #include "adaptive_resortable_list/adaptive_resortable_list.h"
 #include "url/url.h"
 #include "json/json.h"
@@ -129,6 +131,7 @@ extern const char *netdata_configured_host_prefix;
 #include "libnetdata/aral/aral.h"
 #include "onewayalloc/onewayalloc.h"
 #include "worker_utilization/worker_utilization.h"
+#include "executor/executor.h"
 #include "yaml.h"
 #include "http/http_defs.h"
 #include "gorilla/gorilla.h"
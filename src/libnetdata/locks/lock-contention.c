@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libnetdata/libnetdata.h"
+
+// The call sites are kept in a fixed size open addressing table per lock type.
+// It is lock free (the locks use it while they spin), and the slots are never
+// released, so a site is identified by its function pointer for the lifetime
+// of the process. When a table is full, the new sites are not accounted.
+
+#define LOCK_CONTENTION_SITES 512 // per lock type, power of 2
+
+typedef struct lock_contention_slot {
+    const char *function;
+    uint64_t contended;
+    uint64_t spins;
+    uint64_t wait_ut;
+    uint64_t max_wait_ut;
+} LOCK_CONTENTION_SLOT;
+
+bool lock_contention_enabled = false;
+
+static struct {
+    LOCK_CONTENTION_SLOT slots[LOCK_CONTENTION_TYPE_MAX][LOCK_CONTENTION_SITES];
+} lock_contention_globals = { 0 };
+
+void lock_contention_enable(bool enable) {
+    __atomic_store_n(&lock_contention_enabled, enable, __ATOMIC_RELAXED);
+}
+
+const char *lock_contention_type_name(LOCK_CONTENTION_TYPE type) {
+    switch(type) {
+        case LOCK_CONTENTION_SPINLOCK:
+            return "spinlock";
+
+        case LOCK_CONTENTION_RW_SPINLOCK_READ:
+            return "rw-spinlock read";
+
+        case LOCK_CONTENTION_RW_SPINLOCK_WRITE:
+            return "rw-spinlock write";
+
+        case LOCK_CONTENTION_WAITQ:
+            return "waitq";
+
+        default:
+            return "unknown";
+    }
+}
+
+static inline size_t lock_contention_hash(const char *func) {
+    uintptr_t addr = (uintptr_t)func;
+    return (size_t)((addr >> 3) ^ (addr >> 13)) & (LOCK_CONTENTION_SITES - 1);
+}
+
+static LOCK_CONTENTION_SLOT *lock_contention_slot(LOCK_CONTENTION_TYPE type, const char *func) {
+    LOCK_CONTENTION_SLOT *slots = lock_contention_globals.slots[type];
+    size_t hash = lock_contention_hash(func);
+
+    for(size_t i = 0; i < LOCK_CONTENTION_SITES ;i++) {
+        LOCK_CONTENTION_SLOT *slot = &slots[(hash + i) & (LOCK_CONTENTION_SITES - 1)];
+
+        const char *f = __atomic_load_n(&slot->function, __ATOMIC_ACQUIRE);
+        if(f == func)
+            return slot;
+
+        if(!f) {
+            const char *expected = NULL;
+            if(__atomic_compare_exchange_n(&slot->function, &expected, func, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                return slot;
+
+            // another thread claimed it
+            if(expected == func)
+                return slot;
+        }
+    }
+
+    return NULL;
+}
+
+void lock_contention_record_do(LOCK_CONTENTION_TYPE type, const char *func, size_t spins, usec_t started_ut) {
+    if(unlikely(!func || type >= LOCK_CONTENTION_TYPE_MAX))
+        return;
+
+    LOCK_CONTENTION_SLOT *slot = lock_contention_slot(type, func);
+    if(unlikely(!slot))
+        return;
+
+    uint64_t wait_ut = now_monotonic_usec() - started_ut;
+
+    __atomic_add_fetch(&slot->contended, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&slot->spins, spins, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&slot->wait_ut, wait_ut, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&slot->max_wait_ut, __ATOMIC_RELAXED);
+    while(wait_ut > max &&
+           !__atomic_compare_exchange_n(&slot->max_wait_ut, &max, wait_ut, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+size_t lock_contention_sites(LOCK_CONTENTION_SITE *sites, size_t max) {
+    size_t copied = 0;
+
+    for(size_t t = 0; t < LOCK_CONTENTION_TYPE_MAX ;t++) {
+        for(size_t i = 0; i < LOCK_CONTENTION_SITES && copied < max ;i++) {
+            LOCK_CONTENTION_SLOT *slot = &lock_contention_globals.slots[t][i];
+
+            const char *func = __atomic_load_n(&slot->function, __ATOMIC_ACQUIRE);
+            if(!func) continue;
+
+            sites[copied++] = (LOCK_CONTENTION_SITE) {
+                .function = func,
+                .type = (LOCK_CONTENTION_TYPE)t,
+                .contended = __atomic_load_n(&slot->contended, __ATOMIC_RELAXED),
+                .spins = __atomic_load_n(&slot->spins, __ATOMIC_RELAXED),
+                .wait_ut = __atomic_load_n(&slot->wait_ut, __ATOMIC_RELAXED),
+                .max_wait_ut = __atomic_load_n(&slot->max_wait_ut, __ATOMIC_RELAXED),
+            };
+        }
+    }
+
+    return copied;
+}
+
+void lock_contention_totals(uint64_t wait_ut[LOCK_CONTENTION_TYPE_MAX], uint64_t contended[LOCK_CONTENTION_TYPE_MAX]) {
+    for(size_t t = 0; t < LOCK_CONTENTION_TYPE_MAX ;t++) {
+        wait_ut[t] = contended[t] = 0;
+
+        for(size_t i = 0; i < LOCK_CONTENTION_SITES ;i++) {
+            LOCK_CONTENTION_SLOT *slot = &lock_contention_globals.slots[t][i];
+            if(!__atomic_load_n(&slot->function, __ATOMIC_ACQUIRE)) continue;
+
+            wait_ut[t] += __atomic_load_n(&slot->wait_ut, __ATOMIC_RELAXED);
+            contended[t] += __atomic_load_n(&slot->contended, __ATOMIC_RELAXED);
+        }
+    }
+}
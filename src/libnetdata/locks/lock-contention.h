@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_LOCK_CONTENTION_H
+#define NETDATA_LOCK_CONTENTION_H
+
+#include "libnetdata/common.h"
+
+// Lock contention profiling
+//
+// When enabled, the locks time how long their callers had to wait to acquire them,
+// and account it to the function that called the lock (the call site).
+// Only the acquisitions that found the lock busy are timed, so the uncontended
+// path costs just a check of a global flag.
+
+typedef enum __attribute__((packed)) {
+    LOCK_CONTENTION_SPINLOCK = 0,
+    LOCK_CONTENTION_RW_SPINLOCK_READ,
+    LOCK_CONTENTION_RW_SPINLOCK_WRITE,
+    LOCK_CONTENTION_WAITQ,
+
+    // terminator
+    LOCK_CONTENTION_TYPE_MAX,
+} LOCK_CONTENTION_TYPE;
+
+typedef struct lock_contention_site {
+    const char *function;               // the function that called the lock
+    LOCK_CONTENTION_TYPE type;
+    uint64_t contended;                 // the acquisitions that had to wait
+    uint64_t spins;                     // the times the callers backed off
+    uint64_t wait_ut;                   // the total time the callers waited
+    uint64_t max_wait_ut;               // the longest time a caller waited
+} LOCK_CONTENTION_SITE;
+
+extern bool lock_contention_enabled;
+
+void lock_contention_enable(bool enable);
+const char *lock_contention_type_name(LOCK_CONTENTION_TYPE type);
+
+// copy the call sites that have been contended - returns the number of sites copied
+size_t lock_contention_sites(LOCK_CONTENTION_SITE *sites, size_t max);
+
+// the total wait time per lock type
+void lock_contention_totals(uint64_t wait_ut[LOCK_CONTENTION_TYPE_MAX], uint64_t contended[LOCK_CONTENTION_TYPE_MAX]);
+
+void lock_contention_record_do(LOCK_CONTENTION_TYPE type, const char *func, size_t spins, usec_t started_ut);
+
+// to be called when a lock is found busy for the first time
+static inline usec_t lock_contention_started(void) {
+    if(likely(!__atomic_load_n(&lock_contention_enabled, __ATOMIC_RELAXED)))
+        return 0;
+
+    return now_monotonic_usec();
+}
+
+// to be called when the lock is acquired
+static inline void lock_contention_record(LOCK_CONTENTION_TYPE type, const char *func, size_t spins, usec_t started_ut) {
+    if(unlikely(started_ut))
+        lock_contention_record_do(type, func, spins, started_ut);
+}
+
+#endif //NETDATA_LOCK_CONTENTION_H
@@ -36,6 +36,7 @@ ALWAYS_INLINE void rw_spinlock_read_lock_with_trace(RW_SPINLOCK *rw_spinlock, co
     size_t spins = 0;
     usec_t usec = 1;
     usec_t deadlock_timestamp = 0;
+    usec_t contention_started_ut = 0;
 
     while (true) {
         // Optimistically increment reader count
@@ -45,6 +46,7 @@ ALWAYS_INLINE void rw_spinlock_read_lock_with_trace(RW_SPINLOCK *rw_spinlock, co
         if (!(val & WRITER_BIT)) {
             // no writer, we are in
             worker_spinlock_contention(func, spins);
+            lock_contention_record(LOCK_CONTENTION_RW_SPINLOCK_READ, func, spins, contention_started_ut);
             nd_thread_rwspinlock_read_locked();
             return;
         }
@@ -52,7 +54,8 @@ ALWAYS_INLINE void rw_spinlock_read_lock_with_trace(RW_SPINLOCK *rw_spinlock, co
         // Undo our increment and retry
         __atomic_sub_fetch(&rw_spinlock->counter, 1, __ATOMIC_RELEASE);
 
-        spins++;
+        if(!spins++)
+            contention_started_ut = lock_contention_started();
         
         // Check for deadlock every SPINS_BEFORE_DEADLOCK_CHECK iterations
         if ((spins % SPINS_BEFORE_DEADLOCK_CHECK) == 0) {
@@ -96,6 +99,7 @@ ALWAYS_INLINE void rw_spinlock_write_lock_with_trace(RW_SPINLOCK *rw_spinlock, c
     size_t spins = 0;
     usec_t usec = 1;
     usec_t deadlock_timestamp = 0;
+    usec_t contention_started_ut = 0;
 
     while (1) {
         // Optimistically set writer bit
@@ -105,6 +109,7 @@ ALWAYS_INLINE void rw_spinlock_write_lock_with_trace(RW_SPINLOCK *rw_spinlock, c
         if (old == 0) {
             rw_spinlock->writer = gettid_cached();
             worker_spinlock_contention(func, spins);
+            lock_contention_record(LOCK_CONTENTION_RW_SPINLOCK_WRITE, func, spins, contention_started_ut);
             nd_thread_rwspinlock_write_locked();
             return;
         }
@@ -118,7 +123,8 @@ ALWAYS_INLINE void rw_spinlock_write_lock_with_trace(RW_SPINLOCK *rw_spinlock, c
             __atomic_and_fetch(&rw_spinlock->counter, ~WRITER_BIT, __ATOMIC_RELEASE);
         }
 
-        spins++;
+        if(!spins++)
+            contention_started_ut = lock_contention_started();
         
         // Check for deadlock every SPINS_BEFORE_DEADLOCK_CHECK iterations
         if ((spins % SPINS_BEFORE_DEADLOCK_CHECK) == 0) {
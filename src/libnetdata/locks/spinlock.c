@@ -36,6 +36,7 @@ ALWAYS_INLINE void spinlock_lock_with_trace(SPINLOCK *spinlock, const char *func
     size_t spins = 0;
     usec_t usec = 1;
     usec_t deadlock_timestamp = 0;
+    usec_t contention_started_ut = 0;
 
     while (true) {
         if (!__atomic_load_n(&spinlock->locked, __ATOMIC_RELAXED) &&
@@ -45,7 +46,8 @@ ALWAYS_INLINE void spinlock_lock_with_trace(SPINLOCK *spinlock, const char *func
         }
 
         // Backoff strategy with exponential growth
-        spins++;
+        if(!spins++)
+            contention_started_ut = lock_contention_started();
         
         // Check for deadlock every SPINS_BEFORE_DEADLOCK_CHECK iterations
         if ((spins % SPINS_BEFORE_DEADLOCK_CHECK) == 0) {
@@ -63,6 +65,7 @@ ALWAYS_INLINE void spinlock_lock_with_trace(SPINLOCK *spinlock, const char *func
 
     nd_thread_spinlock_locked();
     worker_spinlock_contention(func, spins);
+    lock_contention_record(LOCK_CONTENTION_SPINLOCK, func, spins, contention_started_ut);
 }
 
 ALWAYS_INLINE void spinlock_unlock_with_trace(SPINLOCK *spinlock, const char *func __maybe_unused) {
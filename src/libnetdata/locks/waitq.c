@@ -91,6 +91,8 @@ ALWAYS_INLINE void waitq_acquire_with_trace(WAITQ *waitq, WAITQ_PRIORITY priorit
     size_t spins = 0;
     usec_t usec = 1;
     usec_t deadlock_timestamp = 0;
+    usec_t contention_started_ut = 0;
+    size_t failures = 0;
 
     while(true) {
         while (write_our_priority(waitq, our_order)) {
@@ -98,11 +100,19 @@ ALWAYS_INLINE void waitq_acquire_with_trace(WAITQ *waitq, WAITQ_PRIORITY priorit
                 waitq->writer = gettid_cached();
                 clear_our_priority(waitq, our_order);
                 worker_spinlock_contention(func, spins);
+                lock_contention_record(LOCK_CONTENTION_WAITQ, func, spins, contention_started_ut);
                 return;
             }
+
+            if(!failures++)
+                contention_started_ut = lock_contention_started();
+
             yield_the_processor();
         }
 
+        if(!failures++)
+            contention_started_ut = lock_contention_started();
+
         // Back off
         spins++;
         
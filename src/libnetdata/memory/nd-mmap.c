@@ -159,6 +159,28 @@ void *nd_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t offset)
     return rc;
 }
 
+void *nd_mremap(void *ptr, size_t old_size, size_t new_size) {
+#if defined(MREMAP_MAYMOVE)
+    workers_memory_call(WORKERS_MEMORY_CALL_MMAP);
+
+    // the kernel moves the pages, the data are not copied
+    void *rc = mremap(ptr, old_size, new_size, MREMAP_MAYMOVE);
+
+    if(rc != MAP_FAILED) {
+        if(new_size > old_size)
+            __atomic_add_fetch(&nd_mmap_size, new_size - old_size, __ATOMIC_RELAXED);
+        else
+            __atomic_sub_fetch(&nd_mmap_size, old_size - new_size, __ATOMIC_RELAXED);
+    }
+
+    return rc;
+#else
+    (void)ptr; (void)old_size; (void)new_size;
+    errno = ENOTSUP;
+    return MAP_FAILED;
+#endif
+}
+
 void *nd_mmap_advanced(const char *filename, size_t size, int flags, int ksm, bool read_only, bool dont_dump, int *open_fd) {
     // netdata_log_info("netdata_mmap('%s', %zu", filename, size);
 
@@ -234,3 +256,54 @@ cleanup:
     errno_clear();
     return mem;
 }
+
+void *nd_mmap_huge(size_t size, bool dont_dump, ND_HUGE_PAGES *type) {
+    *type = ND_HUGE_PAGES_NONE;
+
+    if(size % ND_HUGE_PAGE_SIZE)
+        return nd_mmap_advanced(NULL, size, MAP_PRIVATE | MAP_ANONYMOUS, 0, false, dont_dump, NULL);
+
+#if defined(MAP_HUGETLB)
+    // explicit huge pages are available only when the admin has reserved them (vm.nr_hugepages)
+    // once the reservation is exhausted (or missing) we stop trying
+    static bool hugetlb_unavailable = false;
+    if(!__atomic_load_n(&hugetlb_unavailable, __ATOMIC_RELAXED)) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#if defined(MAP_HUGE_2MB)
+        flags |= MAP_HUGE_2MB;
+#endif
+        void *mem = nd_mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if(mem != MAP_FAILED) {
+            if(dont_dump) madvise_dontdump(mem, size);
+            *type = ND_HUGE_PAGES_HUGETLB;
+            return mem;
+        }
+
+        __atomic_store_n(&hugetlb_unavailable, true, __ATOMIC_RELAXED);
+        nd_log(NDLS_DAEMON, NDLP_INFO,
+               "MMAP: explicit huge pages are not available, falling back to transparent huge pages");
+    }
+#endif
+
+#if defined(MADV_HUGEPAGE)
+    // map one huge page more, so that we can align the region to the huge page size
+    uint8_t *mem = nd_mmap(NULL, size + ND_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mem == MAP_FAILED)
+        return NULL;
+
+    uint8_t *aligned = (uint8_t *)(((uintptr_t)mem + ND_HUGE_PAGE_SIZE - 1) & ~((uintptr_t)ND_HUGE_PAGE_SIZE - 1));
+    size_t head = aligned - mem;
+    size_t tail = ND_HUGE_PAGE_SIZE - head;
+    if(head) munmap(mem, head);
+    if(tail) munmap(aligned + size, tail);
+    __atomic_sub_fetch(&nd_mmap_size, ND_HUGE_PAGE_SIZE, __ATOMIC_RELAXED);
+
+    if(madvise(aligned, size, MADV_HUGEPAGE) == 0)
+        *type = ND_HUGE_PAGES_THP;
+
+    if(dont_dump) madvise_dontdump(aligned, size);
+    return aligned;
+#else
+    return nd_mmap_advanced(NULL, size, MAP_PRIVATE | MAP_ANONYMOUS, 0, false, dont_dump, NULL);
+#endif
+}
@@ -19,7 +19,21 @@ extern size_t nd_mmap_size;
 extern int enable_ksm;
 
 void *nd_mmap_advanced(const char *filename, size_t size, int flags, int ksm, bool read_only, bool dont_dump, int *open_fd);
+
+#define ND_HUGE_PAGE_SIZE (2ULL * 1024 * 1024)
+
+typedef enum __attribute__((packed)) {
+    ND_HUGE_PAGES_NONE = 0,             // normal pages
+    ND_HUGE_PAGES_HUGETLB,              // explicit huge pages (MAP_HUGETLB)
+    ND_HUGE_PAGES_THP,                  // transparent huge pages (MADV_HUGEPAGE), the kernel may still use normal pages
+} ND_HUGE_PAGES;
+
+// anonymous private memory, backed by huge pages when possible - size should be a multiple of ND_HUGE_PAGE_SIZE
+void *nd_mmap_huge(size_t size, bool dont_dump, ND_HUGE_PAGES *type);
 void *nd_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t offset);
 int nd_munmap(void *ptr, size_t size);
 
+// resize a mapping of nd_mmap() without copying it - returns MAP_FAILED where it is not supported
+void *nd_mremap(void *ptr, size_t old_size, size_t new_size);
+
 #endif //NETDATA_ND_MMAP_H
@@ -18,6 +18,158 @@ size_t onewayalloc_allocated_memory(void) {
     return __atomic_load_n(&onewayalloc_total_memory, __ATOMIC_RELAXED);
 }
 
+// ----------------------------------------------------------------------------
+// the pool of pages
+//
+// Queries create and destroy OWAs all the time, so the pages of destroyed OWAs
+// are kept in a pool to be given to the next OWAs, already faulted in.
+// Pages up to 2 MiB are rounded up to a power of two, so that they can be reused
+// for any allocation of their size class. Each thread keeps one page per size class
+// for itself and the rest are shared. The pool retains up to a configurable amount
+// of memory - the pages that do not fit are returned to the system.
+
+#define OWA_POOL_MIN_PAGE_SIZE (32ULL * 1024)
+#define OWA_POOL_MAX_PAGE_SIZE (2ULL * 1024 * 1024)
+#define OWA_POOL_CLASSES 7 // 32 KiB, 64 KiB, 128 KiB, 256 KiB, 512 KiB, 1 MiB, 2 MiB
+
+static struct {
+    SPINLOCK spinlock;
+    OWA_PAGE *pages[OWA_POOL_CLASSES];  // the shared pages, linked via next
+
+    size_t retained_max;
+
+    PAD64(size_t) retained_bytes;
+    PAD64(size_t) reused_bytes;
+    PAD64(size_t) fresh_bytes;
+    PAD64(size_t) released_bytes;
+} owa_pool = {
+    .spinlock = SPINLOCK_INITIALIZER,
+    .retained_max = 64ULL * 1024 * 1024,
+};
+
+static __thread OWA_PAGE *owa_thread_pages[OWA_POOL_CLASSES] = { 0 };
+
+void onewayalloc_pool_retained_max_set(size_t bytes) {
+    __atomic_store_n(&owa_pool.retained_max, bytes, __ATOMIC_RELAXED);
+}
+
+void onewayalloc_pool_statistics(ONEWAYALLOC_POOL_STATISTICS *stats) {
+    stats->retained_bytes = __atomic_load_n(&owa_pool.retained_bytes, __ATOMIC_RELAXED);
+    stats->reused_bytes = __atomic_load_n(&owa_pool.reused_bytes, __ATOMIC_RELAXED);
+    stats->fresh_bytes = __atomic_load_n(&owa_pool.fresh_bytes, __ATOMIC_RELAXED);
+    stats->released_bytes = __atomic_load_n(&owa_pool.released_bytes, __ATOMIC_RELAXED);
+}
+
+// returns the size class of a page, or -1 when the page is not pooled
+static inline int owa_pool_class(size_t size) {
+    if(size > OWA_POOL_MAX_PAGE_SIZE)
+        return -1;
+
+    int cls = 0;
+    for(size_t s = OWA_POOL_MIN_PAGE_SIZE; s < size ; s <<= 1)
+        cls++;
+
+    return cls;
+}
+
+static inline size_t owa_pool_class_size(int cls) {
+    return OWA_POOL_MIN_PAGE_SIZE << cls;
+}
+
+static OWA_PAGE *owa_page_get(size_t size) {
+    int cls = owa_pool_class(size);
+    if(cls >= 0) {
+        size = owa_pool_class_size(cls);
+
+        OWA_PAGE *page = owa_thread_pages[cls];
+        if(page)
+            owa_thread_pages[cls] = NULL;
+        else if(__atomic_load_n(&owa_pool.pages[cls], __ATOMIC_RELAXED)) {
+            spinlock_lock(&owa_pool.spinlock);
+            page = owa_pool.pages[cls];
+            if(page)
+                owa_pool.pages[cls] = page->next;
+            spinlock_unlock(&owa_pool.spinlock);
+        }
+
+        if(page) {
+            __atomic_sub_fetch(&owa_pool.retained_bytes, size, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&owa_pool.reused_bytes, size, __ATOMIC_RELAXED);
+            return page;
+        }
+    }
+
+    // Use netdata_mmap instead of mallocz
+    OWA_PAGE *page = (OWA_PAGE *)nd_mmap_advanced(NULL, size, MAP_ANONYMOUS | MAP_PRIVATE, 0, false, false, NULL);
+    if(unlikely(!page)) {
+        page = mallocz(size);
+        page->mmap = false;
+    }
+    else
+        page->mmap = true;
+
+    page->size = size;
+
+    __atomic_add_fetch(&onewayalloc_total_memory, size, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&owa_pool.fresh_bytes, size, __ATOMIC_RELAXED);
+
+    return page;
+}
+
+static void owa_page_release(OWA_PAGE *page) {
+    size_t size = page->size;
+
+    __atomic_sub_fetch(&onewayalloc_total_memory, size, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&owa_pool.released_bytes, size, __ATOMIC_RELAXED);
+
+    // Use netdata_munmap instead of freez
+    if(page->mmap)
+        nd_munmap(page, size);
+    else
+        freez(page);
+}
+
+static void owa_page_put(OWA_PAGE *page) {
+    int cls = owa_pool_class(page->size);
+    if(cls < 0) {
+        owa_page_release(page);
+        return;
+    }
+
+    size_t retained = __atomic_add_fetch(&owa_pool.retained_bytes, page->size, __ATOMIC_RELAXED);
+    if(retained > __atomic_load_n(&owa_pool.retained_max, __ATOMIC_RELAXED)) {
+        // the pool is full
+        __atomic_sub_fetch(&owa_pool.retained_bytes, page->size, __ATOMIC_RELAXED);
+        owa_page_release(page);
+        return;
+    }
+
+    if(!owa_thread_pages[cls]) {
+        owa_thread_pages[cls] = page;
+        return;
+    }
+
+    spinlock_lock(&owa_pool.spinlock);
+    page->next = owa_pool.pages[cls];
+    owa_pool.pages[cls] = page;
+    spinlock_unlock(&owa_pool.spinlock);
+}
+
+// give the pages of the calling thread to the shared pool - to be called when a thread exits
+void onewayalloc_thread_pages_release(void) {
+    for(int cls = 0; cls < OWA_POOL_CLASSES ;cls++) {
+        OWA_PAGE *page = owa_thread_pages[cls];
+        if(!page) continue;
+
+        owa_thread_pages[cls] = NULL;
+
+        spinlock_lock(&owa_pool.spinlock);
+        page->next = owa_pool.pages[cls];
+        owa_pool.pages[cls] = page;
+        spinlock_unlock(&owa_pool.spinlock);
+    }
+}
+
 // Create an OWA
 // Once it is created, the caller may call the onewayalloc_mallocz()
 // any number of times, for any amount of memory.
@@ -53,18 +205,10 @@ static OWA_PAGE *onewayalloc_create_internal(OWA_PAGE *head, size_t size_hint) {
     if(size % OWA_NATURAL_PAGE_SIZE)
         size = size + OWA_NATURAL_PAGE_SIZE - (size % OWA_NATURAL_PAGE_SIZE);
 
-    // Use netdata_mmap instead of mallocz
-    OWA_PAGE *page = (OWA_PAGE *)nd_mmap_advanced(NULL, size, MAP_ANONYMOUS | MAP_PRIVATE, 0, false, false, NULL);
-    if(unlikely(!page)) {
-        page = mallocz(size);
-        page->mmap = false;
-    }
-    else
-        page->mmap = true;
-
-    __atomic_add_fetch(&onewayalloc_total_memory, size, __ATOMIC_RELAXED);
+    // the page may be bigger than the size we asked, when it comes from the pool
+    OWA_PAGE *page = owa_page_get(size);
+    size = page->size;
 
-    page->size = size;
     page->offset = natural_alignment(sizeof(OWA_PAGE));
     page->next = page->last = NULL;
 
@@ -193,20 +337,11 @@ void onewayalloc_destroy(ONEWAYALLOC *owa) {
     //     head->stats_mallocs_made, head->stats_mallocs_size,
     //     head->stats_pages, head->stats_pages_size);
 
-    size_t total_size = 0;
     OWA_PAGE *page = head;
     while(page) {
-        total_size += page->size;
-
         OWA_PAGE *p = page;
         page = page->next;
 
-        // Use netdata_munmap instead of freez
-        if(p->mmap)
-            nd_munmap(p, p->size);
-        else
-            freez(p);
+        owa_page_put(p);
     }
-
-    __atomic_sub_fetch(&onewayalloc_total_memory, total_size, __ATOMIC_RELAXED);
 }
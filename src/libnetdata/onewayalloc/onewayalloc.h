@@ -18,4 +18,15 @@ void *onewayalloc_doublesize(ONEWAYALLOC *owa, const void *src, size_t oldsize);
 
 size_t onewayalloc_allocated_memory(void);
 
+typedef struct onewayalloc_pool_statistics {
+    size_t retained_bytes;              // the memory of the pages kept in the pool
+    size_t reused_bytes;                // the memory of the pages given again from the pool
+    size_t fresh_bytes;                 // the memory of the pages allocated from the system
+    size_t released_bytes;              // the memory of the pages returned to the system
+} ONEWAYALLOC_POOL_STATISTICS;
+
+void onewayalloc_pool_statistics(ONEWAYALLOC_POOL_STATISTICS *stats);
+void onewayalloc_pool_retained_max_set(size_t bytes);
+void onewayalloc_thread_pages_release(void);
+
 #endif // ONEWAYALLOC_H
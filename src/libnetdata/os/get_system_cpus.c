@@ -139,4 +139,227 @@ size_t os_read_cpuset_cpus(const char *filename, size_t system_cpus) {
 
     return 0;
 }
-#endif
\ No newline at end of file
+#endif
+// --------------------------------------------------------------------------------------------------------------------
+// effective cpus
+
+#if defined(OS_LINUX)
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+// find the path of the cgroup of this process, for cgroups v2 (controller == NULL)
+// or the cgroups v1 hierarchy that has the given controller
+static bool cgroup_self_path(const char *controller, char *dst, size_t dst_size) {
+    char buf[4096];
+    if(read_txt_file("/proc/self/cgroup", buf, sizeof(buf)) != 0)
+        return false;
+
+    size_t controller_len = controller ? strlen(controller) : 0;
+
+    // lines are: hierarchy-ID:controller-list:cgroup-path
+    char *line = buf;
+    while(line && *line) {
+        char *eol = strchr(line, '\n');
+        if(eol) *eol = '\0';
+
+        char *controllers = strchr(line, ':');
+        char *path = controllers ? strchr(controllers + 1, ':') : NULL;
+        if(path) {
+            *controllers++ = '\0';
+            *path++ = '\0';
+
+            bool found = false;
+            if(!controller)
+                // cgroups v2 is hierarchy 0, without controllers
+                found = strcmp(line, "0") == 0 && !*controllers;
+            else {
+                for(char *s = controllers; s && *s ;) {
+                    char *comma = strchr(s, ',');
+                    size_t len = comma ? (size_t)(comma - s) : strlen(s);
+                    if(len == controller_len && strncmp(s, controller, len) == 0) {
+                        found = true;
+                        break;
+                    }
+                    s = comma ? comma + 1 : NULL;
+                }
+            }
+
+            if(found) {
+                strncpyz(dst, path, dst_size - 1);
+                return true;
+            }
+        }
+
+        line = eol ? eol + 1 : NULL;
+    }
+
+    return false;
+}
+
+// walk from the cgroup of the process up to the root of the hierarchy,
+// calling cb() for each directory that exists - stops when cb() returns false
+static void cgroup_walk_up(const char *mount, const char *path, bool (*cb)(const char *dir, void *data), void *data) {
+    char dir[FILENAME_MAX + 1];
+    snprintfz(dir, FILENAME_MAX, "%s%s", mount, (path && strcmp(path, "/") != 0) ? path : "");
+
+    // in a cgroup namespace, the path may not exist under our mount - the mount is our cgroup
+    struct stat st;
+    if(stat(dir, &st) != 0 || !S_ISDIR(st.st_mode))
+        strncpyz(dir, mount, FILENAME_MAX);
+
+    size_t mount_len = strlen(mount);
+    while(true) {
+        if(!cb(dir, data))
+            return;
+
+        char *slash = strrchr(dir, '/');
+        if(!slash || (size_t)(slash - dir) < mount_len)
+            return;
+
+        *slash = '\0';
+    }
+}
+
+static bool cgroup_v2_quota_cb(const char *dir, void *data) {
+    double *quota = data;
+
+    char filename[FILENAME_MAX + 1], buf[100];
+    snprintfz(filename, FILENAME_MAX, "%s/cpu.max", dir);
+    if(read_txt_file(filename, buf, sizeof(buf)) != 0)
+        return true;
+
+    // "max 100000" or "200000 100000"
+    if(strncmp(buf, "max", 3) == 0)
+        return true;
+
+    char *end;
+    unsigned long long q = strtoull(buf, &end, 10);
+    unsigned long long p = strtoull(end, NULL, 10);
+    if(q && p) {
+        double cpus = (double)q / (double)p;
+        if(*quota == 0.0 || cpus < *quota)
+            *quota = cpus;
+    }
+
+    return true;
+}
+
+static bool cgroup_v1_quota_cb(const char *dir, void *data) {
+    double *quota = data;
+
+    char filename[FILENAME_MAX + 1];
+    long long q = 0;
+    unsigned long long p = 0;
+
+    snprintfz(filename, FILENAME_MAX, "%s/cpu.cfs_quota_us", dir);
+    if(read_single_signed_number_file(filename, &q) != 0 || q <= 0)
+        return true;
+
+    snprintfz(filename, FILENAME_MAX, "%s/cpu.cfs_period_us", dir);
+    if(read_single_number_file(filename, &p) != 0 || !p)
+        return true;
+
+    double cpus = (double)q / (double)p;
+    if(*quota == 0.0 || cpus < *quota)
+        *quota = cpus;
+
+    return true;
+}
+
+struct cgroup_cpuset {
+    const char *file;
+    size_t system_cpus;
+    size_t cpus;
+};
+
+static bool cgroup_cpuset_cb(const char *dir, void *data) {
+    struct cgroup_cpuset *cs = data;
+
+    char filename[FILENAME_MAX + 1];
+    snprintfz(filename, FILENAME_MAX, "%s/%s", dir, cs->file);
+    cs->cpus = os_read_cpuset_cpus(filename, cs->system_cpus);
+
+    // the first cgroup with a cpuset is the effective one
+    return cs->cpus == 0;
+}
+
+static size_t sched_affinity_cpus(size_t system_cpus) {
+    size_t ncpus = MAX(system_cpus, CPU_SETSIZE);
+    cpu_set_t *set = CPU_ALLOC(ncpus);
+    if(!set)
+        return 0;
+
+    size_t size = CPU_ALLOC_SIZE(ncpus);
+    CPU_ZERO_S(size, set);
+
+    size_t cpus = 0;
+    if(sched_getaffinity(0, size, set) == 0)
+        cpus = (size_t)CPU_COUNT_S(size, set);
+
+    CPU_FREE(set);
+    return cpus;
+}
+#endif
+
+OS_EFFECTIVE_CPUS os_get_effective_cpus(void) {
+    OS_EFFECTIVE_CPUS c = {
+        .system = os_get_system_cpus_uncached(),
+    };
+
+#if defined(OS_LINUX)
+    c.affinity = sched_affinity_cpus(c.system);
+
+    char path[FILENAME_MAX + 1];
+    struct cgroup_cpuset cs = { .system_cpus = c.system };
+
+    struct stat st;
+    if(stat(CGROUP_ROOT "/cgroup.controllers", &st) == 0) {
+        // cgroups v2
+        if(!cgroup_self_path(NULL, path, sizeof(path)))
+            strncpyz(path, "/", sizeof(path) - 1);
+
+        cgroup_walk_up(CGROUP_ROOT, path, cgroup_v2_quota_cb, &c.quota);
+
+        cs.file = "cpuset.cpus.effective";
+        cgroup_walk_up(CGROUP_ROOT, path, cgroup_cpuset_cb, &cs);
+    }
+    else {
+        // cgroups v1
+        if(!cgroup_self_path("cpu", path, sizeof(path)))
+            strncpyz(path, "/", sizeof(path) - 1);
+
+        cgroup_walk_up(CGROUP_ROOT "/cpu", path, cgroup_v1_quota_cb, &c.quota);
+
+        if(!cgroup_self_path("cpuset", path, sizeof(path)))
+            strncpyz(path, "/", sizeof(path) - 1);
+
+        cs.file = "cpuset.effective_cpus";
+        cgroup_walk_up(CGROUP_ROOT "/cpuset", path, cgroup_cpuset_cb, &cs);
+        if(!cs.cpus) {
+            cs.file = "cpuset.cpus";
+            cgroup_walk_up(CGROUP_ROOT "/cpuset", path, cgroup_cpuset_cb, &cs);
+        }
+    }
+
+    c.cpuset = cs.cpus;
+#endif
+
+    c.effective = c.system;
+
+    if(c.affinity && c.affinity < c.effective)
+        c.effective = c.affinity;
+
+    if(c.cpuset && c.cpuset < c.effective)
+        c.effective = c.cpuset;
+
+    if(c.quota > 0.0) {
+        // a quota of 1.5 cpus can keep 2 threads busy most of the time
+        size_t quota_cpus = (size_t)ceil(c.quota);
+        if(quota_cpus < c.effective)
+            c.effective = quota_cpus;
+    }
+
+    if(c.effective < 1)
+        c.effective = 1;
+
+    return c;
+}
@@ -23,4 +23,17 @@ size_t os_get_system_cpus_cached(bool cache);
 size_t os_read_cpuset_cpus(const char *filename, size_t system_cpus);
 #endif
 
+typedef struct {
+    size_t system;          // the cpus of the system
+    size_t affinity;        // the cpus the scheduler allows the process to run on (0 = unknown)
+    size_t cpuset;          // the cpus of the cpuset of the cgroup of the process (0 = unknown)
+    double quota;           // the cpu quota of the cgroup of the process (or its parents), in cpus (0 = unlimited)
+    size_t effective;       // the cpus the process can actually use
+} OS_EFFECTIVE_CPUS;
+
+// the cpus the process can actually use: the minimum of the system cpus, the scheduler affinity,
+// the cgroup cpuset and the cgroup cpu quota (v1 or v2) rounded up.
+// Use this (through netdata_conf_cpus() in the agent) to size pools of threads.
+OS_EFFECTIVE_CPUS os_get_effective_cpus(void);
+
 #endif //NETDATA_GET_SYSTEM_CPUS_H
@@ -2,6 +2,10 @@
 
 #include "../libnetdata.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define PF_PREFIX "PROCFILE"
 
 #define PFWORDS_INCREASE_STEP 2000
@@ -17,15 +21,22 @@ static size_t procfile_max_lines = PFLINES_INCREASE_STEP;
 static size_t procfile_max_words = PFWORDS_INCREASE_STEP;
 static size_t procfile_max_allocation = PROCFILE_INCREMENT_BUFFER;
 
+// the batch workers read files concurrently, so the max values are updated atomically
+static inline void procfile_max_update(size_t *max, size_t value) {
+    size_t current = __atomic_load_n(max, __ATOMIC_RELAXED);
+    while(value > current &&
+           !__atomic_compare_exchange_n(max, &current, value, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+#define procfile_max_get(max) __atomic_load_n(&(max), __ATOMIC_RELAXED)
+
 void procfile_set_adaptive_allocation(bool enable, size_t bytes, size_t lines, size_t words) {
     procfile_adaptive_initial_allocation = enable;
 
-    if(bytes > procfile_max_allocation)
-        procfile_max_allocation = bytes;
-    if(lines > procfile_max_lines)
-        procfile_max_lines = lines;
-    if(words > procfile_max_words)
-        procfile_max_words = words;
+    procfile_max_update(&procfile_max_allocation, bytes);
+    procfile_max_update(&procfile_max_lines, lines);
+    procfile_max_update(&procfile_max_words, words);
 }
 
 // ----------------------------------------------------------------------------
@@ -79,7 +90,7 @@ NEVERNULL
 static inline pfwords *procfile_words_create(void) {
     // netdata_log_debug(D_PROCFILE, PF_PREFIX ":   initializing words");
 
-    size_t size = (procfile_adaptive_initial_allocation) ? procfile_max_words : PFWORDS_INCREASE_STEP;
+    size_t size = (procfile_adaptive_initial_allocation) ? procfile_max_get(procfile_max_words) : PFWORDS_INCREASE_STEP;
 
     pfwords *new = mallocz(sizeof(pfwords) + size * sizeof(char *));
     new->len = 0;
@@ -130,7 +141,7 @@ NEVERNULL
 static inline pflines *procfile_lines_create(void) {
     // netdata_log_debug(D_PROCFILE, PF_PREFIX ":   initializing lines");
 
-    size_t size = (unlikely(procfile_adaptive_initial_allocation)) ? procfile_max_words : PFLINES_INCREASE_STEP;
+    size_t size = (unlikely(procfile_adaptive_initial_allocation)) ? procfile_max_get(procfile_max_words) : PFLINES_INCREASE_STEP;
 
     pflines *new = mallocz(sizeof(pflines) + size * sizeof(ffline));
     new->len = 0;
@@ -291,10 +302,136 @@ static void procfile_parser(procfile *ff) {
     }
 }
 
-procfile *procfile_readall(procfile *ff) {
-    if(!ff) return NULL;
+#if defined(__SSE2__)
+// The vectorized parser, for procfiles without quotes and open/close characters.
+// It classifies 64 bytes at a time into words, separators and newlines, and then
+// walks only the positions where words start and end - so runs of spaces (like the
+// columns of /proc/interrupts on a big machine) are skipped as a whole.
+// It produces exactly the same lines and words as procfile_parser().
+NOINLINE
+static void procfile_parser_vectorized(procfile *ff) {
+    char *data = ff->data
+        , *e = &ff->data[ff->len]       // the terminating null
+        , *t = ff->data;                // the first character of the current word
 
-    // netdata_log_debug(D_PROCFILE, PF_PREFIX ": Reading file '%s'.", ff->filename);
+    size_t len = ff->len;
+    bool in_word = false;               // the previous byte was part of a word
+
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    __m128i extra[sizeof(ff->vector_separators)];
+    size_t extras = ff->vector_separators_count;
+    for(size_t k = 0; k < extras ;k++)
+        extra[k] = _mm_set1_epi8((char)ff->vector_separators[k]);
+
+    uint32_t *line_words = procfile_lines_add(ff);
+
+    for(size_t offset = 0; offset < len ; offset += 64) {
+        char *block = &data[offset];
+        size_t available = len - offset;
+        uint64_t newlines = 0, separators = 0, valid;
+
+        if(likely(available >= 64)) {
+            valid = ~0ULL;
+            for(size_t i = 0; i < 4 ;i++) {
+                __m128i v = _mm_loadu_si128((const __m128i *)&block[i * 16]);
+                __m128i nl = _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr));
+
+                // all the bytes up to the space are separators, except the newlines
+                __m128i sep = _mm_andnot_si128(nl, _mm_cmpeq_epi8(_mm_min_epu8(v, space), v));
+                sep = _mm_or_si128(sep, _mm_cmpeq_epi8(v, del));
+                for(size_t k = 0; k < extras ;k++)
+                    sep = _mm_or_si128(sep, _mm_cmpeq_epi8(v, extra[k]));
+
+                newlines |= (uint64_t)(uint16_t)_mm_movemask_epi8(nl) << (i * 16);
+                separators |= (uint64_t)(uint16_t)_mm_movemask_epi8(sep) << (i * 16);
+            }
+        }
+        else {
+            valid = (1ULL << available) - 1;
+            for(size_t i = 0; i < available ;i++) {
+                PF_CHAR_TYPE ct = ff->separators[(unsigned char)block[i]];
+                if(ct == PF_CHAR_IS_NEWLINE)
+                    newlines |= 1ULL << i;
+                else if(ct == PF_CHAR_IS_SEPARATOR)
+                    separators |= 1ULL << i;
+            }
+        }
+
+        uint64_t words = ~(newlines | separators) & valid;
+        uint64_t after_word = (words << 1) | (in_word ? 1 : 0);
+
+        // the positions we need to stop at: the first byte of each word,
+        // every separator that ends a word and every newline
+        uint64_t events = (words & ~after_word) | (separators & after_word) | newlines;
+
+        while(events) {
+            char *s = &block[__builtin_ctzll(events)];
+            uint64_t bit = events & -events;
+            events &= events - 1;
+
+            if(bit & words) {
+                // a word starts
+                t = s;
+                in_word = true;
+                continue;
+            }
+
+            if(bit & newlines) {
+                // end of line - it always adds a word, even an empty one
+                if(!in_word)
+                    t = s;
+
+                *s = '\0';
+                procfile_words_add(ff, t);
+                (*line_words)++;
+
+                line_words = procfile_lines_add(ff);
+            }
+            else {
+                // separator, but we have word before it
+                *s = '\0';
+                procfile_words_add(ff, t);
+                (*line_words)++;
+            }
+
+            in_word = false;
+        }
+    }
+
+    if(in_word) {
+        // the last word
+        char *s = e;
+        if(unlikely(ff->len >= ff->size)) {
+            // we are going to loose the last byte
+            s = &ff->data[ff->size - 1];
+        }
+
+        *s = '\0';
+        procfile_words_add(ff, t);
+        (*line_words)++;
+    }
+}
+#endif
+
+static inline void procfile_parse(procfile *ff) {
+#if defined(__SSE2__)
+    if(likely(ff->vector_separators_count != PROCFILE_NOT_VECTORIZABLE)) {
+        procfile_parser_vectorized(ff);
+        return;
+    }
+#endif
+
+    procfile_parser(ff);
+}
+
+// read the whole file into ff->data - with pread() at increasing offsets when positional,
+// or with read() from the current position otherwise. ff may be reallocated.
+static bool procfile_read_data(procfile **ffp, int fd, bool positional) {
+    procfile *ff = *ffp;
 
     ff->len = 0;    // zero the used size
     ssize_t r = 1;  // read at least once
@@ -308,7 +445,7 @@ procfile *procfile_readall(procfile *ff) {
             size_t wanted = (optimal > minimum)?optimal:minimum;
 
             netdata_log_debug(D_PROCFILE, PF_PREFIX ": Expanding data buffer for file '%s' by %zu bytes.", procfile_filename(ff), wanted);
-            ff = reallocz(ff, sizeof(procfile) + ff->size + wanted);
+            ff = *ffp = reallocz(ff, sizeof(procfile) + ff->size + wanted);
             ff->size += wanted;
             ff->stats.memory += wanted;
             ff->stats.resizes++;
@@ -316,14 +453,13 @@ procfile *procfile_readall(procfile *ff) {
 
         // netdata_log_info("Reading file '%s', from position %zd with length %zd", procfile_filename(ff), s, (ssize_t)(ff->size - s));
         ff->stats.reads++;
-        r = read(ff->fd, &ff->data[s], ff->size - s);
-        if(unlikely(r == -1)) {
-            if(unlikely(!(ff->flags & PROCFILE_FLAG_NO_ERROR_ON_FILE_IO))) collector_error(PF_PREFIX ": Cannot read from file '%s' on fd %d", procfile_filename(ff), ff->fd);
-            else if(unlikely(ff->flags & PROCFILE_FLAG_ERROR_ON_ERROR_LOG))
-                netdata_log_error(PF_PREFIX ": Cannot read from file '%s' on fd %d", procfile_filename(ff), ff->fd);
-            procfile_close(ff);
-            return NULL;
-        }
+        if(positional)
+            r = pread(fd, &ff->data[s], ff->size - s, s);
+        else
+            r = read(fd, &ff->data[s], ff->size - s);
+
+        if(unlikely(r == -1))
+            return false;
 
         if((ssize_t)ff->stats.max_read_size < r)
             ff->stats.max_read_size = r;
@@ -331,23 +467,38 @@ procfile *procfile_readall(procfile *ff) {
         ff->len += r;
     }
 
-    // netdata_log_debug(D_PROCFILE, "Rewinding file '%s'", ff->filename);
-    if(unlikely(lseek(ff->fd, 0, SEEK_SET) == -1)) {
-        if(unlikely(!(ff->flags & PROCFILE_FLAG_NO_ERROR_ON_FILE_IO))) collector_error(PF_PREFIX ": Cannot rewind on file '%s'.", procfile_filename(ff));
-        else if(unlikely(ff->flags & PROCFILE_FLAG_ERROR_ON_ERROR_LOG))
-            netdata_log_error(PF_PREFIX ": Cannot rewind on file '%s'.", procfile_filename(ff));
-        procfile_close(ff);
-        return NULL;
-    }
+    return true;
+}
+
+// the time each thread spent reading and parsing files, see procfile_thread_times()
+static __thread usec_t procfile_thread_read_ut = 0;
+static __thread usec_t procfile_thread_parse_ut = 0;
+
+void procfile_thread_times(usec_t *read_ut, usec_t *parse_ut) {
+    *read_ut = procfile_thread_read_ut;
+    *parse_ut = procfile_thread_parse_ut;
+}
+
+static void procfile_parse_data(procfile *ff, usec_t started_ut) {
+    usec_t read_ut = now_monotonic_high_precision_usec();
+    ff->stats.last_read_ut = read_ut - started_ut;
+    procfile_thread_read_ut += ff->stats.last_read_ut;
 
     procfile_lines_reset(ff->lines);
     procfile_words_reset(ff->words);
-    procfile_parser(ff);
+
+    if(unlikely(ff->flags & PROCFILE_FLAG_NO_PARSE))
+        ff->data[ff->len] = '\0'; // the read loop always leaves at least one free byte
+    else
+        procfile_parse(ff);
+
+    ff->stats.last_parse_ut = now_monotonic_high_precision_usec() - read_ut;
+    procfile_thread_parse_ut += ff->stats.last_parse_ut;
 
     if(unlikely(procfile_adaptive_initial_allocation)) {
-        if(unlikely(ff->len > procfile_max_allocation)) procfile_max_allocation = ff->len;
-        if(unlikely(ff->lines->len > procfile_max_lines)) procfile_max_lines = ff->lines->len;
-        if(unlikely(ff->words->len > procfile_max_words)) procfile_max_words = ff->words->len;
+        procfile_max_update(&procfile_max_allocation, ff->len);
+        procfile_max_update(&procfile_max_lines, ff->lines->len);
+        procfile_max_update(&procfile_max_words, ff->words->len);
     }
 
     if(ff->stats.max_source_bytes < ff->len)
@@ -360,11 +511,58 @@ procfile *procfile_readall(procfile *ff) {
         ff->stats.max_words = ff->words->len;
 
     ff->stats.total_read_bytes += ff->len;
+}
+
+procfile *procfile_readall(procfile *ff) {
+    if(!ff) return NULL;
+
+    if(ff->prefetched) {
+        // procfile_batch_readall() has already read it
+        ff->prefetched = false;
+        return ff;
+    }
+
+    usec_t started_ut = now_monotonic_high_precision_usec();
+
+    // netdata_log_debug(D_PROCFILE, PF_PREFIX ": Reading file '%s'.", ff->filename);
+
+    if(unlikely(!procfile_read_data(&ff, ff->fd, false))) {
+        if(unlikely(!(ff->flags & PROCFILE_FLAG_NO_ERROR_ON_FILE_IO))) collector_error(PF_PREFIX ": Cannot read from file '%s' on fd %d", procfile_filename(ff), ff->fd);
+        else if(unlikely(ff->flags & PROCFILE_FLAG_ERROR_ON_ERROR_LOG))
+            netdata_log_error(PF_PREFIX ": Cannot read from file '%s' on fd %d", procfile_filename(ff), ff->fd);
+        procfile_close(ff);
+        return NULL;
+    }
+
+    // netdata_log_debug(D_PROCFILE, "Rewinding file '%s'", ff->filename);
+    if(unlikely(lseek(ff->fd, 0, SEEK_SET) == -1)) {
+        if(unlikely(!(ff->flags & PROCFILE_FLAG_NO_ERROR_ON_FILE_IO))) collector_error(PF_PREFIX ": Cannot rewind on file '%s'.", procfile_filename(ff));
+        else if(unlikely(ff->flags & PROCFILE_FLAG_ERROR_ON_ERROR_LOG))
+            netdata_log_error(PF_PREFIX ": Cannot rewind on file '%s'.", procfile_filename(ff));
+        procfile_close(ff);
+        return NULL;
+    }
+
+    procfile_parse_data(ff, started_ut);
 
     // netdata_log_debug(D_PROCFILE, "File '%s' updated.", ff->filename);
     return ff;
 }
 
+bool procfile_pread(procfile **ffp, int fd) {
+    usec_t started_ut = now_monotonic_high_precision_usec();
+
+    if(unlikely(!procfile_read_data(ffp, fd, true))) {
+        (*ffp)->len = 0;
+        procfile_lines_reset((*ffp)->lines);
+        procfile_words_reset((*ffp)->words);
+        return false;
+    }
+
+    procfile_parse_data(*ffp, started_ut);
+    return true;
+}
+
 static PF_CHAR_TYPE procfile_default_separators[256];
 __attribute__((constructor)) void procfile_initialize_default_separators(void) {
     int i = 256;
@@ -380,6 +578,35 @@ __attribute__((constructor)) void procfile_initialize_default_separators(void) {
     }
 }
 
+// check if the character types of this procfile can be handled by the vectorized parser:
+// all the control characters and the space must be default, there must be no quotes or
+// open/close characters, and up to 8 more separators are allowed
+static void procfile_update_vectorization(procfile *ff) {
+    PF_CHAR_TYPE *ffs = ff->separators;
+    size_t count = 0;
+
+    for(int i = 0; i < 256 ;i++) {
+        if(i <= ' ' || i == 0x7f) {
+            if(ffs[i] != procfile_default_separators[i])
+                goto not_vectorizable;
+        }
+        else if(ffs[i] == PF_CHAR_IS_SEPARATOR) {
+            if(count >= sizeof(ff->vector_separators))
+                goto not_vectorizable;
+
+            ff->vector_separators[count++] = (uint8_t)i;
+        }
+        else if(ffs[i] != PF_CHAR_IS_WORD)
+            goto not_vectorizable;
+    }
+
+    ff->vector_separators_count = (uint8_t)count;
+    return;
+
+not_vectorizable:
+    ff->vector_separators_count = PROCFILE_NOT_VECTORIZABLE;
+}
+
 NOINLINE
 static void procfile_set_separators(procfile *ff, const char *separators) {
     // set the separators
@@ -393,6 +620,8 @@ static void procfile_set_separators(procfile *ff, const char *separators) {
     const char *s = separators;
     while(*s)
         ffs[(int)*s++] = PF_CHAR_IS_SEPARATOR;
+
+    procfile_update_vectorization(ff);
 }
 
 void procfile_set_quotes(procfile *ff, const char *quotes) {
@@ -404,14 +633,12 @@ void procfile_set_quotes(procfile *ff, const char *quotes) {
         if(unlikely(ffs[i] == PF_CHAR_IS_QUOTE))
             ffs[i] = PF_CHAR_IS_WORD;
 
-    // if nothing given, return
-    if(unlikely(!quotes || !*quotes))
-        return;
-
     // set the quotes
-    const char *s = quotes;
+    const char *s = (quotes) ? quotes : "";
     while(*s)
         ffs[(int)*s++] = PF_CHAR_IS_QUOTE;
+
+    procfile_update_vectorization(ff);
 }
 
 void procfile_set_open_close(procfile *ff, const char *open, const char *close) {
@@ -424,18 +651,19 @@ void procfile_set_open_close(procfile *ff, const char *open, const char *close)
             ffs[i] = PF_CHAR_IS_WORD;
 
     // if nothing given, return
-    if(unlikely(!open || !*open || !close || !*close))
-        return;
-
-    // set the openings
-    const char *s = open;
-    while(*s)
-        ffs[(int)*s++] = PF_CHAR_IS_OPEN;
+    if(likely(open && *open && close && *close)) {
+        // set the openings
+        const char *s = open;
+        while(*s)
+            ffs[(int)*s++] = PF_CHAR_IS_OPEN;
+
+        // set the closings
+        s = close;
+        while(*s)
+            ffs[(int)*s++] = PF_CHAR_IS_CLOSE;
+    }
 
-    // set the closings
-    s = close;
-    while(*s)
-        ffs[(int)*s++] = PF_CHAR_IS_CLOSE;
+    procfile_update_vectorization(ff);
 }
 
 procfile *procfile_open(const char *filename, const char *separators, uint32_t flags) {
@@ -456,7 +684,7 @@ procfile *procfile_open(const char *filename, const char *separators, uint32_t f
 
     // netdata_log_info("PROCFILE: opened '%s' on fd %d", filename, fd);
 
-    size_t size = (unlikely(procfile_adaptive_initial_allocation)) ? procfile_max_allocation : PROCFILE_INCREMENT_BUFFER;
+    size_t size = (unlikely(procfile_adaptive_initial_allocation)) ? procfile_max_get(procfile_max_allocation) : PROCFILE_INCREMENT_BUFFER;
     procfile *ff = mallocz(sizeof(procfile) + size);
 
     //strncpyz(ff->filename, filename, FILENAME_MAX);
@@ -469,6 +697,8 @@ procfile *procfile_open(const char *filename, const char *separators, uint32_t f
     ff->stats.reads = ff->stats.resizes = 0;
     ff->stats.max_lines = ff->stats.max_words = ff->stats.max_source_bytes = 0;
     ff->stats.total_read_bytes = ff->stats.max_read_size = 0;
+    ff->stats.last_read_ut = ff->stats.last_parse_ut = 0;
+    ff->prefetched = false;
 
     ff->lines = procfile_lines_create();
     ff->words = procfile_words_create();
@@ -483,6 +713,25 @@ procfile *procfile_open(const char *filename, const char *separators, uint32_t f
     return ff;
 }
 
+procfile *procfile_create(const char *separators, uint32_t flags) {
+    size_t size = (unlikely(procfile_adaptive_initial_allocation)) ? procfile_max_get(procfile_max_allocation) : PROCFILE_INCREMENT_BUFFER;
+    procfile *ff = callocz(1, sizeof(procfile) + size);
+
+    ff->fd = -1;
+    ff->size = size;
+    ff->flags = flags;
+
+    ff->lines = procfile_lines_create();
+    ff->words = procfile_words_create();
+
+    ff->stats.memory = sizeof(procfile) + size +
+                       (sizeof(pflines) + ff->lines->size * sizeof(ffline)) +
+                       (sizeof(pfwords) + ff->words->size * sizeof(char *));
+
+    procfile_set_separators(ff, separators);
+    return ff;
+}
+
 procfile *procfile_reopen(procfile *ff, const char *filename, const char *separators, uint32_t flags) {
     if(unlikely(!ff)) return procfile_open(filename, separators, flags);
 
@@ -497,6 +746,7 @@ procfile *procfile_reopen(procfile *ff, const char *filename, const char *separa
         return NULL;
     }
     ff->stats.opens++;
+    ff->prefetched = false;
 
     // netdata_log_info("PROCFILE: opened '%s' on fd %d", filename, ff->fd);
 
@@ -533,3 +783,284 @@ void procfile_print(procfile *ff) {
         }
     }
 }
+
+// ----------------------------------------------------------------------------
+// reading many procfiles in parallel
+
+struct procfile_batch {
+    procfile ***ffs;                    // the current batch
+    size_t count;
+    size_t next;                        // the next procfile to be read, atomically incremented
+
+    size_t threads;                     // including the caller
+    ND_EXECUTOR_GROUP *group;
+};
+
+static void procfile_batch_run(size_t slot __maybe_unused, void *ptr) {
+    PROCFILE_BATCH *pb = ptr;
+
+    size_t i;
+    while((i = __atomic_fetch_add(&pb->next, 1, __ATOMIC_RELAXED)) < pb->count) {
+        procfile **ff = pb->ffs[i];
+        if(!*ff)
+            continue;
+
+        (*ff)->prefetched = false;
+        *ff = procfile_readall(*ff);
+        if(*ff)
+            (*ff)->prefetched = true;
+    }
+}
+
+PROCFILE_BATCH *procfile_batch_create(size_t threads) {
+    PROCFILE_BATCH *pb = callocz(1, sizeof(*pb));
+    pb->threads = threads ? threads : 1;
+
+    // the files are read by the shared executor, at most this many at a time
+    pb->group = nd_executor_group_get("procfile", pb->threads);
+
+    return pb;
+}
+
+void procfile_batch_destroy(PROCFILE_BATCH *pb) {
+    freez(pb);
+}
+
+void procfile_batch_readall(PROCFILE_BATCH *pb, procfile ***ffs, size_t count) {
+    if(!count)
+        return;
+
+    pb->ffs = ffs;
+    pb->count = count;
+    pb->next = 0;
+
+    nd_executor_parallel(pb->group, ND_EXECUTOR_PRIORITY_HIGH, MIN(pb->threads, count), procfile_batch_run, pb);
+}
+
+// ----------------------------------------------------------------------------
+// unit test - the vectorized parser has to give the same lines and words with procfile_parser()
+
+static procfile *procfile_unittest_create(const char *data, size_t len, const char *separators) {
+    procfile *ff = callocz(1, sizeof(procfile) + len + 1);
+    ff->fd = -1;
+    ff->size = len + 1;
+    ff->len = len;
+    memcpy(ff->data, data, len);
+    ff->lines = procfile_lines_create();
+    ff->words = procfile_words_create();
+    procfile_set_separators(ff, separators);
+    return ff;
+}
+
+static void procfile_unittest_reset(procfile *ff, const char *data, size_t len) {
+    memcpy(ff->data, data, len);
+    ff->len = len;
+    procfile_lines_reset(ff->lines);
+    procfile_words_reset(ff->words);
+}
+
+static void procfile_unittest_free(procfile *ff) {
+    procfile_lines_free(ff->lines);
+    procfile_words_free(ff->words);
+    freez(ff);
+}
+
+static bool procfile_unittest_same(procfile *a, procfile *b) {
+    if(a->lines->len != b->lines->len || a->words->len != b->words->len)
+        return false;
+
+    for(size_t l = 0; l < a->lines->len ;l++)
+        if(a->lines->lines[l].words != b->lines->lines[l].words || a->lines->lines[l].first != b->lines->lines[l].first)
+            return false;
+
+    for(size_t w = 0; w < a->words->len ;w++)
+        if(a->words->words[w] - a->data != b->words->words[w] - b->data || strcmp(a->words->words[w], b->words->words[w]) != 0)
+            return false;
+
+    return true;
+}
+
+static int procfile_unittest_compare(const char *title, const char *data, size_t len, const char *separators, bool report) {
+    procfile *ref = procfile_unittest_create(data, len, separators);
+    procfile *vec = procfile_unittest_create(data, len, separators);
+    int errors = 0;
+
+    procfile_parser(ref);
+#if defined(__SSE2__)
+    if(vec->vector_separators_count != PROCFILE_NOT_VECTORIZABLE)
+        procfile_parser_vectorized(vec);
+    else
+#endif
+        procfile_parser(vec);
+
+    if(!procfile_unittest_same(ref, vec)) {
+        fprintf(stderr, "PROCFILE: the parsers disagree on %s (%zu bytes): %zu lines %zu words vs %zu lines %zu words\n",
+                title, len, ref->lines->len, ref->words->len, vec->lines->len, vec->words->len);
+        errors++;
+    }
+    else if(report)
+        fprintf(stderr, "PROCFILE: %-30s %8zu bytes, %6zu lines, %7zu words - OK\n",
+                title, len, ref->lines->len, ref->words->len);
+
+    procfile_unittest_free(ref);
+    procfile_unittest_free(vec);
+    return errors;
+}
+
+static void procfile_unittest_benchmark(const char *title, const char *data, size_t len, const char *separators) {
+    procfile *ff = procfile_unittest_create(data, len, separators);
+
+    usec_t ut[2] = { 0, 0 };
+    size_t runs = 0;
+    for(int p = 0; p < 2 ;p++) {
+        usec_t started_ut = now_monotonic_high_precision_usec();
+        runs = 0;
+        do {
+            for(size_t i = 0; i < 100 ;i++, runs++) {
+                procfile_unittest_reset(ff, data, len);
+                if(p == 0)
+                    procfile_parser(ff);
+                else
+                    procfile_parse(ff);
+            }
+            ut[p] = now_monotonic_high_precision_usec() - started_ut;
+        } while(ut[p] < USEC_PER_SEC / 2);
+        ut[p] /= runs;
+        if(!ut[p]) ut[p] = 1;
+    }
+
+    fprintf(stderr, "PROCFILE: %-30s scalar %6"PRIu64" us, vectorized %6"PRIu64" us per parse (%.2fx)\n",
+            title, ut[0], ut[1], (double)ut[0] / (double)ut[1]);
+
+    procfile_unittest_free(ff);
+}
+
+// procfile_pread() on a file kept open has to give the same words with procfile_readall()
+static int procfile_unittest_pread(const char *data, size_t len) {
+    char filename[] = "/tmp/netdata-procfile-unittest-XXXXXX";
+    int fd = mkstemp(filename);
+    if(fd == -1) {
+        fprintf(stderr, "PROCFILE: cannot create a temporary file for the pread test - SKIPPED\n");
+        return 0;
+    }
+
+    int errors = 0;
+    if(write(fd, data, len) != (ssize_t)len) {
+        fprintf(stderr, "PROCFILE: cannot write the temporary file for the pread test\n");
+        errors++;
+    }
+
+    procfile *ff = procfile_open(filename, NULL, PROCFILE_FLAG_DEFAULT);
+    procfile *pf = procfile_create(NULL, PROCFILE_FLAG_DEFAULT);
+    ff = procfile_readall(ff);
+
+    // twice, the file position of fd is at its end after the write
+    for(size_t i = 0; i < 2 && !errors ;i++) {
+        if(!ff || !procfile_pread(&pf, fd)) {
+            fprintf(stderr, "PROCFILE: cannot read the file for the pread test\n");
+            errors++;
+            break;
+        }
+
+        if(pf->len != len || pf->words->len != ff->words->len || procfile_lines(pf) != procfile_lines(ff)) {
+            fprintf(stderr, "PROCFILE: pread gave %zu bytes, %zu words, %zu lines, expected %zu bytes, %zu words, %zu lines\n",
+                    pf->len, pf->words->len, procfile_lines(pf), len, ff->words->len, procfile_lines(ff));
+            errors++;
+            break;
+        }
+
+        for(size_t w = 0; w < ff->words->len ;w++) {
+            if(strcmp(procfile_word(pf, w), procfile_word(ff, w)) != 0) {
+                fprintf(stderr, "PROCFILE: pread word %zu is '%s', expected '%s'\n", w, procfile_word(pf, w), procfile_word(ff, w));
+                errors++;
+                break;
+            }
+        }
+    }
+
+    procfile_close(ff);
+    procfile_close(pf);
+    close(fd);
+    unlink(filename);
+
+    fprintf(stderr, "PROCFILE: pread of a file kept open - %s\n", errors ? "FAILED" : "OK");
+    return errors;
+}
+
+int procfile_unittest(void) {
+    int errors = 0;
+
+    struct {
+        const char *title;
+        const char *data;
+        const char *separators;
+    } cases[] = {
+        { "empty", "", NULL },
+        { "one word", "word", NULL },
+        { "one line", "a b c\n", NULL },
+        { "separator before newline", "a b \n\nc", NULL },
+        { "separators only", "   \t \n  \n", NULL },
+        { "crlf", "a\r\nb c\r\n", NULL },
+        { "custom separators", "key: 1234 kB\nother:5\n", " \t:" },
+        { "many separators", "a,b;c=d|e:f g\th/i-j\n", " \t,;=|:/-" },
+        { "not vectorizable", "a,b;c=d|e:f+g*h/i-j\n", " \t,;=|:/-+*" },
+        { NULL, NULL, NULL },
+    };
+
+    for(size_t i = 0; cases[i].title ;i++)
+        errors += procfile_unittest_compare(cases[i].title, cases[i].data, strlen(cases[i].data), cases[i].separators, true);
+
+    // random inputs, with a bias to separators and newlines
+    const char alphabet[] = "ab1:  \t\t\n\r\x01\x7f\xc3 =|";
+    char buf[300];
+    size_t failed_random = 0;
+    for(size_t i = 0; i < 20000 ;i++) {
+        size_t len = os_random32() % sizeof(buf);
+        for(size_t c = 0; c < len ;c++)
+            buf[c] = alphabet[os_random32() % (sizeof(alphabet) - 1)];
+
+        failed_random += procfile_unittest_compare("random", buf, len, (i % 2) ? " \t:" : NULL, false);
+    }
+    if(failed_random)
+        fprintf(stderr, "PROCFILE: %zu random inputs failed\n", failed_random);
+    else
+        fprintf(stderr, "PROCFILE: 20000 random inputs - OK\n");
+    errors += (int)failed_random;
+
+    // a /proc/interrupts and a /proc/stat of a 256 core machine
+    BUFFER *interrupts = buffer_create(0, NULL);
+    BUFFER *stat = buffer_create(0, NULL);
+
+    buffer_strcat(interrupts, "     ");
+    for(size_t c = 0; c < 256 ;c++)
+        buffer_sprintf(interrupts, "     CPU%-4zu", c);
+    buffer_strcat(interrupts, "\n");
+
+    for(size_t irq = 0; irq < 120 ;irq++) {
+        buffer_sprintf(interrupts, "%4zu:", irq);
+        for(size_t c = 0; c < 256 ;c++)
+            buffer_sprintf(interrupts, " %10u", (irq * 7 + c) % 5 ? 0 : os_random32() % 100000);
+        buffer_sprintf(interrupts, "  IR-PCI-MSI %zu-edge      nvme0q%zu\n", irq * 4096, irq);
+    }
+
+    buffer_strcat(stat, "cpu  10132153 290696 3084719 46828483 16683 0 25195 0 0 0\n");
+    for(size_t c = 0; c < 256 ;c++)
+        buffer_sprintf(stat, "cpu%zu %u %u %u %u %u 0 %u 0 0 0\n", c,
+                       os_random32() % 10000000, os_random32() % 100000, os_random32() % 1000000,
+                       os_random32() % 100000000, os_random32() % 10000, os_random32() % 100000);
+    buffer_strcat(stat, "ctxt 1990473\nbtime 1062191376\nprocesses 2915\nprocs_running 1\nprocs_blocked 0\n");
+
+    errors += procfile_unittest_compare("interrupts of 256 cpus", buffer_tostring(interrupts), buffer_strlen(interrupts), NULL, true);
+    errors += procfile_unittest_compare("stat of 256 cpus", buffer_tostring(stat), buffer_strlen(stat), NULL, true);
+
+    procfile_unittest_benchmark("interrupts of 256 cpus", buffer_tostring(interrupts), buffer_strlen(interrupts), NULL);
+    procfile_unittest_benchmark("stat of 256 cpus", buffer_tostring(stat), buffer_strlen(stat), NULL);
+
+    errors += procfile_unittest_pread(buffer_tostring(stat), buffer_strlen(stat));
+
+    buffer_free(interrupts);
+    buffer_free(stat);
+
+    fprintf(stderr, "PROCFILE: %s\n", errors ? "FAILED" : "OK");
+    return errors ? 1 : 0;
+}
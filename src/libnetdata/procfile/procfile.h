@@ -36,6 +36,9 @@ typedef struct {
 #define PROCFILE_FLAG_DEFAULT             0x00000000 // To store inside `collector.log`
 #define PROCFILE_FLAG_NO_ERROR_ON_FILE_IO 0x00000001 // Do not log anything
 #define PROCFILE_FLAG_ERROR_ON_ERROR_LOG  0x00000002 // Store inside `error.log`
+#define PROCFILE_FLAG_NO_PARSE            0x00000004 // Only read the file (null terminated), without splitting it into lines and words
+
+#define PROCFILE_NOT_VECTORIZABLE 0xff
 
 typedef enum __attribute__ ((__packed__)) procfile_separator {
     PF_CHAR_IS_SEPARATOR,
@@ -56,6 +59,8 @@ struct procfile_stats {
     size_t max_lines;
     size_t max_words;
     size_t max_read_size;
+    usec_t last_read_ut;            // the time the last procfile_readall() spent in read()
+    usec_t last_parse_ut;           // the time the last procfile_readall() spent parsing
 };
 
 
@@ -69,6 +74,9 @@ typedef struct procfile {
     size_t size;                    // the bytes we have allocated for data
     pflines *lines;
     pfwords *words;
+    bool prefetched;                // read by procfile_batch_readall(), not consumed yet
+    uint8_t vector_separators_count; // PROCFILE_NOT_VECTORIZABLE when the vectorized parser cannot be used
+    uint8_t vector_separators[8];   // the printable separators, for the vectorized parser
     PF_CHAR_TYPE separators[256];
     struct procfile_stats stats;
     char data[];                    // allocated buffer to keep file contents
@@ -80,9 +88,21 @@ void procfile_close(procfile *ff);
 // (re)read and parse the proc file
 procfile *procfile_readall(procfile *ff);
 
+// the total time the calling thread has spent reading and parsing files so far
+void procfile_thread_times(usec_t *read_ut, usec_t *parse_ut);
+
 // open a /proc or /sys file
 procfile *procfile_open(const char *filename, const char *separators, uint32_t flags);
 
+// create a procfile that is not attached to a file,
+// to parse files kept open by the caller with procfile_pread()
+procfile *procfile_create(const char *separators, uint32_t flags);
+
+// read with pread() and parse the whole file fd into ff, which may be reallocated.
+// the fd belongs to the caller and it is not closed, not even on failure:
+// on failure ff remains valid, empty, and false is returned.
+bool procfile_pread(procfile **ff, int fd);
+
 // re-open a file
 // if separators == NULL, the last separators are used
 procfile *procfile_reopen(procfile *ff, const char *filename, const char *separators, uint32_t flags);
@@ -95,6 +115,21 @@ void procfile_set_open_close(procfile *ff, const char *open, const char *close);
 
 char *procfile_filename(procfile *ff);
 
+// ----------------------------------------------------------------------------
+// read and parse many procfiles in parallel, using the threads of the executor
+
+typedef struct procfile_batch PROCFILE_BATCH;
+
+PROCFILE_BATCH *procfile_batch_create(size_t threads);
+void procfile_batch_destroy(PROCFILE_BATCH *pb);
+
+// re-read all the given procfiles (NULL ones are skipped) and mark them prefetched,
+// so that the next procfile_readall() on each of them returns immediately.
+// procfiles that fail are closed and set to NULL, exactly like procfile_readall() does.
+void procfile_batch_readall(PROCFILE_BATCH *pb, procfile ***ffs, size_t count);
+
+int procfile_unittest(void);
+
 // ----------------------------------------------------------------------------
 
 // set to the O_XXXX flags, to have procfile_open and procfile_reopen use them when opening proc files
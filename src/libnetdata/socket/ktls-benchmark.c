@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "../libnetdata.h"
+
+// Compares the throughput of userspace TLS against kernel TLS offload (kTLS),
+// over a loopback TCP connection, using a throw-away self-signed certificate.
+// Run it with: netdata -W ktlstest
+
+#define KTLS_BENCH_BYTES (1024ULL * 1024ULL * 1024ULL)  // 1 GiB per run
+#define KTLS_BENCH_CHUNK (64 * 1024)                  // bytes per write() call
+#define KTLS_BENCH_ACCEPT_TIMEOUT_MS (10 * MSEC_PER_SEC)  // how long the server waits for the client
+
+#if defined(SSL_OP_ENABLE_KTLS) && (OPENSSL_VERSION_NUMBER >= OPENSSL_VERSION_300)
+
+typedef struct {
+    int listen_fd;
+    SSL_CTX *ctx;
+    size_t received;
+    usec_t duration_ut;
+    bool ktls_recv;
+    bool ok;
+} KTLS_BENCH_SERVER;
+
+static bool ktls_bench_self_signed(SSL_CTX *ctx) {
+    EVP_PKEY *pkey = EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256");
+    if(!pkey)
+        return false;
+
+    X509 *x509 = X509_new();
+    if(!x509) {
+        EVP_PKEY_free(pkey);
+        return false;
+    }
+
+    ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509), 3600);
+    X509_set_pubkey(x509, pkey);
+
+    X509_NAME *name = X509_get_subject_name(x509);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)"localhost", -1, -1, 0);
+    X509_set_issuer_name(x509, name);
+
+    bool ok = X509_sign(x509, pkey, EVP_sha256()) > 0 &&
+              SSL_CTX_use_certificate(ctx, x509) == 1 &&
+              SSL_CTX_use_PrivateKey(ctx, pkey) == 1;
+
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+    return ok;
+}
+
+static void ktls_bench_server_thread(void *arg) {
+    KTLS_BENCH_SERVER *srv = arg;
+
+    // do not block forever in accept() when the client fails to connect
+    struct pollfd pfd = { .fd = srv->listen_fd, .events = POLLIN };
+    if(poll(&pfd, 1, KTLS_BENCH_ACCEPT_TIMEOUT_MS) != 1 || !(pfd.revents & POLLIN))
+        return;
+
+    int fd = accept(srv->listen_fd, NULL, NULL);
+    if(fd < 0)
+        return;
+
+    NETDATA_SSL ssl = NETDATA_SSL_UNSET_CONNECTION;
+    if(netdata_ssl_open(&ssl, srv->ctx, fd) && netdata_ssl_accept(&ssl)) {
+        srv->ktls_recv = ssl.ktls_recv;
+
+        char *buf = mallocz(KTLS_BENCH_CHUNK);
+        usec_t started_ut = now_monotonic_high_precision_usec();
+
+        while(srv->received < KTLS_BENCH_BYTES) {
+            ssize_t rc = netdata_ssl_read(&ssl, buf, KTLS_BENCH_CHUNK);
+            if(rc <= 0)
+                break;
+            srv->received += rc;
+        }
+
+        srv->duration_ut = now_monotonic_high_precision_usec() - started_ut;
+        srv->ok = (srv->received == KTLS_BENCH_BYTES);
+        freez(buf);
+    }
+
+    netdata_ssl_close(&ssl);
+    close(fd);
+}
+
+static bool ktls_bench_run(const char *title, bool ktls, SSL_CTX *server_ctx, SSL_CTX *client_ctx) {
+    if(ktls) {
+        SSL_CTX_set_options(server_ctx, SSL_OP_ENABLE_KTLS);
+        SSL_CTX_set_options(client_ctx, SSL_OP_ENABLE_KTLS);
+    }
+    else {
+        SSL_CTX_clear_options(server_ctx, SSL_OP_ENABLE_KTLS);
+        SSL_CTX_clear_options(client_ctx, SSL_OP_ENABLE_KTLS);
+    }
+
+    KTLS_BENCH_SERVER srv = { .listen_fd = -1, .ctx = server_ctx };
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        .sin_port = 0,
+    };
+    socklen_t addr_len = sizeof(addr);
+
+    srv.listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(srv.listen_fd < 0 ||
+        bind(srv.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(srv.listen_fd, 1) != 0 ||
+        getsockname(srv.listen_fd, (struct sockaddr *)&addr, &addr_len) != 0) {
+        fprintf(stderr, "%-20s: cannot setup the loopback listener: %s\n", title, strerror(errno));
+        if(srv.listen_fd >= 0) close(srv.listen_fd);
+        return false;
+    }
+
+    ND_THREAD *thread = nd_thread_create("KTLSBENCH", NETDATA_THREAD_OPTION_DONT_LOG, ktls_bench_server_thread, &srv);
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool ok = false, ktls_send = false;
+    size_t sent = 0;
+    usec_t duration_ut = 0;
+
+    if(fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        NETDATA_SSL ssl = NETDATA_SSL_UNSET_CONNECTION;
+        if(netdata_ssl_open(&ssl, client_ctx, fd) && netdata_ssl_connect(&ssl)) {
+            ktls_send = ssl.ktls_send;
+
+            char *buf = mallocz(KTLS_BENCH_CHUNK);
+            memset(buf, 'x', KTLS_BENCH_CHUNK);
+            usec_t started_ut = now_monotonic_high_precision_usec();
+
+            while(sent < KTLS_BENCH_BYTES) {
+                size_t len = MIN(KTLS_BENCH_CHUNK, KTLS_BENCH_BYTES - sent);
+                ssize_t rc = netdata_ssl_write(&ssl, buf, len);
+                if(rc <= 0)
+                    break;
+                sent += rc;
+            }
+
+            duration_ut = now_monotonic_high_precision_usec() - started_ut;
+            ok = (sent == KTLS_BENCH_BYTES);
+            freez(buf);
+        }
+        netdata_ssl_close(&ssl);
+    }
+
+    if(fd >= 0)
+        close(fd);
+
+    nd_thread_join(thread);
+    close(srv.listen_fd);
+
+    if(!ok || !srv.ok) {
+        fprintf(stderr, "%-20s: FAILED (sent %zu, received %zu bytes)\n", title, sent, srv.received);
+        return false;
+    }
+
+    usec_t ut = MAX(duration_ut, srv.duration_ut);
+    fprintf(stderr, "%-20s: %8.2f MiB/s (kTLS TX: %-3s RX: %-3s) %zu MiB in %.2f ms\n",
+            title,
+            (double)KTLS_BENCH_BYTES / 1024.0 / 1024.0 * USEC_PER_SEC / (double)ut,
+            ktls_send ? "yes" : "no", srv.ktls_recv ? "yes" : "no",
+            (size_t)(KTLS_BENCH_BYTES / 1024 / 1024),
+            (double)ut / USEC_PER_MS);
+
+    return true;
+}
+
+int netdata_ssl_ktls_benchmark(void) {
+    netdata_ssl_initialize_openssl();
+
+    SSL_CTX *server_ctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX *client_ctx = netdata_ssl_create_client_ctx(SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    if(!server_ctx || !client_ctx || !ktls_bench_self_signed(server_ctx)) {
+        fprintf(stderr, "Cannot initialize the TLS contexts for the benchmark\n");
+        if(server_ctx) SSL_CTX_free(server_ctx);
+        if(client_ctx) SSL_CTX_free(client_ctx);
+        return 1;
+    }
+    SSL_CTX_set_verify(client_ctx, SSL_VERIFY_NONE, NULL);
+
+    int errors = 0;
+    const char *ciphers[] = { "TLS_AES_128_GCM_SHA256", "TLS_AES_256_GCM_SHA384", "TLS_CHACHA20_POLY1305_SHA256", NULL };
+
+    for(size_t i = 0; ciphers[i]; i++) {
+        SSL_CTX_set_ciphersuites(server_ctx, ciphers[i]);
+        SSL_CTX_set_ciphersuites(client_ctx, ciphers[i]);
+
+        fprintf(stderr, "\n%s:\n", ciphers[i]);
+        errors += ktls_bench_run("userspace TLS", false, server_ctx, client_ctx) ? 0 : 1;
+        errors += ktls_bench_run("kernel TLS offload", true, server_ctx, client_ctx) ? 0 : 1;
+    }
+
+    NETDATA_SSL_KTLS_STATISTICS stats;
+    netdata_ssl_ktls_get_statistics(&stats);
+    fprintf(stderr, "\nkTLS handshakes: %zu, TX offloaded: %zu, RX offloaded: %zu, fallbacks to userspace: %zu\n",
+            stats.handshakes, stats.send_offloaded, stats.recv_offloaded, stats.fallbacks);
+
+    if(stats.fallbacks)
+        fprintf(stderr, "Some connections fell back to userspace TLS - is the 'tls' kernel module loaded (modprobe tls)?\n");
+
+    SSL_CTX_free(server_ctx);
+    SSL_CTX_free(client_ctx);
+    return errors ? 1 : 0;
+}
+
+#else // !SSL_OP_ENABLE_KTLS
+
+int netdata_ssl_ktls_benchmark(void) {
+    fprintf(stderr, "Kernel TLS offload is not supported by the OpenSSL library netdata is compiled with.\n");
+    return 0;
+}
+
+#endif
@@ -117,7 +117,7 @@ static int create_listen_socket_unix(const char *path, int listen_backlog) {
     return sock;
 }
 
-static int create_listen_socket4(int socktype, const char *ip, uint16_t port, int listen_backlog) {
+static int create_listen_socket4(int socktype, const char *ip, uint16_t port, int listen_backlog, bool reuse_port) {
     int sock;
 
     sock = socket(AF_INET, socktype | DEFAULT_SOCKET_FLAGS, 0);
@@ -134,7 +134,13 @@ static int create_listen_socket4(int socktype, const char *ip, uint16_t port, in
                "LISTENER: IPv4 socket on ip '%s' port %d, socktype %d failed to enable reuse address.",
                ip, port, socktype);
 
-    if(sock_setreuse_port(sock, false) == 1) // -1 means not supported
+    if(reuse_port) {
+        if(sock_setreuse_port(sock, true) != 1)
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "LISTENER: IPv4 socket on ip '%s' port %d, socktype %d failed to enable reuse port.",
+                   ip, port, socktype);
+    }
+    else if(sock_setreuse_port(sock, false) == 1) // -1 means not supported
         nd_log(NDLS_DAEMON, NDLP_ERR,
                "LISTENER: IPv4 socket on ip '%s' port %d, socktype %d failed to disable reuse port.",
                ip, port, socktype);
@@ -191,7 +197,7 @@ static int create_listen_socket4(int socktype, const char *ip, uint16_t port, in
     return sock;
 }
 
-static int create_listen_socket6(int socktype, uint32_t scope_id, const char *ip, int port, int listen_backlog) {
+static int create_listen_socket6(int socktype, uint32_t scope_id, const char *ip, int port, int listen_backlog, bool reuse_port) {
     int sock;
     int ipv6only = 1;
 
@@ -209,7 +215,13 @@ static int create_listen_socket6(int socktype, uint32_t scope_id, const char *ip
                "LISTENER: IPv6 socket on ip '%s' port %d, socktype %d failed to set reuse address.",
                ip, port, socktype);
 
-    if(sock_setreuse_port(sock, false) == 1) // -1 means not supported
+    if(reuse_port) {
+        if(sock_setreuse_port(sock, true) != 1)
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "LISTENER: IPv6 socket on ip '%s' port %d, socktype %d failed to enable reuse port.",
+                   ip, port, socktype);
+    }
+    else if(sock_setreuse_port(sock, false) == 1) // -1 means not supported
         nd_log(NDLS_DAEMON, NDLP_ERR,
                "LISTENER: IPv6 socket on ip '%s' port %d, socktype %d failed to disable reuse port.",
                ip, port, socktype);
@@ -331,6 +343,84 @@ void listen_sockets_close(LISTEN_SOCKETS *sockets) {
     sockets->failed = 0;
 }
 
+// open another socket on the same address of each UDP socket of 'src', so that
+// the kernel distributes the incoming datagrams among them (SO_REUSEPORT).
+// 'src' has to be setup with 'udp_reuse_port' enabled.
+int listen_sockets_clone_udp_reuseport(LISTEN_SOCKETS *dst, LISTEN_SOCKETS *src) {
+    listen_sockets_init(dst);
+
+    size_t i;
+    for(i = 0; i < src->opened ;i++) {
+        if(src->fds_types[i] != SOCK_DGRAM || (src->fds_families[i] != AF_INET && src->fds_families[i] != AF_INET6))
+            continue;
+
+        struct sockaddr_storage addr;
+        socklen_t addr_len = sizeof(addr);
+        if(getsockname(src->fds[i], (struct sockaddr *)&addr, &addr_len) != 0) {
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "LISTENER: cannot get the address of listen socket %s to clone it.",
+                   src->fds_names[i]);
+            dst->failed++;
+            continue;
+        }
+
+        int sock = socket(src->fds_families[i], SOCK_DGRAM | DEFAULT_SOCKET_FLAGS, 0);
+        if(sock < 0) {
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "LISTENER: socket() failed while cloning listen socket %s.",
+                   src->fds_names[i]);
+            dst->failed++;
+            continue;
+        }
+
+        sock_setreuse_addr(sock, true);
+        if(sock_setreuse_port(sock, true) != 1) {
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "LISTENER: reuse port is not supported, cannot clone listen socket %s.",
+                   src->fds_names[i]);
+            close(sock);
+            dst->failed++;
+            continue;
+        }
+
+        sock_setnonblock(sock, true);
+        sock_setcloexec(sock, true);
+        sock_enlarge_rcv_buf(sock);
+
+        if(src->fds_families[i] == AF_INET6) {
+            int ipv6only = 1;
+            if(setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, (void *)&ipv6only, sizeof(ipv6only)) != 0)
+                nd_log(NDLS_DAEMON, NDLP_ERR,
+                       "LISTENER: Cannot set IPV6_V6ONLY on cloned listen socket %s.",
+                       src->fds_names[i]);
+        }
+
+        if(bind(sock, (struct sockaddr *)&addr, addr_len) < 0) {
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "LISTENER: bind() failed while cloning listen socket %s.",
+                   src->fds_names[i]);
+            close(sock);
+            dst->failed++;
+            continue;
+        }
+
+        if(dst->opened >= MAX_LISTEN_FDS) {
+            close(sock);
+            dst->failed++;
+            continue;
+        }
+
+        dst->fds[dst->opened] = sock;
+        dst->fds_types[dst->opened] = SOCK_DGRAM;
+        dst->fds_families[dst->opened] = src->fds_families[i];
+        dst->fds_names[dst->opened] = strdupz(src->fds_names[i]);
+        dst->fds_acl_flags[dst->opened] = src->fds_acl_flags[i];
+        dst->opened++;
+    }
+
+    return (int)dst->opened;
+}
+
 static inline int bind_to_this(LISTEN_SOCKETS *sockets, const char *definition, uint16_t default_port, int listen_backlog) {
     int added = 0;
     HTTP_ACL acl_flags = HTTP_ACL_NONE;
@@ -482,7 +572,8 @@ static inline int bind_to_this(LISTEN_SOCKETS *sockets, const char *definition,
                 struct sockaddr_in *sin = (struct sockaddr_in *) rp->ai_addr;
                 inet_ntop(AF_INET, &sin->sin_addr, rip, INET_ADDRSTRLEN);
                 rport = ntohs(sin->sin_port);
-                fd = create_listen_socket4(socktype, rip, rport, listen_backlog);
+                fd = create_listen_socket4(socktype, rip, rport, listen_backlog,
+                                           socktype == SOCK_DGRAM && sockets->udp_reuse_port);
                 break;
             }
 
@@ -490,7 +581,8 @@ static inline int bind_to_this(LISTEN_SOCKETS *sockets, const char *definition,
                 struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) rp->ai_addr;
                 inet_ntop(AF_INET6, &sin6->sin6_addr, rip, INET6_ADDRSTRLEN);
                 rport = ntohs(sin6->sin6_port);
-                fd = create_listen_socket6(socktype, scope_id, rip, rport, listen_backlog);
+                fd = create_listen_socket6(socktype, scope_id, rip, rport, listen_backlog,
+                                           socktype == SOCK_DGRAM && sockets->udp_reuse_port);
                 break;
             }
 
@@ -15,6 +15,7 @@ typedef struct listen_sockets {
     const char *default_bind_to;        // the default bind to configuration string
     uint16_t default_port;              // the default port to use
     int backlog;                        // the default listen backlog to use
+    bool udp_reuse_port;                // enable SO_REUSEPORT on UDP sockets, to allow cloning them
 
     size_t opened;                      // the number of sockets opened
     size_t failed;                      // the number of sockets attempted to open, but failed
@@ -27,5 +28,6 @@ typedef struct listen_sockets {
 
 int listen_sockets_setup(LISTEN_SOCKETS *sockets);
 void listen_sockets_close(LISTEN_SOCKETS *sockets);
+int listen_sockets_clone_udp_reuseport(LISTEN_SOCKETS *dst, LISTEN_SOCKETS *src);
 
 #endif //NETDATA_LISTEN_SOCKETS_H
@@ -140,6 +140,19 @@ static ssize_t nd_sock_send_nowait(ND_SOCK *s, void *buf, size_t num) {
         return send(s->fd, buf, num, MSG_DONTWAIT);
 }
 
+// gathered send - SSL encrypts one buffer at a time, so only the first one is sent there
+ALWAYS_INLINE
+static ssize_t nd_sock_sendv_nowait(ND_SOCK *s, struct iovec *iov, int iovcnt) {
+    if (nd_sock_is_ssl(s) || iovcnt == 1)
+        return nd_sock_send_nowait(s, iov[0].iov_base, iov[0].iov_len);
+
+    struct msghdr msg = {
+        .msg_iov = iov,
+        .msg_iovlen = iovcnt,
+    };
+    return sendmsg(s->fd, &msg, MSG_DONTWAIT);
+}
+
 ssize_t nd_sock_send_timeout(ND_SOCK *s, void *buf, size_t len, int flags, time_t timeout);
 ssize_t nd_sock_recv_timeout(ND_SOCK *s, void *buf, size_t len, int flags, time_t timeout);
 
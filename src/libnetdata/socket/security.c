@@ -9,6 +9,10 @@ const char *tls_version=NULL;
 const char *tls_ciphers=NULL;
 bool netdata_ssl_validate_certificate =  true;
 bool netdata_ssl_validate_certificate_sender =  true;
+bool netdata_ssl_kernel_tls = false;
+bool netdata_ssl_kernel_tls_sender = false;
+
+static NETDATA_SSL_KTLS_STATISTICS ktls_stats = { 0 };
 
 static SOCKET_PEERS netdata_ssl_peers(NETDATA_SSL *ssl) {
     int sock_fd;
@@ -181,6 +185,8 @@ bool netdata_ssl_open_ext(NETDATA_SSL *ssl, SSL_CTX *ctx, int fd, const unsigned
     }
 
     ssl->state = NETDATA_SSL_STATE_INIT;
+    ssl->ktls_send = false;
+    ssl->ktls_recv = false;
 
     ERR_clear_error();
 
@@ -477,6 +483,70 @@ static bool want_read_write_should_retry(NETDATA_SSL *ssl, int err) {
     return false; // an unknown error
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// kernel TLS offload
+//
+// OpenSSL 3.0+ can hand the session keys to the kernel (setsockopt(SOL_TLS, TLS_TX/TLS_RX)) right after
+// the handshake, when SSL_OP_ENABLE_KTLS is set on the context. From then on SSL_read()/SSL_write()
+// become plain recv()/send() on the socket and the kernel does the encryption.
+// When the kernel lacks the tls module, or the negotiated cipher cannot be offloaded, OpenSSL silently
+// stays in userspace, so enabling it is always safe; we only record what actually happened.
+
+static void netdata_ssl_ctx_set_ktls(SSL_CTX *ctx, bool enable, const char *who) {
+    if(!ctx || !enable)
+        return;
+
+#if defined(SSL_OP_ENABLE_KTLS)
+    SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+    netdata_log_info("SSL: kernel TLS offload enabled for %s connections", who);
+#else
+    netdata_log_info("SSL: kernel TLS offload requested for %s connections, "
+                     "but this OpenSSL does not support it - using userspace TLS", who);
+#endif
+}
+
+ALWAYS_INLINE
+static void netdata_ssl_ktls_check(NETDATA_SSL *ssl) {
+#if defined(SSL_OP_ENABLE_KTLS)
+    if(!(SSL_get_options(ssl->conn) & SSL_OP_ENABLE_KTLS))
+        return;
+
+    ssl->ktls_send = BIO_get_ktls_send(SSL_get_wbio(ssl->conn)) ? true : false;
+    ssl->ktls_recv = BIO_get_ktls_recv(SSL_get_rbio(ssl->conn)) ? true : false;
+
+    __atomic_add_fetch(&ktls_stats.handshakes, 1, __ATOMIC_RELAXED);
+    if(ssl->ktls_send)
+        __atomic_add_fetch(&ktls_stats.send_offloaded, 1, __ATOMIC_RELAXED);
+    if(ssl->ktls_recv)
+        __atomic_add_fetch(&ktls_stats.recv_offloaded, 1, __ATOMIC_RELAXED);
+
+    // kTLS RX needs newer kernels than TX, so without RX we still offload what matters most;
+    // only when TX is not offloaded, the connection falls back to userspace TLS
+    if(!ssl->ktls_send) {
+        __atomic_add_fetch(&ktls_stats.fallbacks, 1, __ATOMIC_RELAXED);
+
+        nd_log_limit_static_global_var(erl, 60, 0);
+        SOCKET_PEERS peers = netdata_ssl_peers(ssl);
+        nd_log_limit(&erl, NDLS_DAEMON, NDLP_INFO,
+                     "SSL: on socket local [[%s]:%d] <-> remote [[%s]:%d], kernel TLS is not active for sending "
+                     "(TX: %s, RX: %s, cipher: %s) - using userspace TLS. "
+                     "Is the 'tls' kernel module loaded?",
+                     peers.local.ip, peers.local.port, peers.peer.ip, peers.peer.port,
+                     ssl->ktls_send ? "yes" : "no", ssl->ktls_recv ? "yes" : "no",
+                     SSL_get_cipher(ssl->conn));
+    }
+#else
+    (void)ssl;
+#endif
+}
+
+void netdata_ssl_ktls_get_statistics(NETDATA_SSL_KTLS_STATISTICS *stats) {
+    stats->handshakes = __atomic_load_n(&ktls_stats.handshakes, __ATOMIC_RELAXED);
+    stats->send_offloaded = __atomic_load_n(&ktls_stats.send_offloaded, __ATOMIC_RELAXED);
+    stats->recv_offloaded = __atomic_load_n(&ktls_stats.recv_offloaded, __ATOMIC_RELAXED);
+    stats->fallbacks = __atomic_load_n(&ktls_stats.fallbacks, __ATOMIC_RELAXED);
+}
+
 bool netdata_ssl_connect(NETDATA_SSL *ssl) {
     errno = 0;
     ssl->ssl_errno = 0;
@@ -500,6 +570,7 @@ bool netdata_ssl_connect(NETDATA_SSL *ssl) {
     }
 
     ssl->state = NETDATA_SSL_STATE_COMPLETE;
+    netdata_ssl_ktls_check(ssl);
     return true;
 }
 
@@ -526,6 +597,7 @@ bool netdata_ssl_accept(NETDATA_SSL *ssl) {
     }
 
     ssl->state = NETDATA_SSL_STATE_COMPLETE;
+    netdata_ssl_ktls_check(ssl);
     return true;
 }
 
@@ -730,6 +802,8 @@ void netdata_ssl_initialize_ctx(int selector) {
 
                     if(netdata_ssl_web_server_ctx && !netdata_ssl_validate_certificate)
                         SSL_CTX_set_verify(netdata_ssl_web_server_ctx, SSL_VERIFY_NONE, NULL);
+
+                    netdata_ssl_ctx_set_ktls(netdata_ssl_web_server_ctx, netdata_ssl_kernel_tls, "web server");
                 }
             }
             break;
@@ -748,6 +822,8 @@ void netdata_ssl_initialize_ctx(int selector) {
 
                 if(netdata_ssl_streaming_sender_ctx && !netdata_ssl_validate_certificate_sender)
                     SSL_CTX_set_verify(netdata_ssl_streaming_sender_ctx, SSL_VERIFY_NONE, NULL);
+
+                netdata_ssl_ctx_set_ktls(netdata_ssl_streaming_sender_ctx, netdata_ssl_kernel_tls_sender, "streaming sender");
             }
             break;
         }
@@ -16,9 +16,11 @@ typedef struct netdata_ssl {
     SSL *conn;               // SSL connection
     NETDATA_SSL_STATE state; // The state for SSL connection
     unsigned long ssl_errno; // The SSL errno of the last SSL call
+    bool ktls_send;          // The kernel encrypts what we send (kTLS TX)
+    bool ktls_recv;          // The kernel decrypts what we receive (kTLS RX)
 } NETDATA_SSL;
 
-#define NETDATA_SSL_UNSET_CONNECTION (NETDATA_SSL){ .conn = NULL, .state = NETDATA_SSL_STATE_NOT_SSL, .ssl_errno = 0 }
+#define NETDATA_SSL_UNSET_CONNECTION (NETDATA_SSL){ .conn = NULL, .state = NETDATA_SSL_STATE_NOT_SSL, .ssl_errno = 0, .ktls_send = false, .ktls_recv = false }
 
 #define SSL_connection(ssl) ((ssl)->conn && (ssl)->state != NETDATA_SSL_STATE_NOT_SSL)
 
@@ -31,6 +33,16 @@ extern const char *tls_version;
 extern const char *tls_ciphers;
 extern bool netdata_ssl_validate_certificate;
 extern bool netdata_ssl_validate_certificate_sender;
+extern bool netdata_ssl_kernel_tls;
+extern bool netdata_ssl_kernel_tls_sender;
+
+typedef struct netdata_ssl_ktls_statistics {
+    size_t handshakes;      // completed handshakes on contexts with kTLS enabled
+    size_t send_offloaded;  // connections with kTLS TX active
+    size_t recv_offloaded;  // connections with kTLS RX active
+    size_t fallbacks;       // connections without kTLS TX, sending through userspace TLS
+} NETDATA_SSL_KTLS_STATISTICS;
+
 int ssl_security_location_for_context(SSL_CTX *ctx, const char *file, const char *path);
 
 void netdata_ssl_initialize_openssl();
@@ -53,4 +65,7 @@ ssize_t netdata_ssl_peek(NETDATA_SSL *ssl, void *buf, size_t num);
 ssize_t netdata_ssl_pending(NETDATA_SSL *ssl);
 bool netdata_ssl_has_pending(NETDATA_SSL *ssl);
 
+void netdata_ssl_ktls_get_statistics(NETDATA_SSL_KTLS_STATISTICS *stats);
+int netdata_ssl_ktls_benchmark(void);
+
 #endif //NETDATA_SECURITY_H
@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "../libnetdata.h"
+
+#define DDSKETCH_INITIAL_BINS 64
+#define DDSKETCH_MIN_INDEXABLE 1e-9
+
+// --------------------------------------------------------------------------------------------------------------------
+// the bucket store
+
+static void ddsketch_store_free(DDSKETCH_STORE *s) {
+    freez(s->bins);
+    memset(s, 0, sizeof(*s));
+}
+
+static void ddsketch_store_reset(DDSKETCH_STORE *s) {
+    if(s->bins)
+        memset(s->bins, 0, s->size * sizeof(*s->bins));
+
+    s->offset = s->min_key = s->max_key = 0;
+    s->count = 0;
+}
+
+// make room for 'key', returning the key to be incremented (it changes when the lowest keys are collapsed)
+static int32_t ddsketch_store_extend(DDSKETCH_STORE *s, uint32_t max_bins, int32_t key) {
+    int32_t new_min = MIN(key, s->min_key);
+    int32_t new_max = MAX(key, s->max_key);
+
+    if((int64_t)new_max - (int64_t)new_min + 1 > (int64_t)max_bins) {
+        // collapse the keys closest to zero
+        new_min = new_max - (int32_t)max_bins + 1;
+        if(key < new_min)
+            key = new_min;
+    }
+
+    uint32_t needed = (uint32_t)(new_max - new_min + 1);
+    if(needed > s->size) {
+        uint32_t size = MIN(max_bins, MAX(needed, s->size * 2));
+        s->bins = reallocz(s->bins, size * sizeof(*s->bins));
+        memset(&s->bins[s->size], 0, (size - s->size) * sizeof(*s->bins));
+        s->size = size;
+    }
+
+    uint64_t collapsed = 0;
+    for(int32_t k = s->min_key; k < new_min && k <= s->max_key; k++) {
+        collapsed += s->bins[k - s->offset];
+        s->bins[k - s->offset] = 0;
+    }
+
+    if(new_min < s->offset || new_max >= s->offset + (int32_t)s->size) {
+        // move the window to start at new_min
+        int32_t from = MAX(s->min_key, new_min);
+        if(from <= s->max_key) {
+            uint32_t dst = (uint32_t)(from - new_min);
+            uint32_t len = (uint32_t)(s->max_key - from + 1);
+            memmove(&s->bins[dst], &s->bins[from - s->offset], len * sizeof(*s->bins));
+            memset(s->bins, 0, dst * sizeof(*s->bins));
+            memset(&s->bins[dst + len], 0, (s->size - dst - len) * sizeof(*s->bins));
+        }
+        else
+            memset(s->bins, 0, s->size * sizeof(*s->bins));
+
+        s->offset = new_min;
+    }
+
+    s->bins[new_min - s->offset] += collapsed;
+    s->min_key = new_min;
+    s->max_key = new_max;
+    return key;
+}
+
+static inline void ddsketch_store_add(DDSKETCH_STORE *s, uint32_t max_bins, int32_t key, uint64_t n) {
+    if(unlikely(!s->count)) {
+        if(unlikely(!s->size)) {
+            s->size = MIN(DDSKETCH_INITIAL_BINS, max_bins);
+            s->bins = callocz(s->size, sizeof(*s->bins));
+        }
+        s->offset = s->min_key = s->max_key = key;
+    }
+    else if(unlikely(key < s->min_key || key > s->max_key))
+        key = ddsketch_store_extend(s, max_bins, key);
+
+    s->bins[key - s->offset] += n;
+    s->count += n;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// key <-> value mapping
+
+static inline int32_t ddsketch_key(const DDSKETCH *sk, NETDATA_DOUBLE value) {
+    return (int32_t)ceilndd(logndd(value) * sk->multiplier);
+}
+
+static inline NETDATA_DOUBLE ddsketch_value(const DDSKETCH *sk, int32_t key) {
+    // the middle of the bucket (gamma^(key-1), gamma^key], in terms of relative error
+    return 2.0 * powndd(sk->gamma, (NETDATA_DOUBLE)key) / (sk->gamma + 1.0);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// public API
+
+DDSKETCH *ddsketch_create(NETDATA_DOUBLE relative_error, uint32_t max_bins) {
+    if(!(relative_error > 0.0 && relative_error < 1.0))
+        relative_error = DDSKETCH_DEFAULT_RELATIVE_ERROR;
+
+    if(max_bins < 16)
+        max_bins = 16;
+
+    DDSKETCH *sk = callocz(1, sizeof(*sk));
+    sk->relative_error = relative_error;
+    sk->gamma = (1.0 + relative_error) / (1.0 - relative_error);
+    sk->multiplier = 1.0 / logndd(sk->gamma);
+    sk->min_indexable = DDSKETCH_MIN_INDEXABLE;
+    sk->max_bins = max_bins;
+    ddsketch_reset(sk);
+    return sk;
+}
+
+void ddsketch_destroy(DDSKETCH *sk) {
+    if(!sk) return;
+
+    ddsketch_store_free(&sk->positive);
+    ddsketch_store_free(&sk->negative);
+    freez(sk);
+}
+
+void ddsketch_reset(DDSKETCH *sk) {
+    ddsketch_store_reset(&sk->positive);
+    ddsketch_store_reset(&sk->negative);
+    sk->zero_count = 0;
+    sk->count = 0;
+    sk->min = NAN;
+    sk->max = NAN;
+    sk->sum = 0;
+    sk->mean = 0;
+    sk->m2 = 0;
+}
+
+void ddsketch_add(DDSKETCH *sk, NETDATA_DOUBLE value, uint64_t n) {
+    if(unlikely(!n || !netdata_double_isnumber(value)))
+        return;
+
+    if(value > sk->min_indexable)
+        ddsketch_store_add(&sk->positive, sk->max_bins, ddsketch_key(sk, value), n);
+    else if(value < -sk->min_indexable)
+        ddsketch_store_add(&sk->negative, sk->max_bins, ddsketch_key(sk, -value), n);
+    else
+        sk->zero_count += n;
+
+    if(unlikely(!sk->count)) {
+        sk->min = sk->max = value;
+    }
+    else {
+        if(value < sk->min) sk->min = value;
+        if(value > sk->max) sk->max = value;
+    }
+
+    sk->count += n;
+    sk->sum += value * (NETDATA_DOUBLE)n;
+
+    NETDATA_DOUBLE delta = value - sk->mean;
+    sk->mean += delta * (NETDATA_DOUBLE)n / (NETDATA_DOUBLE)sk->count;
+    sk->m2 += delta * (value - sk->mean) * (NETDATA_DOUBLE)n;
+}
+
+static void ddsketch_store_merge(DDSKETCH_STORE *dst, uint32_t max_bins, const DDSKETCH_STORE *src) {
+    if(!src->count)
+        return;
+
+    for(int32_t k = src->min_key; k <= src->max_key; k++) {
+        uint64_t c = src->bins[k - src->offset];
+        if(c)
+            ddsketch_store_add(dst, max_bins, k, c);
+    }
+}
+
+bool ddsketch_merge(DDSKETCH *dst, const DDSKETCH *src) {
+    if(dst->gamma != src->gamma || dst->max_bins != src->max_bins)
+        return false;
+
+    if(!src->count)
+        return true;
+
+    ddsketch_store_merge(&dst->positive, dst->max_bins, &src->positive);
+    ddsketch_store_merge(&dst->negative, dst->max_bins, &src->negative);
+    dst->zero_count += src->zero_count;
+
+    if(!dst->count) {
+        dst->min = src->min;
+        dst->max = src->max;
+        dst->mean = src->mean;
+        dst->m2 = src->m2;
+    }
+    else {
+        if(src->min < dst->min) dst->min = src->min;
+        if(src->max > dst->max) dst->max = src->max;
+
+        NETDATA_DOUBLE n_a = (NETDATA_DOUBLE)dst->count;
+        NETDATA_DOUBLE n_b = (NETDATA_DOUBLE)src->count;
+        NETDATA_DOUBLE delta = src->mean - dst->mean;
+        dst->mean += delta * n_b / (n_a + n_b);
+        dst->m2 += src->m2 + delta * delta * n_a * n_b / (n_a + n_b);
+    }
+
+    dst->count += src->count;
+    dst->sum += src->sum;
+    return true;
+}
+
+NETDATA_DOUBLE ddsketch_quantile(const DDSKETCH *sk, NETDATA_DOUBLE q) {
+    if(unlikely(!sk->count))
+        return NAN;
+
+    if(q <= 0.0) return sk->min;
+    if(q >= 1.0) return sk->max;
+
+    NETDATA_DOUBLE rank = q * (NETDATA_DOUBLE)(sk->count - 1);
+    NETDATA_DOUBLE result = sk->max;
+    uint64_t seen = 0;
+
+    // the negative values, from the largest absolute value down
+    const DDSKETCH_STORE *s = &sk->negative;
+    for(int32_t k = s->max_key; s->count && k >= s->min_key; k--) {
+        seen += s->bins[k - s->offset];
+        if((NETDATA_DOUBLE)seen > rank) {
+            result = -ddsketch_value(sk, k);
+            goto done;
+        }
+    }
+
+    seen += sk->zero_count;
+    if((NETDATA_DOUBLE)seen > rank) {
+        result = 0.0;
+        goto done;
+    }
+
+    s = &sk->positive;
+    for(int32_t k = s->min_key; s->count && k <= s->max_key; k++) {
+        seen += s->bins[k - s->offset];
+        if((NETDATA_DOUBLE)seen > rank) {
+            result = ddsketch_value(sk, k);
+            goto done;
+        }
+    }
+
+done:
+    // the exact min and max are known
+    if(result < sk->min) result = sk->min;
+    if(result > sk->max) result = sk->max;
+    return result;
+}
+
+NETDATA_DOUBLE ddsketch_average(const DDSKETCH *sk) {
+    if(unlikely(!sk->count))
+        return NAN;
+
+    return sk->sum / (NETDATA_DOUBLE)sk->count;
+}
+
+NETDATA_DOUBLE ddsketch_stddev(const DDSKETCH *sk) {
+    if(unlikely(!sk->count))
+        return NAN;
+
+    // same as standard_deviation(): population stddev, and the value itself for a single sample
+    if(unlikely(sk->count == 1))
+        return sk->mean;
+
+    return sqrtndd(sk->m2 / (NETDATA_DOUBLE)sk->count);
+}
+
+size_t ddsketch_memory(const DDSKETCH *sk) {
+    return sizeof(*sk) + (sk->positive.size + sk->negative.size) * sizeof(uint64_t);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// unittest
+
+static int ddsketch_unittest_check(const char *title, DDSKETCH *sk, NETDATA_DOUBLE *sorted, size_t entries) {
+    static const NETDATA_DOUBLE quantiles[] = { 0.01, 0.10, 0.25, 0.50, 0.75, 0.90, 0.95, 0.99, 0.999 };
+    int errors = 0;
+
+    for(size_t i = 0; i < _countof(quantiles); i++) {
+        // the rank ddsketch_quantile() returns, without interpolation
+        NETDATA_DOUBLE expected = sorted[(size_t)floorndd(quantiles[i] * (NETDATA_DOUBLE)(entries - 1))];
+        NETDATA_DOUBLE got = ddsketch_quantile(sk, quantiles[i]);
+        NETDATA_DOUBLE error = fabsndd(got - expected) / fabsndd(expected);
+
+        if(error > sk->relative_error * 1.0001) {
+            fprintf(stderr, "DDSKETCH %s: quantile %0.3f expected " NETDATA_DOUBLE_FORMAT ", got " NETDATA_DOUBLE_FORMAT " (error %0.4f%%)\n",
+                    title, quantiles[i], expected, got, error * 100.0);
+            errors++;
+        }
+    }
+
+    if(sk->min != sorted[0] || sk->max != sorted[entries - 1] || sk->count != entries) {
+        fprintf(stderr, "DDSKETCH %s: min/max/count do not match\n", title);
+        errors++;
+    }
+
+    NETDATA_DOUBLE avg = average(sorted, entries);
+    NETDATA_DOUBLE stddev = standard_deviation(sorted, entries);
+    if(fabsndd(ddsketch_average(sk) - avg) > fabsndd(avg) * 1e-9 ||
+       fabsndd(ddsketch_stddev(sk) - stddev) > fabsndd(stddev) * 1e-6) {
+        fprintf(stderr, "DDSKETCH %s: average/stddev do not match\n", title);
+        errors++;
+    }
+
+    fprintf(stderr, "DDSKETCH %s: %zu values, median " NETDATA_DOUBLE_FORMAT ", p99 " NETDATA_DOUBLE_FORMAT ", %zu bytes, %s\n",
+            title, entries, ddsketch_quantile(sk, 0.5), ddsketch_quantile(sk, 0.99), ddsketch_memory(sk), errors ? "FAILED" : "OK");
+
+    return errors;
+}
+
+int ddsketch_unittest(void) {
+    const size_t entries = 100000;
+    NETDATA_DOUBLE *values = mallocz(entries * sizeof(NETDATA_DOUBLE));
+    int errors = 0;
+
+    // log-normal-like latencies, spanning several orders of magnitude
+    for(size_t i = 0; i < entries; i++)
+        values[i] = powndd(10.0, (NETDATA_DOUBLE)os_random(6000) / 1000.0 - 1.0);
+
+    DDSKETCH *all = ddsketch_create(DDSKETCH_DEFAULT_RELATIVE_ERROR, DDSKETCH_DEFAULT_MAX_BINS);
+    DDSKETCH *a = ddsketch_create(DDSKETCH_DEFAULT_RELATIVE_ERROR, DDSKETCH_DEFAULT_MAX_BINS);
+    DDSKETCH *b = ddsketch_create(DDSKETCH_DEFAULT_RELATIVE_ERROR, DDSKETCH_DEFAULT_MAX_BINS);
+
+    usec_t started_ut = now_monotonic_high_precision_usec();
+    for(size_t i = 0; i < entries; i++)
+        ddsketch_add(all, values[i], 1);
+    usec_t add_ut = now_monotonic_high_precision_usec() - started_ut;
+
+    for(size_t i = 0; i < entries; i++)
+        ddsketch_add(i % 2 ? a : b, values[i], 1);
+
+    if(!ddsketch_merge(a, b)) {
+        fprintf(stderr, "DDSKETCH: cannot merge compatible sketches\n");
+        errors++;
+    }
+
+    started_ut = now_monotonic_high_precision_usec();
+    sort_series(values, entries);
+    usec_t sort_ut = now_monotonic_high_precision_usec() - started_ut;
+
+    errors += ddsketch_unittest_check("single", all, values, entries);
+    errors += ddsketch_unittest_check("merged", a, values, entries);
+
+    fprintf(stderr, "DDSKETCH: adding %zu values took %"PRIu64" usec, sorting them took %"PRIu64" usec\n",
+            entries, add_ut, sort_ut);
+
+    // negative values and zeros
+    ddsketch_reset(all);
+    for(size_t i = 0; i < entries; i++) {
+        values[i] = (NETDATA_DOUBLE)((int64_t)os_random(20001) - 10000);
+        ddsketch_add(all, values[i], 1);
+    }
+    sort_series(values, entries);
+    errors += ddsketch_unittest_check("signed", all, values, entries);
+
+    // bounded memory: the lowest buckets are collapsed, but the high quantiles stay accurate
+    DDSKETCH *small = ddsketch_create(DDSKETCH_DEFAULT_RELATIVE_ERROR, 128);
+    for(size_t i = 0; i < entries; i++)
+        ddsketch_add(small, powndd(10.0, (NETDATA_DOUBLE)i / (NETDATA_DOUBLE)entries * 9.0), 1);
+
+    NETDATA_DOUBLE p99 = powndd(10.0, 0.99 * 9.0 * (NETDATA_DOUBLE)(entries - 1) / (NETDATA_DOUBLE)entries);
+    if(small->positive.size > 128 ||
+       fabsndd(ddsketch_quantile(small, 0.99) - p99) / p99 > small->relative_error * 1.0001) {
+        fprintf(stderr, "DDSKETCH: collapsing sketch uses %u bins, p99 " NETDATA_DOUBLE_FORMAT " expected " NETDATA_DOUBLE_FORMAT "\n",
+                small->positive.size, ddsketch_quantile(small, 0.99), p99);
+        errors++;
+    }
+
+    ddsketch_destroy(small);
+    ddsketch_destroy(all);
+    ddsketch_destroy(a);
+    ddsketch_destroy(b);
+    freez(values);
+
+    fprintf(stderr, "DDSKETCH: %s\n", errors ? "FAILED" : "OK");
+    return errors;
+}
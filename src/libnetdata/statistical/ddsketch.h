@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DDSKETCH_H
+#define NETDATA_DDSKETCH_H 1
+
+#include "../libnetdata.h"
+
+// DDSketch - quantile estimation with bounded relative error and bounded memory.
+// Values are counted in logarithmic buckets, so any quantile is returned within
+// 'relative_error' of the real value, as long as the sketch does not need more
+// than 'max_bins' buckets per sign. When it does, the buckets closest to zero
+// are collapsed (the high quantiles keep their accuracy).
+// Two sketches with the same relative error and max bins can be merged.
+
+#define DDSKETCH_DEFAULT_RELATIVE_ERROR 0.01
+#define DDSKETCH_DEFAULT_MAX_BINS 2048
+
+typedef struct ddsketch_store {
+    uint64_t *bins;                 // the counts, bins[0] is key 'offset'
+    uint32_t size;                  // the allocated bins, grows up to max_bins
+    int32_t offset;
+    int32_t min_key;
+    int32_t max_key;
+    uint64_t count;
+} DDSKETCH_STORE;
+
+typedef struct ddsketch {
+    NETDATA_DOUBLE relative_error;
+    NETDATA_DOUBLE gamma;
+    NETDATA_DOUBLE multiplier;      // 1 / ln(gamma)
+    NETDATA_DOUBLE min_indexable;   // smaller absolute values are counted as zero
+    uint32_t max_bins;
+
+    DDSKETCH_STORE positive;
+    DDSKETCH_STORE negative;        // keys of the absolute values
+    uint64_t zero_count;
+
+    // exact statistics
+    uint64_t count;
+    NETDATA_DOUBLE min;
+    NETDATA_DOUBLE max;
+    NETDATA_DOUBLE sum;
+    NETDATA_DOUBLE mean;            // running (Welford) mean and sum of squared differences, for stddev
+    NETDATA_DOUBLE m2;
+} DDSKETCH;
+
+DDSKETCH *ddsketch_create(NETDATA_DOUBLE relative_error, uint32_t max_bins);
+void ddsketch_destroy(DDSKETCH *sk);
+void ddsketch_reset(DDSKETCH *sk);
+
+void ddsketch_add(DDSKETCH *sk, NETDATA_DOUBLE value, uint64_t n);
+bool ddsketch_merge(DDSKETCH *dst, const DDSKETCH *src);
+
+NETDATA_DOUBLE ddsketch_quantile(const DDSKETCH *sk, NETDATA_DOUBLE q);
+NETDATA_DOUBLE ddsketch_average(const DDSKETCH *sk);
+NETDATA_DOUBLE ddsketch_stddev(const DDSKETCH *sk);
+size_t ddsketch_memory(const DDSKETCH *sk);
+
+int ddsketch_unittest(void);
+
+#endif //NETDATA_DDSKETCH_H
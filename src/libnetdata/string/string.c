@@ -6,10 +6,13 @@
 // ----------------------------------------------------------------------------
 // STRING implementation - dedup all STRING
 
-#define STRING_PARTITION_SHIFTS (0)
-#define STRING_PARTITIONS (256 >> STRING_PARTITION_SHIFTS)
-#define string_partition_str(str) ((uint8_t)((str)[0]) >> STRING_PARTITION_SHIFTS)
-#define string_partition(string) (string_partition_str((string)->str))
+// The strings are partitioned by the hash of their contents.
+// Most of our strings share a few prefixes (k8s_, cgroup_, net., etc), so
+// partitioning them by their first character puts most of them on a few partitions.
+#define STRING_PARTITION_BITS (8)
+#define STRING_PARTITIONS (1 << STRING_PARTITION_BITS)
+#define string_partition_str(str, length) ((uint8_t)(XXH3_64bits(str, (length) - 1) >> (64 - STRING_PARTITION_BITS)))
+#define string_partition(string) (string_partition_str((string)->str, (string)->length))
 
 struct netdata_string {
     uint32_t length;    // the string length including the terminating '\0'
@@ -96,6 +99,130 @@ void string_statistics(size_t *inserts, size_t *deletes, size_t *searches, size_
     }
 }
 
+// ----------------------------------------------------------------------------
+// STRING arena
+//
+// The small strings are allocated from pages of equally sized slots.
+// The pages are aligned to their size, so the page of a string is found from its address,
+// and the strings do not carry the header malloc() adds to each allocation
+// (8 bytes, rounded up to 16 bytes, with a minimum of 32 bytes per allocation).
+
+#define STRING_ARENA_PAGE_SIZE (64 * 1024)
+#define STRING_ARENA_SLOT_ALIGNMENT (8)
+#define STRING_ARENA_MAX_SLOT_SIZE (256)
+#define STRING_ARENA_CLASSES (STRING_ARENA_MAX_SLOT_SIZE / STRING_ARENA_SLOT_ALIGNMENT)
+#define string_arena_class(size) (((size) - 1) / STRING_ARENA_SLOT_ALIGNMENT)
+
+typedef struct string_arena_slot {
+    struct string_arena_slot *next;
+} STRING_ARENA_SLOT;
+
+typedef struct string_arena_page {
+    struct string_arena_page *prev, *next;  // the pages of the class with free slots
+    STRING_ARENA_SLOT *free;                // the slots released back to the page
+    uint32_t slot_size;
+    uint32_t slots;                         // the number of slots in the page
+    uint32_t used;                          // the number of slots in use
+    uint32_t bumped;                        // the number of slots given out at least once
+} STRING_ARENA_PAGE;
+
+#define STRING_ARENA_PAGE_HEADER_SIZE (memory_alignment(sizeof(STRING_ARENA_PAGE), STRING_ARENA_SLOT_ALIGNMENT))
+
+static struct {
+    struct {
+        SPINLOCK spinlock;
+        STRING_ARENA_PAGE *available;       // the pages with free slots
+    } classes[STRING_ARENA_CLASSES];
+
+    size_t allocated;                       // the memory of the pages
+    size_t requested;                       // the memory of the strings in the pages
+} string_arena = { 0 };
+
+static STRING *string_arena_mallocz(size_t size) {
+    if(unlikely(size > STRING_ARENA_MAX_SLOT_SIZE))
+        return mallocz(size);
+
+    size_t c = string_arena_class(size);
+    STRING_ARENA_PAGE *page;
+    void *slot;
+
+    spinlock_lock(&string_arena.classes[c].spinlock);
+
+    page = string_arena.classes[c].available;
+    if(unlikely(!page)) {
+        (void)posix_memalignz((void **)&page, STRING_ARENA_PAGE_SIZE, STRING_ARENA_PAGE_SIZE);
+        memset(page, 0, sizeof(*page));
+        page->slot_size = (c + 1) * STRING_ARENA_SLOT_ALIGNMENT;
+        page->slots = (STRING_ARENA_PAGE_SIZE - STRING_ARENA_PAGE_HEADER_SIZE) / page->slot_size;
+        DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(string_arena.classes[c].available, page, prev, next);
+        __atomic_add_fetch(&string_arena.allocated, STRING_ARENA_PAGE_SIZE, __ATOMIC_RELAXED);
+    }
+
+    if(page->free) {
+        slot = page->free;
+        page->free = page->free->next;
+    }
+    else
+        slot = (char *)page + STRING_ARENA_PAGE_HEADER_SIZE + (size_t)page->bumped++ * page->slot_size;
+
+    if(++page->used == page->slots)
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(string_arena.classes[c].available, page, prev, next);
+
+    spinlock_unlock(&string_arena.classes[c].spinlock);
+
+    __atomic_add_fetch(&string_arena.requested, size, __ATOMIC_RELAXED);
+
+    return slot;
+}
+
+static void string_arena_freez(STRING *string, size_t size) {
+    if(unlikely(size > STRING_ARENA_MAX_SLOT_SIZE)) {
+        freez(string);
+        return;
+    }
+
+    size_t c = string_arena_class(size);
+    STRING_ARENA_PAGE *page = (STRING_ARENA_PAGE *)((uintptr_t)string & ~((uintptr_t)STRING_ARENA_PAGE_SIZE - 1));
+    STRING_ARENA_SLOT *slot = (STRING_ARENA_SLOT *)string;
+
+    spinlock_lock(&string_arena.classes[c].spinlock);
+
+    if(page->used == page->slots)
+        // it was full, it has a free slot now
+        DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(string_arena.classes[c].available, page, prev, next);
+
+    slot->next = page->free;
+    page->free = slot;
+
+    // release empty pages, but keep one per class
+    if(--page->used == 0 && (string_arena.classes[c].available != page || page->next))
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(string_arena.classes[c].available, page, prev, next);
+    else
+        page = NULL;
+
+    spinlock_unlock(&string_arena.classes[c].spinlock);
+
+    __atomic_sub_fetch(&string_arena.requested, size, __ATOMIC_RELAXED);
+
+    if(page) {
+        posix_memalign_freez(page);
+        __atomic_sub_fetch(&string_arena.allocated, STRING_ARENA_PAGE_SIZE, __ATOMIC_RELAXED);
+    }
+}
+
+void string_memory_statistics(STRING_MEMORY *sm) {
+    size_t entries = 0, memory = 0, memory_index = 0;
+    string_statistics(NULL, NULL, NULL, &entries, NULL, &memory, &memory_index, NULL, NULL);
+
+    size_t allocated = __atomic_load_n(&string_arena.allocated, __ATOMIC_RELAXED);
+    size_t requested = __atomic_load_n(&string_arena.requested, __ATOMIC_RELAXED);
+
+    sm->headers = entries * sizeof(STRING);
+    sm->text = (memory > sm->headers) ? memory - sm->headers : 0;
+    sm->arena = (allocated > requested) ? allocated - requested : 0;
+    sm->index = memory_index;
+}
+
 static inline bool string_entry_check_and_acquire(STRING *se) {
 #ifdef NETDATA_INTERNAL_CHECKS
     uint8_t partition = string_partition(se);
@@ -134,11 +261,9 @@ STRING *string_dup(STRING *string) {
 }
 
 // Search the index and return an ACQUIRED string entry, or NULL
-static STRING *string_index_search(const char *str, size_t length) {
+static STRING *string_index_search(const char *str, size_t length, uint8_t partition) {
     STRING *string;
 
-    uint8_t partition = string_partition_str(str);
-
     // Find the string in the index
     // With a read-lock so that multiple readers can use the index concurrently.
 
@@ -177,10 +302,22 @@ static STRING *string_index_search(const char *str, size_t length) {
 // The returned entry is ACQUIRED, and it can either be:
 //   1. a new item inserted, or
 //   2. an item found in the index that is not currently deleted
-static STRING *string_index_insert(const char *str, size_t length) {
+static STRING *string_index_insert(const char *str, size_t length, uint8_t partition) {
     STRING *string;
 
-    uint8_t partition = string_partition_str(str);
+    // allocate the new string before locking the partition,
+    // to keep the time the partition is locked for writing short
+    long mem_size = (long)sizeof(STRING) + (long)length;
+    STRING *new_string = string_arena_mallocz(mem_size);
+    memcpy((char *)new_string->str, str, length - 1);
+    ((char *)new_string->str)[length - 1] = '\0';
+    new_string->length = length;
+    new_string->refcount = 1;
+
+#ifdef FSANITIZE_ADDRESS
+    // Initialize stacktrace tracking
+    stacktrace_array_init(&new_string->stacktraces);
+#endif
 
     rw_spinlock_write_lock(&string_base[partition].spinlock);
 
@@ -208,23 +345,17 @@ static STRING *string_index_insert(const char *str, size_t length) {
 
     if (likely(*ptr == 0)) {
         // a new item added to the index
-        long mem_size = (long)sizeof(STRING) + (long)length;
-        string = mallocz(mem_size);
-        strcpy((char *)string->str, str);
-        string->length = length;
-        string->refcount = 1;
-        
+        string = new_string;
+        new_string = NULL;
+
 #ifdef FSANITIZE_ADDRESS
-        // Initialize stacktrace tracking
-        stacktrace_array_init(&string->stacktraces);
-        
         // Add to JudyL array for tracking strings by pointer
         Pvoid_t *PValue;
         PValue = JudyLIns(&string_base[partition].JudyLPointers, (Word_t)string, PJE0);
         if (PValue != PJERR)
             *PValue = (void *)1;  // Use a simple value of 1 for now
 #endif
-        
+
         *ptr = string;
         string_base[partition].inserts++;
         string_base[partition].entries++;
@@ -250,6 +381,12 @@ static STRING *string_index_insert(const char *str, size_t length) {
     }
 
     rw_spinlock_write_unlock(&string_base[partition].spinlock);
+
+    if(unlikely(new_string)) {
+        // another thread added it before us
+        string_arena_freez(new_string, mem_size);
+    }
+
     return string;
 }
 
@@ -295,30 +432,29 @@ static void string_index_delete(STRING *string) {
         if (string_base[partition].JudyLPointers)
             JudyLDel(&string_base[partition].JudyLPointers, (Word_t)string, PJE0);
 #endif
-        
-        freez(string);
     }
 
     rw_spinlock_write_unlock(&string_base[partition].spinlock);
+
+    // nobody can find it anymore
+    if (likely(deleted))
+        string_arena_freez(string, sizeof(STRING) + string->length);
 }
 
 ALWAYS_INLINE
 STRING *string_strdupz(const char *str) {
     if(unlikely(!str || !*str)) return NULL;
 
-#ifdef NETDATA_INTERNAL_CHECKS
-    uint8_t partition = string_partition_str(str);
-#endif
-
     size_t length = strlen(str) + 1;
-    STRING *string = string_index_search(str, length);
+    uint8_t partition = string_partition_str(str, length);
+    STRING *string = string_index_search(str, length, partition);
 
     while(!string) {
         // The search above did not find anything,
         // We loop here, because during insert we may find an entry that is being deleted by another thread.
         // So, we have to let it go and retry to insert it again.
 
-        string = string_index_insert(str, length);
+        string = string_index_insert(str, length, partition);
     }
 
     // statistics
@@ -336,17 +472,14 @@ ALWAYS_INLINE
 STRING *string_strndupz(const char *str, size_t len) {
     if(unlikely(!str || !*str || !len)) return NULL;
 
-#ifdef NETDATA_INTERNAL_CHECKS
-    uint8_t partition = string_partition_str(str);
-#endif
-
     char buf[len + 1];
     memcpy(buf, str, len);
     buf[len] = '\0';
 
-    STRING *string = string_index_search(buf, len + 1);
+    uint8_t partition = string_partition_str(buf, len + 1);
+    STRING *string = string_index_search(buf, len + 1, partition);
     while(!string)
-        string = string_index_insert(buf, len + 1);
+        string = string_index_insert(buf, len + 1, partition);
 
     string_stats_atomic_increment(partition, active_references);
 
@@ -951,6 +1084,270 @@ int string_unittest(size_t entries) {
     return  errors ? 1 : 0;
 }
 
+// ----------------------------------------------------------------------------
+// STRING benchmark
+
+// names with the prefixes of the strings netdata interns, in similar proportions
+static char **string_benchmark_generate_names(size_t entries) {
+    static const char *dimensions[] = { "user", "system", "nice", "iowait", "read", "write", "received", "sent", "used", "free" };
+
+    char **names = mallocz(sizeof(char *) * entries);
+    for(size_t i = 0; i < entries ;i++) {
+        char buf[200 + 1];
+        const char *dim = dimensions[i % _countof(dimensions)];
+
+        switch(i % 10) {
+            case 0: case 1: case 2: case 3:
+                snprintfz(buf, sizeof(buf) - 1, "k8s_kube-system_coredns-%zu_%s", i, dim);
+                break;
+
+            case 4: case 5:
+                snprintfz(buf, sizeof(buf) - 1, "cgroup_system.slice_service-%zu.%s", i, dim);
+                break;
+
+            case 6:
+                snprintfz(buf, sizeof(buf) - 1, "net.veth%zu", i);
+                break;
+
+            case 7:
+                snprintfz(buf, sizeof(buf) - 1, "disk.nvme0n%zu", i);
+                break;
+
+            case 8:
+                snprintfz(buf, sizeof(buf) - 1, "apps.app%zu_%s", i, dim);
+                break;
+
+            default:
+                snprintfz(buf, sizeof(buf) - 1, "system.%s%zu", dim, i);
+                break;
+        }
+
+        names[i] = strdupz(buf);
+    }
+    return names;
+}
+
+struct string_benchmark_thread {
+    ND_THREAD *thread;
+    char **names;
+    size_t entries;
+    size_t new_every;           // 0 = only existing strings, N = every Nth call interns a new one
+    size_t id;
+    bool *stop;
+    size_t ops;
+};
+
+static void string_benchmark_thread(void *arg) {
+    struct string_benchmark_thread *t = arg;
+    size_t ops = 0, new_id = 0;
+    uint64_t x = t->id * 0x9E3779B97F4A7C15ULL + 1;
+
+    while(!__atomic_load_n(t->stop, __ATOMIC_RELAXED)) {
+        for(size_t i = 0; i < 1000 ;i++) {
+            // xorshift, to pick names randomly
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+
+            STRING *s;
+            if(t->new_every && (ops + i) % t->new_every == 0) {
+                char buf[100 + 1];
+                snprintfz(buf, sizeof(buf) - 1, "k8s_default_job-%zu-%zu_%s", t->id, new_id++, t->names[x % t->entries]);
+                s = string_strdupz(buf);
+            }
+            else
+                s = string_strdupz(t->names[x % t->entries]);
+
+            string_freez(s);
+        }
+        ops += 1000;
+    }
+
+    t->ops = ops;
+}
+
+static void string_benchmark_run(const char *title, char **names, size_t entries, size_t threads, size_t new_every) {
+    bool stop = false;
+    struct string_benchmark_thread t[threads];
+
+    usec_t started_ut = now_monotonic_usec();
+
+    for(size_t i = 0; i < threads ;i++) {
+        t[i] = (struct string_benchmark_thread){
+            .names = names,
+            .entries = entries,
+            .new_every = new_every,
+            .id = i,
+            .stop = &stop,
+        };
+
+        char tag[ND_THREAD_TAG_MAX + 1];
+        snprintfz(tag, sizeof(tag) - 1, "STRBENCH[%zu]", i);
+        t[i].thread = nd_thread_create(tag, NETDATA_THREAD_OPTION_DONT_LOG, string_benchmark_thread, &t[i]);
+    }
+
+    sleep_usec(2 * USEC_PER_SEC);
+    __atomic_store_n(&stop, true, __ATOMIC_RELAXED);
+
+    size_t ops = 0;
+    for(size_t i = 0; i < threads ;i++) {
+        nd_thread_join(t[i].thread);
+        ops += t[i].ops;
+    }
+
+    usec_t dt = now_monotonic_usec() - started_ut;
+
+    fprintf(stderr, "  %-30s %3zu threads: %8.2f M ops/s, %8.2f M ops/s per thread\n",
+            title, threads,
+            (double)ops / (double)dt,
+            (double)ops / (double)dt / (double)threads);
+}
+
+// one name per line, the empty lines and the duplicates are kept
+static char **string_benchmark_load_names(const char *filename, size_t *entries) {
+    FILE *fp = fopen(filename, "r");
+    if(!fp) {
+        fprintf(stderr, "Cannot open file '%s'\n", filename);
+        return NULL;
+    }
+
+    size_t size = 0, used = 0;
+    char **names = NULL;
+
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t len;
+    while((len = getline(&line, &line_size, fp)) != -1) {
+        while(len && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+            line[--len] = '\0';
+
+        if(!len)
+            continue;
+
+        if(used == size) {
+            size = size ? size * 2 : 65536;
+            names = reallocz(names, sizeof(char *) * size);
+        }
+
+        names[used++] = strdupz(line);
+    }
+
+    free(line);
+    fclose(fp);
+
+    *entries = used;
+    return names;
+}
+
+static int string_benchmark_compare_names(const void *a, const void *b) {
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+// how much memory the strings use, and how much a prefix compression could save
+static void string_benchmark_memory(char **names, size_t entries) {
+    STRING_MEMORY sm;
+    string_memory_statistics(&sm);
+
+    size_t strings = 0;
+    string_statistics(NULL, NULL, NULL, &strings, NULL, NULL, NULL, NULL, NULL);
+
+    // what malloc() would use for them: 8 bytes of header, rounded up to 16, at least 32 bytes
+    size_t with_malloc = 0;
+    char **sorted = mallocz(sizeof(char *) * entries);
+    size_t unique = 0;
+    for(size_t i = 0; i < entries ;i++)
+        sorted[i] = names[i];
+
+    qsort(sorted, entries, sizeof(char *), string_benchmark_compare_names);
+
+    size_t text = 0, shared = 0;
+    for(size_t i = 0; i < entries ;i++) {
+        if(i && strcmp(sorted[i], sorted[i - 1]) == 0)
+            continue;
+
+        size_t len = strlen(sorted[i]);
+        size_t size = memory_alignment(sizeof(STRING) + len + 1 + sizeof(size_t), 16);
+        with_malloc += (size < 32) ? 32 : size;
+        text += len + 1;
+        unique++;
+
+        if(unique > 1) {
+            const char *a = sorted[i], *b = sorted[i - 1];
+            while(*a && *a == *b) { a++; b++; }
+            shared += a - sorted[i];
+        }
+    }
+    freez(sorted);
+
+    size_t total = sm.text + sm.headers + sm.arena + sm.index;
+
+    fprintf(stderr, "\nSTRING memory, %zu names, %zu unique, %zu strings in the index:\n", entries, unique, strings);
+    fprintf(stderr, "  text    %12zu bytes (%.1f bytes per string)\n", sm.text, (double)sm.text / (double)(strings ? strings : 1));
+    fprintf(stderr, "  headers %12zu bytes\n", sm.headers);
+    fprintf(stderr, "  arena   %12zu bytes (unused memory of the arena pages)\n", sm.arena);
+    fprintf(stderr, "  index   %12zu bytes (%.1f bytes per string)\n", sm.index, (double)sm.index / (double)(strings ? strings : 1));
+    fprintf(stderr, "  total   %12zu bytes (%.1f bytes per string)\n", total, (double)total / (double)(strings ? strings : 1));
+    fprintf(stderr, "\n  the same strings allocated with malloc() would need %zu bytes, instead of %zu bytes\n",
+            with_malloc, sm.text + sm.headers + sm.arena);
+    fprintf(stderr, "  %zu bytes of the text (%.1f%%) are prefixes shared with another string\n",
+            shared, text ? (double)shared * 100.0 / (double)text : 0.0);
+}
+
+int string_benchmark(const char *filename) {
+    size_t entries = 100000;
+    char **names;
+
+    if(filename && *filename) {
+        names = string_benchmark_load_names(filename, &entries);
+        if(!names || !entries) {
+            fprintf(stderr, "No names found in '%s'\n", filename);
+            freez(names);
+            return 1;
+        }
+    }
+    else
+        names = string_benchmark_generate_names(entries);
+
+    // keep all the names in the index, so that string_strdupz() finds them
+    STRING **strings = mallocz(sizeof(STRING *) * entries);
+    for(size_t i = 0; i < entries ;i++)
+        strings[i] = string_strdupz(names[i]);
+
+    string_benchmark_memory(names, entries);
+
+    size_t min = SIZE_MAX, max = 0;
+    for(size_t i = 0; i < STRING_PARTITIONS ;i++) {
+        size_t e = __atomic_load_n(&string_base[i].entries, __ATOMIC_RELAXED);
+        if(e < min) min = e;
+        if(e > max) max = e;
+    }
+
+    fprintf(stderr, "\nSTRING benchmark, %zu strings on %d partitions (min %zu, max %zu strings per partition)\n\n",
+            entries, STRING_PARTITIONS, min, max);
+
+    size_t cpus = os_get_system_cpus();
+    if(cpus < 1) cpus = 1;
+
+    size_t threads_list[] = { 1, 2, 4, 8, 16, 32, 64 };
+    for(size_t i = 0; i < _countof(threads_list) ;i++) {
+        size_t threads = threads_list[i];
+        if(threads > cpus && threads != 1)
+            break;
+
+        string_benchmark_run("existing strings", names, entries, threads, 0);
+        string_benchmark_run("10% new strings", names, entries, threads, 10);
+        string_benchmark_run("only new strings", names, entries, threads, 1);
+    }
+
+    for(size_t i = 0; i < entries ;i++)
+        string_freez(strings[i]);
+
+    freez(strings);
+    string_unittest_free_char_pp(names, entries);
+
+    return 0;
+}
+
 void string_init(void) {
     for (size_t i = 0; i != STRING_PARTITIONS; i++) {
         rw_spinlock_init(&string_base[i].spinlock);
@@ -42,7 +42,17 @@ static inline int string_strncmp(STRING *string, const char *s, size_t n) {
 
 void string_statistics(size_t *inserts, size_t *deletes, size_t *searches, size_t *entries, size_t *references, size_t *memory, size_t *memory_index, size_t *duplications, size_t *releases);
 
+typedef struct string_memory {
+    size_t text;        // the strings, including their terminating '\0'
+    size_t headers;     // the length and the refcount of each string
+    size_t arena;       // the unused memory of the pages the small strings are allocated from
+    size_t index;       // the JudyHS index
+} STRING_MEMORY;
+
+void string_memory_statistics(STRING_MEMORY *sm);
+
 int string_unittest(size_t entries);
+int string_benchmark(const char *filename);
 
 void string_init(void);
 
@@ -321,6 +321,8 @@ static void nd_thread_exit(ND_THREAD *nti) {
     rrdset_thread_rda_free();
     query_target_free();
     thread_cache_destroy();
+    aral_thread_magazines_release();
+    onewayalloc_thread_pages_release();
     service_exits();
     worker_unregister();
 
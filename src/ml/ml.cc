@@ -947,7 +947,7 @@ ml_host_detect_once(ml_host_t *host)
 
             if (spinlock_trylock(&host->context_anomaly_rate_spinlock))
             {
-                STRING *key = rs->context;
+                STRING *key = rrdset_def(rs)->context;
                 auto &um = host->context_anomaly_rate;
                 auto it = um.find(key);
                 if (it == um.end()) {
@@ -774,6 +774,7 @@ static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words,
     char *update_every_str = get_word(words, num_words, idx++);
     char *end_time_str = get_word(words, num_words, idx++);
     char *wall_clock_time_str = get_word(words, num_words, idx++);
+    char *keyframe_str = get_word(words, num_words, idx++);
 
     if(unlikely(!id || !update_every_str || !end_time_str || !wall_clock_time_str))
         return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_BEGIN_V2, "missing parameters");
@@ -825,6 +826,7 @@ static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words,
     parser->user.v2.update_every = update_every;
     parser->user.v2.end_time = end_time;
     parser->user.v2.wall_clock_time = wall_clock_time;
+    parser->user.v2.keyframe = keyframe_str && strcmp(keyframe_str, STREAM_DELTA_KEYFRAME) == 0;
     parser->user.v2.ml_locked = ml_chart_update_begin(st);
 
     timing_step(TIMING_STEP_BEGIN2_ML);
@@ -880,6 +882,10 @@ static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words,
         else
             buffer_print_uint64_encoded(wb, integer_encoding, wall_clock_time);
 
+        // we forward all values, including the ones repeated at END2, so every block is a keyframe
+        if(stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_DELTA))
+            buffer_fast_strcat(wb, " " STREAM_DELTA_KEYFRAME, sizeof(STREAM_DELTA_KEYFRAME) - 1 + 1);
+
         buffer_fast_strcat(wb, "\n", 1);
 
         parser->user.v2.stream_buffer.last_point_end_time_s = end_time;
@@ -908,59 +914,7 @@ static ALWAYS_INLINE PARSER_RC pluginsd_begin_v2(char **words, size_t num_words,
     return PARSER_RC_OK;
 }
 
-static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, PARSER *parser) {
-    timing_init();
-
-    int idx = 1;
-    ssize_t slot = pluginsd_parse_rrd_slot(words, num_words);
-    if(slot >= 0) idx++;
-
-    char *dimension = get_word(words, num_words, idx++);
-    char *collected_str = get_word(words, num_words, idx++);
-    char *value_str = get_word(words, num_words, idx++);
-    char *flags_str = get_word(words, num_words, idx++);
-
-    if(unlikely(!dimension || !collected_str || !value_str || !flags_str))
-        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_SET_V2, "missing parameters");
-
-    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_KEYWORD_SET_V2);
-    if(unlikely(!host)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
-
-    RRDSET *st = pluginsd_require_scope_chart(parser, PLUGINSD_KEYWORD_SET_V2, PLUGINSD_KEYWORD_BEGIN_V2);
-    if(unlikely(!st)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
-
-    timing_step(TIMING_STEP_SET2_PREPARE);
-
-    RRDDIM *rd = pluginsd_acquire_dimension(host, st, dimension, slot, PLUGINSD_KEYWORD_SET_V2);
-    if(unlikely(!rd)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
-
-    st->pluginsd.set = true;
-
-    if(unlikely(rrddim_flag_check(rd, RRDDIM_FLAG_OBSOLETE))) {
-        if(!spinlock_trylock(&rd->destroy_lock))
-            fatal("PLUGINSD: dimension '%s' of chart '%s' is being collected while is being destroyed.", rrddim_id(rd), rrdset_id(st));
-
-        rrddim_isnot_obsolete___safe_from_collector_thread(st, rd);
-        spinlock_unlock(&rd->destroy_lock);
-    }
-
-    timing_step(TIMING_STEP_SET2_LOOKUP_DIMENSION);
-
-    // ------------------------------------------------------------------------
-    // parse the parameters
-
-    collected_number collected_value = (collected_number) str2ll_encoded(collected_str);
-
-    NETDATA_DOUBLE value;
-    if(*value_str == '#')
-        value = (NETDATA_DOUBLE)collected_value;
-    else
-        value = str2ndd_encoded(value_str, NULL);
-
-    SN_FLAGS flags = pluginsd_parse_storage_number_flags(flags_str);
-
-    timing_step(TIMING_STEP_SET2_PARSE);
-
+static ALWAYS_INLINE void pluginsd_store_v2_value(PARSER *parser, RRDDIM *rd, collected_number collected_value, NETDATA_DOUBLE value, SN_FLAGS flags, const char *collected_str, const char *value_str) {
     // ------------------------------------------------------------------------
     // check value and ML
 
@@ -1000,7 +954,9 @@ static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, P
 
     if(parser->user.v2.stream_buffer.v2 && parser->user.v2.stream_buffer.begin_v2_added && parser->user.v2.stream_buffer.wb) {
         // check if receiver and sender have the same number parsing capabilities
-        bool can_copy = stream_has_capability(&parser->user, STREAM_CAP_IEEE754) == stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_IEEE754);
+        // (values repeated at END2 have no strings to copy)
+        bool can_copy = collected_str && value_str &&
+                        stream_has_capability(&parser->user, STREAM_CAP_IEEE754) == stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_IEEE754);
 
         // check the sender capabilities
         bool with_slots = stream_has_capability(&parser->user.v2.stream_buffer, STREAM_CAP_SLOTS) ? true : false;
@@ -1048,10 +1004,85 @@ static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, P
     rrddim_set_updated(rd);
 
     timing_step(TIMING_STEP_SET2_STORE);
+}
+
+static ALWAYS_INLINE PARSER_RC pluginsd_set_v2(char **words, size_t num_words, PARSER *parser) {
+    timing_init();
+
+    int idx = 1;
+    ssize_t slot = pluginsd_parse_rrd_slot(words, num_words);
+    if(slot >= 0) idx++;
+
+    char *dimension = get_word(words, num_words, idx++);
+    char *collected_str = get_word(words, num_words, idx++);
+    char *value_str = get_word(words, num_words, idx++);
+    char *flags_str = get_word(words, num_words, idx++);
+
+    if(unlikely(!dimension || !collected_str || !value_str || !flags_str))
+        return PLUGINSD_DISABLE_PLUGIN(parser, PLUGINSD_KEYWORD_SET_V2, "missing parameters");
+
+    RRDHOST *host = pluginsd_require_scope_host(parser, PLUGINSD_KEYWORD_SET_V2);
+    if(unlikely(!host)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    RRDSET *st = pluginsd_require_scope_chart(parser, PLUGINSD_KEYWORD_SET_V2, PLUGINSD_KEYWORD_BEGIN_V2);
+    if(unlikely(!st)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    timing_step(TIMING_STEP_SET2_PREPARE);
+
+    RRDDIM *rd = pluginsd_acquire_dimension(host, st, dimension, slot, PLUGINSD_KEYWORD_SET_V2);
+    if(unlikely(!rd)) return PLUGINSD_DISABLE_PLUGIN(parser, NULL, NULL);
+
+    st->pluginsd.set = true;
+
+    if(unlikely(rrddim_flag_check(rd, RRDDIM_FLAG_OBSOLETE))) {
+        if(!spinlock_trylock(&rd->destroy_lock))
+            fatal("PLUGINSD: dimension '%s' of chart '%s' is being collected while is being destroyed.", rrddim_id(rd), rrdset_id(st));
+
+        rrddim_isnot_obsolete___safe_from_collector_thread(st, rd);
+        spinlock_unlock(&rd->destroy_lock);
+    }
+
+    timing_step(TIMING_STEP_SET2_LOOKUP_DIMENSION);
+
+    // ------------------------------------------------------------------------
+    // parse the parameters
+
+    collected_number collected_value = (collected_number) str2ll_encoded(collected_str);
+
+    NETDATA_DOUBLE value;
+    if(*value_str == '#')
+        value = (NETDATA_DOUBLE)collected_value;
+    else
+        value = str2ndd_encoded(value_str, NULL);
+
+    SN_FLAGS flags = pluginsd_parse_storage_number_flags(flags_str);
+
+    // remember what we received, to repeat it when the sender omits it (STREAM_CAP_DELTA)
+    rd->stream.rcv.delta = netdata_double_isnumber(value) && flags != SN_EMPTY_SLOT;
+    rd->stream.rcv.delta_flags = flags;
+
+    timing_step(TIMING_STEP_SET2_PARSE);
+
+    pluginsd_store_v2_value(parser, rd, collected_value, value, flags, collected_str, value_str);
 
     return PARSER_RC_OK;
 }
 
+static ALWAYS_INLINE void pluginsd_end_v2_repeat_delta(PARSER *parser, RRDDIM *rd) {
+    if(rrddim_check_updated(rd))
+        return;
+
+    if(parser->user.v2.keyframe) {
+        // a keyframe carries all the values, so this dimension has a gap
+        rd->stream.rcv.delta = false;
+        return;
+    }
+
+    if(rd->stream.rcv.delta)
+        pluginsd_store_v2_value(parser, rd, rd->collector.last_collected_value, rd->collector.last_stored_value,
+                                rd->stream.rcv.delta_flags, NULL, NULL);
+}
+
 static ALWAYS_INLINE PARSER_RC pluginsd_end_v2(char **words __maybe_unused, size_t num_words __maybe_unused, PARSER *parser) {
     timing_init();
 
@@ -1063,6 +1094,26 @@ static ALWAYS_INLINE PARSER_RC pluginsd_end_v2(char **words __maybe_unused, size
 
     parser->user.data_collections_count++;
 
+    // ------------------------------------------------------------------------
+    // repeat the values the sender omitted because they did not change
+
+    if(stream_has_capability(&parser->user, STREAM_CAP_DELTA)) {
+        if(likely(st->pluginsd.dims_with_slots)) {
+            for(size_t i = 0; i < st->pluginsd.size ;i++) {
+                RRDDIM *rd = st->pluginsd.prd_array[i].rd;
+                if(rd)
+                    pluginsd_end_v2_repeat_delta(parser, rd);
+            }
+        }
+        else {
+            RRDDIM *rd;
+            rrddim_foreach_read(rd, st) {
+                pluginsd_end_v2_repeat_delta(parser, rd);
+            }
+            rrddim_foreach_done(rd);
+        }
+    }
+
     timing_step(TIMING_STEP_END2_PREPARE);
 
     // ------------------------------------------------------------------------
@@ -1231,7 +1282,7 @@ bool parser_reconstruct_context(BUFFER *wb, void *ptr) {
     if(!parser || !parser->user.st)
         return false;
 
-    buffer_strcat(wb, string2str(parser->user.st->context));
+    buffer_strcat(wb, string2str(rrdset_def(parser->user.st)->context));
     return true;
 }
 
@@ -1277,6 +1328,9 @@ inline size_t pluginsd_process(RRDHOST *host, struct plugind *cd, int fd_input,
     while(likely(service_running(SERVICE_COLLECTORS))) {
 
         if(unlikely(!buffered_reader_next_line(&parser->reader, buffer))) {
+            // we are going to wait for the plugin - stream what we have collected so far
+            sender_thread_buffer_flush();
+
             buffered_reader_ret_t ret = buffered_reader_read_timeout(
                     &parser->reader, parser->fd_input,
                     2 * 60 * MSEC_PER_SEC, true);
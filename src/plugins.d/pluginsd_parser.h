@@ -95,6 +95,7 @@ typedef struct parser_user_object {
         time_t end_time;
         time_t wall_clock_time;
         bool ml_locked;
+        bool keyframe;                      // STREAM_CAP_DELTA: all values are included in this BEGIN2
     } v2;
 
     struct {
@@ -4,8 +4,29 @@
 #include "../stream-sender-internals.h"
 #include "plugins.d/pluginsd_internals.h"
 
+static inline bool stream_send_rrddim_delta_unchanged(RRDSET_STREAM_BUFFER *rsb, RRDDIM *rd, NETDATA_DOUBLE n, SN_FLAGS flags) {
+    if(!rsb->keyframe && rd->stream.snd.delta &&
+        rd->stream.snd.delta_collected == rd->collector.last_collected_value &&
+        rd->stream.snd.delta_value == n &&
+        rd->stream.snd.delta_flags == flags)
+        return true;
+
+    rd->stream.snd.delta = true;
+    rd->stream.snd.delta_collected = rd->collector.last_collected_value;
+    rd->stream.snd.delta_value = n;
+    rd->stream.snd.delta_flags = flags;
+    return false;
+}
+
 void stream_send_rrddim_metrics_v2(RRDSET_STREAM_BUFFER *rsb, RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n, SN_FLAGS flags) {
-    if(!rsb->wb || !rsb->v2 || !netdata_double_isnumber(n) || !does_storage_number_exist(flags))
+    if(!rsb->wb || !rsb->v2)
+        return;
+
+    bool delta = stream_has_capability(rsb, STREAM_CAP_DELTA) ? true : false;
+    bool has_value = netdata_double_isnumber(n) && does_storage_number_exist(flags);
+
+    // gaps are not sent, unless the parent would otherwise repeat the previous value
+    if(!has_value && !(delta && rd->stream.snd.delta))
         return;
 
     bool with_slots = stream_has_capability(rsb, STREAM_CAP_SLOTS) ? true : false;
@@ -36,12 +57,34 @@ void stream_send_rrddim_metrics_v2(RRDSET_STREAM_BUFFER *rsb, RRDDIM *rd, usec_t
             buffer_fast_strcat(wb, "#", 1);
         else
             buffer_print_uint64_encoded(wb, integer_encoding, rsb->wall_clock_time);
+
+        if(delta) {
+            RRDSET *st = rd->rrdset;
+            rsb->keyframe = !st->stream.snd.delta_keyframe_countdown;
+            st->stream.snd.delta_keyframe_countdown = rsb->keyframe ? STREAM_DELTA_KEYFRAME_EVERY - 1 : st->stream.snd.delta_keyframe_countdown - 1;
+
+            if(rsb->keyframe)
+                buffer_fast_strcat(wb, " " STREAM_DELTA_KEYFRAME, sizeof(STREAM_DELTA_KEYFRAME) - 1 + 1);
+        }
+
         buffer_fast_strcat(wb, "\n", 1);
 
         rsb->last_point_end_time_s = point_end_time_s;
         rsb->begin_v2_added = true;
     }
 
+    if(delta) {
+        if(!has_value) {
+            // tell the parent explicitly to stop repeating the previous value
+            rd->stream.snd.delta = false;
+            n = NAN;
+            flags = SN_EMPTY_SLOT;
+        }
+        else if(stream_send_rrddim_delta_unchanged(rsb, rd, n, flags))
+            // the parent repeats the previous value
+            return;
+    }
+
     buffer_fast_strcat(wb, PLUGINSD_KEYWORD_SET_V2, sizeof(PLUGINSD_KEYWORD_SET_V2) - 1);
 
     if(with_slots) {
@@ -55,7 +98,7 @@ void stream_send_rrddim_metrics_v2(RRDSET_STREAM_BUFFER *rsb, RRDDIM *rd, usec_t
     buffer_print_int64_encoded(wb, integer_encoding, rd->collector.last_collected_value);
     buffer_fast_strcat(wb, " ", 1);
 
-    if((NETDATA_DOUBLE)rd->collector.last_collected_value == n)
+    if(!has_value || (NETDATA_DOUBLE)rd->collector.last_collected_value == n)
         buffer_fast_strcat(wb, "#", 1);
     else
         buffer_print_netdata_double_encoded(wb, doubles_encoding, n);
@@ -81,3 +124,134 @@ ALWAYS_INLINE void stream_send_rrdset_metrics_finished(RRDSET_STREAM_BUFFER *rsb
     *rsb = (RRDSET_STREAM_BUFFER){ .wb = NULL, };
 }
 
+
+// ----------------------------------------------------------------------------
+// STREAM_CAP_DELTA unittest
+
+// send a BEGIN2 block with the values of 2 dimensions - NAN is a gap
+static const char *stream_delta_unittest_block(BUFFER *wb, RRDDIM **dims, NETDATA_DOUBLE *values, time_t now_s) {
+    buffer_flush(wb);
+
+    RRDSET_STREAM_BUFFER rsb = {
+        .capabilities = STREAM_CAP_V2 | STREAM_CAP_INTERPOLATED | STREAM_CAP_DELTA,
+        .v2 = true,
+        .wb = wb,
+        .wall_clock_time = now_s,
+    };
+
+    for(size_t i = 0; i < 2 ;i++) {
+        bool gap = isnan(values[i]);
+        if(!gap)
+            dims[i]->collector.last_collected_value = (collected_number)values[i];
+
+        stream_send_rrddim_metrics_v2(&rsb, dims[i], now_s * USEC_PER_SEC, values[i], gap ? SN_EMPTY_SLOT : SN_DEFAULT_FLAGS);
+    }
+
+    return buffer_tostring(wb);
+}
+
+static bool stream_delta_unittest_line_ends_with(const char *line, char c) {
+    const char *eol = line ? strchr(line, '\n') : NULL;
+    return eol && eol - line > 2 && eol[-1] == c && eol[-2] == ' ';
+}
+
+// what the block has for a dimension: "V" a value, "E" a gap, NULL omitted
+static const char *stream_delta_unittest_dim(const char *txt, RRDDIM *rd) {
+    char search[100];
+    snprintfz(search, sizeof(search), PLUGINSD_KEYWORD_SET_V2 " '%s' ", rrddim_id(rd));
+
+    const char *s = strstr(txt, search);
+    if(!s)
+        return NULL;
+
+    return stream_delta_unittest_line_ends_with(s, 'E') ? "E" : "V";
+}
+
+static size_t stream_delta_unittest_check(const char *name, const char *txt, RRDDIM **dims, bool keyframe, const char *a, const char *b) {
+    size_t errors = 0;
+
+    const char *begin = strstr(txt, PLUGINSD_KEYWORD_BEGIN_V2 " ");
+    if(!begin) {
+        fprintf(stderr, "STREAM DELTA: %s: no BEGIN2 in:\n%s\n", name, txt);
+        return 1;
+    }
+
+    if(stream_delta_unittest_line_ends_with(begin, *STREAM_DELTA_KEYFRAME) != keyframe) {
+        fprintf(stderr, "STREAM DELTA: %s: expected %s keyframe in:\n%s\n", name, keyframe ? "a" : "no", txt);
+        errors++;
+    }
+
+    const char *expected[2] = { a, b };
+    for(size_t i = 0; i < 2 ;i++) {
+        const char *found = stream_delta_unittest_dim(txt, dims[i]);
+        if((found == NULL) != (expected[i] == NULL) || (found && strcmp(found, expected[i]) != 0)) {
+            fprintf(stderr, "STREAM DELTA: %s: dimension '%s' expected '%s', found '%s' in:\n%s\n",
+                    name, rrddim_id(dims[i]), expected[i] ? expected[i] : "omitted", found ? found : "omitted", txt);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+int stream_delta_unittest(void) {
+    size_t errors = 0;
+
+    RRDSET *st = callocz(1, sizeof(RRDSET));
+    st->id = string_strdupz("chart");
+    st->update_every = 1;
+
+    RRDDIM *dims[2];
+    for(size_t i = 0; i < 2 ;i++) {
+        dims[i] = callocz(1, sizeof(RRDDIM));
+        dims[i]->id = string_strdupz(i ? "b" : "a");
+        dims[i]->rrdset = st;
+    }
+
+    struct {
+        const char *name;
+        NETDATA_DOUBLE values[2];
+        bool definition_sent;
+        bool keyframe;
+        const char *a, *b;
+    } tests[] = {
+        { "the first block",                    { 1, 5 },     false, true,  "V", "V" },
+        { "an unchanged value",                 { 2, 5 },     false, false, "V", NULL },
+        { "a gap after a value",                { NAN, 5 },   false, false, "E", NULL },
+        { "a gap after a gap",                  { NAN, 5 },   false, false, NULL, NULL },
+        { "the chart definition is re-sent",    { 3, 5 },     true,  true,  "V", "V" },
+    };
+
+    BUFFER *wb = buffer_create(0, NULL);
+    time_t now_s = 1;
+
+    for(size_t i = 0; i < sizeof(tests) / sizeof(tests[0]) ;i++, now_s++) {
+        if(tests[i].definition_sent)
+            stream_send_rrdset_delta_keyframe_next(st);
+
+        const char *txt = stream_delta_unittest_block(wb, dims, tests[i].values, now_s);
+        errors += stream_delta_unittest_check(tests[i].name, txt, dims, tests[i].keyframe, tests[i].a, tests[i].b);
+    }
+
+    // the keyframes repeat, carrying the unchanged values
+    NETDATA_DOUBLE values[2] = { 3, 5 };
+    for(size_t i = 0; i < STREAM_DELTA_KEYFRAME_EVERY - 1 ;i++, now_s++) {
+        const char *txt = stream_delta_unittest_block(wb, dims, values, now_s);
+        errors += stream_delta_unittest_check("a block between keyframes", txt, dims, false, NULL, NULL);
+    }
+
+    const char *txt = stream_delta_unittest_block(wb, dims, values, now_s);
+    errors += stream_delta_unittest_check("the periodic keyframe", txt, dims, true, "V", "V");
+
+    buffer_free(wb);
+
+    for(size_t i = 0; i < 2 ;i++) {
+        string_freez(dims[i]->id);
+        freez(dims[i]);
+    }
+    string_freez(st->id);
+    freez(st);
+
+    fprintf(stderr, "STREAM DELTA: %s\n", errors ? "FAILED" : "OK");
+    return errors ? 1 : 0;
+}
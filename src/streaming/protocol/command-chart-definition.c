@@ -59,8 +59,8 @@ bool stream_sender_send_rrdset_definition(BUFFER *wb, RRDSET *st) {
         , rrdset_units(st)
         , rrdset_family(st)
         , rrdset_context(st)
-        , rrdset_type_name(st->chart_type)
-        , st->priority
+        , rrdset_type_name(rrdset_def(st)->chart_type)
+        , rrdset_def(st)->priority
         , st->update_every
         , rrdset_flag_check(st, RRDSET_FLAG_OBSOLETE)?"obsolete":""
         , rrdset_flag_check(st, RRDSET_FLAG_STORE_FIRST)?"store_first":""
@@ -139,6 +139,10 @@ bool stream_sender_send_rrdset_definition(BUFFER *wb, RRDSET *st) {
     rrdset_metadata_exposed_upstream(st, version);
 
     st->stream.snd.resync_time_s = st->last_collected_time.tv_sec + (stream_send.initial_clock_resync_iterations * st->update_every);
+
+    // the next BEGIN2 has to be a keyframe, so that the parent has all the values to repeat
+    stream_send_rrdset_delta_keyframe_next(st);
+
     return replication_progress;
 }
 
@@ -159,7 +163,7 @@ bool should_send_rrdset_matching(RRDSET *st, RRDSET_FLAGS flags) {
             int negative = 0, positive = 0;
             SIMPLE_PATTERN_RESULT r;
 
-            r = simple_pattern_matches_string_extract(host->stream.snd.charts_matching, st->context, NULL, 0);
+            r = simple_pattern_matches_string_extract(host->stream.snd.charts_matching, rrdset_def(st)->context, NULL, 0);
             if(r == SP_MATCHED_POSITIVE) positive++;
             else if(r == SP_MATCHED_NEGATIVE) negative++;
 
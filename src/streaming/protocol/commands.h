@@ -6,10 +6,22 @@
 #include "database/rrd.h"
 #include "../stream.h"
 
+// with STREAM_CAP_DELTA, every Nth BEGIN2 of a chart is a keyframe carrying all its dimensions
+#define STREAM_DELTA_KEYFRAME_EVERY 60
+#define STREAM_DELTA_KEYFRAME "K"
+
+// the next BEGIN2 of the chart will be a keyframe
+static inline void stream_send_rrdset_delta_keyframe_next(RRDSET *st) {
+    st->stream.snd.delta_keyframe_countdown = 0;
+}
+
+int stream_delta_unittest(void);
+
 typedef struct rrdset_stream_buffer {
     STREAM_CAPABILITIES capabilities;
     bool v2;
     bool begin_v2_added;
+    bool keyframe;
     time_t wall_clock_time;
     RRDSET_FLAGS rrdset_flags;
     time_t last_point_end_time_s;
@@ -36,6 +36,7 @@ static struct {
     {STREAM_CAP_PROGRESS,     "PROGRESS" },
     {STREAM_CAP_NODE_ID,      "NODEID" },
     {STREAM_CAP_PATHS,        "PATHS" },
+    {STREAM_CAP_DELTA,        "DELTA" },
 
     // terminator
     {0 , NULL },
@@ -139,6 +140,7 @@ STREAM_CAPABILITIES stream_our_capabilities(RRDHOST *host, bool sender) {
             STREAM_CAP_PATHS |
             STREAM_CAP_IEEE754 |
             STREAM_CAP_ML_MODELS |
+            STREAM_CAP_DELTA |
             0) & ~disabled_capabilities;
 }
 
@@ -164,8 +166,8 @@ STREAM_CAPABILITIES convert_stream_version_to_capabilities(int32_t version, RRDH
     STREAM_CAPABILITIES common_caps = caps & stream_our_capabilities(host, sender);
 
     if(!(common_caps & STREAM_CAP_INTERPOLATED))
-        // DATA WITH ML requires INTERPOLATED
-        common_caps &= ~(STREAM_CAP_ML_MODELS);
+        // DATA WITH ML and DELTA require INTERPOLATED
+        common_caps &= ~(STREAM_CAP_ML_MODELS | STREAM_CAP_DELTA);
 
     return common_caps;
 }
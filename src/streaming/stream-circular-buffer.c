@@ -128,6 +128,10 @@ size_t stream_circular_buffer_get_unsafe(STREAM_CIRCULAR_BUFFER *scb, char **chu
     return cbuffer_next_unsafe(scb->cb, chunk);
 }
 
+size_t stream_circular_buffer_get_iovec_unsafe(STREAM_CIRCULAR_BUFFER *scb, struct iovec iov[2], int *iovcnt) {
+    return cbuffer_next_iovec_unsafe(scb->cb, iov, iovcnt);
+}
+
 // removes data from the beginning of the circular buffer
 void stream_circular_buffer_del_unsafe(STREAM_CIRCULAR_BUFFER *scb, size_t bytes, usec_t now_ut) {
     scb->last_sent_ut = now_ut ? now_ut : now_monotonic_usec();
@@ -18,6 +18,8 @@ extern "C" {
 #define STREAM_CIRCULAR_BUFFER_ADAPT_TO_TIMES_MAX_SIZE 3
 
 typedef struct stream_circular_buffer_stats {
+    size_t commits;                     // the number of sender_commit() calls made by collectors and receivers
+    size_t batches;                     // the number of times these commits were given to the sender (under lock)
     size_t adds;
     size_t sends;
     size_t recreates;
@@ -88,6 +90,9 @@ bool stream_circular_buffer_add_unsafe(
 // returns a pointer to the beginning of the buffer, and its size in bytes
 size_t stream_circular_buffer_get_unsafe(STREAM_CIRCULAR_BUFFER *scb, char **chunk);
 
+// returns all the data of the circular buffer, in up to 2 segments (when it wraps around)
+size_t stream_circular_buffer_get_iovec_unsafe(STREAM_CIRCULAR_BUFFER *scb, struct iovec iov[2], int *iovcnt);
+
 // removes data from the beginning of circular buffer
 // it updates the statistics
 void stream_circular_buffer_del_unsafe(STREAM_CIRCULAR_BUFFER *scb, size_t bytes, usec_t now_ut);
@@ -51,6 +51,8 @@ struct _stream_send stream_send = {
         .h2o = false,
         .timeout_s = 300,
         .reconnect_delay_s = 15,
+        .rebalance_every_s = 0,               // opt-in
+        .rebalance_load_difference = 20,
         .ssl_ca_path = NULL,
         .ssl_ca_file = NULL,
     },
@@ -145,6 +147,9 @@ void stream_conf_load() {
     stream_conf_load_internal();
     check_local_streaming_capabilities();
 
+    // collectors give their batched DATA to the senders before they sleep
+    heartbeat_set_before_sleep_callback(sender_thread_buffer_flush);
+
     stream_send.enabled =
         inicfg_get_boolean(&stream_config, CONFIG_SECTION_STREAM, "enabled", stream_send.enabled);
 
@@ -187,6 +192,21 @@ void stream_conf_load() {
     if(stream_send.parents.reconnect_delay_s < SENDER_MIN_RECONNECT_DELAY)
         stream_send.parents.reconnect_delay_s = SENDER_MIN_RECONNECT_DELAY;
 
+    stream_send.parents.rebalance_every_s = inicfg_get_duration_seconds(
+        &stream_config, CONFIG_SECTION_STREAM, "rebalance every",
+        stream_send.parents.rebalance_every_s);
+    if(stream_send.parents.rebalance_every_s && stream_send.parents.rebalance_every_s < 60)
+        stream_send.parents.rebalance_every_s = 60;
+
+    stream_send.parents.rebalance_load_difference = (uint32_t)inicfg_get_number_range(
+        &stream_config, CONFIG_SECTION_STREAM, "rebalance load difference",
+        stream_send.parents.rebalance_load_difference, 1, 100);
+
+    stream_receive.capacity = (size_t)inicfg_get_number(
+        &stream_config, CONFIG_SECTION_STREAM, "children capacity", 0);
+    if(!stream_receive.capacity)
+        stream_receive.capacity = netdata_conf_cpus() * STREAM_RECEIVE_CAPACITY_PER_CPU;
+
     stream_send.compression.enabled =
         inicfg_get_boolean(&stream_config, CONFIG_SECTION_STREAM, "enable compression",
                               stream_send.compression.enabled);
@@ -234,6 +254,10 @@ void stream_conf_load() {
     if(!netdata_ssl_validate_certificate_sender)
         nd_log_daemon(NDLP_NOTICE, "SSL: streaming senders will skip SSL certificates verification.");
 
+    netdata_ssl_kernel_tls_sender = inicfg_get_boolean(
+        &stream_config, CONFIG_SECTION_STREAM, "ssl kernel tls offload",
+        netdata_ssl_kernel_tls_sender);
+
     stream_send.parents.ssl_ca_path = string_strdupz(inicfg_get(&stream_config, CONFIG_SECTION_STREAM, "CApath", NULL));
     stream_send.parents.ssl_ca_file = string_strdupz(inicfg_get(&stream_config, CONFIG_SECTION_STREAM, "CAfile", NULL));
 
@@ -38,6 +38,8 @@ struct _stream_send {
         uint16_t default_port;
         time_t timeout_s;
         time_t reconnect_delay_s;
+        time_t rebalance_every_s;               // 0 = do not rebalance across parents
+        uint32_t rebalance_load_difference;     // the load difference (percentage points) that justifies moving
     } parents;
 
     struct {
@@ -47,7 +49,11 @@ struct _stream_send {
 };
 extern struct _stream_send stream_send;
 
+#define STREAM_RECEIVE_CAPACITY_PER_CPU 50
+
 struct _stream_receive {
+    size_t capacity;                            // the number of children we advertise we are sized for
+
     struct {
         bool enabled;
         time_t period;
@@ -620,6 +620,9 @@ static void stream_connector_thread(void *ptr) {
         }
         spinlock_unlock(&sc->queue.spinlock);
 
+        if(!exiting)
+            stream_parents_load_refresh(now_monotonic_usec());
+
         worker_set_metric(WORKER_SENDER_CONNECTOR_JOB_QUEUED_NODES, (NETDATA_DOUBLE)nodes);
         worker_set_metric(WORKER_SENDER_CONNECTOR_JOB_CONNECTED_NODES, (NETDATA_DOUBLE)connected_nodes);
         worker_set_metric(WORKER_SENDER_CONNECTOR_JOB_FAILED_NODES, (NETDATA_DOUBLE)failed_nodes);
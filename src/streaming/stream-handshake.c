@@ -58,6 +58,9 @@ static struct {
     {STREAM_HANDSHAKE_SP_NO_STREAM_INFO, "NO STREAM INFO", 404}, // Not Found
     {STREAM_HANDSHAKE_SP_NO_DESTINATION, "NO PARENT TO SEND TO", 502}, // Bad Gateway
 
+    // sender-only codes
+    {STREAM_HANDSHAKE_SND_DISCONNECT_REBALANCE, "DISCONNECTED TO REBALANCE PARENTS", 307}, // Temporary Redirect
+
     { 0, NULL, 0 },
 };
 
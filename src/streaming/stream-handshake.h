@@ -73,8 +73,11 @@ typedef enum {
     STREAM_HANDSHAKE_SP_NO_STREAM_INFO                  = -37,
     STREAM_HANDSHAKE_SP_NO_DESTINATION                  = -38,
 
+    // sender-only codes
+    STREAM_HANDSHAKE_SND_DISCONNECT_REBALANCE           = -39,
+
     // terminator - keep this positive, bigger than all negative values
-    STREAM_HANDSHAKE_NEGATIVE_MAX                       = 39,
+    STREAM_HANDSHAKE_NEGATIVE_MAX                       = 40,
 } STREAM_HANDSHAKE;
 
 const char *stream_handshake_error_to_string(STREAM_HANDSHAKE reason);
@@ -23,6 +23,7 @@ struct stream_parent {
         uint32_t nonce;                         // a random 32-bit number
         size_t nodes;                           // how many nodes the parent has
         size_t receivers;                       // how many receivers the parent has
+        size_t capacity;                        // how many receivers the parent is sized for (0 = not advertised)
 
         // these are from RRDHOST_STATUS and can only be used when status == 200
         RRDHOST_DB_STATUS db_status;
@@ -81,6 +82,73 @@ static bool is_a_blocked_parent(STREAM_PARENT *d) {
     return ret;
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// the load parents advertise in stream_info, shared by all nodes we host, so that we can rebalance them
+
+struct parent_load {
+    STRING *destination;
+    bool ssl;
+    size_t receivers;
+    size_t capacity;
+    usec_t updated_ut;                          // monotonic
+};
+
+DEFINE_JUDYL_TYPED(PARENTS_LOAD, struct parent_load *);
+static PARENTS_LOAD_JudyLSet parents_load_set = { 0 };
+static RW_SPINLOCK parents_load_spinlock = RW_SPINLOCK_INITIALIZER;
+
+static void parent_load_update(STREAM_PARENT *d) {
+    rw_spinlock_write_lock(&parents_load_spinlock);
+
+    struct parent_load *p = PARENTS_LOAD_GET(&parents_load_set, (Word_t)d->destination);
+    if(!p) {
+        p = callocz(1, sizeof(*p));
+        p->destination = string_dup(d->destination);
+        PARENTS_LOAD_SET(&parents_load_set, (Word_t)p->destination, p);
+    }
+    p->ssl = d->ssl;
+    p->receivers = d->remote.receivers;
+    p->capacity = d->remote.capacity;
+    p->updated_ut = now_monotonic_usec();
+
+    rw_spinlock_write_unlock(&parents_load_spinlock);
+}
+
+// returns the load of the parent in percent of its capacity, or -1 when it is not known
+static NETDATA_DOUBLE parent_load_percent(size_t receivers, size_t capacity) {
+    if(!capacity) return -1.0;
+    return (NETDATA_DOUBLE)receivers * 100.0 / (NETDATA_DOUBLE)capacity;
+}
+
+static NETDATA_DOUBLE parent_load_get(STRING *destination, usec_t now_ut, size_t *receivers, size_t *capacity) {
+    NETDATA_DOUBLE load = -1.0;
+
+    rw_spinlock_read_lock(&parents_load_spinlock);
+    struct parent_load *p = PARENTS_LOAD_GET(&parents_load_set, (Word_t)destination);
+    if(p && p->capacity && now_ut - p->updated_ut <= 2 * stream_send.parents.rebalance_every_s * USEC_PER_SEC) {
+        *receivers = p->receivers;
+        *capacity = p->capacity;
+        load = parent_load_percent(p->receivers, p->capacity);
+    }
+    rw_spinlock_read_unlock(&parents_load_spinlock);
+
+    return load;
+}
+
+static void parent_load_move_one_receiver(STRING *from, STRING *to) {
+    // account the move immediately, so that the other nodes we host
+    // will not all decide to move to the same parent at once
+    rw_spinlock_write_lock(&parents_load_spinlock);
+
+    struct parent_load *p = PARENTS_LOAD_GET(&parents_load_set, (Word_t)from);
+    if(p && p->receivers) p->receivers--;
+
+    p = PARENTS_LOAD_GET(&parents_load_set, (Word_t)to);
+    if(p) p->receivers++;
+
+    rw_spinlock_write_unlock(&parents_load_spinlock);
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 
 STREAM_HANDSHAKE stream_parent_get_disconnect_reason(STREAM_PARENT *d) {
@@ -196,6 +264,11 @@ void rrdhost_stream_parents_to_json(BUFFER *wb, RRDHOST_STATUS *s) {
 
                 buffer_json_member_add_boolean(wb, "info", d->selection.info);
                 buffer_json_member_add_boolean(wb, "skipped", d->selection.skipped);
+
+                if(d->remote.capacity) {
+                    buffer_json_member_add_uint64(wb, "receivers", d->remote.receivers);
+                    buffer_json_member_add_uint64(wb, "capacity", d->remote.capacity);
+                }
             }
             else {
                 if(d->banned_permanently)
@@ -322,6 +395,7 @@ int stream_info_to_json_v1(BUFFER *wb, const char *machine_guid) {
     buffer_json_member_add_uuid(wb, "host_id", localhost->host_id.uuid);
     buffer_json_member_add_uint64(wb, "nodes", dictionary_entries(rrdhost_root_index));
     buffer_json_member_add_uint64(wb, "receivers", stream_receivers_currently_connected());
+    buffer_json_member_add_uint64(wb, "capacity", stream_receive.capacity);
     buffer_json_member_add_uint64(wb, "nonce", os_random32());
 
     if(ret == HTTP_RESP_OK) {
@@ -351,6 +425,11 @@ static bool stream_info_json_parse_v1(struct json_object *jobj, const char *path
     JSONC_PARSE_UINT64_OR_ERROR_AND_RETURN(jobj, path, "receivers", d->remote.receivers, error, true);
     JSONC_PARSE_UINT64_OR_ERROR_AND_RETURN(jobj, path, "nonce", d->remote.nonce, error, true);
 
+    // older parents do not advertise their capacity
+    d->remote.capacity = 0;
+    JSONC_PARSE_UINT64_OR_ERROR_AND_RETURN(jobj, path, "capacity", d->remote.capacity, error, false);
+    parent_load_update(d);
+
     if(d->remote.status == HTTP_RESP_OK) {
         JSONC_PARSE_UINT64_OR_ERROR_AND_RETURN(jobj, path, "first_time_s", d->remote.db_first_time_s, error, true);
         JSONC_PARSE_UINT64_OR_ERROR_AND_RETURN(jobj, path, "last_time_s", d->remote.db_last_time_s, error, true);
@@ -373,7 +452,7 @@ static bool stream_info_json_parse_v1(struct json_object *jobj, const char *path
     return false;
 }
 
-static bool stream_info_fetch(STREAM_PARENT *d, const char *uuid, int default_port, ND_SOCK *sender_sock, bool ssl, const char *hostname) {
+static bool stream_info_fetch(STREAM_PARENT *d, const char *uuid, int default_port, ND_SOCK *sender_sock, bool ssl, const char *hostname, int timeout_s) {
     ND_LOG_STACK lgs[] = {
         ND_LOG_FIELD_STR(NDF_DST_IP, d->destination),
         ND_LOG_FIELD_I64(NDF_DST_PORT, default_port),
@@ -409,7 +488,7 @@ static bool stream_info_fetch(STREAM_PARENT *d, const char *uuid, int default_po
 
     // Establish connection
     d->reason = STREAM_HANDSHAKE_SP_CONNECTING;
-    if (!nd_sock_connect_to_this(&sock, string2str(d->destination), default_port, 5, ssl)) {
+    if (!nd_sock_connect_to_this(&sock, string2str(d->destination), default_port, timeout_s, ssl)) {
         d->selection.info = false;
         stream_parent_nd_sock_error_to_reason(d, &sock);
         nd_log(NDLS_DAEMON, NDLP_WARNING,
@@ -420,7 +499,7 @@ static bool stream_info_fetch(STREAM_PARENT *d, const char *uuid, int default_po
     }
 
     // Send HTTP request
-    ssize_t sent = nd_sock_send_timeout(&sock, buf, strlen(buf), 0, 5);
+    ssize_t sent = nd_sock_send_timeout(&sock, buf, strlen(buf), 0, timeout_s);
     if (sent <= 0) {
         d->selection.info = false;
         stream_parent_nd_sock_error_to_reason(d, &sock);
@@ -449,7 +528,7 @@ static bool stream_info_fetch(STREAM_PARENT *d, const char *uuid, int default_po
             return false;
         }
 
-        ssize_t received = nd_sock_recv_timeout(&sock, buf + total_received, remaining - 1, 0, 5);
+        ssize_t received = nd_sock_recv_timeout(&sock, buf + total_received, remaining - 1, 0, timeout_s);
         if (received <= 0) {
             nd_log(NDLS_DAEMON, NDLP_WARNING,
                    "STREAM PARENTS '%s': socket receive error while querying stream info on '%s' "
@@ -529,10 +608,10 @@ static bool stream_info_fetch(STREAM_PARENT *d, const char *uuid, int default_po
 
     nd_log(NDLS_DAEMON, NDLP_DEBUG,
            "STREAM PARENTS '%s': received stream_info data from '%s': "
-           "status: %d, nodes: %zu, receivers: %zu, first_time_s: %ld, last_time_s: %ld, "
+           "status: %d, nodes: %zu, receivers: %zu, capacity: %zu, first_time_s: %ld, last_time_s: %ld, "
            "db status: %s, db liveness: %s, ingest type: %s, ingest status: %s",
            hostname, string2str(d->destination),
-           d->remote.status, d->remote.nodes, d->remote.receivers,
+           d->remote.status, d->remote.nodes, d->remote.receivers, d->remote.capacity,
            d->remote.db_first_time_s, d->remote.db_last_time_s,
            RRDHOST_DB_STATUS_2str(d->remote.db_status),
            RRDHOST_DB_LIVENESS_2str(d->remote.db_liveness),
@@ -544,6 +623,21 @@ static bool stream_info_fetch(STREAM_PARENT *d, const char *uuid, int default_po
     return true;
 }
 
+// returns true when parent a should be preferred over parent b
+// the least loaded parent wins, but only when the difference is above the hysteresis
+// threshold - otherwise we flip coins, to spread the nodes across similar parents
+static bool stream_parent_is_preferred(STREAM_PARENT *a, STREAM_PARENT *b) {
+    NETDATA_DOUBLE load_a = parent_load_percent(a->remote.receivers, a->remote.capacity);
+    NETDATA_DOUBLE load_b = parent_load_percent(b->remote.receivers, b->remote.capacity);
+
+    if(load_a >= 0.0 && load_b >= 0.0 && fabsndd(load_a - load_b) > (NETDATA_DOUBLE)stream_send.parents.rebalance_load_difference)
+        return load_a < load_b;
+
+    uint32_t a_nonce = a->remote.nonce | os_random32();
+    uint32_t b_nonce = b->remote.nonce | os_random32();
+    return a_nonce > b_nonce;
+}
+
 static int compare_last_time(const void *a, const void *b) {
     STREAM_PARENT *parent_a = *(STREAM_PARENT **)a;
     STREAM_PARENT *parent_b = *(STREAM_PARENT **)b;
@@ -604,6 +698,7 @@ bool stream_parent_connect_to_one_unsafe(
         // this is taken from the parent, but if the stream_info call fails,
         // we generate a random number for every parent here
         d->remote.nonce = os_random32();
+        d->remote.capacity = 0; // stream_info will set it, if the parent advertises it
         d->banned_temporarily_erroneous = is_a_blocked_parent(d);
 
         if (d->banned_permanently || d->banned_for_this_session)
@@ -629,7 +724,7 @@ bool stream_parent_connect_to_one_unsafe(
         }
 
         if(stream_info_fetch(d, host->machine_guid, default_port,
-                              sender_sock, stream_parent_is_ssl(d), rrdhost_hostname(host))) {
+                              sender_sock, stream_parent_is_ssl(d), rrdhost_hostname(host), 5)) {
             switch(d->remote.ingest_type) {
                 case RRDHOST_INGEST_TYPE_VIRTUAL:
                 case RRDHOST_INGEST_TYPE_LOCALHOST:
@@ -767,9 +862,8 @@ bool stream_parent_connect_to_one_unsafe(
                 while (similar > 1) {
                     size_t chosen = base;
                     for(size_t i = base + 1 ; i < base + similar ;i++) {
-                        uint32_t i_nonce = array[i]->remote.nonce | os_random32();
-                        uint32_t chosen_nonce = array[chosen]->remote.nonce | os_random32();
-                        if(i_nonce > chosen_nonce) chosen = i;
+                        if(stream_parent_is_preferred(array[i], array[chosen]))
+                            chosen = i;
                     }
 
                     if (chosen != base)
@@ -893,6 +987,126 @@ bool stream_parent_connect_to_one(
     return rc;
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// rebalance nodes across parents
+
+// this runs on the connector thread, so every cycle queries only a few parents, with short timeouts
+#define STREAM_PARENTS_LOAD_REFRESH_PER_CYCLE 1
+#define STREAM_PARENTS_LOAD_REFRESH_TIMEOUT_S 2
+
+void stream_parents_load_refresh(usec_t now_ut) {
+    static struct {
+        usec_t last_refresh_ut;
+        Word_t next_idx;            // the parent to continue from, when running
+        bool running;
+    } refresh = { 0 };
+
+    if(!stream_send.parents.rebalance_every_s || !localhost)
+        return;
+
+    if(!refresh.running) {
+        // refresh twice per rebalancing period, so that the load is always fresh when nodes check it
+        if(now_ut - refresh.last_refresh_ut < stream_send.parents.rebalance_every_s * USEC_PER_SEC / 2)
+            return;
+
+        refresh.last_refresh_ut = now_ut;
+        refresh.next_idx = 0;
+        refresh.running = true;
+    }
+
+    // copy the next parents, to query them without holding the lock
+    size_t used = 0;
+    STREAM_PARENT parents[STREAM_PARENTS_LOAD_REFRESH_PER_CYCLE];
+
+    rw_spinlock_read_lock(&parents_load_spinlock);
+    Word_t idx = refresh.next_idx;
+    struct parent_load *p = PARENTS_LOAD_FIRST(&parents_load_set, &idx);
+    while(p && used < STREAM_PARENTS_LOAD_REFRESH_PER_CYCLE) {
+        memset(&parents[used], 0, sizeof(*parents));
+        parents[used].destination = string_dup(p->destination);
+        parents[used].ssl = p->ssl;
+        used++;
+
+        p = PARENTS_LOAD_NEXT(&parents_load_set, &idx);
+    }
+    rw_spinlock_read_unlock(&parents_load_spinlock);
+
+    if(p)
+        refresh.next_idx = idx;
+    else
+        refresh.running = false;
+
+    // stream_info_fetch() updates the load of every parent that responds
+    ND_SOCK sock = ND_SOCK_INIT(netdata_ssl_streaming_sender_ctx, netdata_ssl_validate_certificate_sender);
+    for(size_t i = 0; i < used ; i++) {
+        if(!nd_thread_signaled_to_cancel() && service_running(SERVICE_STREAMING_CONNECTOR))
+            stream_info_fetch(&parents[i], localhost->machine_guid, stream_send.parents.default_port,
+                              &sock, parents[i].ssl, rrdhost_hostname(localhost),
+                              STREAM_PARENTS_LOAD_REFRESH_TIMEOUT_S);
+
+        string_freez(parents[i].destination);
+    }
+}
+
+bool stream_parent_rebalance_check(RRDHOST *host) {
+    if(!stream_send.parents.rebalance_every_s)
+        return false;
+
+    usec_t now_monotonic_ut = now_monotonic_usec();
+    usec_t now_ut = now_realtime_usec();
+    bool rebalance = false;
+
+    rw_spinlock_write_lock(&host->stream.snd.parents.spinlock);
+
+    STREAM_PARENT *current = host->stream.snd.parents.current;
+    size_t current_receivers = 0, current_capacity = 0;
+    NETDATA_DOUBLE current_load = current && current->selection.batch ?
+        parent_load_get(current->destination, now_monotonic_ut, &current_receivers, &current_capacity) : -1.0;
+
+    if(current_load >= 0.0) {
+        STREAM_PARENT *best = NULL;
+        NETDATA_DOUBLE best_load = 0.0;
+
+        // consider only the parents that had similar data with the current one, when we connected
+        for(STREAM_PARENT *d = host->stream.snd.parents.all; d; d = d->next) {
+            if(d == current || d->selection.batch != current->selection.batch ||
+                d->banned_permanently || d->banned_for_this_session || d->banned_temporarily_erroneous ||
+                d->postpone_until_ut > now_ut)
+                continue;
+
+            size_t receivers = 0, capacity = 0;
+            if(parent_load_get(d->destination, now_monotonic_ut, &receivers, &capacity) < 0.0)
+                continue;
+
+            // the load it will have, after we connect to it
+            NETDATA_DOUBLE load = parent_load_percent(receivers + 1, capacity);
+            if(!best || load < best_load) {
+                best = d;
+                best_load = load;
+            }
+        }
+
+        if(best && current_load - best_load > (NETDATA_DOUBLE)stream_send.parents.rebalance_load_difference) {
+            nd_log(NDLS_DAEMON, NDLP_NOTICE,
+                   "STREAM PARENTS '%s': rebalancing from parent '%s' (load %.1f%%, %zu of %zu receivers) "
+                   "to parent '%s' (load %.1f%% after we connect)",
+                   rrdhost_hostname(host),
+                   string2str(current->destination), current_load, current_receivers, current_capacity,
+                   string2str(best->destination), best_load);
+
+            parent_load_move_one_receiver(current->destination, best->destination);
+
+            // do not reconnect to the current parent for a while, so that the next connection goes elsewhere
+            current->reason = STREAM_HANDSHAKE_SND_DISCONNECT_REBALANCE;
+            current->postpone_until_ut = randomize_wait_ut(60, 120);
+            rebalance = true;
+        }
+    }
+
+    rw_spinlock_write_unlock(&host->stream.snd.parents.spinlock);
+    return rebalance;
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // create stream parents linked list
 
@@ -32,6 +32,11 @@ bool stream_parent_connect_to_one(
     size_t connected_to_size,
     STREAM_PARENT **destination);
 
+// rebalancing: the connector thread refreshes the load of the known parents,
+// and the stream threads periodically check if their nodes should move to a less loaded parent
+void stream_parents_load_refresh(usec_t now_ut);
+bool stream_parent_rebalance_check(struct rrdhost *host);
+
 void rrdhost_stream_parents_to_json(BUFFER *wb, struct rrdhost_status_t *s);
 STREAM_HANDSHAKE stream_parent_get_disconnect_reason(STREAM_PARENT *d);
 void stream_parent_set_host_disconnect_reason(RRDHOST *host, STREAM_HANDSHAKE reason, time_t since);
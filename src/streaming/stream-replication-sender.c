@@ -1909,7 +1909,8 @@ void *replication_thread_main(void *ptr) {
 }
 
 int replication_threads_default(void) {
-    int threads = netdata_conf_is_parent() ? (int)MAX(netdata_conf_cpus() / 3, 4) : 1;
+    int cpus = (int)netdata_conf_cpus();
+    int threads = netdata_conf_is_parent() ? MAX(cpus / 3, MIN(cpus, 4)) : 1;
     threads = FIT_IN_RANGE(threads, 1, MAX_REPLICATION_THREADS);
     return threads;
 }
@@ -79,6 +79,7 @@ void stream_sender_structures_free(struct rrdhost *host) {
 
     // stop a possibly running thread
     stream_sender_signal_to_stop_and_wait(host, STREAM_HANDSHAKE_SND_DISCONNECT_HOST_CLEANUP, true);
+    sender_thread_buffers_drop(host->sender);
     stream_circular_buffer_destroy(host->sender->scb);
     host->sender->scb = NULL;
     waitq_destroy(&host->sender->waitq);
@@ -5,18 +5,179 @@
 
 static __thread struct sender_buffer commit___thread = { 0 };
 
+// the thread buffers that have accumulated commits
+// the spinlock of a thread buffer may be held while taking this spinlock,
+// so while holding this spinlock, thread buffers can only be trylock()ed
+static struct {
+    SPINLOCK spinlock;
+    struct sender_buffer *base;
+    struct sender_buffer *flushing;     // expired, locked and being given to their senders by a stream thread
+} thread_batches = {
+    .spinlock = SPINLOCK_INITIALIZER,
+    .base = NULL,
+    .flushing = NULL,
+};
+
+static void sender_thread_batch_unlink_unsafe(struct sender_buffer *commit) {
+    if(commit->linked) {
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(thread_batches.base, commit, prev, next);
+        commit->linked = false;
+    }
+}
+
+static void sender_thread_batch_unlink(struct sender_buffer *commit) {
+    // linked is only changed while holding the spinlock of the thread buffer, which we have
+    if(!commit->linked)
+        return;
+
+    spinlock_lock(&thread_batches.spinlock);
+    sender_thread_batch_unlink_unsafe(commit);
+    spinlock_unlock(&thread_batches.spinlock);
+}
+
+static void sender_thread_batch_link(struct sender_buffer *commit) {
+    spinlock_lock(&thread_batches.spinlock);
+    if(!commit->linked) {
+        DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(thread_batches.base, commit, prev, next);
+        commit->linked = true;
+    }
+    spinlock_unlock(&thread_batches.spinlock);
+}
+
+static void sender_thread_batch_reset(struct sender_buffer *commit) {
+    commit->reused = 0;
+    commit->sender = NULL;
+    commit->sender_generation = 0;
+    commit->since_ut = 0;
+}
+
 void sender_buffer_destroy(struct sender_buffer *commit) {
+    sender_thread_batch_unlink(commit);
     buffer_free(commit->wb);
     commit->wb = NULL;
     commit->used = false;
-    commit->reused = 0;
     commit->our_recreates = 0;
     commit->sender_recreates = 0;
     commit->last_function = NULL;
+    sender_thread_batch_reset(commit);
+}
+
+// the spinlock of the thread buffer must be held
+static void sender_thread_buffer_flush_pending_locked(struct sender_buffer *commit) {
+    sender_thread_batch_unlink(commit);
+
+    if(commit->reused && commit->sender && commit->wb)
+        sender_buffer_commit(commit->sender, commit->wb, commit, STREAM_TRAFFIC_TYPE_DATA);
+
+    sender_thread_batch_reset(commit);
+}
+
+void sender_thread_buffer_flush(void) {
+    struct sender_buffer *commit = &commit___thread;
+
+    // other threads only reset it, so we can check it without the lock
+    if(!commit->reused)
+        return;
+
+    spinlock_lock(&commit->spinlock);
+    if(commit->reused && !commit->used)
+        sender_thread_buffer_flush_pending_locked(commit);
+    spinlock_unlock(&commit->spinlock);
 }
 
 void sender_thread_buffer_free(void) {
+    sender_thread_buffer_flush();
+
+    spinlock_lock(&commit___thread.spinlock);
     sender_buffer_destroy(&commit___thread);
+    spinlock_unlock(&commit___thread.spinlock);
+}
+
+#define SENDER_THREAD_BUFFERS_FLUSH_MAX 32
+
+void sender_thread_buffers_flush_expired(usec_t now_ut) {
+    struct sender_buffer *expired[SENDER_THREAD_BUFFERS_FLUSH_MAX];
+    size_t count = 0;
+
+    // under the global lock, we only claim the expired thread buffers:
+    // we keep them locked and move them to the flushing list,
+    // so that their senders wait for us before they are freed
+    spinlock_lock(&thread_batches.spinlock);
+
+    struct sender_buffer *commit = thread_batches.base, *next;
+    while(commit && count < SENDER_THREAD_BUFFERS_FLUSH_MAX) {
+        next = commit->next;
+
+        // since_ut does not change while the thread buffer is linked
+        if(commit->since_ut + SENDER_THREAD_BUFFER_MAX_BATCH_AGE_UT <= now_ut &&
+            spinlock_trylock(&commit->spinlock)) {
+
+            // when it is used, its thread will decide when its commit finishes
+            if(!commit->used) {
+                sender_thread_batch_unlink_unsafe(commit);
+                DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(thread_batches.flushing, commit, prev, next);
+                expired[count++] = commit;
+            }
+            else
+                spinlock_unlock(&commit->spinlock);
+        }
+
+        commit = next;
+    }
+
+    spinlock_unlock(&thread_batches.spinlock);
+
+    // the commits run without the global lock
+    for(size_t i = 0; i < count ;i++) {
+        commit = expired[i];
+
+        sender_thread_buffer_flush_pending_locked(commit);
+
+        spinlock_lock(&thread_batches.spinlock);
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(thread_batches.flushing, commit, prev, next);
+        spinlock_unlock(&thread_batches.spinlock);
+
+        spinlock_unlock(&commit->spinlock);
+    }
+}
+
+void sender_thread_buffers_drop(struct sender_state *s) {
+    bool again;
+
+    do {
+        again = false;
+
+        spinlock_lock(&thread_batches.spinlock);
+
+        struct sender_buffer *commit = thread_batches.base, *next;
+        while(commit) {
+            next = commit->next;
+
+            // sender does not change while the thread buffer is linked
+            if(commit->sender == s) {
+                if(spinlock_trylock(&commit->spinlock)) {
+                    sender_thread_batch_unlink_unsafe(commit);
+                    sender_thread_batch_reset(commit);
+                    spinlock_unlock(&commit->spinlock);
+                }
+                else
+                    again = true;
+            }
+
+            commit = next;
+        }
+
+        // a stream thread is giving one of them to this sender - wait for it
+        for(commit = thread_batches.flushing; commit && !again ; commit = commit->next)
+            if(commit->sender == s)
+                again = true;
+
+        spinlock_unlock(&thread_batches.spinlock);
+
+        if(again)
+            tinysleep();
+
+    } while(again);
 }
 
 void sender_host_buffer_free(RRDHOST *host) {
@@ -25,6 +186,10 @@ void sender_host_buffer_free(RRDHOST *host) {
 
 // Collector thread starting a transmission
 static BUFFER *sender_commit_start_with_trace(struct sender_state *s, struct sender_buffer *commit, size_t default_size, const char *func) {
+    bool thread_buffer = (commit == &commit___thread);
+    if(thread_buffer)
+        spinlock_lock(&commit->spinlock);
+
     if(unlikely(commit->used))
         fatal("STREAM SND '%s' [to %s]: thread buffer is used multiple times concurrently (%u). "
               "It is already being used by '%s()', and now is called by '%s()'",
@@ -38,7 +203,13 @@ static BUFFER *sender_commit_start_with_trace(struct sender_state *s, struct sen
               rrdhost_hostname(s->host), s->remote_ip,
               commit->receiver_tid, gettid_cached(), func ? func : "(null)");
 
-    if(unlikely(commit->wb &&
+    // the thread buffer has data accumulated for another sender, or for a previous connection
+    // of this sender - give them to it first (data of previous connections are dropped)
+    if(unlikely(commit->reused && commit->sender &&
+                 (commit->sender != s || commit->sender_generation != stream_sender_generation(s))))
+        sender_thread_buffer_flush_pending_locked(commit);
+
+    if(unlikely(commit->wb && !commit->reused &&
                  commit->wb->size > default_size &&
                  commit->our_recreates != commit->sender_recreates)) {
         buffer_free(commit->wb);
@@ -55,6 +226,9 @@ static BUFFER *sender_commit_start_with_trace(struct sender_state *s, struct sen
     if(!commit->reused)
         buffer_flush(commit->wb);
 
+    if(thread_buffer)
+        spinlock_unlock(&commit->spinlock);
+
     return commit->wb;
 }
 
@@ -84,6 +258,10 @@ void sender_buffer_commit(struct sender_state *s, BUFFER *wb, struct sender_buff
     if(commit)
         commit->sender_recreates = stats->recreates;
 
+    // the number of commits made by the collectors vs. the times we take this lock
+    stats->commits += (commit && commit->reused) ? commit->reused : 1;
+    stats->batches++;
+
     if (!s->thread.msg.session) {
         // the dispatcher is not there anymore - ignore these data
 
@@ -95,6 +273,15 @@ void sender_buffer_commit(struct sender_state *s, BUFFER *wb, struct sender_buff
         return;
     }
 
+    if (commit && commit->sender == s && commit->sender_generation != s->thread.generation) {
+        // these data have been batched for a previous connection - the parent
+        // has not received yet the chart definitions they depend on - ignore them
+        buffer_flush(wb);
+        stream_sender_unlock(s);
+        waitq_release(&s->waitq);
+        return;
+    }
+
     if (unlikely(stream_circular_buffer_set_max_size_unsafe(
             s->scb, src_len * STREAM_CIRCULAR_BUFFER_ADAPT_TO_TIMES_MAX_SIZE, false))) {
         // adaptive sizing of the circular buffer
@@ -242,6 +429,10 @@ void sender_thread_commit_with_trace(struct sender_state *s, BUFFER *wb, STREAM_
         is_receiver = commit->receiver_tid == gettid_cached();
     }
 
+    bool thread_buffer = (commit == &commit___thread);
+    if(thread_buffer)
+        spinlock_lock(&commit->spinlock);
+
     if (unlikely(wb != commit->wb))
         fatal("STREAM SND '%s' [to %s]: function '%s()' is trying to commit an unknown commit buffer.",
               rrdhost_hostname(s->host), s->remote_ip, func);
@@ -250,16 +441,39 @@ void sender_thread_commit_with_trace(struct sender_state *s, BUFFER *wb, STREAM_
         fatal("STREAM SND '%s' [to %s]: function '%s()' is committing a sender buffer twice.",
               rrdhost_hostname(s->host), s->remote_ip, func);
 
-    if(!is_receiver ||
-        type != STREAM_TRAFFIC_TYPE_DATA ||
-        commit->reused >= 100 ||
-        buffer_strlen(wb) >= COMPRESSION_MAX_MSG_SIZE * 2 / 3) {
+    commit->reused++;
+
+    bool batch = false;
+    if(type == STREAM_TRAFFIC_TYPE_DATA &&
+        commit->reused < SENDER_BUFFER_MAX_BATCHED_COMMITS &&
+        buffer_strlen(wb) < SENDER_BUFFER_MAX_BATCHED_SIZE) {
+
+        if(is_receiver)
+            batch = true;
+
+        else if(thread_buffer) {
+            // collector threads accumulate their chart updates, so that they
+            // lock the sender once per batch instead of once per chart
+            usec_t now_ut = now_monotonic_usec();
+            if(commit->reused == 1) {
+                commit->sender = s;
+                commit->sender_generation = stream_sender_generation(s);
+                commit->since_ut = now_ut;
+                sender_thread_batch_link(commit);
+            }
+            batch = now_ut - commit->since_ut < SENDER_THREAD_BUFFER_MAX_BATCH_AGE_UT;
+        }
+    }
+
+    if(!batch) {
+        sender_thread_batch_unlink(commit);
         sender_buffer_commit(s, wb, commit, type);
-        commit->reused = 0;
+        sender_thread_batch_reset(commit);
     }
-    else
-        commit->reused++;
 
     commit->used = false;
     commit->last_function = NULL;
+
+    if(thread_buffer)
+        spinlock_unlock(&commit->spinlock);
 }
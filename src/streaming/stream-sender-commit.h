@@ -15,15 +15,46 @@ struct sender_buffer {
     BUFFER *wb;
     pid_t receiver_tid;
     bool used;
-    uint16_t reused;
+    uint16_t reused;                // the number of commits accumulated in wb, not yet given to the sender
     uint32_t our_recreates;
     uint32_t sender_recreates;
+
+    // thread buffers only: the sender connection the accumulated commits are for,
+    // and when the first of them was made - protected by spinlock
+    SPINLOCK spinlock;
+    struct sender_state *sender;
+    uint32_t sender_generation;
+    usec_t since_ut;
+
+    // thread buffers with accumulated commits are linked in a global list,
+    // so that the stream threads can flush the expired ones and the senders can drop theirs
+    bool linked;
+    struct sender_buffer *prev, *next;
 };
+
+// commits are accumulated into the same buffer, and they are given to the sender
+// (under its lock) when any of these is reached, when the thread flushes them,
+// or when a stream thread finds them older than the max batch age
+#define SENDER_BUFFER_MAX_BATCHED_COMMITS 100
+#define SENDER_BUFFER_MAX_BATCHED_SIZE (COMPRESSION_MAX_MSG_SIZE * 2 / 3)
+#define SENDER_THREAD_BUFFER_MAX_BATCH_AGE_UT (100 * USEC_PER_MS)
+
 void sender_buffer_destroy(struct sender_buffer *commit);
 
 // thread buffer for sending data upstream (to a parent)
 
 void sender_thread_buffer_free(void);
+
+// give any DATA accumulated in the thread buffer to its sender
+// collectors call this before they sleep or block (heartbeat_next() does it automatically)
+void sender_thread_buffer_flush(void);
+
+// give to their senders the DATA accumulated by threads for longer than SENDER_THREAD_BUFFER_MAX_BATCH_AGE_UT
+// called periodically by the stream threads, for threads that stopped committing
+void sender_thread_buffers_flush_expired(usec_t now_ut);
+
+// drop the DATA accumulated by all threads for this sender - called before the sender is freed
+void sender_thread_buffers_drop(struct sender_state *s);
 void sender_host_buffer_free(struct rrdhost *host);
 
 // get the thread buffer
@@ -45,6 +45,7 @@ struct sender_state {
 
     struct {
         struct stream_opcode msg;   // the template for sending a message to the dispatcher - protected by sender_lock()
+        uint32_t generation;        // incremented on every connection - written under sender_lock()
 
         // this is a property of stream_sender_send_msg_to_dispatcher()
         // protected by dispatcher->messages.spinlock
@@ -77,6 +78,10 @@ struct sender_state {
         int8_t id;                              // the connector id - protected by sender_lock()
     } connector;
 
+    struct {
+        usec_t next_check_ut;                   // when to check if we should move to a less loaded parent (monotonic)
+    } rebalance;
+
     struct {
         bool shutdown;                          // when set, the sender should stop sending this host
         STREAM_HANDSHAKE reason;                // the reason we decided to stop this sender
@@ -110,6 +115,8 @@ struct sender_state {
     char remote_ip[CONNECTED_TO_SIZE + 1];      // We don't know which proxy we connect to, passed back from socket.c
 };
 
+#define stream_sender_generation(sender) __atomic_load_n(&((sender)->thread.generation), __ATOMIC_RELAXED)
+
 #define stream_sender_lock(sender) spinlock_lock(&(sender)->spinlock)
 #define stream_sender_unlock(sender) spinlock_unlock(&(sender)->spinlock)
 #define stream_sender_trylock(sender) spinlock_trylock(&(sender)->spinlock)
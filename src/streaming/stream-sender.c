@@ -137,6 +137,11 @@ void stream_sender_on_connect(struct sender_state *s) {
 
     s->thread.last_traffic_ut = now_monotonic_usec();
 
+    // randomize the first check, so that nodes connected together will not check together
+    usec_t rebalance_every_ut = stream_send.parents.rebalance_every_s * USEC_PER_SEC;
+    s->rebalance.next_check_ut = rebalance_every_ut ?
+        s->thread.last_traffic_ut + rebalance_every_ut + os_random(rebalance_every_ut / 4) : 0;
+
     freez(s->thread.rbuf.b);
     s->thread.rbuf.size = PLUGINSD_LINE_MAX + 1;
     s->thread.rbuf.b = mallocz(s->thread.rbuf.size);
@@ -328,6 +333,7 @@ void stream_sender_move_queue_to_running_unsafe(struct stream_thread *sth) {
 
         s->thread.msg.thread_slot = (int32_t)sth->id;
         s->thread.msg.session = os_random32();
+        __atomic_add_fetch(&s->thread.generation, 1, __ATOMIC_RELAXED);
         s->thread.msg.meta = &s->thread.meta;
 
         __atomic_store_n(&s->host->stream.snd.status.tid, gettid_cached(), __ATOMIC_RELAXED);
@@ -522,6 +528,17 @@ void stream_sender_check_all_nodes_from_poll(struct stream_thread *sth, usec_t n
             continue;
         }
 
+        if(unlikely(s->rebalance.next_check_ut && s->rebalance.next_check_ut <= now_ut &&
+                     !stream_sender_pending_replication_requests(s) &&
+                     !stream_sender_replicating_charts(s))) {
+            s->rebalance.next_check_ut = now_ut + stream_send.parents.rebalance_every_s * USEC_PER_SEC;
+
+            if(stream_parent_rebalance_check(s->host)) {
+                stream_sender_move_running_to_connector_or_remove(sth, s, STREAM_HANDSHAKE_SND_DISCONNECT_REBALANCE, 0, true);
+                continue;
+            }
+        }
+
         bytes_compressed += stats.bytes_added;
         bytes_uncompressed += stats.bytes_uncompressed;
 
@@ -652,8 +669,9 @@ bool stream_sender_send_data(struct stream_thread *sth, struct sender_state *s,
         stream_sender_lock(s);
 
         STREAM_CIRCULAR_BUFFER_STATS *stats = stream_circular_buffer_stats_unsafe(s->scb);
-        char *chunk;
-        size_t outstanding = stream_circular_buffer_get_unsafe(s->scb, &chunk);
+        struct iovec iov[2];
+        int iovcnt;
+        size_t outstanding = stream_circular_buffer_get_iovec_unsafe(s->scb, iov, &iovcnt);
 
         if(!outstanding) {
             status = EVLOOP_STATUS_NO_MORE_DATA;
@@ -662,7 +680,7 @@ bool stream_sender_send_data(struct stream_thread *sth, struct sender_state *s,
             continue;
         }
 
-        ssize_t rc = nd_sock_send_nowait(&s->sock, chunk, outstanding);
+        ssize_t rc = nd_sock_sendv_nowait(&s->sock, iov, iovcnt);
         if (likely(rc > 0)) {
             pulse_stream_sent_bytes(rc);
             stream_circular_buffer_del_unsafe(s->scb, rc, now_ut);
@@ -712,9 +730,9 @@ bool stream_sender_send_data(struct stream_thread *sth, struct sender_state *s,
 
             nd_log(NDLS_DAEMON, NDLP_ERR,
                    "STREAM SND[%zu] '%s' [to %s]: %s (%zd, on fd %d) - restarting connection - "
-                   "we have sent %zu bytes in %zu operations.",
+                   "we have sent %zu bytes in %zu operations (%zu commits in %zu batches).",
                    sth->id, rrdhost_hostname(s->host), s->remote_ip, disconnect_reason, rc, s->sock.fd,
-                   stats->bytes_sent, stats->sends);
+                   stats->bytes_sent, stats->sends, stats->commits, stats->batches);
 
             if(process_opcodes_and_enable_removal) {
                 // this is not executed from the opcode handling mechanism
@@ -835,8 +853,10 @@ bool stream_sender_process_poll_events(struct stream_thread *sth, struct sender_
         stream_sender_unlock(s);
 
         nd_log(NDLS_DAEMON, NDLP_ERR,
-               "STREAM SND[%zu] '%s' [to %s]: %s restarting connection - %zu bytes transmitted in %zu operations.",
-               sth->id, rrdhost_hostname(s->host), s->remote_ip, error, stats.bytes_sent, stats.sends);
+               "STREAM SND[%zu] '%s' [to %s]: %s restarting connection - %zu bytes transmitted in %zu operations "
+               "(%zu commits in %zu batches).",
+               sth->id, rrdhost_hostname(s->host), s->remote_ip, error, stats.bytes_sent, stats.sends,
+               stats.commits, stats.batches);
 
         stream_sender_move_running_to_connector_or_remove(sth, s, STREAM_HANDSHAKE_DISCONNECT_SOCKET_ERROR, 0, true);
         return false;
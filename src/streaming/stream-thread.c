@@ -544,6 +544,9 @@ void stream_thread(void *ptr) {
             // process any opcodes waiting
             stream_thread_process_opcodes(sth, NULL);
 
+            // give to the senders the data of collectors that stopped committing
+            sender_thread_buffers_flush_expired(now_ut);
+
             if(now_ut - last_check_all_nodes_ut >= nd_profile.update_every * USEC_PER_SEC) {
                 last_check_all_nodes_ut = now_ut;
 
@@ -30,7 +30,7 @@ void rrdset2json(RRDSET *st, BUFFER *wb, size_t *dimensions_count, size_t *memor
     buffer_json_member_add_string(wb, "context", rrdset_context(st));
     snprintfz(buf, RRD_ID_LENGTH_MAX + 15, "%s (%s)", rrdset_title(st), rrdset_name(st));
     buffer_json_member_add_string(wb, "title", buf);
-    buffer_json_member_add_int64(wb, "priority", st->priority);
+    buffer_json_member_add_int64(wb, "priority", rrdset_def(st)->priority);
     buffer_json_member_add_string(wb, "plugin", rrdset_plugin_name(st));
     buffer_json_member_add_string(wb, "module", rrdset_module_name(st));
     buffer_json_member_add_string(wb, "units", rrdset_units(st));
@@ -38,7 +38,7 @@ void rrdset2json(RRDSET *st, BUFFER *wb, size_t *dimensions_count, size_t *memor
     snprintfz(buf, RRD_ID_LENGTH_MAX + 15, "/api/v1/data?chart=%s", rrdset_name(st));
     buffer_json_member_add_string(wb, "data_url", buf);
 
-    buffer_json_member_add_string(wb, "chart_type", rrdset_type_name(st->chart_type));
+    buffer_json_member_add_string(wb, "chart_type", rrdset_type_name(rrdset_def(st)->chart_type));
     buffer_json_member_add_int64(wb, "duration", (int64_t)(last_entry_t - first_entry_t + st->update_every));
     buffer_json_member_add_int64(wb, "first_entry", (int64_t)first_entry_t);
     buffer_json_member_add_int64(wb, "last_entry", (int64_t)last_entry_t);
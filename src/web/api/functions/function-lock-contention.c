@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "function-lock-contention.h"
+
+#define FUNCTION_LOCK_CONTENTION_MAX_SITES 2048
+
+int function_lock_contention(BUFFER *wb, const char *function __maybe_unused, BUFFER *payload __maybe_unused, const char *source __maybe_unused) {
+    buffer_flush(wb);
+    wb->content_type = CT_APPLICATION_JSON;
+    buffer_json_initialize(wb, "\"", "\"", 0, true, BUFFER_JSON_OPTIONS_DEFAULT);
+
+    buffer_json_member_add_string(wb, "hostname", rrdhost_hostname(localhost));
+    buffer_json_member_add_uint64(wb, "status", HTTP_RESP_OK);
+    buffer_json_member_add_string(wb, "type", "table");
+    buffer_json_member_add_time_t(wb, "update_every", 1);
+    buffer_json_member_add_boolean(wb, "has_history", false);
+    buffer_json_member_add_string(wb, "help", RRDFUNCTIONS_LOCK_CONTENTION_HELP);
+
+    if(!lock_contention_enabled)
+        buffer_json_member_add_string(wb, "message", "Lock contention profiling is disabled. Enable it with [pulse].lock contention = yes in netdata.conf.");
+
+    LOCK_CONTENTION_SITE *sites = mallocz(FUNCTION_LOCK_CONTENTION_MAX_SITES * sizeof(*sites));
+    size_t used = lock_contention_sites(sites, FUNCTION_LOCK_CONTENTION_MAX_SITES);
+
+    uint64_t max_contended = 0, max_spins = 0, max_wait_ut = 0, max_avg_wait_ut = 0, max_max_wait_ut = 0;
+
+    buffer_json_member_add_array(wb, "data");
+    for(size_t i = 0; i < used ;i++) {
+        LOCK_CONTENTION_SITE *s = &sites[i];
+        uint64_t avg_wait_ut = s->contended ? s->wait_ut / s->contended : 0;
+
+        buffer_json_add_array_item_array(wb);
+        {
+            char id[256];
+            snprintfz(id, sizeof(id), "%s %s", lock_contention_type_name(s->type), s->function);
+
+            buffer_json_add_array_item_string(wb, id);
+            buffer_json_add_array_item_string(wb, s->function);
+            buffer_json_add_array_item_string(wb, lock_contention_type_name(s->type));
+            buffer_json_add_array_item_uint64(wb, s->contended);
+            buffer_json_add_array_item_uint64(wb, s->spins);
+            buffer_json_add_array_item_double(wb, (double)s->wait_ut / USEC_PER_MS);
+            buffer_json_add_array_item_uint64(wb, avg_wait_ut);
+            buffer_json_add_array_item_uint64(wb, s->max_wait_ut);
+        }
+        buffer_json_array_close(wb);
+
+        if(s->contended > max_contended) max_contended = s->contended;
+        if(s->spins > max_spins) max_spins = s->spins;
+        if(s->wait_ut > max_wait_ut) max_wait_ut = s->wait_ut;
+        if(avg_wait_ut > max_avg_wait_ut) max_avg_wait_ut = avg_wait_ut;
+        if(s->max_wait_ut > max_max_wait_ut) max_max_wait_ut = s->max_wait_ut;
+    }
+    buffer_json_array_close(wb); // data
+
+    freez(sites);
+
+    buffer_json_member_add_object(wb, "columns");
+    {
+        size_t field_id = 0;
+
+        buffer_rrdf_table_add_field(wb, field_id++, "ID", "Lock Type and Function",
+                                    RRDF_FIELD_TYPE_STRING, RRDF_FIELD_VISUAL_VALUE, RRDF_FIELD_TRANSFORM_NONE,
+                                    0, NULL, NAN, RRDF_FIELD_SORT_ASCENDING, NULL,
+                                    RRDF_FIELD_SUMMARY_COUNT, RRDF_FIELD_FILTER_NONE,
+                                    RRDF_FIELD_OPTS_UNIQUE_KEY,
+                                    NULL);
+
+        buffer_rrdf_table_add_field(wb, field_id++, "Function", "The Function that Called the Lock",
+                                    RRDF_FIELD_TYPE_STRING, RRDF_FIELD_VISUAL_VALUE, RRDF_FIELD_TRANSFORM_NONE,
+                                    0, NULL, NAN, RRDF_FIELD_SORT_ASCENDING, NULL,
+                                    RRDF_FIELD_SUMMARY_COUNT, RRDF_FIELD_FILTER_MULTISELECT,
+                                    RRDF_FIELD_OPTS_FULL_WIDTH | RRDF_FIELD_OPTS_VISIBLE | RRDF_FIELD_OPTS_STICKY,
+                                    NULL);
+
+        buffer_rrdf_table_add_field(wb, field_id++, "Lock", "Lock Type",
+                                    RRDF_FIELD_TYPE_STRING, RRDF_FIELD_VISUAL_VALUE, RRDF_FIELD_TRANSFORM_NONE,
+                                    0, NULL, NAN, RRDF_FIELD_SORT_ASCENDING, NULL,
+                                    RRDF_FIELD_SUMMARY_COUNT, RRDF_FIELD_FILTER_MULTISELECT,
+                                    RRDF_FIELD_OPTS_VISIBLE,
+                                    NULL);
+
+        buffer_rrdf_table_add_field(wb, field_id++, "Contended", "Number of Acquisitions that Had to Wait",
+                                    RRDF_FIELD_TYPE_INTEGER, RRDF_FIELD_VISUAL_VALUE, RRDF_FIELD_TRANSFORM_NUMBER,
+                                    0, "locks", (double)max_contended, RRDF_FIELD_SORT_DESCENDING, NULL,
+                                    RRDF_FIELD_SUMMARY_SUM, RRDF_FIELD_FILTER_RANGE,
+                                    RRDF_FIELD_OPTS_VISIBLE,
+                                    NULL);
+
+        buffer_rrdf_table_add_field(wb, field_id++, "Spins", "Number of Times the Callers Backed Off",
+                                    RRDF_FIELD_TYPE_INTEGER, RRDF_FIELD_VISUAL_VALUE, RRDF_FIELD_TRANSFORM_NUMBER,
+                                    0, "spins", (double)max_spins, RRDF_FIELD_SORT_DESCENDING, NULL,
+                                    RRDF_FIELD_SUMMARY_SUM, RRDF_FIELD_FILTER_RANGE,
+                                    RRDF_FIELD_OPTS_NONE,
+                                    NULL);
+
+        buffer_rrdf_table_add_field(wb, field_id++, "Wait Time", "Total Time the Callers Waited",
+                                    RRDF_FIELD_TYPE_BAR_WITH_INTEGER, RRDF_FIELD_VISUAL_BAR, RRDF_FIELD_TRANSFORM_NUMBER,
+                                    2, "ms", (double)max_wait_ut / USEC_PER_MS, RRDF_FIELD_SORT_DESCENDING, NULL,
+                                    RRDF_FIELD_SUMMARY_SUM, RRDF_FIELD_FILTER_RANGE,
+                                    RRDF_FIELD_OPTS_VISIBLE,
+                                    NULL);
+
+        buffer_rrdf_table_add_field(wb, field_id++, "Avg Wait", "Average Time a Caller Waited",
+                                    RRDF_FIELD_TYPE_INTEGER, RRDF_FIELD_VISUAL_VALUE, RRDF_FIELD_TRANSFORM_NUMBER,
+                                    0, "us", (double)max_avg_wait_ut, RRDF_FIELD_SORT_DESCENDING, NULL,
+                                    RRDF_FIELD_SUMMARY_MAX, RRDF_FIELD_FILTER_RANGE,
+                                    RRDF_FIELD_OPTS_VISIBLE,
+                                    NULL);
+
+        buffer_rrdf_table_add_field(wb, field_id++, "Max Wait", "Longest Time a Caller Waited",
+                                    RRDF_FIELD_TYPE_INTEGER, RRDF_FIELD_VISUAL_VALUE, RRDF_FIELD_TRANSFORM_NUMBER,
+                                    0, "us", (double)max_max_wait_ut, RRDF_FIELD_SORT_DESCENDING, NULL,
+                                    RRDF_FIELD_SUMMARY_MAX, RRDF_FIELD_FILTER_RANGE,
+                                    RRDF_FIELD_OPTS_VISIBLE,
+                                    NULL);
+    }
+    buffer_json_object_close(wb); // columns
+
+    buffer_json_member_add_string(wb, "default_sort_column", "Wait Time");
+
+    buffer_json_member_add_object(wb, "charts");
+    {
+        buffer_json_member_add_object(wb, "Wait Time");
+        {
+            buffer_json_member_add_string(wb, "name", "Wait Time");
+            buffer_json_member_add_string(wb, "type", "stacked-bar");
+            buffer_json_member_add_array(wb, "columns");
+            buffer_json_add_array_item_string(wb, "Wait Time");
+            buffer_json_array_close(wb);
+        }
+        buffer_json_object_close(wb);
+    }
+    buffer_json_object_close(wb); // charts
+
+    buffer_json_member_add_array(wb, "default_charts");
+    {
+        buffer_json_add_array_item_array(wb);
+        buffer_json_add_array_item_string(wb, "Wait Time");
+        buffer_json_add_array_item_string(wb, "Lock");
+        buffer_json_array_close(wb);
+    }
+    buffer_json_array_close(wb); // default_charts
+
+    buffer_json_member_add_object(wb, "group_by");
+    {
+        buffer_json_member_add_object(wb, "Lock");
+        {
+            buffer_json_member_add_string(wb, "name", "Lock Type");
+            buffer_json_member_add_array(wb, "columns");
+            buffer_json_add_array_item_string(wb, "Lock");
+            buffer_json_array_close(wb);
+        }
+        buffer_json_object_close(wb);
+    }
+    buffer_json_object_close(wb); // group_by
+
+    buffer_json_member_add_time_t(wb, "expires", now_realtime_sec() + 1);
+    buffer_json_finalize(wb);
+
+    return HTTP_RESP_OK;
+}
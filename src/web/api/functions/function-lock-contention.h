@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_FUNCTION_LOCK_CONTENTION_H
+#define NETDATA_FUNCTION_LOCK_CONTENTION_H
+
+#include "database/rrd.h"
+
+#define RRDFUNCTIONS_LOCK_CONTENTION_HELP "Shows the spinlocks, rw-spinlocks and wait queues of the agent that callers had to wait for, by the function that called them. Lock contention profiling has to be enabled with [pulse].lock contention in netdata.conf."
+
+int function_lock_contention(BUFFER *wb, const char *function, BUFFER *payload, const char *source);
+
+#endif //NETDATA_FUNCTION_LOCK_CONTENTION_H
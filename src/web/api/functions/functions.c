@@ -52,4 +52,16 @@ void global_functions_add(void) {
         "top",
         HTTP_ACCESS_ANONYMOUS_DATA,
         function_metrics_cardinality);
+
+    rrd_function_add_inline(
+        localhost,
+        NULL,
+        "netdata-lock-contention",
+        10,
+        RRDFUNCTIONS_PRIORITY_DEFAULT + 1,
+        RRDFUNCTIONS_VERSION_DEFAULT,
+        RRDFUNCTIONS_LOCK_CONTENTION_HELP,
+        "top",
+        HTTP_ACCESS_SIGNED_ID | HTTP_ACCESS_SAME_SPACE | HTTP_ACCESS_SENSITIVE_DATA,
+        function_lock_contention);
 }
@@ -922,6 +922,57 @@ void web_client_build_http_header(struct web_client *w) {
     buffer_strcat(w->response.header_output, "\r\n");
 }
 
+// send the HTTP header on a plain socket, together with the body when possible,
+// so that small responses need one system call.
+// Returns the bytes of the header sent - the body bytes sent are added to w->response.sent
+static ssize_t web_client_send_http_header_plain(struct web_client *w) {
+    size_t header_len = buffer_strlen(w->response.header_output);
+
+    bool with_body = w->response.data->len &&
+                     !w->response.zoutput &&
+                     !(w->flags & WEB_CLIENT_CHUNKED_TRANSFER) &&
+                     w->mode != HTTP_REQUEST_MODE_STREAM &&
+                     w->response.code != HTTP_RESP_WEBSOCKET_HANDSHAKE;
+
+    struct iovec iov[2] = {
+        { .iov_base = (void *)buffer_tostring(w->response.header_output), .iov_len = header_len },
+        { .iov_base = w->response.data->buffer, .iov_len = w->response.data->len },
+    };
+
+    size_t header_sent = 0, count = 0;
+    while(header_sent < header_len) {
+        struct msghdr msg = {
+            .msg_iov = iov,
+            .msg_iovlen = with_body ? 2 : 1,
+        };
+
+        ssize_t rc = sendmsg(w->fd, &msg, 0);
+        if(rc == -1) {
+            count++;
+
+            if(count > 100 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                netdata_log_error("Cannot send HTTP headers to web client.");
+                return -1;
+            }
+            continue;
+        }
+
+        size_t header_bytes = MIN((size_t)rc, header_len - header_sent);
+        header_sent += header_bytes;
+        iov[0].iov_base = (char *)iov[0].iov_base + header_bytes;
+        iov[0].iov_len -= header_bytes;
+
+        // the body is sent only after the whole header
+        size_t body_bytes = (size_t)rc - header_bytes;
+        if(body_bytes) {
+            w->response.sent += body_bytes;
+            w->statistics.sent_bytes += body_bytes;
+        }
+    }
+
+    return (ssize_t)header_sent;
+}
+
 static inline void web_client_send_http_header(struct web_client *w) {
     // For WebSocket handshake, the header is already fully prepared in websocket_handle_handshake
     // For standard HTTP responses, we need to build the header
@@ -938,7 +989,6 @@ static inline void web_client_send_http_header(struct web_client *w) {
 
     sock_setcork(w->fd, true);
 
-    size_t count = 0;
     ssize_t bytes;
 
     if ( (web_client_check_conn_tcp(w)) && (netdata_ssl_web_server_ctx) ) {
@@ -946,27 +996,11 @@ static inline void web_client_send_http_header(struct web_client *w) {
             bytes = netdata_ssl_write(&w->ssl, buffer_tostring(w->response.header_output), buffer_strlen(w->response.header_output));
             web_client_enable_wait_from_ssl(w);
         }
-        else {
-            while((bytes = send(w->fd, buffer_tostring(w->response.header_output), buffer_strlen(w->response.header_output), 0)) == -1) {
-                count++;
-
-                if(count > 100 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
-                    netdata_log_error("Cannot send HTTP headers to web client.");
-                    break;
-                }
-            }
-        }
-    }
-    else if(web_client_check_conn_tcp(w) || web_client_check_conn_unix(w)) {
-        while((bytes = send(w->fd, buffer_tostring(w->response.header_output), buffer_strlen(w->response.header_output), 0)) == -1) {
-            count++;
-
-            if(count > 100 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
-                netdata_log_error("Cannot send HTTP headers to web client.");
-                break;
-            }
-        }
+        else
+            bytes = web_client_send_http_header_plain(w);
     }
+    else if(web_client_check_conn_tcp(w) || web_client_check_conn_unix(w))
+        bytes = web_client_send_http_header_plain(w);
     else
         bytes = -999;
 